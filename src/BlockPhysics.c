@@ -14,95 +14,380 @@
 #include "Vectors.h"
 #include "Chat.h"
 
-/* Data for a resizable queue, used for liquid physic tick entries. */
-struct TickQueue {
-	cc_uint32* entries; /* Buffer holding the items in the tick queue */
+/* Data for a growable list, used for liquid physics tick entries. */
+struct PhysicsList {
+	cc_uint32* entries; /* Buffer holding the items in the list */
 	int capacity; /* Max number of elements in the buffer */
-	int mask;     /* capacity - 1, as capacity is always a power of two */
 	int count;    /* Number of used elements */
-	int head;     /* Head index into the buffer */
-	int tail;     /* Tail index into the buffer */
 };
 
-static void TickQueue_Init(struct TickQueue* queue) {
-	queue->entries  = NULL;
-	queue->capacity = 0;
-	queue->mask  = 0;
-	queue->count = 0;
-	queue->head  = 0;
-	queue->tail  = 0;
+static void PhysicsList_Add(struct PhysicsList* list, cc_uint32 item) {
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity ? list->capacity * 2 : 32;
+		list->entries  = (cc_uint32*)Mem_Realloc(list->entries, list->capacity, 4, "physics list");
+	}
+	list->entries[list->count++] = item;
+}
+
+static void PhysicsList_Free(struct PhysicsList* list) {
+	Mem_Free(list->entries);
+	list->entries  = NULL;
+	list->capacity = 0;
+	list->count    = 0;
 }
 
-static void TickQueue_Clear(struct TickQueue* queue) {
-	if (!queue->entries) return;
-	Mem_Free(queue->entries);
-	TickQueue_Init(queue);
+
+/* Liquid tick entries are stored in a timing wheel, so each tick only looks at the entries due in that tick. */
+/* Entries due in the current or next block of WHEEL_SIZE ticks are stored in the bucket for their tick. */
+/* Entries due later are stored in the bucket for their block instead, and moved into the bucket for their tick */
+/*  when the block before theirs starts. (so entries can be delayed by any number of ticks) */
+#define WHEEL_SHIFT 5
+#define WHEEL_SIZE  (1 << WHEEL_SHIFT)
+#define WHEEL_MASK  (WHEEL_SIZE - 1)
+#define WHEEL_TICKS_MASK  (WHEEL_SIZE * 2 - 1)
+#define WHEEL_MAX_ENTRIES (Int32_MaxValue / 4)
+
+struct TickWheel {
+	struct PhysicsList ticks[WHEEL_SIZE * 2]; /* Entries due in the current or next block, by tick */
+	struct PhysicsList blocks[WHEEL_SIZE];    /* Entries due in later blocks, as (index, due tick) pairs */
+	cc_uint32 now; /* Tick that entries are being processed for next */
+	int count;     /* Total number of entries in the wheel */
+};
+
+static void TickWheel_Clear(struct TickWheel* wheel) {
+	int i;
+	for (i = 0; i < WHEEL_SIZE * 2; i++) { PhysicsList_Free(&wheel->ticks[i]);  }
+	for (i = 0; i < WHEEL_SIZE;     i++) { PhysicsList_Free(&wheel->blocks[i]); }
+	wheel->count = 0;
 }
 
-static void TickQueue_Resize(struct TickQueue* queue) {
-	cc_uint32* entries;
-	int i, idx, capacity;
+/* Adds an entry that is due the given number of ticks after the next tick. */
+/* NOTE: Entries due in the same tick are always processed in the order they were added in. */
+static void TickWheel_Add(struct TickWheel* wheel, int index, cc_uint32 delay) {
+	cc_uint32 due = wheel->now + delay;
+	struct PhysicsList* list;
 
-	if (queue->capacity >= (Int32_MaxValue / 4)) {
+	if (wheel->count >= WHEEL_MAX_ENTRIES) {
 		Chat_AddRaw("&cToo many physics entries, clearing");
-		TickQueue_Clear(queue);
+		TickWheel_Clear(wheel);
 		return;
 	}
+	wheel->count++;
 
-	capacity = queue->capacity * 2;
-	if (capacity < 32) capacity = 32;
-	entries = (cc_uint32*)Mem_Alloc(capacity, 4, "physics tick queue");
+	if ((due >> WHEEL_SHIFT) <= (wheel->now >> WHEEL_SHIFT) + 1) {
+		PhysicsList_Add(&wheel->ticks[due & WHEEL_TICKS_MASK], index);
+	} else {
+		list = &wheel->blocks[(due >> WHEEL_SHIFT) & WHEEL_MASK];
+		PhysicsList_Add(list, index);
+		PhysicsList_Add(list, due);
+	}
+}
 
-	/* Elements must be readjusted to avoid index wrapping issues */
-	/* https://stackoverflow.com/questions/55343683/resizing-of-the-circular-queue-using-dynamic-array */
-	for (i = 0; i < queue->count; i++) {
-		idx = (queue->head + i) & queue->mask;
-		entries[i] = queue->entries[idx];
+/* Returns the entries due in the next tick. */
+#define TickWheel_Due(wheel) (&(wheel)->ticks[(wheel)->now & WHEEL_TICKS_MASK])
+
+/* Removes the entries due in the next tick, then moves on to the tick after that. */
+static void TickWheel_Advance(struct TickWheel* wheel) {
+	struct PhysicsList* list = TickWheel_Due(wheel);
+	cc_uint32 block, due;
+	int i, j;
+
+	wheel->count -= list->count;
+	list->count   = 0;
+	wheel->now++;
+	if (wheel->now & WHEEL_MASK) return;
+
+	/* Started a new block, so entries due in the block after it now go in the buckets for their ticks */
+	block = (wheel->now >> WHEEL_SHIFT) + 1;
+	list  = &wheel->blocks[block & WHEEL_MASK];
+
+	for (i = 0, j = 0; i < list->count; i += 2) {
+		due = list->entries[i + 1];
+
+		if ((due >> WHEEL_SHIFT) == block) {
+			PhysicsList_Add(&wheel->ticks[due & WHEEL_TICKS_MASK], list->entries[i]);
+		} else {
+			/* Entry is due in a block WHEEL_SIZE or more blocks later */
+			list->entries[j++] = list->entries[i];
+			list->entries[j++] = due;
+		}
 	}
-	Mem_Free(queue->entries);
+	list->count = j;
+}
+
 
-	queue->entries  = entries;
-	queue->capacity = capacity;
-	queue->mask     = capacity - 1; /* capacity is power of two */
-	queue->head = 0;
-	queue->tail = queue->count;
+struct Physics_ Physics;
+static RNGState physics_rnd;
+static int physics_tickCount;
+static int physics_maxWaterX, physics_maxWaterY, physics_maxWaterZ;
+static struct TickWheel lavaWheel, waterWheel;
+
+/* Number of ticks before lava/water flows again */
+#define PHYSICS_LAVA_DELAY  30
+#define PHYSICS_WATER_DELAY 5
+
+/* Liquid tick entries due in a tick are partitioned into regions of 16x16 columns of the map, which are ticked in 9 passes */
+/*  (one for each value of (regionX % 3, regionZ % 3)), so regions ticked in the same pass are always at least */
+/*  two regions apart. Ticking a liquid only accesses blocks within 3 blocks of it, so regions in the same pass */
+/*  never access the same blocks (or 16x16x16 world section/sponge count), and can be ticked on different threads. */
+#define REGION_SHIFT  4
+#define REGION_SIZE   (1 << REGION_SHIFT)
+#define REGION_PASSES 9
+
+struct PhysicsRegion {
+	struct PhysicsList due;     /* Tick entries for liquids in this region due in the current tick */
+	struct PhysicsList spawned; /* Tick entries queued while ticking as (index, delay), added to the wheel afterwards */
+	struct PhysicsList changes; /* Block changes made while ticking on background threads, as (index, old << 16 | now) */
+};
+
+static struct PhysicsRegion* regions;
+static int regionsX, regionsZ, regionsCount;
+/* Indices of all regions, sorted by the pass they are ticked in */
+static int* regionsOrder;
+static int regionsPassStart[REGION_PASSES + 1];
+
+/* Indices of the regions being ticked, in the order they are ticked */
+static int* tickedRegions;
+static int tickedPassStart[REGION_PASSES + 1];
+/* Whether block changes are being deferred until all regions have been ticked (see Physics_ApplyChanges) */
+static cc_bool physics_deferChanges;
+/* Whether liquids are being ticked for Physics_Benchmark, so the game isn't running */
+static cc_bool physics_benchmarking;
+static volatile cc_bool physics_outOfMemory;
+
+static struct PhysicsRegion* Physics_RegionOf(int index) {
+	int x = index % World.Width;
+	int z = (index / World.Width) % World.Length;
+	return &regions[(z >> REGION_SHIFT) * regionsX + (x >> REGION_SHIFT)];
 }
 
-/* Appends an entry to the end of the queue, resizing if necessary. */
-static void TickQueue_Enqueue(struct TickQueue* queue, cc_uint32 item) {
-	if (queue->count == queue->capacity)
-		TickQueue_Resize(queue);
+static void Physics_FreeRegions(void) {
+	int i;
+	for (i = 0; i < regionsCount; i++) {
+		PhysicsList_Free(&regions[i].due);
+		PhysicsList_Free(&regions[i].spawned);
+		PhysicsList_Free(&regions[i].changes);
+	}
 
-	queue->entries[queue->tail] = item;
-	queue->tail = (queue->tail + 1) & queue->mask;
-	queue->count++;
+	Mem_Free(regions);
+	Mem_Free(regionsOrder);
+	Mem_Free(tickedRegions);
+	regions       = NULL;
+	regionsOrder  = NULL;
+	tickedRegions = NULL;
+	regionsCount  = 0;
 }
 
-/* Retrieves the entry from the front of the queue. */
-static cc_uint32 TickQueue_Dequeue(struct TickQueue* queue) {
-	cc_uint32 result = queue->entries[queue->head];
-	queue->head = (queue->head + 1) & queue->mask;
-	queue->count--;
-	return result;
+static void Physics_AllocRegions(void) {
+	int x, z, pass, i = 0;
+	regionsX = (World.Width  + REGION_SIZE - 1) >> REGION_SHIFT;
+	regionsZ = (World.Length + REGION_SIZE - 1) >> REGION_SHIFT;
+	regionsCount = regionsX * regionsZ;
+	if (!regionsCount) return;
+
+	regions       = (struct PhysicsRegion*)Mem_AllocCleared(regionsCount, sizeof(struct PhysicsRegion), "physics regions");
+	regionsOrder  = (int*)Mem_Alloc(regionsCount, 4, "physics regions order");
+	tickedRegions = (int*)Mem_Alloc(regionsCount, 4, "physics ticked regions");
+
+	for (pass = 0; pass < REGION_PASSES; pass++) {
+		regionsPassStart[pass] = i;
+		for (z = pass / 3; z < regionsZ; z += 3) {
+			for (x = pass % 3; x < regionsX; x += 3) {
+				regionsOrder[i++] = z * regionsX + x;
+			}
+		}
+	}
+	regionsPassStart[REGION_PASSES] = i;
 }
 
+/* Queues a tick entry for the lava or water block at the given index, after the given number of ticks. */
+/* When called while ticking a region, the entry is deferred until all regions have been ticked. */
+static void Physics_Queue(struct PhysicsRegion* ticking, cc_bool lava, int index, cc_uint32 delay) {
+	if (ticking) {
+		PhysicsList_Add(&ticking->spawned, index);
+		PhysicsList_Add(&ticking->spawned, delay);
+	} else {
+		TickWheel_Add(lava ? &lavaWheel : &waterWheel, index, delay);
+	}
+}
 
-struct Physics_ Physics;
-static RNGState physics_rnd;
-static int physics_tickCount;
-static int physics_maxWaterX, physics_maxWaterY, physics_maxWaterZ;
-static struct TickQueue lavaQ, waterQ;
+/* Changes the block at the given coordinates as the result of a liquid flowing. */
+static void Physics_SetLiquidBlock(struct PhysicsRegion* ticking, int index, int x, int y, int z, BlockID block) {
+	BlockID old;
+	if (physics_benchmarking) { World_TrySetBlock(x, y, z, block); return; }
+	if (!ticking || !physics_deferChanges) { Game_UpdateBlock(x, y, z, block); return; }
+
+	/* Game_UpdateBlock can only be called on the main thread */
+	old = World_GetBlock(x, y, z);
+	if (!World_TrySetBlock(x, y, z, block)) { physics_outOfMemory = true; return; }
+
+	PhysicsList_Add(&ticking->changes, index);
+	PhysicsList_Add(&ticking->changes, ((cc_uint32)old << 16) | block);
+}
+
+
+/* Number of sponges in each 16x16x16 chunk of the map, or SPONGES_UNCOUNTED if not counted yet. */
+/* Chunks are only counted when water first flows near them, so that maps without flowing water */
+/*  do not have to be scanned for sponges. Lets water skip checking for sponges around it in most cases. */
+#define SPONGES_UNCOUNTED 0xFFFF
+static cc_uint16* spongeCounts;
+/* Whether spongeCounts is used to skip checking for sponges around water. (only disabled when benchmarking) */
+static cc_bool physics_useSpongeCounts = true;
+
+/* Number of blocks which have a random tick handler in each 16x16x16 chunk of the map, */
+/*  or TICKABLE_UNCOUNTED if not counted yet. Chunks without any such blocks (e.g. only air or stone) */
+/*  are skipped entirely when randomly ticking blocks. Kept up to date by Physics_OnBlockUpdated. */
+#define TICKABLE_UNCOUNTED 0xFFFF
+/* Max number of chunks counted each tick, so that loading a map does not cause a long pause */
+#define TICKABLE_COUNTS_PER_TICK 32
+static cc_uint16* tickableCounts;
+
+static int chunksX, chunksY, chunksZ;
+#define Physics_ChunkIndex(x, y, z) ((((y) >> CHUNK_SHIFT) * chunksZ + ((z) >> CHUNK_SHIFT)) * chunksX + ((x) >> CHUNK_SHIFT))
+
+static void Physics_FreeChunkCounts(void) {
+	Mem_Free(spongeCounts);
+	spongeCounts = NULL;
+	Mem_Free(tickableCounts);
+	tickableCounts = NULL;
+}
+
+static void Physics_AllocChunkCounts(void) {
+	int count;
+	chunksX = (World.Width  + CHUNK_MAX) >> CHUNK_SHIFT;
+	chunksY = (World.Height + CHUNK_MAX) >> CHUNK_SHIFT;
+	chunksZ = (World.Length + CHUNK_MAX) >> CHUNK_SHIFT;
+
+	count = chunksX * chunksY * chunksZ;
+	if (!count) return;
+	spongeCounts   = (cc_uint16*)Mem_Alloc(count, 2, "physics sponge counts");
+	tickableCounts = (cc_uint16*)Mem_Alloc(count, 2, "physics tickable counts");
+	Mem_Set(spongeCounts,   0xFF, count * 2);
+	Mem_Set(tickableCounts, 0xFF, count * 2);
+}
+
+static int Physics_CountSponges(int cx, int cy, int cz) {
+	int x1 = cx << CHUNK_SHIFT, x2 = min(x1 + CHUNK_MAX, World.MaxX);
+	int y1 = cy << CHUNK_SHIFT, y2 = min(y1 + CHUNK_MAX, World.MaxY);
+	int z1 = cz << CHUNK_SHIFT, z2 = min(z1 + CHUNK_MAX, World.MaxZ);
+	int x, y, z, count = 0;
+
+	for (y = y1; y <= y2; y++) {
+		for (z = z1; z <= z2; z++) {
+			for (x = x1; x <= x2; x++) {
+				if (World_GetBlock(x, y, z) == BLOCK_SPONGE) count++;
+			}
+		}
+	}
+	return count;
+}
+
+static int Physics_CountTickable(int cx, int cy, int cz) {
+	int x1 = cx << CHUNK_SHIFT, x2 = min(x1 + CHUNK_MAX, World.MaxX);
+	int y1 = cy << CHUNK_SHIFT, y2 = min(y1 + CHUNK_MAX, World.MaxY);
+	int z1 = cz << CHUNK_SHIFT, z2 = min(z1 + CHUNK_MAX, World.MaxZ);
+	int x, y, z, count = 0;
+
+	for (y = y1; y <= y2; y++) {
+		for (z = z1; z <= z2; z++) {
+			for (x = x1; x <= x2; x++) {
+				if (Physics.OnRandomTick[(BlockRaw)World_GetBlock(x, y, z)]) count++;
+			}
+		}
+	}
+	return count;
+}
+
+/* Returns whether any of the chunks overlapping the given range of coordinates contain sponges. */
+/* NOTE: Counts any chunks not counted yet, so must only be called for blocks a thread may access. */
+static cc_bool Physics_AnySponges(int x1, int y1, int z1, int x2, int y2, int z2) {
+	int cx, cy, cz, i;
+	for (cy = y1 >> CHUNK_SHIFT; cy <= (y2 >> CHUNK_SHIFT); cy++) {
+		for (cz = z1 >> CHUNK_SHIFT; cz <= (z2 >> CHUNK_SHIFT); cz++) {
+			for (cx = x1 >> CHUNK_SHIFT; cx <= (x2 >> CHUNK_SHIFT); cx++) {
+				i = (cy * chunksZ + cz) * chunksX + cx;
+
+				if (spongeCounts[i] == SPONGES_UNCOUNTED) spongeCounts[i] = Physics_CountSponges(cx, cy, cz);
+				if (spongeCounts[i]) return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* Updates the number of sponges in the chunk containing the given coordinates. */
+static void Physics_ChangeSpongeCount(int x, int y, int z, int delta) {
+	int i;
+	if (!spongeCounts) return;
+	i = Physics_ChunkIndex(x, y, z);
+
+	if (spongeCounts[i] == SPONGES_UNCOUNTED) return;
+	spongeCounts[i] += delta;
+}
+
+/* Marks the chunk containing the given coordinates as needing its sponges to be counted again. */
+static void Physics_ResetSpongeCount(int x, int y, int z) {
+	if (!spongeCounts) return;
+	spongeCounts[Physics_ChunkIndex(x, y, z)] = SPONGES_UNCOUNTED;
+}
+
+void Physics_OnBlockUpdated(int x, int y, int z, BlockID old, BlockID now) {
+	cc_uint16* count;
+	if (!tickableCounts) return;
+	count = &tickableCounts[Physics_ChunkIndex(x, y, z)];
+
+	if (*count == TICKABLE_UNCOUNTED) return;
+	if (Physics.OnRandomTick[(BlockRaw)old]) (*count)--;
+	if (Physics.OnRandomTick[(BlockRaw)now]) (*count)++;
+}
+
+
+/* Random coordinates within a chunk are generated in batches, using several independent xorshift generators. */
+/* NOTE: Each step only uses shifts and xors on separate lanes, so compilers can vectorise it (e.g. using SSE2/NEON) */
+#define RANDOM_LANES 4
+#define RANDOM_BATCH 64
+static cc_uint32 randomLanes[RANDOM_LANES];
+static cc_uint16 randomOffsets[RANDOM_BATCH];
+static int randomNext = RANDOM_BATCH;
+/* Number of randomly chosen blocks ticked in each chunk every tick */
+static int physics_randomTicks = 3;
+
+static void Physics_SeedRandomBatch(void) {
+	int i;
+	/* xorshift generators must never have a state of 0 */
+	for (i = 0; i < RANDOM_LANES; i++) {
+		randomLanes[i] = (cc_uint32)Random_Next(&physics_rnd, Int32_MaxValue) | 1;
+	}
+	randomNext = RANDOM_BATCH;
+}
+
+static void Physics_NextRandomBatch(void) {
+	cc_uint32 state;
+	int i, j;
+
+	for (i = 0; i < RANDOM_BATCH; i += RANDOM_LANES) {
+		for (j = 0; j < RANDOM_LANES; j++) {
+			state  = randomLanes[j];
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			randomLanes[j] = state;
+
+			/* Top 12 bits are the X, Z, and Y coordinates within the chunk */
+			randomOffsets[i + j] = (cc_uint16)(state >> 20);
+		}
+	}
+	randomNext = 0;
+}
 
-#define PHYSICS_DELAY_MASK 0xF8000000UL
-#define PHYSICS_POS_MASK   0x07FFFFFFUL
-#define PHYSICS_DELAY_SHIFT 27
-#define PHYSICS_ONE_DELAY   (1U << PHYSICS_DELAY_SHIFT)
-#define PHYSICS_LAVA_DELAY (30U << PHYSICS_DELAY_SHIFT)
-#define PHYSICS_WATER_DELAY (5U << PHYSICS_DELAY_SHIFT)
 
 static void Physics_OnNewMapLoaded(void* obj) {
-	TickQueue_Clear(&lavaQ);
-	TickQueue_Clear(&waterQ);
+	TickWheel_Clear(&lavaWheel);
+	TickWheel_Clear(&waterWheel);
+	Physics_FreeRegions();
+	Physics_AllocRegions();
+	Physics_FreeChunkCounts();
+	Physics_AllocChunkCounts();
 
 	physics_maxWaterX = World.MaxX - 2;
 	physics_maxWaterY = World.MaxY - 2;
@@ -111,6 +396,7 @@ static void Physics_OnNewMapLoaded(void* obj) {
 	Tree_Blocks = World.Blocks;
 	Random_SeedFromCurrentTime(&physics_rnd);
 	Tree_Rnd = &physics_rnd;
+	Physics_SeedRandomBatch();
 }
 
 void Physics_SetEnabled(cc_bool enabled) {
@@ -118,8 +404,17 @@ void Physics_SetEnabled(cc_bool enabled) {
 	Physics_OnNewMapLoaded(NULL);
 }
 
+/* Gets the block at the given packed index. (only the lower 8 bits, as physics is only for classic blocks) */
+static BlockRaw Physics_GetBlock(int index) {
+	int x, y, z;
+	if (World.Blocks) return World.Blocks[index];
+
+	World_Unpack(index, x, y, z);
+	return (BlockRaw)World_GetSectionBlock(x, y, z);
+}
+
 static void Physics_Activate(int index) {
-	BlockID block = World.Blocks[index];
+	BlockID block = Physics_GetBlock(index);
 	PhysicsHandler activate = Physics.OnActivate[block];
 	if (activate) activate(index, block);
 }
@@ -152,6 +447,9 @@ void Physics_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now) {
 	}
 	index = World_Pack(x, y, z);
 
+	if (old == BLOCK_SPONGE) Physics_ChangeSpongeCount(x, y, z, -1);
+	if (now == BLOCK_SPONGE) Physics_ChangeSpongeCount(x, y, z,  1);
+
 	/* User can place/delete blocks over ID 256 */
 	if (now == BLOCK_AIR) {
 		handler = Physics.OnDelete[(BlockRaw)old];
@@ -164,36 +462,37 @@ void Physics_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now) {
 }
 
 static void Physics_TickRandomBlocks(void) {
-	int lo, hi, index;
+	int i = 0, counted = 0, index, offset, j;
 	BlockID block;
 	PhysicsHandler tick;
-	int x, y, z, x2, y2, z2;
-
-	for (y = 0; y < World.Height; y += CHUNK_SIZE) {
-		y2 = min(y + CHUNK_MAX, World.MaxY);
-		for (z = 0; z < World.Length; z += CHUNK_SIZE) {
-			z2 = min(z + CHUNK_MAX, World.MaxZ);
-			for (x = 0; x < World.Width; x += CHUNK_SIZE) {
-				x2 = min(x + CHUNK_MAX, World.MaxX);
-
-				/* Inlined 3 random ticks for this chunk */
-				lo = World_Pack( x,  y,  z);
-				hi = World_Pack(x2, y2, z2);
-				
-				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
-				tick = Physics.OnRandomTick[block];
-				if (tick) tick(index, block);
-
-				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
-				tick = Physics.OnRandomTick[block];
-				if (tick) tick(index, block);
-
-				index = Random_Range(&physics_rnd, lo, hi);
-				block = World.Blocks[index];
-				tick = Physics.OnRandomTick[block];
-				if (tick) tick(index, block);
+	int cx, cy, cz, x, y, z;
+	if (!tickableCounts) return;
+
+	for (cy = 0; cy < chunksY; cy++) {
+		for (cz = 0; cz < chunksZ; cz++) {
+			for (cx = 0; cx < chunksX; cx++, i++) {
+				/* Chunks not counted yet are still ticked, in case they contain tickable blocks */
+				if (tickableCounts[i] == TICKABLE_UNCOUNTED && counted < TICKABLE_COUNTS_PER_TICK) {
+					tickableCounts[i] = Physics_CountTickable(cx, cy, cz);
+					counted++;
+				}
+				if (!tickableCounts[i]) continue;
+
+				for (j = 0; j < physics_randomTicks; j++) {
+					if (randomNext == RANDOM_BATCH) Physics_NextRandomBatch();
+					offset = randomOffsets[randomNext++];
+
+					x = (cx << CHUNK_SHIFT) | (offset & CHUNK_MASK);
+					z = (cz << CHUNK_SHIFT) | ((offset >> 4) & CHUNK_MASK);
+					y = (cy << CHUNK_SHIFT) | (offset >> 8);
+					/* Chunks on the edges of the map may only be partially inside the map */
+					if (x > World.MaxX || y > World.MaxY || z > World.MaxZ) continue;
+
+					index = World_Pack(x, y, z);
+					block = Physics_GetBlock(index);
+					tick  = Physics.OnRandomTick[block];
+					if (tick) tick(index, block);
+				}
 			}
 		}
 	}
@@ -208,7 +507,7 @@ static void Physics_DoFalling(int index, BlockID block) {
 	/* Find lowest block can fall into */
 	while (index >= World.OneY) {
 		index -= World.OneY;
-		other  = World.Blocks[index];
+		other  = Physics_GetBlock(index);
 
 		if (other == BLOCK_AIR || (other >= BLOCK_WATER && other <= BLOCK_STILL_LAVA))
 			found = index;
@@ -225,18 +524,6 @@ static void Physics_DoFalling(int index, BlockID block) {
 	Physics_ActivateNeighbours(x, y, z, start);
 }
 
-static cc_bool Physics_CheckItem(struct TickQueue* queue, int* posIndex) {
-	cc_uint32 item = TickQueue_Dequeue(queue);
-	*posIndex     = (int)(item & PHYSICS_POS_MASK);
-
-	if (item >= PHYSICS_ONE_DELAY) {
-		item -= PHYSICS_ONE_DELAY;
-		TickQueue_Enqueue(queue, item);
-		return false;
-	}
-	return true;
-}
-
 
 static void Physics_HandleSapling(int index, BlockID block) {
 	IVec3 coords[TREE_MAX_COUNT];
@@ -248,7 +535,7 @@ static void Physics_HandleSapling(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 
 	below = BLOCK_AIR;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (below != BLOCK_GRASS) return;
 
 	height = 5 + Random_Next(&physics_rnd, 3);
@@ -295,7 +582,7 @@ static void Physics_HandleFlower(int index, BlockID block) {
 	}
 
 	below = BLOCK_DIRT;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (!(below == BLOCK_DIRT || below == BLOCK_GRASS)) {
 		Game_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
@@ -314,7 +601,7 @@ static void Physics_HandleMushroom(int index, BlockID block) {
 	}
 
 	below = BLOCK_STONE;
-	if (y > 0) below = World.Blocks[index - World.OneY];
+	if (y > 0) below = Physics_GetBlock(index - World.OneY);
 	if (!(below == BLOCK_STONE || below == BLOCK_COBBLE)) {
 		Game_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
@@ -323,91 +610,81 @@ static void Physics_HandleMushroom(int index, BlockID block) {
 
 
 static void Physics_PlaceLava(int index, BlockID block) {
-	TickQueue_Enqueue(&lavaQ, PHYSICS_LAVA_DELAY | index);
+	Physics_Queue(NULL, true, index, PHYSICS_LAVA_DELAY);
 }
 
-static void Physics_PropagateLava(int posIndex, int x, int y, int z) {
-	BlockID block = World.Blocks[posIndex];
+static void Physics_PropagateLava(struct PhysicsRegion* ticking, int posIndex, int x, int y, int z) {
+	BlockID block = Physics_GetBlock(posIndex);
 	if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-		Game_UpdateBlock(x, y, z, BLOCK_STONE);
+		Physics_SetLiquidBlock(ticking, posIndex, x, y, z, BLOCK_STONE);
 	} else if (Blocks.Collide[block] == COLLIDE_GAS) {
-		TickQueue_Enqueue(&lavaQ, PHYSICS_LAVA_DELAY | posIndex);
-		Game_UpdateBlock(x, y, z, BLOCK_LAVA);
+		Physics_Queue(ticking, true, posIndex, PHYSICS_LAVA_DELAY);
+		Physics_SetLiquidBlock(ticking, posIndex, x, y, z, BLOCK_LAVA);
 	}
 }
 
-static void Physics_ActivateLava(int index, BlockID block) {
+static void Physics_SpreadLava(struct PhysicsRegion* ticking, int index) {
 	int x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (x > 0)          Physics_PropagateLava(index - 1, x - 1, y, z);
-	if (x < World.MaxX) Physics_PropagateLava(index + 1, x + 1, y, z);
-	if (z > 0)          Physics_PropagateLava(index - World.Width, x, y, z - 1);
-	if (z < World.MaxZ) Physics_PropagateLava(index + World.Width, x, y, z + 1);
-	if (y > 0)          Physics_PropagateLava(index - World.OneY, x, y - 1, z);
+	if (x > 0)          Physics_PropagateLava(ticking, index - 1, x - 1, y, z);
+	if (x < World.MaxX) Physics_PropagateLava(ticking, index + 1, x + 1, y, z);
+	if (z > 0)          Physics_PropagateLava(ticking, index - World.Width, x, y, z - 1);
+	if (z < World.MaxZ) Physics_PropagateLava(ticking, index + World.Width, x, y, z + 1);
+	if (y > 0)          Physics_PropagateLava(ticking, index - World.OneY, x, y - 1, z);
 }
 
-static void Physics_TickLava(void) {
-	int i, count = lavaQ.count;
-	for (i = 0; i < count; i++) {
-		int index;
-		if (Physics_CheckItem(&lavaQ, &index)) {
-			BlockID block = World.Blocks[index];
-			if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
-			Physics_ActivateLava(index, block);
-		}
-	}
-}
+static void Physics_ActivateLava(int index, BlockID block) { Physics_SpreadLava(NULL, index); }
 
 
 static void Physics_PlaceWater(int index, BlockID block) {
-	TickQueue_Enqueue(&waterQ, PHYSICS_WATER_DELAY | index);
+	Physics_Queue(NULL, false, index, PHYSICS_WATER_DELAY);
 }
 
-static void Physics_PropagateWater(int posIndex, int x, int y, int z) {
-	BlockID block = World.Blocks[posIndex];
+/* Returns whether there is a sponge within 2 blocks of the given coordinates */
+static cc_bool Physics_NearSponge(int x, int y, int z) {
+	int x1 = x < 2 ? 0 : x - 2, x2 = x > physics_maxWaterX ? World.MaxX : x + 2;
+	int y1 = y < 2 ? 0 : y - 2, y2 = y > physics_maxWaterY ? World.MaxY : y + 2;
+	int z1 = z < 2 ? 0 : z - 2, z2 = z > physics_maxWaterZ ? World.MaxZ : z + 2;
 	int xx, yy, zz;
 
-	if (block == BLOCK_LAVA || block == BLOCK_STILL_LAVA) {
-		Game_UpdateBlock(x, y, z, BLOCK_STONE);
-	} else if (Blocks.Collide[block] == COLLIDE_GAS && block != BLOCK_ROPE) {
-		/* Sponge check */		
-		for (yy = (y < 2 ? 0 : y - 2); yy <= (y > physics_maxWaterY ? World.MaxY : y + 2); yy++) {
-			for (zz = (z < 2 ? 0 : z - 2); zz <= (z > physics_maxWaterZ ? World.MaxZ : z + 2); zz++) {
-				for (xx = (x < 2 ? 0 : x - 2); xx <= (x > physics_maxWaterX ? World.MaxX : x + 2); xx++) {
-					block = World_GetBlock(xx, yy, zz);
-					if (block == BLOCK_SPONGE) return;
-				}
+	if (physics_useSpongeCounts && !Physics_AnySponges(x1, y1, z1, x2, y2, z2)) return false;
+
+	for (yy = y1; yy <= y2; yy++) {
+		for (zz = z1; zz <= z2; zz++) {
+			for (xx = x1; xx <= x2; xx++) {
+				if (World_GetBlock(xx, yy, zz) == BLOCK_SPONGE) return true;
 			}
 		}
+	}
+	return false;
+}
+
+static void Physics_PropagateWater(struct PhysicsRegion* ticking, int posIndex, int x, int y, int z) {
+	BlockID block = Physics_GetBlock(posIndex);
+
+	if (block == BLOCK_LAVA || block == BLOCK_STILL_LAVA) {
+		Physics_SetLiquidBlock(ticking, posIndex, x, y, z, BLOCK_STONE);
+	} else if (Blocks.Collide[block] == COLLIDE_GAS && block != BLOCK_ROPE) {
+		if (Physics_NearSponge(x, y, z)) return;
 
-		TickQueue_Enqueue(&waterQ, PHYSICS_WATER_DELAY | posIndex);
-		Game_UpdateBlock(x, y, z, BLOCK_WATER);
+		Physics_Queue(ticking, false, posIndex, PHYSICS_WATER_DELAY);
+		Physics_SetLiquidBlock(ticking, posIndex, x, y, z, BLOCK_WATER);
 	}
 }
 
-static void Physics_ActivateWater(int index, BlockID block) {
+static void Physics_SpreadWater(struct PhysicsRegion* ticking, int index) {
 	int x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (x > 0)          Physics_PropagateWater(index - 1,           x - 1, y,     z);
-	if (x < World.MaxX) Physics_PropagateWater(index + 1,           x + 1, y,     z);
-	if (z > 0)          Physics_PropagateWater(index - World.Width, x,     y,     z - 1);
-	if (z < World.MaxZ) Physics_PropagateWater(index + World.Width, x,     y,     z + 1);
-	if (y > 0)          Physics_PropagateWater(index - World.OneY,  x,     y - 1, z);
+	if (x > 0)          Physics_PropagateWater(ticking, index - 1,           x - 1, y,     z);
+	if (x < World.MaxX) Physics_PropagateWater(ticking, index + 1,           x + 1, y,     z);
+	if (z > 0)          Physics_PropagateWater(ticking, index - World.Width, x,     y,     z - 1);
+	if (z < World.MaxZ) Physics_PropagateWater(ticking, index + World.Width, x,     y,     z + 1);
+	if (y > 0)          Physics_PropagateWater(ticking, index - World.OneY,  x,     y - 1, z);
 }
 
-static void Physics_TickWater(void) {
-	int i, count = waterQ.count;
-	for (i = 0; i < count; i++) {
-		int index;
-		if (Physics_CheckItem(&waterQ, &index)) {
-			BlockID block = World.Blocks[index];
-			if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
-			Physics_ActivateWater(index, block);
-		}
-	}
-}
+static void Physics_ActivateWater(int index, BlockID block) { Physics_SpreadWater(NULL, index); }
 
 
 static void Physics_PlaceSponge(int index, BlockID block) {
@@ -439,9 +716,9 @@ static void Physics_DeleteSponge(int index, BlockID block) {
 					if (!World_Contains(xx, yy, zz)) continue;
 
 					index = World_Pack(xx, yy, zz);
-					block = World.Blocks[index];
+					block = Physics_GetBlock(index);
 					if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-						TickQueue_Enqueue(&waterQ, index | PHYSICS_ONE_DELAY);
+						Physics_Queue(NULL, false, index, 1);
 					}
 				}
 			}
@@ -450,12 +727,254 @@ static void Physics_DeleteSponge(int index, BlockID block) {
 }
 
 
+static void Physics_TickRegion(struct PhysicsRegion* r, cc_bool lava) {
+	int i, index;
+	BlockID block;
+
+	for (i = 0; i < r->due.count; i++) {
+		index = (int)r->due.entries[i];
+		block = Physics_GetBlock(index);
+
+		if (lava) {
+			if (block == BLOCK_LAVA  || block == BLOCK_STILL_LAVA)  Physics_SpreadLava(r,  index);
+		} else {
+			if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) Physics_SpreadWater(r, index);
+		}
+	}
+	r->due.count = 0;
+}
+
+#define PHYSICS_MAX_WORKERS 16
+/* Liquids are only ticked on background threads when at least this many tick entries are due */
+#define PHYSICS_MIN_THREADED_ENTRIES 4096
+
+static int workersCount;
+static cc_bool workersStopping;
+static void* workerThreads[PHYSICS_MAX_WORKERS];
+/* Range of tickedRegions that still need to be ticked in the current pass */
+static int jobsNext, jobsEnd, jobsLeft;
+static cc_bool jobsLava;
+/* jobsMutex protects all of the job and worker state above */
+static void* jobsMutex;
+static void* pendingWaitable;
+static void* doneWaitable;
+
+/* Ticks the next region of the current pass. Returns false if there are no regions left to tick. */
+static cc_bool Physics_RunJob(void) {
+	int region = -1;
+	cc_bool lava, moreJobs;
+
+	Mutex_Lock(jobsMutex);
+	{
+		if (jobsNext < jobsEnd) region = tickedRegions[jobsNext++];
+		moreJobs = jobsNext < jobsEnd;
+		lava     = jobsLava;
+	}
+	Mutex_Unlock(jobsMutex);
+	if (region == -1) return false;
+
+	/* Wake up another worker to tick the remaining regions */
+	if (moreJobs) Waitable_Signal(pendingWaitable);
+	Physics_TickRegion(&regions[region], lava);
+
+	Mutex_Lock(jobsMutex);
+	{
+		jobsLeft--;
+		moreJobs = jobsLeft > 0;
+	}
+	Mutex_Unlock(jobsMutex);
+
+	if (!moreJobs) Waitable_Signal(doneWaitable);
+	return true;
+}
+
+static void Physics_WorkerLoop(void) {
+	cc_bool stopping;
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		{
+			stopping = workersStopping;
+		}
+		Mutex_Unlock(jobsMutex);
+		if (stopping) break;
+
+		/* Block until the main thread starts ticking another pass */
+		if (!Physics_RunJob()) Waitable_Wait(pendingWaitable);
+	}
+	/* Wake up the next worker so it can stop too */
+	Waitable_Signal(pendingWaitable);
+}
+
+static void Physics_StartWorkers(void) {
+	int i, cores;
+	cores = Thread_CoresCount();
+	/* Leave one core free for the main thread */
+	workersCount = Options_GetInt(OPT_PHYSICS_THREADS, 0, PHYSICS_MAX_WORKERS, cores - 1);
+#ifdef CC_BUILD_WEB
+	/* No background threads, so liquids are always ticked on the main thread */
+	workersCount = 0;
+#endif
+	if (!workersCount) return;
+
+	jobsMutex       = Mutex_Create();
+	pendingWaitable = Waitable_Create();
+	doneWaitable    = Waitable_Create();
+	for (i = 0; i < workersCount; i++) {
+		workerThreads[i] = Thread_Start(Physics_WorkerLoop);
+	}
+	Platform_Log1("Ticking liquids using %i background threads", &workersCount);
+}
+
+static void Physics_StopWorkers(void) {
+	int i;
+	if (!workersCount) return;
+
+	Mutex_Lock(jobsMutex);
+	{
+		workersStopping = true;
+	}
+	Mutex_Unlock(jobsMutex);
+	Waitable_Signal(pendingWaitable);
+
+	for (i = 0; i < workersCount; i++) {
+		Thread_Join(workerThreads[i]);
+	}
+
+	Mutex_Free(jobsMutex);
+	Waitable_Free(pendingWaitable);
+	Waitable_Free(doneWaitable);
+	workersCount    = 0;
+	workersStopping = false;
+}
+
+/* Ticks all the regions in the given range of tickedRegions, using the background threads if possible */
+static void Physics_RunPass(int begin, int end, cc_bool lava) {
+	cc_bool finished;
+	int i;
+
+	if (!physics_deferChanges || end - begin <= 1) {
+		for (i = begin; i < end; i++) {
+			Physics_TickRegion(&regions[tickedRegions[i]], lava);
+		}
+		return;
+	}
+
+	Mutex_Lock(jobsMutex);
+	{
+		jobsNext = begin;
+		jobsEnd  = end;
+		jobsLeft = end - begin;
+		jobsLava = lava;
+	}
+	Mutex_Unlock(jobsMutex);
+	Waitable_Signal(pendingWaitable);
+
+	/* Main thread ticks regions too, rather than just waiting for the workers */
+	while (Physics_RunJob()) { }
+
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		{
+			finished = jobsLeft == 0;
+		}
+		Mutex_Unlock(jobsMutex);
+
+		if (finished) break;
+		Waitable_Wait(doneWaitable);
+	}
+}
+
+/* Number of changes passed to Game_UpdateBlocks at once */
+#define PHYSICS_APPLY_BATCH 256
+
+/* Block changes made on background threads only changed the blocks in the world. So the changes are */
+/*  undone and then redone using Game_UpdateBlocks in the same order they were originally made in, */
+/*  so that lighting and rendering are updated exactly as if the changes were made on the main thread. */
+static void Physics_ApplyChanges(int count) {
+	struct PhysicsList* changes;
+	int indices[PHYSICS_APPLY_BATCH];
+	BlockID blocks[PHYSICS_APPLY_BATCH];
+	int i, j, index, x, y, z, n = 0;
+
+	for (i = count - 1; i >= 0; i--) {
+		changes = &regions[tickedRegions[i]].changes;
+
+		for (j = changes->count - 2; j >= 0; j -= 2) {
+			index = (int)changes->entries[j];
+			World_Unpack(index, x, y, z);
+			World_SetBlock(x, y, z, (BlockID)(changes->entries[j + 1] >> 16));
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		changes = &regions[tickedRegions[i]].changes;
+
+		for (j = 0; j < changes->count; j += 2) {
+			indices[n] = (int)changes->entries[j];
+			blocks[n]  = (BlockID)(changes->entries[j + 1] & 0xFFFF);
+			if (++n < PHYSICS_APPLY_BATCH) continue;
+
+			Game_UpdateBlocks(indices, blocks, n);
+			n = 0;
+		}
+		changes->count = 0;
+	}
+	Game_UpdateBlocks(indices, blocks, n);
+}
+
+/* Ticks all the queued lava or water tick entries. */
+/* NOTE: The resulting world is the same regardless of how many background threads are used. */
+static void Physics_TickLiquid(cc_bool lava) {
+	struct TickWheel* wheel = lava ? &lavaWheel : &waterWheel;
+	struct PhysicsList* due = TickWheel_Due(wheel);
+	struct PhysicsRegion* r;
+	int i, j, pass, count = 0, entries = due->count;
+
+	for (i = 0; i < entries; i++) {
+		r = Physics_RegionOf((int)due->entries[i]);
+		PhysicsList_Add(&r->due, due->entries[i]);
+	}
+	TickWheel_Advance(wheel);
+	if (!entries) return;
+
+	for (pass = 0; pass < REGION_PASSES; pass++) {
+		tickedPassStart[pass] = count;
+
+		for (i = regionsPassStart[pass]; i < regionsPassStart[pass + 1]; i++) {
+			if (!regions[regionsOrder[i]].due.count) continue;
+			tickedRegions[count++] = regionsOrder[i];
+		}
+	}
+	tickedPassStart[REGION_PASSES] = count;
+
+	physics_deferChanges = workersCount && entries >= PHYSICS_MIN_THREADED_ENTRIES;
+	for (pass = 0; pass < REGION_PASSES; pass++) {
+		Physics_RunPass(tickedPassStart[pass], tickedPassStart[pass + 1], lava);
+	}
+
+	if (physics_outOfMemory) {
+		physics_outOfMemory = false;
+		World_OutOfMemory(); return;
+	}
+	if (physics_deferChanges) Physics_ApplyChanges(count);
+
+	for (i = 0; i < count; i++) {
+		r = &regions[tickedRegions[i]];
+
+		for (j = 0; j < r->spawned.count; j += 2) {
+			Physics_Queue(NULL, lava, (int)r->spawned.entries[j], r->spawned.entries[j + 1]);
+		}
+		r->spawned.count = 0;
+	}
+}
+
+
 static void Physics_HandleSlab(int index, BlockID block) {
 	int x, y, z;
 	World_Unpack(index, x, y, z);
 	if (index < World.OneY) return;
 
-	if (World.Blocks[index - World.OneY] != BLOCK_SLAB) return;
+	if (Physics_GetBlock(index - World.OneY) != BLOCK_SLAB) return;
 	Game_UpdateBlock(x, y,     z, BLOCK_AIR);
 	Game_UpdateBlock(x, y - 1, z, BLOCK_DOUBLE_SLAB);
 }
@@ -465,7 +984,7 @@ static void Physics_HandleCobblestoneSlab(int index, BlockID block) {
 	World_Unpack(index, x, y, z);
 	if (index < World.OneY) return;
 
-	if (World.Blocks[index - World.OneY] != BLOCK_COBBLE_SLAB) return;
+	if (Physics_GetBlock(index - World.OneY) != BLOCK_COBBLE_SLAB) return;
 	Game_UpdateBlock(x, y,     z, BLOCK_AIR);
 	Game_UpdateBlock(x, y - 1, z, BLOCK_COBBLE);
 }
@@ -496,8 +1015,9 @@ static void Physics_HandleTnt(int index, BlockID block) {
 				if (!World_Contains(xx, yy, zz)) continue;
 				index = World_Pack(xx, yy, zz);
 
-				block = World.Blocks[index];
+				block = Physics_GetBlock(index);
 				if (block < BLOCK_CPE_COUNT && blocksTnt[block]) continue;
+				if (block == BLOCK_SPONGE) Physics_ResetSpongeCount(xx, yy, zz);
 
 				Game_UpdateBlock(xx, yy, zz, BLOCK_AIR);
 				Physics_ActivateNeighbours(xx, yy, zz, index);
@@ -506,11 +1026,74 @@ static void Physics_HandleTnt(int index, BlockID block) {
 	}
 }
 
+#define PHYSICS_BENCHMARK_TICKS 100
+/* Floods a generated map with water, returning how many blocks were flooded */
+static int Physics_BenchmarkFlood(int width, int height, int length, cc_uint64* elapsed) {
+	BlockRaw* blocks;
+	cc_uint64 beg;
+	int x, z, i, flooded = 0;
+
+	World_Reset();
+	blocks = (BlockRaw*)Mem_AllocCleared(width * height * length, 1, "physics benchmark map");
+	World_SetDimensions(width, height, length);
+
+	/* Stone floor with a sponge every 32 blocks, and water falling from every 16 blocks above */
+	for (i = 0; i < World.OneY * 8; i++) { blocks[i] = BLOCK_STONE; }
+	for (z = 0; z < length; z += 32) {
+		for (x = 0; x < width; x += 32) { blocks[World_Pack(x, 8, z)] = BLOCK_SPONGE; }
+	}
+	World_SetNewMap(blocks, width, height, length);
+
+	for (z = 8; z < length; z += 16) {
+		for (x = 8; x < width; x += 16) {
+			i = World_Pack(x, height - 1, z);
+			blocks[i] = BLOCK_WATER;
+			Physics_Queue(NULL, false, i, PHYSICS_WATER_DELAY);
+			flooded--;
+		}
+	}
+
+	beg = Stopwatch_Measure();
+	for (i = 0; i < PHYSICS_BENCHMARK_TICKS; i++) { Physics_TickLiquid(false); }
+	*elapsed = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+
+	for (i = 0; i < World.Volume; i++) { flooded += blocks[i] == BLOCK_WATER; }
+	return flooded;
+}
+
+void Physics_Benchmark(void) {
+	static const int sizes[][2] = { { 128, 128 }, { 256, 256 }, { 512, 512 } };
+	cc_uint64 elapsed;
+	int i, flooded, scanRate, countsRate;
+
+	/* Blocks component hasn't been initialised yet, as the game isn't running */
+	for (i = BLOCK_AIR; i < BLOCK_CPE_COUNT; i++) { Block_ResetProps((BlockID)i); }
+	Physics_Init();
+	physics_benchmarking = true;
+
+	for (i = 0; i < Array_Elems(sizes); i++) {
+		physics_useSpongeCounts = false;
+		flooded  = Physics_BenchmarkFlood(sizes[i][0], 64, sizes[i][1], &elapsed);
+		scanRate = (int)(flooded * 1000000.0 / elapsed);
+
+		physics_useSpongeCounts = true;
+		flooded    = Physics_BenchmarkFlood(sizes[i][0], 64, sizes[i][1], &elapsed);
+		countsRate = (int)(flooded * 1000000.0 / elapsed);
+
+		Platform_Log4("Flooding %i x 64 x %i map: %i blocks/sec scanning for sponges, %i blocks/sec using sponge counts",
+			&sizes[i][0], &sizes[i][1], &scanRate, &countsRate);
+	}
+
+	physics_benchmarking = false;
+	World_Reset();
+	Physics_Free();
+}
+
 void Physics_Init(void) {
 	Event_Register_(&WorldEvents.MapLoaded,    NULL, Physics_OnNewMapLoaded);
 	Physics.Enabled = Options_GetBool(OPT_BLOCK_PHYSICS, true);
-	TickQueue_Init(&lavaQ);
-	TickQueue_Init(&waterQ);
+	physics_randomTicks = Options_GetInt(OPT_PHYSICS_RANDOM_TICKS, 0, 256, 3);
+	Physics_StartWorkers();
 
 	Physics.OnPlace[BLOCK_SAND]        = Physics_DoFalling;
 	Physics.OnPlace[BLOCK_GRAVEL]      = Physics_DoFalling;
@@ -551,14 +1134,19 @@ void Physics_Init(void) {
 
 void Physics_Free(void) {
 	Event_Unregister_(&WorldEvents.MapLoaded,    NULL, Physics_OnNewMapLoaded);
+	Physics_StopWorkers();
+	TickWheel_Clear(&lavaWheel);
+	TickWheel_Clear(&waterWheel);
+	Physics_FreeRegions();
+	Physics_FreeChunkCounts();
 }
 
 void Physics_Tick(void) {
-	if (!Physics.Enabled || !World.Blocks) return;
+	if (!Physics.Enabled || !World_HasBlocks()) return;
 
 	/*if ((tickCount % 5) == 0) {*/
-	Physics_TickLava();
-	Physics_TickWater();
+	Physics_TickLiquid(true);
+	Physics_TickLiquid(false);
 	/*}*/
 	physics_tickCount++;
 	Physics_TickRandomBlocks();
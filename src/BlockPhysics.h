@@ -14,6 +14,8 @@ CC_VAR extern struct Physics_ {
 	PhysicsHandler OnActivate[256];
 	/* Called when this block is randomly activated. */
 	/* e.g. grass eventually fading to dirt in darkness */
+	/* NOTE: Chunks are only randomly ticked if they contain blocks with a handler, */
+	/*  so the map must be reloaded after changing which blocks have a handler. */
 	PhysicsHandler OnRandomTick[256];
 	/* Called when user manually places a block. */
 	PhysicsHandler OnPlace[256];
@@ -23,7 +25,12 @@ CC_VAR extern struct Physics_ {
 
 void Physics_SetEnabled(cc_bool enabled);
 void Physics_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now);
+/* Called whenever a block in the world is changed (including by physics), to update internal state. */
+void Physics_OnBlockUpdated(int x, int y, int z, BlockID old, BlockID now);
 void Physics_Init(void);
 void Physics_Free(void);
 void Physics_Tick(void);
+/* Logs how quickly water floods several generated maps, with and without using sponge counts. */
+/* NOTE: Replaces the current map, so must only be called before the game has started. */
+void Physics_Benchmark(void);
 #endif
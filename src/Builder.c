@@ -19,24 +19,8 @@ int Builder_SidesLevel, Builder_EdgeLevel;
 #define Builder_PackCount(xx, yy, zz) ((((yy) << 8) | ((zz) << 4) | (xx)) * FACE_COUNT)
 /* Packs an index into the 18x18x18 chunk array. Coordinates range from -1 to 16. */
 #define Builder_PackChunk(xx, yy, zz) (((yy) + 1) * EXTCHUNK_SIZE_2 + ((zz) + 1) * EXTCHUNK_SIZE + ((xx) + 1))
-
-static BlockID* Builder_Chunk;
-static cc_uint8* Builder_Counts;
-static int* Builder_BitFlags;
-static int Builder_X, Builder_Y, Builder_Z;
-static BlockID Builder_Block;
-static int Builder_ChunkIndex;
-static cc_bool Builder_FullBright;
-static int Builder_ChunkEndX, Builder_ChunkEndZ;
 static int Builder_Offsets[FACE_COUNT] = { -1,1, -EXTCHUNK_SIZE,EXTCHUNK_SIZE, -EXTCHUNK_SIZE_2,EXTCHUNK_SIZE_2 };
 
-static int (*Builder_StretchXLiquid)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
-static int (*Builder_StretchX)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static int (*Builder_StretchZ)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static void (*Builder_RenderBlock)(int countsIndex, int x, int y, int z);
-static void (*Builder_PrePrepareChunk)(void);
-static void (*Builder_PostPrepareChunk)(void);
-
 /* Contains state for vertices for a portion of a chunk mesh (vertices that are in a 1D atlas) */
 struct Builder1DPart {
 	struct VertexTextured* fVertices[FACE_COUNT];
@@ -44,10 +28,119 @@ struct Builder1DPart {
 	int sCount, sOffset, sAdvance;
 };
 
-/* Part builder data, for both normal and translucent parts.
-The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
-static struct Builder1DPart Builder_Parts[ATLAS1D_MAX_ATLASES * 2];
-static struct VertexTextured* Builder_Vertices;
+/* Contains the state of a chunk from the last time its mesh was built, */
+/*  so that only the rows of the chunk affected by block changes have to be stretched again. */
+struct BuilderCache {
+	int chunkIndex; /* -1 if not used by any chunk */
+	cc_uint32 lastUsed;
+	cc_bool valid; /* Whether the state below is from a completely built mesh */
+	cc_bool busy;  /* Whether a chunk is currently being built using this cache */
+	BlockID chunk[EXTCHUNK_SIZE_3];
+	cc_int16 heights[EXTCHUNK_SIZE_2];
+	cc_uint8 levels[EXTCHUNK_SIZE_3];
+	cc_uint8 counts[CHUNK_SIZE_3 * FACE_COUNT];
+	int bitFlags[EXTCHUNK_SIZE_3];
+};
+
+/* Size of the largest cells of blocks in level of detail meshes */
+#define LOD_MAX_SIZE (1 << CHUNK_MAX_LOD)
+/* Size of the region of blocks a level of detail mesh is built from (chunk and largest cells around it) */
+#define LOD_REGION_SIZE (CHUNK_SIZE + 2 * LOD_MAX_SIZE)
+
+/* Contains the data needed to build the mesh of a chunk, and the resulting mesh. */
+/* The input data is copied from the world when the job is created, so that */
+/*  a background thread can build the mesh without accessing the world at all. */
+struct BuilderJob {
+	struct ChunkInfo* info;
+	struct BuilderJob* next;
+	int x1, y1, z1, xMax, yMax, zMax;
+	int usedAtlases;
+	/* Level of detail the mesh is built at (see ChunkInfo.Lod) */
+	int lod;
+	/* Blocks in the chunk (and 1 block border around it) */
+	BlockID chunk[EXTCHUNK_SIZE_3];
+	/* Blocks in the chunk and in the cells around it, only when building a level of detail mesh */
+	/*  (these are combined into cells in 'chunk' when the mesh is built, see Lod_ReadCells) */
+	BlockID lodBlocks[LOD_REGION_SIZE * LOD_REGION_SIZE * LOD_REGION_SIZE];
+	/* Light heights of the columns in the chunk (and 1 block border around it) */
+	cc_int16 heights[EXTCHUNK_SIZE_2];
+	/* Light levels of the blocks in the chunk (and 1 block border around it), only when Lighting_Propagated */
+	cc_uint8 levels[EXTCHUNK_SIZE_3];
+	/* State from when the chunk's mesh was last built, or NULL if not cached */
+	struct BuilderCache* cache;
+	/* Vertices of the mesh built, or NULL if the chunk ended up having no vertices */
+	struct VertexTextured* vertices;
+	int totalVerts;
+	cc_bool hasNorm, hasTran;
+	/* Parts of the built mesh for each atlas, which replace the chunk's parts once the mesh is uploaded */
+	struct ChunkPartInfo normParts[ATLAS1D_MAX_ATLASES], tranParts[ATLAS1D_MAX_ATLASES];
+	/* Which faces of the chunk are connected to each other through non-opaque blocks */
+	cc_uint32 occlusionFlags;
+};
+
+/* Max sum of the light levels of the 4 cube points around a vertex (see Adv_SumLevels) */
+#define ADV_MAX_LIGHT (4 * 15)
+
+/* Contains the temp state used while building the mesh for a chunk. */
+/* Each background thread has its own, so that multiple chunks can be built at once. */
+struct BuilderContext {
+	struct BuilderJob* job;
+	BlockID* chunk;
+	cc_uint8* counts;
+	int* bitFlags;
+	int x, y, z;
+	BlockID block;
+	int chunkIndex;
+	cc_bool fullBright;
+	int chunkEndX, chunkEndZ;
+	struct VertexTextured* vertices;
+	RNGState spriteRng;
+	struct _DrawerData drawer;
+
+	/* Advanced/smooth lighting mesh builder state */
+	Vec3 minBB, maxBB;
+	int initBitFlags, baseOffset;
+	float x1, y1, z1, x2, y2, z2;
+	PackedCol lerp[ADV_MAX_LIGHT + 1], lerpX[ADV_MAX_LIGHT + 1], lerpZ[ADV_MAX_LIGHT + 1], lerpY[ADV_MAX_LIGHT + 1];
+	cc_bool tinted;
+
+	/* Part builder data, for both normal and translucent parts.
+	The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
+	struct Builder1DPart parts[ATLAS1D_MAX_ATLASES * 2];
+
+	/* Whether only the dirty rows/columns of the chunk are stretched again */
+	cc_bool incremental;
+	/* Whether the faces stretched along X in the given row (i.e. [y * 16 + z]) need to be stretched again */
+	cc_bool dirtyRows[CHUNK_SIZE_2];
+	/* Whether the faces stretched along Z in the given column (i.e. [y * 16 + x]) need to be stretched again */
+	cc_bool dirtyCols[CHUNK_SIZE_2];
+	/* Used when the chunk being built has no cached state */
+	cc_uint8 countsBuffer[CHUNK_SIZE_3 * FACE_COUNT];
+	int bitFlagsBuffer[EXTCHUNK_SIZE_3];
+	/* Number of rows/layers each stretched face was merged across (greedy mesh builder only) */
+	cc_uint8 spans[CHUNK_SIZE_3 * FACE_COUNT];
+
+	/* Flood fill state used when computing which faces of the chunk are connected */
+	cc_bool occVisited[CHUNK_SIZE_3];
+	cc_uint16 occStack[CHUNK_SIZE_3];
+};
+
+static int (*Builder_StretchXLiquid)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
+static int (*Builder_StretchX)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static int (*Builder_StretchZ)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static void (*Builder_RenderBlock)(struct BuilderContext* ctx, int countsIndex, int x, int y, int z);
+static void (*Builder_PrePrepareChunk)(struct BuilderContext* ctx);
+static void (*Builder_PostPrepareChunk)(struct BuilderContext* ctx);
+/* Whether the active builder supports only stretching the dirty rows/columns of a chunk again */
+static cc_bool Builder_Incremental;
+/* Defined in the 'Level of detail mesh builder' section */
+static cc_bool ReadLodChunkData(BlockID* blocks, int x1, int y1, int z1, int lod, cc_bool* outAllAir);
+static void LodBuilder_Build(struct BuilderContext* ctx, struct BuilderJob* job);
+
+/* Light heights are copied into the job when it is created, so the live heightmap is never accessed here */
+#define Builder_LightHeight(ctx, x, z) (ctx)->job->heights[((z) - (ctx)->job->z1 + 1) * EXTCHUNK_SIZE + ((x) - (ctx)->job->x1 + 1)]
+#define Builder_IsLit(ctx, x, y, z) ((y) > Builder_LightHeight(ctx, x, z))
+#define Builder_LightCol(ctx, x, y, z, sun, shadow) (Builder_IsLit(ctx, x, y, z) ? (sun) : (shadow))
 
 static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	int i, count = part->sCount;
@@ -55,23 +148,23 @@ static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	return count;
 }
 
-static int Builder1DPart_CalcOffsets(struct Builder1DPart* part, int offset) {
+static int Builder1DPart_CalcOffsets(struct BuilderContext* ctx, struct Builder1DPart* part, int offset) {
 	int i;
 	part->sOffset  = offset;
 	part->sAdvance = part->sCount >> 2;
 
 	offset += part->sCount;
 	for (i = 0; i < FACE_COUNT; i++) {
-		part->fVertices[i] = &Builder_Vertices[offset];
+		part->fVertices[i] = &ctx->vertices[offset];
 		offset += part->fCount[i];
 	}
 	return offset;
 }
 
-static int Builder_TotalVerticesCount(void) {
+static int Builder_TotalVerticesCount(struct BuilderContext* ctx) {
 	int i, count = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES * 2; i++) {
-		count += Builder1DPart_VerticesCount(&Builder_Parts[i]);
+		count += Builder1DPart_VerticesCount(&ctx->parts[i]);
 	}
 	return count;
 }
@@ -80,28 +173,28 @@ static int Builder_TotalVerticesCount(void) {
 /*########################################################################################################################*
 *----------------------------------------------------Base mesh builder----------------------------------------------------*
 *#########################################################################################################################*/
-static void AddSpriteVertices(BlockID block) {
+static void AddSpriteVertices(struct BuilderContext* ctx, BlockID block) {
 	int i = Atlas1D_Index(Block_Tex(block, FACE_XMAX));
-	struct Builder1DPart* part = &Builder_Parts[i];
+	struct Builder1DPart* part = &ctx->parts[i];
 	part->sCount += 4 * 4;
 }
 
-static void AddVertices(BlockID block, Face face) {
+static void AddVertices(struct BuilderContext* ctx, BlockID block, Face face) {
 	int baseOffset = (Blocks.Draw[block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
 	int i = Atlas1D_Index(Block_Tex(block, face));
-	struct Builder1DPart* part = &Builder_Parts[baseOffset + i];
+	struct Builder1DPart* part = &ctx->parts[baseOffset + i];
 	part->fCount[face] += 4;
 }
 
 #ifdef CC_BUILD_GL11
-static void BuildPartVbs(struct ChunkPartInfo* info) {
+static void BuildPartVbs(struct ChunkPartInfo* info, struct VertexTextured* vertices) {
 	/* Sprites vertices are stored before chunk face sides */
 	int i, count, offset = info->Offset + info->SpriteCount;
 	for (i = 0; i < FACE_COUNT; i++) {
 		count = info->Counts[i];
 
 		if (count) {
-			info->Vbs[i] = Gfx_CreateVb2(&Builder_Vertices[offset], VERTEX_FORMAT_TEXTURED, count);
+			info->Vbs[i] = Gfx_CreateVb2(&vertices[offset], VERTEX_FORMAT_TEXTURED, count);
 			offset += count;
 		} else {
 			info->Vbs[i] = 0;
@@ -111,7 +204,7 @@ static void BuildPartVbs(struct ChunkPartInfo* info) {
 	count  = info->SpriteCount;
 	offset = info->Offset;
 	if (count) {
-		info->Vbs[i] = Gfx_CreateVb2(&Builder_Vertices[offset], VERTEX_FORMAT_TEXTURED, count);
+		info->Vbs[i] = Gfx_CreateVb2(&vertices[offset], VERTEX_FORMAT_TEXTURED, count);
 	} else {
 		info->Vbs[i] = 0;
 	}
@@ -134,111 +227,351 @@ static void SetPartInfo(struct Builder1DPart* part, int* offset, struct ChunkPar
 	info->Counts[FACE_YMIN] = part->fCount[FACE_YMIN];
 	info->Counts[FACE_YMAX] = part->fCount[FACE_YMAX];
 	info->SpriteCount       = part->sCount;
-
-#ifdef CC_BUILD_GL11
-	BuildPartVbs(info);
-#endif
 }
 
 
-static void PrepareChunk(int x1, int y1, int z1) {
-	int xMax = min(World.Width,  x1 + CHUNK_SIZE);
-	int yMax = min(World.Height, y1 + CHUNK_SIZE);
-	int zMax = min(World.Length, z1 + CHUNK_SIZE);
+static void PrepareChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	int xMax = ctx->job->xMax;
+	int yMax = ctx->job->yMax;
+	int zMax = ctx->job->zMax;
+	BlockID* chunk   = ctx->chunk;
+	cc_uint8* counts = ctx->counts;
 
 	int cIndex, index, tileIdx;
 	BlockID b;
 	int x, y, z, xx, yy, zz;
+	cc_bool rowDirty = true, colDirty = true;
+
 
-#ifdef OCCLUSION
-	int flags = ComputeOcclusion();
-#endif
-#ifdef DEBUG_OCCLUSION
-	FastColour col = new FastColour(60, 60, 60, 255);
-	if (flags & 1) col.R = 255; /* x */
-	if (flags & 4) col.G = 255; /* y */
-	if (flags & 2) col.B = 255; /* z */
-	map.Sunlight = map.Shadowlight = col;
-	map.SunlightXSide = map.ShadowlightXSide = col;
-	map.SunlightZSide = map.ShadowlightZSide = col;
-	map.SunlightYBottom = map.ShadowlightYBottom = col;
-#endif
-	
 	for (y = y1, yy = 0; y < yMax; y++, yy++) {
 		for (z = z1, zz = 0; z < zMax; z++, zz++) {
 			cIndex = Builder_PackChunk(0, yy, zz);
+			if (ctx->incremental) rowDirty = ctx->dirtyRows[yy * CHUNK_SIZE + zz];
 
 			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				b = Builder_Chunk[cIndex];
+				/* Faces in clean rows/columns keep their counts from when the chunk was last built */
+				if (ctx->incremental) {
+					colDirty = ctx->dirtyCols[yy * CHUNK_SIZE + xx];
+					if (!rowDirty && !colDirty) continue;
+				}
+
+				b = chunk[cIndex];
 				if (Blocks.Draw[b] == DRAW_GAS) continue;
 				index = Builder_PackCount(xx, yy, zz);
 
 				/* Sprites can't be stretched, nor can then be they hidden by other blocks. */
 				/* Note sprites are drawn using DrawSprite and not with any of the DrawXFace. */
-				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(b); continue; }
+				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(ctx, b); continue; }
 
-				Builder_X = x; Builder_Y = y; Builder_Z = z;
-				Builder_FullBright = Blocks.FullBright[b];
+				ctx->x = x; ctx->y = y; ctx->z = z;
+				ctx->fullBright = Blocks.FullBright[b];
 				tileIdx = b * BLOCK_COUNT;
 				/* All of these function calls are inlined as they can be called tens of millions to hundreds of millions of times. */
 
-				if (Builder_Counts[index] == 0 ||
-					(x == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - 1]] & (1 << FACE_XMIN)) != 0)) {
-					Builder_Counts[index] = 0;
-				} else {
-					Builder_Counts[index] = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMIN);
+				if (colDirty) {
+					if (counts[index] == 0 ||
+						(x == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+						(x != 0 && (Blocks.Hidden[tileIdx + chunk[cIndex - 1]] & (1 << FACE_XMIN)) != 0)) {
+						counts[index] = 0;
+					} else {
+						counts[index] = Builder_StretchZ(ctx, index, x, y, z, cIndex, b, FACE_XMIN);
+					}
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(x == World.MaxX && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != World.MaxX && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + 1]] & (1 << FACE_XMAX)) != 0)) {
-					Builder_Counts[index] = 0;
-				} else {
-					Builder_Counts[index] = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMAX);
+				if (colDirty) {
+					if (counts[index] == 0 ||
+						(x == World.MaxX && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+						(x != World.MaxX && (Blocks.Hidden[tileIdx + chunk[cIndex + 1]] & (1 << FACE_XMAX)) != 0)) {
+						counts[index] = 0;
+					} else {
+						counts[index] = Builder_StretchZ(ctx, index, x, y, z, cIndex, b, FACE_XMAX);
+					}
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(z == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE]] & (1 << FACE_ZMIN)) != 0)) {
-					Builder_Counts[index] = 0;
-				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMIN);
+				if (rowDirty) {
+					if (counts[index] == 0 ||
+						(z == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+						(z != 0 && (Blocks.Hidden[tileIdx + chunk[cIndex - EXTCHUNK_SIZE]] & (1 << FACE_ZMIN)) != 0)) {
+						counts[index] = 0;
+					} else {
+						counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_ZMIN);
+					}
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(z == World.MaxZ && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != World.MaxZ && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE]] & (1 << FACE_ZMAX)) != 0)) {
-					Builder_Counts[index] = 0;
-				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMAX);
+				if (rowDirty) {
+					if (counts[index] == 0 ||
+						(z == World.MaxZ && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
+						(z != World.MaxZ && (Blocks.Hidden[tileIdx + chunk[cIndex + EXTCHUNK_SIZE]] & (1 << FACE_ZMAX)) != 0)) {
+						counts[index] = 0;
+					} else {
+						counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_ZMAX);
+					}
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 || y == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE_2]] & (1 << FACE_YMIN)) != 0) {
-					Builder_Counts[index] = 0;
-				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMIN);
+				if (rowDirty) {
+					if (counts[index] == 0 || y == 0 ||
+						(Blocks.Hidden[tileIdx + chunk[cIndex - EXTCHUNK_SIZE_2]] & (1 << FACE_YMIN)) != 0) {
+						counts[index] = 0;
+					} else {
+						counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_YMIN);
+					}
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE_2]] & (1 << FACE_YMAX)) != 0) {
-					Builder_Counts[index] = 0;
-				} else if (b < BLOCK_WATER || b > BLOCK_STILL_LAVA) {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMAX);
-				} else {
-					Builder_Counts[index] = Builder_StretchXLiquid(index, x, y, z, cIndex, b);
+				if (rowDirty) {
+					if (counts[index] == 0 ||
+						(Blocks.Hidden[tileIdx + chunk[cIndex + EXTCHUNK_SIZE_2]] & (1 << FACE_YMAX)) != 0) {
+						counts[index] = 0;
+					} else if (b < BLOCK_WATER || b > BLOCK_STILL_LAVA) {
+						counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_YMAX);
+					} else {
+						counts[index] = Builder_StretchXLiquid(ctx, index, x, y, z, cIndex, b);
+					}
+				}
+			}
+		}
+	}
+}
+
+/*########################################################################################################################*
+*-------------------------------------------------Incremental mesh building-----------------------------------------------*
+*#########################################################################################################################*/
+/* Max number of chunks whose state from when their mesh was last built is kept around */
+#define BUILDER_MAX_CACHES 16
+static struct BuilderCache* caches;
+static cc_uint32 cachesTime;
+
+/* Marks the rows/columns whose stretched faces may be affected by the block at the given coordinates changing. */
+/* (The visibility and lighting of a block's faces depends on the blocks in the 3x3x3 area around it) */
+static void MarkDirtyBlock(struct BuilderContext* ctx, int xx, int yy, int zz) {
+	int x, y, z;
+	for (y = max(yy - 1, 0); y <= min(yy + 1, CHUNK_MAX); y++) {
+		for (z = max(zz - 1, 0); z <= min(zz + 1, CHUNK_MAX); z++) {
+			ctx->dirtyRows[y * CHUNK_SIZE + z] = true;
+		}
+		for (x = max(xx - 1, 0); x <= min(xx + 1, CHUNK_MAX); x++) {
+			ctx->dirtyCols[y * CHUNK_SIZE + x] = true;
+		}
+	}
+}
+
+/* Marks the rows/columns whose stretched faces may be affected by the light height of the given column changing. */
+static void MarkDirtyColumn(struct BuilderContext* ctx, int xx, int zz) {
+	int x, y, z;
+	for (y = 0; y < CHUNK_SIZE; y++) {
+		for (z = max(zz - 1, 0); z <= min(zz + 1, CHUNK_MAX); z++) {
+			ctx->dirtyRows[y * CHUNK_SIZE + z] = true;
+		}
+		for (x = max(xx - 1, 0); x <= min(xx + 1, CHUNK_MAX); x++) {
+			ctx->dirtyCols[y * CHUNK_SIZE + x] = true;
+		}
+	}
+}
+
+/* Compares the chunk's blocks and lighting to the cached state, and marks rows/columns affected by changes as dirty. */
+/* Returns false if so much of the chunk changed that it is better to just rebuild the entire chunk instead. */
+static cc_bool DiffCache(struct BuilderContext* ctx, struct BuilderCache* cache) {
+	struct BuilderJob* job = ctx->job;
+	int i, xx, yy, zz, dirty = 0;
+
+	Mem_Set(ctx->dirtyRows, 0, sizeof(ctx->dirtyRows));
+	Mem_Set(ctx->dirtyCols, 0, sizeof(ctx->dirtyCols));
+
+	for (i = 0; i < EXTCHUNK_SIZE_3; i++) {
+		if (job->chunk[i] == cache->chunk[i]) continue;
+
+		xx = (i % EXTCHUNK_SIZE) - 1;
+		zz = (i / EXTCHUNK_SIZE) % EXTCHUNK_SIZE - 1;
+		yy = (i / EXTCHUNK_SIZE_2) - 1;
+		MarkDirtyBlock(ctx, xx, yy, zz);
+	}
+
+	for (i = 0; Lighting_Propagated && i < EXTCHUNK_SIZE_3; i++) {
+		if (job->levels[i] == cache->levels[i]) continue;
+
+		xx = (i % EXTCHUNK_SIZE) - 1;
+		zz = (i / EXTCHUNK_SIZE) % EXTCHUNK_SIZE - 1;
+		yy = (i / EXTCHUNK_SIZE_2) - 1;
+		MarkDirtyBlock(ctx, xx, yy, zz);
+	}
+
+	for (i = 0; i < EXTCHUNK_SIZE_2; i++) {
+		if (job->heights[i] == cache->heights[i]) continue;
+
+		xx = (i % EXTCHUNK_SIZE) - 1;
+		zz = (i / EXTCHUNK_SIZE) - 1;
+		MarkDirtyColumn(ctx, xx, zz);
+	}
+
+	for (i = 0; i < CHUNK_SIZE_2; i++) {
+		dirty += ctx->dirtyRows[i] + ctx->dirtyCols[i];
+	}
+	return dirty <= CHUNK_SIZE_2;
+}
+
+/* Resets the counts of the faces in the dirty rows/columns, so they are stretched again by PrepareChunk */
+static void ResetDirtyCounts(struct BuilderContext* ctx) {
+	int xx, yy, zz, index;
+	for (yy = 0; yy < CHUNK_SIZE; yy++) {
+		for (zz = 0; zz < CHUNK_SIZE; zz++) {
+			if (!ctx->dirtyRows[yy * CHUNK_SIZE + zz]) continue;
+
+			for (xx = 0; xx < CHUNK_SIZE; xx++) {
+				index = Builder_PackCount(xx, yy, zz);
+				ctx->counts[index + FACE_ZMIN] = 1; ctx->counts[index + FACE_ZMAX] = 1;
+				ctx->counts[index + FACE_YMIN] = 1; ctx->counts[index + FACE_YMAX] = 1;
+			}
+		}
+
+		for (xx = 0; xx < CHUNK_SIZE; xx++) {
+			if (!ctx->dirtyCols[yy * CHUNK_SIZE + xx]) continue;
+
+			for (zz = 0; zz < CHUNK_SIZE; zz++) {
+				index = Builder_PackCount(xx, yy, zz);
+				ctx->counts[index + FACE_XMIN] = 1; ctx->counts[index + FACE_XMAX] = 1;
+			}
+		}
+	}
+}
+
+/* Counts the vertices in each part of the chunk again, using the counts of faces in the chunk. */
+/* (PrepareChunk only adds vertices for faces it stretches, so this is needed after an incremental rebuild) */
+static void CountVertices(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	int xMax = ctx->job->xMax;
+	int yMax = ctx->job->yMax;
+	int zMax = ctx->job->zMax;
+	int cIndex, index, face;
+	BlockID b;
+	int x, y, z, xx, yy, zz;
+	Mem_Set(ctx->parts, 0, sizeof(ctx->parts));
+
+	for (y = y1, yy = 0; y < yMax; y++, yy++) {
+		for (z = z1, zz = 0; z < zMax; z++, zz++) {
+			cIndex = Builder_PackChunk(0, yy, zz);
+
+			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
+				b = ctx->chunk[cIndex];
+				if (Blocks.Draw[b] == DRAW_GAS) continue;
+				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(ctx, b); continue; }
+
+				index = Builder_PackCount(xx, yy, zz);
+				for (face = 0; face < FACE_COUNT; face++) {
+					if (ctx->counts[index + face]) AddVertices(ctx, b, face);
 				}
 			}
 		}
 	}
 }
 
+/* Returns the cached state for the given chunk, potentially reusing the least recently used cached state. */
+/* NOTE: Only chunks that have been changed are cached, as they are likely to be changed again soon. */
+static struct BuilderCache* AcquireCache(int chunkIndex, cc_bool changed) {
+	struct BuilderCache* cache;
+	struct BuilderCache* oldest = NULL;
+	int i;
+
+	for (i = 0; i < BUILDER_MAX_CACHES; i++) {
+		cache = &caches[i];
+		if (cache->chunkIndex == chunkIndex) {
+			cache->busy     = true;
+			cache->lastUsed = ++cachesTime;
+			return cache;
+		}
+
+		if (cache->busy) continue;
+		if (!oldest || cache->lastUsed < oldest->lastUsed) oldest = cache;
+	}
+
+	if (!changed || !oldest) return NULL;
+	oldest->chunkIndex = chunkIndex;
+	oldest->valid      = false;
+	oldest->busy       = true;
+	oldest->lastUsed   = ++cachesTime;
+	return oldest;
+}
+
+static void ReleaseCache(struct BuilderCache* cache, cc_bool valid) {
+	if (!cache) return;
+	cache->busy  = false;
+	cache->valid = valid;
+}
+
+static void ClearCaches(void) {
+	int i;
+	for (i = 0; i < BUILDER_MAX_CACHES; i++) {
+		caches[i].chunkIndex = -1;
+		caches[i].valid      = false;
+		caches[i].busy       = false;
+	}
+}
+
+/* Returns which faces of the chunk are touched by the given cell. (i.e. Bit 1 << FACE_XMIN set if on XMin face) */
+static int OccludedFaces(int xx, int yy, int zz) {
+	int faces = 0;
+	if (xx == 0) faces |= 1 << FACE_XMIN;
+	if (xx == CHUNK_MAX) faces |= 1 << FACE_XMAX;
+	if (zz == 0) faces |= 1 << FACE_ZMIN;
+	if (zz == CHUNK_MAX) faces |= 1 << FACE_ZMAX;
+	if (yy == 0) faces |= 1 << FACE_YMIN;
+	if (yy == CHUNK_MAX) faces |= 1 << FACE_YMAX;
+	return faces;
+}
+
+/* Flood fills the non-opaque blocks in the chunk, and computes which faces of the chunk */
+/*  can be seen from which other faces. (i.e. whether there is a path of non-opaque blocks between them) */
+static cc_uint32 ComputeOcclusion(struct BuilderContext* ctx) {
+	cc_bool* visited = ctx->occVisited;
+	cc_uint16* stack = ctx->occStack;
+	cc_uint32 flags  = 0;
+	int i, count, cell, cIndex, faces, a, b;
+	int xx, yy, zz;
+	Mem_Set(visited, 0, sizeof(ctx->occVisited));
+
+	/* cells are packed the same way as Builder_PackCount, i.e. (y << 8) | (z << 4) | x */
+	for (i = 0; i < CHUNK_SIZE_3; i++) {
+		if (visited[i]) continue;
+		visited[i] = true;
+		if (Blocks.FullOpaque[ctx->chunk[Builder_PackChunk(i & 0x0F, i >> 8, (i >> 4) & 0x0F)]]) continue;
+
+		stack[0] = i; count = 1;
+		faces    = 0;
+
+		while (count) {
+			cell = stack[--count];
+			xx = cell & 0x0F; zz = (cell >> 4) & 0x0F; yy = cell >> 8;
+			cIndex = Builder_PackChunk(xx, yy, zz);
+			faces |= OccludedFaces(xx, yy, zz);
+
+#define Occlusion_Visit(condition, cellOffset, chunkOffset) \
+if ((condition) && !visited[cell + (cellOffset)]) {\
+	visited[cell + (cellOffset)] = true;\
+	if (!Blocks.FullOpaque[ctx->chunk[cIndex + (chunkOffset)]]) stack[count++] = cell + (cellOffset);\
+}
+			Occlusion_Visit(xx > 0,          -1,            -1);
+			Occlusion_Visit(xx < CHUNK_MAX,   1,             1);
+			Occlusion_Visit(zz > 0,         -CHUNK_SIZE,   -EXTCHUNK_SIZE);
+			Occlusion_Visit(zz < CHUNK_MAX,  CHUNK_SIZE,    EXTCHUNK_SIZE);
+			Occlusion_Visit(yy > 0,         -CHUNK_SIZE_2, -EXTCHUNK_SIZE_2);
+			Occlusion_Visit(yy < CHUNK_MAX,  CHUNK_SIZE_2,  EXTCHUNK_SIZE_2);
+		}
+
+		/* Can see through the whole chunk from any face */
+		if (faces == (1 << FACE_COUNT) - 1) return CHUNKINFO_ALL_CONNECTED;
+
+		for (a = 0; a < FACE_COUNT; a++) {
+			if (!(faces & (1 << a))) continue;
+			for (b = a + 1; b < FACE_COUNT; b++) {
+				if (faces & (1 << b)) flags |= ChunkInfo_ConnectedBit(a, b);
+			}
+		}
+	}
+	return flags;
+}
+
 #define ReadChunkBody(get_block)\
 for (yy = -1; yy < 17; ++yy) {\
 	y = yy + y1;\
@@ -251,12 +584,12 @@ for (yy = -1; yy < 17; ++yy) {\
 			block    = get_block;\
 			allAir   = allAir   && Blocks.Draw[block] == DRAW_GAS;\
 			allSolid = allSolid && Blocks.FullOpaque[block];\
-			Builder_Chunk[cIndex] = block;\
+			chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static cc_bool ReadChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
+static cc_bool ReadChunkData(BlockID* chunk, int x1, int y1, int z1, cc_bool* outAllAir) {
 	BlockRaw* blocks = World.Blocks;
 	BlockRaw* blocks2;
 	cc_bool allAir = true, allSolid = true;
@@ -300,12 +633,12 @@ for (yy = -1; yy < 17; ++yy) {\
 \
 			block  = get_block;\
 			allAir = allAir && Blocks.Draw[block] == DRAW_GAS;\
-			Builder_Chunk[cIndex] = block;\
+			chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static cc_bool ReadBorderChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
+static cc_bool ReadBorderChunkData(BlockID* chunk, int x1, int y1, int z1, cc_bool* outAllAir) {
 	BlockRaw* blocks = World.Blocks;
 	BlockRaw* blocks2;
 	cc_bool allAir = true;
@@ -328,58 +661,174 @@ static cc_bool ReadBorderChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
 	return false;
 }
 
-static cc_bool BuildChunk(int x1, int y1, int z1, struct ChunkInfo* info) {
-	BlockID chunk[EXTCHUNK_SIZE_3]; 
-	cc_uint8 counts[CHUNK_SIZE_3 * FACE_COUNT]; 
-	int bitFlags[EXTCHUNK_SIZE_3];
+/* Reads the blocks of the chunk and its neighbours, when the world is stored as sections */
+static cc_bool ReadChunkSections(BlockID* chunk, int x1, int y1, int z1, cc_bool* outAllAir) {
+	cc_bool allAir = true, allSolid = true;
+	int xMin = max(x1 - 1, 0), count = min(x1 + 17, World.Width) - xMin;
+	int cIndex, xx, yy, zz, y, z;
+	BlockID block;
+
+	for (yy = -1; yy < 17; ++yy) {
+		y = yy + y1;
+		if (y < 0 || y >= World.Height) continue;
+
+		for (zz = -1; zz < 17; ++zz) {
+			z = zz + z1;
+			if (z < 0 || z >= World.Length) continue;
 
+			/* Decoding a whole row at once avoids looking up the section for every block */
+			cIndex = Builder_PackChunk(xMin - x1, yy, zz);
+			World_GetSectionRow(xMin, y, z, count, &chunk[cIndex]);
+
+			for (xx = 0; xx < count; xx++) {
+				block    = chunk[cIndex + xx];
+				allAir   = allAir   && Blocks.Draw[block] == DRAW_GAS;
+				allSolid = allSolid && Blocks.FullOpaque[block];
+			}
+		}
+	}
+
+	*outAllAir = allAir;
+	return allSolid;
+}
+
+/* Copies the blocks and lighting needed to build the mesh of the given chunk into the job. */
+/* Returns false if the chunk is known to have no mesh. (e.g. completely air) */
+static cc_bool InitJob(struct BuilderJob* job, struct ChunkInfo* info) {
+	int x1 = info->CentreX - 8, y1 = info->CentreY - 8, z1 = info->CentreZ - 8;
 	cc_bool allAir, allSolid, onBorder;
-	int xMax, yMax, zMax, totalVerts;
-	int cIndex, index;
-	int x, y, z, xx, yy, zz;
 
-	Builder_Chunk  = chunk;
-	Builder_Counts = counts;
-	Builder_BitFlags = bitFlags;
-	Builder_PrePrepareChunk();
-	
+	job->info = info;
+	job->x1   = x1; job->y1 = y1; job->z1 = z1;
+	job->usedAtlases = MapRenderer_1DUsedCount;
+	job->lod  = info->Lod;
+
 	onBorder = 
 		x1 == 0 || y1 == 0 || z1 == 0   || x1 + CHUNK_SIZE >= World.Width ||
 		y1 + CHUNK_SIZE >= World.Height || z1 + CHUNK_SIZE >= World.Length;
 
-	if (onBorder) {
+	if (job->lod) {
+		allSolid = ReadLodChunkData(job->lodBlocks, x1, y1, z1, job->lod, &allAir) && !onBorder;
+	} else if (World.Sections) {
+		if (onBorder) Mem_Set(job->chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
+		allSolid = ReadChunkSections(job->chunk, x1, y1, z1, &allAir) && !onBorder;
+	} else if (onBorder) {
 		/* less optimal case here */
-		Mem_Set(chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
-		allSolid = ReadBorderChunkData(x1, y1, z1, &allAir);
+		Mem_Set(job->chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
+		allSolid = ReadBorderChunkData(job->chunk, x1, y1, z1, &allAir);
 	} else {
-		allSolid = ReadChunkData(x1, y1, z1, &allAir);
+		allSolid = ReadChunkData(job->chunk, x1, y1, z1, &allAir);
 	}
 
 	info->AllAir = allAir;
-	if (allAir || allSolid) return false;
+	if (allAir || allSolid) {
+		MapRenderer_SetOcclusionFlags(info, allAir ? CHUNKINFO_ALL_CONNECTED : 0);
+		return false;
+	}
+
 	Lighting_LightHint(x1 - 1, z1 - 1);
+	Lighting_CopyHint(x1 - 1,  z1 - 1, job->heights);
+	if (Lighting_Propagated) Lighting_CopyLevels(x1 - 1, y1 - 1, z1 - 1, job->levels);
 
-	Mem_Set(counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
-	xMax = min(World.Width,  x1 + CHUNK_SIZE);
-	yMax = min(World.Height, y1 + CHUNK_SIZE);
-	zMax = min(World.Length, z1 + CHUNK_SIZE);
+	job->xMax = min(World.Width,  x1 + CHUNK_SIZE);
+	job->yMax = min(World.Height, y1 + CHUNK_SIZE);
+	job->zMax = min(World.Length, z1 + CHUNK_SIZE);
 
-	Builder_ChunkEndX = xMax; Builder_ChunkEndZ = zMax;
-	PrepareChunk(x1, y1, z1);
+	/* PendingDelete is only set when the chunk was changed since its mesh was last built */
+	/* NOTE: Level of detail meshes are always built from scratch, so never use cached state */
+	job->cache = job->lod ? NULL : AcquireCache(MapRenderer_Pack(x1 >> CHUNK_SHIFT, y1 >> CHUNK_SHIFT, z1 >> CHUNK_SHIFT),
+							info->PendingDelete);
+	return true;
+}
 
-	totalVerts = Builder_TotalVerticesCount();
-	if (!totalVerts) return false;
+/* Converts the given coordinate to fixed point, clamping it instead of letting it wrap around if out of range */
+static cc_int16 PackCoord(float value, float scale) {
+	float packed = Math_Floor(value * scale + 0.5f);
+	if (packed < -Int16_MaxValue) return -Int16_MaxValue;
+	if (packed >  Int16_MaxValue) return  Int16_MaxValue;
+	return (cc_int16)packed;
+}
 
-#ifndef CC_BUILD_GL11
-	/* add an extra element to fix crashing on some GPUs */
-	Builder_Vertices = (struct VertexTextured*)Gfx_RecreateAndLockVb(&info->Vb,
-													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
-#else
-	/* NOTE: Relies on assumption vb is ignored by GL11 Gfx_LockVb implementation */
-	Builder_Vertices = (struct VertexTextured*)Gfx_LockVb(0, 
-													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
-#endif
-	Builder_PostPrepareChunk();
+/* Converts the built vertices of the given job into packed vertices, with positions relative to the chunk. */
+/* NOTE: Block bounds are at most 8 blocks outside of the block (see BlockDefs_DefineBlockExt), so positions */
+/*  relative to the chunk are always between -8 and 24, well within the range of packed positions. */
+/* NOTE: Packed vertices are smaller, so this is done in place (each vertex is read before it is overwritten) */
+static void PackVertices(struct BuilderJob* job) {
+	struct VertexTextured* src = job->vertices;
+	struct VertexPacked* dst   = (struct VertexPacked*)job->vertices;
+	struct VertexTextured v;
+	int i;
+
+	for (i = 0; i < job->totalVerts; i++) {
+		v = src[i];
+		dst[i].X   = PackCoord(v.X - job->x1, PACKED_VERTEX_POS_SCALE);
+		dst[i].Y   = PackCoord(v.Y - job->y1, PACKED_VERTEX_POS_SCALE);
+		dst[i].Z   = PackCoord(v.Z - job->z1, PACKED_VERTEX_POS_SCALE);
+		dst[i].U   = PackCoord(v.U, PACKED_VERTEX_UV_SCALE);
+		dst[i].Col = v.Col;
+		dst[i].V   = v.V;
+	}
+}
+
+/* Packs the built vertices if necessary, and sets the chunk's parts to the parts of the built mesh */
+static void SetJobParts(struct BuilderContext* ctx, struct BuilderJob* job) {
+	int offset = 0, i, j;
+	if (Gfx.PackedVertices) PackVertices(job);
+
+	/* Chunk's current parts may still be being drawn, so can't be changed here */
+	for (i = 0; i < job->usedAtlases; i++) {
+		j = i + ATLAS1D_MAX_ATLASES;
+		SetPartInfo(&ctx->parts[i], &offset, &job->normParts[i], &job->hasNorm);
+		SetPartInfo(&ctx->parts[j], &offset, &job->tranParts[i], &job->hasTran);
+	}
+}
+
+/* Builds the mesh of the chunk described by the given job. */
+/* NOTE: This may be called on a background thread, and so must not touch the world or graphics API */
+static void BuildJob(struct BuilderContext* ctx, struct BuilderJob* job) {
+	int x1 = job->x1, y1 = job->y1, z1 = job->z1;
+	int xMax = job->xMax, yMax = job->yMax, zMax = job->zMax;
+	int cIndex, index;
+	int x, y, z, xx, yy, zz;
+	struct BuilderCache* cache;
+
+	job->vertices   = NULL;
+	job->totalVerts = 0;
+	job->hasNorm    = false;
+	job->hasTran    = false;
+
+	ctx->job   = job;
+	ctx->chunk = job->chunk;
+	if (job->lod) { LodBuilder_Build(ctx, job); return; }
+	Builder_PrePrepareChunk(ctx);
+	job->occlusionFlags = ComputeOcclusion(ctx);
+
+	cache = job->cache;
+	ctx->incremental = Builder_Incremental && cache && cache->valid && DiffCache(ctx, cache);
+	ctx->counts      = cache ? cache->counts   : ctx->countsBuffer;
+	ctx->bitFlags    = cache ? cache->bitFlags : ctx->bitFlagsBuffer;
+
+	if (ctx->incremental) {
+		ResetDirtyCounts(ctx);
+	} else {
+		Mem_Set(ctx->counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
+	}
+	ctx->chunkEndX = xMax; ctx->chunkEndZ = zMax;
+	PrepareChunk(ctx, x1, y1, z1);
+
+	if (ctx->incremental) CountVertices(ctx, x1, y1, z1);
+	if (cache) {
+		Mem_Copy(cache->chunk,   job->chunk,   sizeof(job->chunk));
+		Mem_Copy(cache->heights, job->heights, sizeof(job->heights));
+		if (Lighting_Propagated) Mem_Copy(cache->levels, job->levels, sizeof(job->levels));
+	}
+
+	job->totalVerts = Builder_TotalVerticesCount(ctx);
+	if (!job->totalVerts) return;
+
+	job->vertices = (struct VertexTextured*)Mem_Alloc(job->totalVerts, SIZEOF_VERTEX_TEXTURED, "chunk vertices");
+	ctx->vertices = job->vertices;
+	Builder_PostPrepareChunk(ctx);
 	/* now render the chunk */
 
 	for (y = y1, yy = 0; y < yMax; y++, yy++) {
@@ -387,84 +836,396 @@ static cc_bool BuildChunk(int x1, int y1, int z1, struct ChunkInfo* info) {
 			cIndex = Builder_PackChunk(0, yy, zz);
 
 			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				Builder_Block = chunk[cIndex];
-				if (Blocks.Draw[Builder_Block] == DRAW_GAS) continue;
+				ctx->block = ctx->chunk[cIndex];
+				if (Blocks.Draw[ctx->block] == DRAW_GAS) continue;
 
 				index = Builder_PackCount(xx, yy, zz);
-				Builder_ChunkIndex = cIndex;
-				Builder_RenderBlock(index, x, y, z);
+				ctx->chunkIndex = cIndex;
+				Builder_RenderBlock(ctx, index, x, y, z);
 			}
 		}
 	}
 
-#ifndef CC_BUILD_GL11
-	Gfx_UnlockVb(info->Vb);
-#endif
-	return true;
+	SetJobParts(ctx, job);
 }
 
-void Builder_MakeChunk(struct ChunkInfo* info) {
-	int x = info->CentreX - 8, y = info->CentreY - 8, z = info->CentreZ - 8;
-	cc_bool hasMesh, hasNorm, hasTran;
-	int partsIndex;
-	int i, j, curIdx, offset;
+/* Uploads the mesh built by the given job to the GPU */
+static void UploadJob(struct BuilderJob* job) {
+	struct ChunkInfo* info = job->info;
+	int partsIndex, curIdx, i;
 
-	hasMesh = BuildChunk(x, y, z, info);
-	if (!hasMesh) return;
+	ReleaseCache(job->cache, true);
+	/* Chunk's previous mesh is kept (and drawn) until it is replaced by the new one */
+	MapRenderer_DeleteMesh(info);
+	MapRenderer_SetOcclusionFlags(info, job->occlusionFlags);
+	if (!job->vertices) return;
+	partsIndex = MapRenderer_Pack(job->x1 >> CHUNK_SHIFT, job->y1 >> CHUNK_SHIFT, job->z1 >> CHUNK_SHIFT);
 
-	partsIndex = MapRenderer_Pack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
-	offset  = 0;
-	hasNorm = false;
-	hasTran = false;
-
-	for (i = 0; i < MapRenderer_1DUsedCount; i++) {
-		j = i + ATLAS1D_MAX_ATLASES;
+	for (i = 0; i < job->usedAtlases; i++) {
 		curIdx = partsIndex + i * MapRenderer_ChunksCount;
+		MapRenderer_PartsNormal[curIdx]      = job->normParts[i];
+		MapRenderer_PartsTranslucent[curIdx] = job->tranParts[i];
+	}
 
-		SetPartInfo(&Builder_Parts[i], &offset, &MapRenderer_PartsNormal[curIdx],      &hasNorm);
-		SetPartInfo(&Builder_Parts[j], &offset, &MapRenderer_PartsTranslucent[curIdx], &hasTran);
+#ifndef CC_BUILD_GL11
+	MapRenderer_UploadMesh(info, job->vertices, job->totalVerts);
+#else
+	for (i = 0; i < job->usedAtlases; i++) {
+		if (MapRenderer_PartsNormal[partsIndex + i * MapRenderer_ChunksCount].Offset >= 0)
+			BuildPartVbs(&MapRenderer_PartsNormal[partsIndex + i * MapRenderer_ChunksCount], job->vertices);
+		if (MapRenderer_PartsTranslucent[partsIndex + i * MapRenderer_ChunksCount].Offset >= 0)
+			BuildPartVbs(&MapRenderer_PartsTranslucent[partsIndex + i * MapRenderer_ChunksCount], job->vertices);
 	}
+#endif
 
-	if (hasNorm) {
+	if (job->hasNorm) {
 		info->NormalParts      = &MapRenderer_PartsNormal[partsIndex];
 	}
-	if (hasTran) {
+	if (job->hasTran) {
 		info->TranslucentParts = &MapRenderer_PartsTranslucent[partsIndex];
 	}
 
-#ifdef OCCLUSION
-	if (info.NormalParts != null || info.TranslucentParts != null)
-		info.occlusionFlags = (cc_uint8)ComputeOcclusion();
+	Mem_Free(job->vertices);
+	job->vertices = NULL;
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------Background mesh building------------------------------------------------*
+*#########################################################################################################################*/
+/* Max number of chunks that can be queued for building per background thread */
+#define BUILDER_JOBS_PER_WORKER 4
+#define BUILDER_MAX_WORKERS 32
+
+/* Linked list of jobs, with jobs being added to the tail and removed from the head */
+struct BuilderJobList { struct BuilderJob* head; struct BuilderJob* tail; };
+
+static void JobList_Add(struct BuilderJobList* list, struct BuilderJob* job) {
+	job->next = NULL;
+	if (list->tail) {
+		list->tail->next = job;
+	} else {
+		list->head = job;
+	}
+	list->tail = job;
+}
+
+static struct BuilderJob* JobList_Remove(struct BuilderJobList* list) {
+	struct BuilderJob* job = list->head;
+	if (!job) return NULL;
+
+	list->head = job->next;
+	if (!list->head) list->tail = NULL;
+	return job;
+}
+
+static int workersCount, workersStarted, workersBusy;
+static cc_bool workersStopping;
+static void* workerThreads[BUILDER_MAX_WORKERS];
+static struct BuilderContext* workerContexts;
+static struct BuilderJob* jobs;
+/* Jobs that are unused, waiting to be built, and finished building but not uploaded yet */
+static struct BuilderJobList freeJobs, pendingJobs, doneJobs;
+/* jobsMutex protects all of the job lists and worker counters above */
+static void* jobsMutex;
+static void* pendingWaitable;
+static void* doneWaitable;
+/* Function passed to Builder_RunOnWorkers, the number of workers which still need to start */
+/*  running it, and the number of workers which are currently running it */
+static void (*workerTask)(void);
+static int taskWorkersLeft, taskWorkersBusy;
+
+static void RunWorkerTask(void (*task)(void), cc_bool moreTasks) {
+	/* Wake up another worker to run the task too */
+	if (moreTasks) Waitable_Signal(pendingWaitable);
+	task();
+
+	Mutex_Lock(jobsMutex);
+	{
+		taskWorkersBusy--;
+	}
+	Mutex_Unlock(jobsMutex);
+	Waitable_Signal(doneWaitable);
+}
+
+static void WorkerLoop(void) {
+	struct BuilderContext* ctx;
+	struct BuilderJob* job;
+	void (*task)(void);
+	cc_bool moreJobs;
+
+	Mutex_Lock(jobsMutex);
+	{
+		ctx = &workerContexts[workersStarted++];
+	}
+	Mutex_Unlock(jobsMutex);
+
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		{
+			if (workersStopping) { Mutex_Unlock(jobsMutex); break; }
+			task = NULL;
+			job  = NULL;
+
+			/* Main thread is waiting for the task to finish, so it takes priority over building chunks */
+			if (taskWorkersLeft) {
+				task = workerTask;
+				taskWorkersLeft--;
+				taskWorkersBusy++;
+				moreJobs = taskWorkersLeft > 0;
+			} else {
+				job      = JobList_Remove(&pendingJobs);
+				moreJobs = pendingJobs.head != NULL;
+				if (job) workersBusy++;
+			}
+		}
+		Mutex_Unlock(jobsMutex);
+
+		if (task) { RunWorkerTask(task, moreJobs); continue; }
+		/* Block until the main thread queues another chunk to build */
+		if (!job) { Waitable_Wait(pendingWaitable); continue; }
+		/* Wake up another worker to build the remaining chunks */
+		if (moreJobs) Waitable_Signal(pendingWaitable);
+
+		BuildJob(ctx, job);
+
+		Mutex_Lock(jobsMutex);
+		{
+			JobList_Add(&doneJobs, job);
+			workersBusy--;
+		}
+		Mutex_Unlock(jobsMutex);
+		Waitable_Signal(doneWaitable);
+	}
+	/* Wake up the next worker so it can stop too */
+	Waitable_Signal(pendingWaitable);
+}
+
+static void StartWorkers(void) {
+	int i, cores;
+	cores = Thread_CoresCount();
+	/* Leave one core free for the main thread */
+	/* (but build on the main thread by default when benchmarking, so results don't depend on core count) */
+	workersCount = Options_GetInt(OPT_BUILDER_THREADS, 0, BUILDER_MAX_WORKERS, Game_BenchmarkFrames ? 0 : cores - 1);
+#ifdef CC_BUILD_WEB
+	/* No background threads, so chunks are always built on the main thread */
+	workersCount = 0;
 #endif
+	caches = (struct BuilderCache*)Mem_Alloc(BUILDER_MAX_CACHES, sizeof(struct BuilderCache), "chunk builder caches");
+	ClearCaches();
+
+	/* Chunks are built immediately on the main thread instead */
+	if (!workersCount) {
+		workerContexts = (struct BuilderContext*)Mem_Alloc(1, sizeof(struct BuilderContext), "chunk builder");
+		jobs           = (struct BuilderJob*)Mem_Alloc(1, sizeof(struct BuilderJob),         "chunk builder job");
+		return;
+	}
+
+	workerContexts = (struct BuilderContext*)Mem_Alloc(workersCount, sizeof(struct BuilderContext), "chunk builders");
+	jobs = (struct BuilderJob*)Mem_Alloc(workersCount * BUILDER_JOBS_PER_WORKER, sizeof(struct BuilderJob), "chunk builder jobs");
+	for (i = 0; i < workersCount * BUILDER_JOBS_PER_WORKER; i++) {
+		JobList_Add(&freeJobs, &jobs[i]);
+	}
+
+	jobsMutex       = Mutex_Create();
+	pendingWaitable = Waitable_Create();
+	doneWaitable    = Waitable_Create();
+	for (i = 0; i < workersCount; i++) {
+		workerThreads[i] = Thread_Start(WorkerLoop);
+	}
+	Platform_Log1("Building chunks using %i background threads", &workersCount);
+}
+
+static void StopWorkers(void) {
+	int i;
+	Builder_CancelAll();
+
+	if (workersCount) {
+		Mutex_Lock(jobsMutex);
+		{
+			workersStopping = true;
+		}
+		Mutex_Unlock(jobsMutex);
+		Waitable_Signal(pendingWaitable);
+
+		for (i = 0; i < workersCount; i++) {
+			Thread_Join(workerThreads[i]);
+		}
+
+		Mutex_Free(jobsMutex);
+		Waitable_Free(pendingWaitable);
+		Waitable_Free(doneWaitable);
+	}
+
+	Mem_Free(workerContexts);
+	Mem_Free(jobs);
+	Mem_Free(caches);
+	workerContexts = NULL;
+	jobs           = NULL;
+	caches         = NULL;
+	workersCount   = 0;
+}
+
+int Builder_WorkersCount(void) { return workersCount; }
+
+void Builder_RunOnWorkers(void (*func)(void)) {
+	cc_bool busy;
+	if (workersCount) {
+		Mutex_Lock(jobsMutex);
+		{
+			workerTask      = func;
+			taskWorkersLeft = workersCount;
+		}
+		Mutex_Unlock(jobsMutex);
+		Waitable_Signal(pendingWaitable);
+	}
+
+	/* Main thread does the work too, rather than just waiting for the workers */
+	func();
+	if (!workersCount) return;
+
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		{
+			/* All of the work has been taken by now, so workers which haven't started can skip running func */
+			taskWorkersLeft = 0;
+			busy = taskWorkersBusy > 0;
+		}
+		Mutex_Unlock(jobsMutex);
+
+		if (!busy) break;
+		Waitable_Wait(doneWaitable);
+	}
+}
+
+cc_bool Builder_CanQueue(void) {
+	return !workersCount || freeJobs.head != NULL;
 }
 
-static cc_bool Builder_OccludedLiquid(int chunkIndex) {
+cc_bool Builder_MakeChunk(struct ChunkInfo* info) {
+	struct BuilderJob* job;
+
+	/* No background threads, so just build and upload the mesh immediately */
+	if (!workersCount) {
+		job = &jobs[0];
+		if (!InitJob(job, info)) { MapRenderer_DeleteMesh(info); return false; }
+
+		BuildJob(&workerContexts[0], job);
+		UploadJob(job);
+		return false;
+	}
+
+	/* Free jobs list is only accessed by the main thread */
+	job = freeJobs.head;
+	if (!job) return false;
+	/* Chunk has no mesh when completely air or completely hidden */
+	if (!InitJob(job, info)) { MapRenderer_DeleteMesh(info); return false; }
+	JobList_Remove(&freeJobs);
+
+	info->Building = true;
+	Mutex_Lock(jobsMutex);
+	{
+		JobList_Add(&pendingJobs, job);
+	}
+	Mutex_Unlock(jobsMutex);
+	Waitable_Signal(pendingWaitable);
+	return true;
+}
+
+struct ChunkInfo* Builder_FinishChunk(void) {
+	struct BuilderJob* job;
+	struct ChunkInfo* info;
+	if (!workersCount) return NULL;
+
+	Mutex_Lock(jobsMutex);
+	{
+		job = JobList_Remove(&doneJobs);
+	}
+	Mutex_Unlock(jobsMutex);
+	if (!job) return NULL;
+
+	info = job->info;
+	info->Building = false;
+	UploadJob(job);
+
+	JobList_Add(&freeJobs, job);
+	return info;
+}
+
+static void DiscardJob(struct BuilderJob* job) {
+	/* Chunk's mesh is rebuilt later, as its previous mesh is still in use */
+	job->info->Building      = false;
+	job->info->PendingDelete = true;
+	ReleaseCache(job->cache, false);
+	Mem_Free(job->vertices);
+	job->vertices = NULL;
+	JobList_Add(&freeJobs, job);
+}
+
+static void CancelJobs(void) {
+	struct BuilderJob* job;
+	int busy;
+
+	Mutex_Lock(jobsMutex);
+	{
+		while ((job = JobList_Remove(&pendingJobs))) { DiscardJob(job); }
+	}
+	Mutex_Unlock(jobsMutex);
+
+	/* Wait for workers to finish building the chunks they are currently building */
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		{
+			busy = workersBusy;
+		}
+		Mutex_Unlock(jobsMutex);
+
+		if (!busy) break;
+		Waitable_WaitFor(doneWaitable, 10);
+	}
+
+	Mutex_Lock(jobsMutex);
+	{
+		while ((job = JobList_Remove(&doneJobs))) { DiscardJob(job); }
+	}
+	Mutex_Unlock(jobsMutex);
+}
+
+void Builder_CancelAll(void) {
+	if (workersCount) CancelJobs();
+	if (caches) ClearCaches();
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------------Mesh builder helpers---------------------------------------------------*
+*#########################################################################################################################*/
+static cc_bool Builder_OccludedLiquid(struct BuilderContext* ctx, int chunkIndex) {
 	chunkIndex += EXTCHUNK_SIZE_2; /* Checking y above */
 	return
-		Blocks.FullOpaque[Builder_Chunk[chunkIndex]]
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
+		Blocks.FullOpaque[ctx->chunk[chunkIndex]]
+		&& Blocks.Draw[ctx->chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex - 1]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex + 1]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
 }
 
-static void DefaultPrePrepateChunk(void) {
-	Mem_Set(Builder_Parts, 0, sizeof(Builder_Parts));
+static void DefaultPrePrepateChunk(struct BuilderContext* ctx) {
+	Mem_Set(ctx->parts, 0, sizeof(ctx->parts));
 }
 
-static void DefaultPostStretchChunk(void) {
+static void DefaultPostStretchChunk(struct BuilderContext* ctx) {
 	int i, j, offset;
 	offset = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES; i++) {
 		j = i + ATLAS1D_MAX_ATLASES;
 
-		offset = Builder1DPart_CalcOffsets(&Builder_Parts[i], offset);
-		offset = Builder1DPart_CalcOffsets(&Builder_Parts[j], offset);
+		offset = Builder1DPart_CalcOffsets(ctx, &ctx->parts[i], offset);
+		offset = Builder1DPart_CalcOffsets(ctx, &ctx->parts[j], offset);
 	}
 }
 
-static RNGState spriteRng;
-static void Builder_DrawSprite(int x, int y, int z) {
+static void Builder_DrawSprite(struct BuilderContext* ctx, int x, int y, int z) {
 	struct Builder1DPart* part;
 	struct VertexTextured v;
 	cc_uint8 offsetType;
@@ -483,54 +1244,54 @@ static void Builder_DrawSprite(int x, int y, int z) {
 
 #define s_u1 0.0f
 #define s_u2 UV2_Scale
-	loc = Block_Tex(Builder_Block, FACE_XMAX);
+	loc = Block_Tex(ctx->block, FACE_XMAX);
 	v1  = Atlas1D_RowId(loc) * Atlas1D.InvTileSize;
 	v2  = v1 + Atlas1D.InvTileSize * UV2_Scale;
 
-	offsetType = Blocks.SpriteOffset[Builder_Block];
+	offsetType = Blocks.SpriteOffset[ctx->block];
 	if (offsetType >= 6 && offsetType <= 7) {
-		Random_Seed(&spriteRng, (x + 1217 * z) & 0x7fffffff);
-		valX = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
-		valY = Random_Range(&spriteRng, 0,  3 + 1) / 16.0f;
-		valZ = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
+		Random_Seed(&ctx->spriteRng, (x + 1217 * z) & 0x7fffffff);
+		valX = Random_Range(&ctx->spriteRng, -3, 3 + 1) / 16.0f;
+		valY = Random_Range(&ctx->spriteRng, 0,  3 + 1) / 16.0f;
+		valZ = Random_Range(&ctx->spriteRng, -3, 3 + 1) / 16.0f;
 
 		x1 += valX - 1.7f/16.0f; x2 += valX + 1.7f/16.0f;
 		z1 += valZ - 1.7f/16.0f; z2 += valZ + 1.7f/16.0f;
 		if (offsetType == 7) { y1 -= valY; y2 -= valY; }
 	}
 	
-	bright = Blocks.FullBright[Builder_Block];
-	part   = &Builder_Parts[Atlas1D_Index(loc)];
-	v.Col  = bright ? PACKEDCOL_WHITE : Lighting_Color_Sprite_Fast(x, y, z);
-	Block_Tint(v.Col, Builder_Block);
+	bright = Blocks.FullBright[ctx->block];
+	part   = &ctx->parts[Atlas1D_Index(loc)];
+	v.Col  = bright ? PACKEDCOL_WHITE : Builder_LightCol(ctx, x, y, z, Env.SunCol, Env.ShadowCol);
+	Block_Tint(v.Col, ctx->block);
 
 	/* Draw Z axis */
 	index = part->sOffset;
-	v.X = x1; v.Y = y1; v.Z = z1; v.U = s_u2; v.V = v2; Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x2;           v.Z = z2; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x1; v.Y = y1; v.Z = z1; v.U = s_u2; v.V = v2; ctx->vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; ctx->vertices[index + 1] = v;
+	v.X = x2;           v.Z = z2; v.U = s_u1;           ctx->vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; ctx->vertices[index + 3] = v;
 
 	/* Draw Z axis mirrored */
 	index += part->sAdvance;
-	v.X = x2; v.Y = y1; v.Z = z2; v.U = s_u2;           Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x1;           v.Z = z1; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x2; v.Y = y1; v.Z = z2; v.U = s_u2;           ctx->vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; ctx->vertices[index + 1] = v;
+	v.X = x1;           v.Z = z1; v.U = s_u1;           ctx->vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; ctx->vertices[index + 3] = v;
 
 	/* Draw X axis */
 	index += part->sAdvance;
-	v.X = x1; v.Y = y1; v.Z = z2; v.U = s_u2;           Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x2;           v.Z = z1; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x1; v.Y = y1; v.Z = z2; v.U = s_u2;           ctx->vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; ctx->vertices[index + 1] = v;
+	v.X = x2;           v.Z = z1; v.U = s_u1;           ctx->vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; ctx->vertices[index + 3] = v;
 
 	/* Draw X axis mirrored */
 	index += part->sAdvance;
-	v.X = x2; v.Y = y1; v.Z = z1; v.U = s_u2;           Builder_Vertices[index + 0] = v;
-	          v.Y = y2;                       v.V = v1; Builder_Vertices[index + 1] = v;
-	v.X = x1;           v.Z = z2; v.U = s_u1;           Builder_Vertices[index + 2] = v;
-	          v.Y = y1;                       v.V = v2; Builder_Vertices[index + 3] = v;
+	v.X = x2; v.Y = y1; v.Z = z1; v.U = s_u2;           ctx->vertices[index + 0] = v;
+	          v.Y = y2;                       v.V = v1; ctx->vertices[index + 1] = v;
+	v.X = x1;           v.Z = z2; v.U = s_u1;           ctx->vertices[index + 2] = v;
+	          v.Y = y1;                       v.V = v2; ctx->vertices[index + 3] = v;
 
 	part->sOffset += 4;
 }
@@ -539,92 +1300,92 @@ static void Builder_DrawSprite(int x, int y, int z) {
 /*########################################################################################################################*
 *--------------------------------------------------Normal mesh builder----------------------------------------------------*
 *#########################################################################################################################*/
-static PackedCol Normal_LightCol(int x, int y, int z, Face face, BlockID block) {
+static PackedCol Normal_LightCol(struct BuilderContext* ctx, int x, int y, int z, Face face, BlockID block) {
 	int offset = (Blocks.LightOffset[block] >> face) & 1;
 
 	switch (face) {
 	case FACE_XMIN:
-		return x < offset                ? Env.SunXSide : Lighting_Color_XSide_Fast(x - offset, y, z);
+		return x < offset                ? Env.SunXSide : Builder_LightCol(ctx, x - offset, y, z, Env.SunXSide, Env.ShadowXSide);
 	case FACE_XMAX:
-		return x > (World.MaxX - offset) ? Env.SunXSide : Lighting_Color_XSide_Fast(x + offset, y, z);
+		return x > (World.MaxX - offset) ? Env.SunXSide : Builder_LightCol(ctx, x + offset, y, z, Env.SunXSide, Env.ShadowXSide);
 	case FACE_ZMIN:
-		return z < offset                ? Env.SunZSide : Lighting_Color_ZSide_Fast(x, y, z - offset);
+		return z < offset                ? Env.SunZSide : Builder_LightCol(ctx, x, y, z - offset, Env.SunZSide, Env.ShadowZSide);
 	case FACE_ZMAX:
-		return z > (World.MaxZ - offset) ? Env.SunZSide : Lighting_Color_ZSide_Fast(x, y, z + offset);
+		return z > (World.MaxZ - offset) ? Env.SunZSide : Builder_LightCol(ctx, x, y, z + offset, Env.SunZSide, Env.ShadowZSide);
 	case FACE_YMIN:
-		return y <= 0                    ? Env.SunYMin  : Lighting_Color_YMin_Fast(x, y - offset, z);
+		return y <= 0                    ? Env.SunYMin  : Builder_LightCol(ctx, x, y - offset, z, Env.SunYMin, Env.ShadowYMin);
 	case FACE_YMAX:
-		return y >= World.MaxY           ? Env.SunCol   : Lighting_Color_YMax_Fast(x, (y + 1) - offset, z);
+		return y >= World.MaxY           ? Env.SunCol   : Builder_LightCol(ctx, x, (y + 1) - offset, z, Env.SunCol, Env.ShadowCol);
 	}
 	return 0; /* should never happen */
 }
 
-static cc_bool Normal_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
+static cc_bool Normal_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = ctx->chunk[chunkIndex];
 
-	if (cur != initial || Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
-	if (Builder_FullBright) return true;
+	if (cur != initial || Block_IsFaceHidden(cur, ctx->chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
+	if (ctx->fullBright) return true;
 
-	return Normal_LightCol(Builder_X, Builder_Y, Builder_Z, face, initial) == Normal_LightCol(x, y, z, face, cur);
+	return Normal_LightCol(ctx, ctx->x, ctx->y, ctx->z, face, initial) == Normal_LightCol(ctx, x, y, z, face, cur);
 }
 
-static int NormalBuilder_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int NormalBuilder_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; cc_bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, FACE_YMAX);
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int NormalBuilder_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int NormalBuilder_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < ctx->chunkEndZ && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
 		countIndex += CHUNK_SIZE * FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static void NormalBuilder_RenderBlock(int index, int x, int y, int z) {	
+static void NormalBuilder_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {	
 	/* counters */
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
@@ -640,90 +1401,90 @@ static void NormalBuilder_RenderBlock(int index, int x, int y, int z) {
 	PackedCol col;
 	int offset;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	fullBright = Blocks.FullBright[Builder_Block];
-	baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	lightFlags = Blocks.LightOffset[Builder_Block];
+	fullBright = Blocks.FullBright[ctx->block];
+	baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	lightFlags = Blocks.LightOffset[ctx->block];
 
-	Drawer.MinBB = Blocks.MinBB[Builder_Block]; Drawer.MinBB.Y = 1.0f - Drawer.MinBB.Y;
-	Drawer.MaxBB = Blocks.MaxBB[Builder_Block]; Drawer.MaxBB.Y = 1.0f - Drawer.MaxBB.Y;
+	ctx->drawer.MinBB = Blocks.MinBB[ctx->block]; ctx->drawer.MinBB.Y = 1.0f - ctx->drawer.MinBB.Y;
+	ctx->drawer.MaxBB = Blocks.MaxBB[ctx->block]; ctx->drawer.MaxBB.Y = 1.0f - ctx->drawer.MaxBB.Y;
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	Drawer.X1 = x + min.X; Drawer.Y1 = y + min.Y; Drawer.Z1 = z + min.Z;
-	Drawer.X2 = x + max.X; Drawer.Y2 = y + max.Y; Drawer.Z2 = z + max.Z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->drawer.X1 = x + min.X; ctx->drawer.Y1 = y + min.Y; ctx->drawer.Z1 = z + min.Z;
+	ctx->drawer.X2 = x + max.X; ctx->drawer.Y2 = y + max.Y; ctx->drawer.Z2 = z + max.Z;
 
-	Drawer.Tinted  = Blocks.Tinted[Builder_Block];
-	Drawer.TintCol = Blocks.FogCol[Builder_Block];
+	ctx->drawer.Tinted  = Blocks.Tinted[ctx->block];
+	ctx->drawer.TintCol = Blocks.FogCol[ctx->block];
 
 	if (count_XMin) {
-		loc    = Block_Tex(Builder_Block, FACE_XMIN);
+		loc    = Block_Tex(ctx->block, FACE_XMIN);
 		offset = (lightFlags >> FACE_XMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
-			x >= offset ? Lighting_Color_XSide_Fast(x - offset, y, z) : Env.SunXSide;
-		Drawer_XMin(count_XMin, col, loc, &part->fVertices[FACE_XMIN]);
+			x >= offset ? Builder_LightCol(ctx, x - offset, y, z, Env.SunXSide, Env.ShadowXSide) : Env.SunXSide;
+		Drawer_XMinExt(count_XMin, col, loc, &part->fVertices[FACE_XMIN], &ctx->drawer);
 	}
 
 	if (count_XMax) {
-		loc    = Block_Tex(Builder_Block, FACE_XMAX);
+		loc    = Block_Tex(ctx->block, FACE_XMAX);
 		offset = (lightFlags >> FACE_XMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
-			x <= (World.MaxX - offset) ? Lighting_Color_XSide_Fast(x + offset, y, z) : Env.SunXSide;
-		Drawer_XMax(count_XMax, col, loc, &part->fVertices[FACE_XMAX]);
+			x <= (World.MaxX - offset) ? Builder_LightCol(ctx, x + offset, y, z, Env.SunXSide, Env.ShadowXSide) : Env.SunXSide;
+		Drawer_XMaxExt(count_XMax, col, loc, &part->fVertices[FACE_XMAX], &ctx->drawer);
 	}
 
 	if (count_ZMin) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMIN);
+		loc    = Block_Tex(ctx->block, FACE_ZMIN);
 		offset = (lightFlags >> FACE_ZMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
-			z >= offset ? Lighting_Color_ZSide_Fast(x, y, z - offset) : Env.SunZSide;
-		Drawer_ZMin(count_ZMin, col, loc, &part->fVertices[FACE_ZMIN]);
+			z >= offset ? Builder_LightCol(ctx, x, y, z - offset, Env.SunZSide, Env.ShadowZSide) : Env.SunZSide;
+		Drawer_ZMinExt(count_ZMin, col, loc, &part->fVertices[FACE_ZMIN], &ctx->drawer);
 	}
 
 	if (count_ZMax) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMAX);
+		loc    = Block_Tex(ctx->block, FACE_ZMAX);
 		offset = (lightFlags >> FACE_ZMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
-			z <= (World.MaxZ - offset) ? Lighting_Color_ZSide_Fast(x, y, z + offset) : Env.SunZSide;
-		Drawer_ZMax(count_ZMax, col, loc, &part->fVertices[FACE_ZMAX]);
+			z <= (World.MaxZ - offset) ? Builder_LightCol(ctx, x, y, z + offset, Env.SunZSide, Env.ShadowZSide) : Env.SunZSide;
+		Drawer_ZMaxExt(count_ZMax, col, loc, &part->fVertices[FACE_ZMAX], &ctx->drawer);
 	}
 
 	if (count_YMin) {
-		loc    = Block_Tex(Builder_Block, FACE_YMIN);
+		loc    = Block_Tex(ctx->block, FACE_YMIN);
 		offset = (lightFlags >> FACE_YMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? PACKEDCOL_WHITE : Lighting_Color_YMin_Fast(x, y - offset, z);
-		Drawer_YMin(count_YMin, col, loc, &part->fVertices[FACE_YMIN]);
+		col = fullBright ? PACKEDCOL_WHITE : Builder_LightCol(ctx, x, y - offset, z, Env.SunYMin, Env.ShadowYMin);
+		Drawer_YMinExt(count_YMin, col, loc, &part->fVertices[FACE_YMIN], &ctx->drawer);
 	}
 
 	if (count_YMax) {
-		loc    = Block_Tex(Builder_Block, FACE_YMAX);
+		loc    = Block_Tex(ctx->block, FACE_YMAX);
 		offset = (lightFlags >> FACE_YMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
-		col = fullBright ? PACKEDCOL_WHITE : Lighting_Color_YMax_Fast(x, (y + 1) - offset, z);
-		Drawer_YMax(count_YMax, col, loc, &part->fVertices[FACE_YMAX]);
+		col = fullBright ? PACKEDCOL_WHITE : Builder_LightCol(ctx, x, (y + 1) - offset, z, Env.SunCol, Env.ShadowCol);
+		Drawer_YMaxExt(count_YMax, col, loc, &part->fVertices[FACE_YMAX], &ctx->drawer);
 	}
 }
 
@@ -735,6 +1496,7 @@ static void Builder_SetDefault(void) {
 
 	Builder_PrePrepareChunk  = DefaultPrePrepateChunk;
 	Builder_PostPrepareChunk = DefaultPostStretchChunk;
+	Builder_Incremental      = true;
 }
 
 static void NormalBuilder_SetActive(void) {
@@ -746,15 +1508,481 @@ static void NormalBuilder_SetActive(void) {
 }
 
 
+/*########################################################################################################################*
+*--------------------------------------------------Greedy mesh builder----------------------------------------------------*
+*#########################################################################################################################*/
+/* Same as the normal mesh builder, except that after a face is stretched into a row, the following rows/layers */
+/*  are also merged into it while they contain the same faces. (e.g. a flat floor becomes a single quad) */
+/* The merged rows rely on the texture also repeating vertically, which only happens when each 1D atlas */
+/*  contains a single tile - so faces are still only stretched along a single row if that is not the case. */
+
+/* Whether faces of the given block completely cover the axis that faces are merged along */
+static cc_bool Greedy_CanMerge(BlockID block, Face face) {
+	if (Atlas1D.TilesPerAtlas != 1) return false;
+
+	if (face >= FACE_YMIN) {
+		return Blocks.MinBB[block].Z       == 0.0f && Blocks.MaxBB[block].Z       == 1.0f
+			&& Blocks.RenderMinBB[block].Z == 0.0f && Blocks.RenderMaxBB[block].Z == 1.0f;
+	}
+	return Blocks.MinBB[block].Y       == 0.0f && Blocks.MaxBB[block].Y       == 1.0f
+		&& Blocks.RenderMinBB[block].Y == 0.0f && Blocks.RenderMaxBB[block].Y == 1.0f;
+}
+
+/* Merges the following rows/layers into the given row of stretched faces, for as long as they contain the same faces */
+/* Y faces are merged along Z, while all other faces are merged along Y */
+static int Greedy_Merge(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face, int count, cc_bool liquid) {
+	int uX, uZ, uChunk, uCount;
+	int vY, vZ, vChunk, vCount, vEnd;
+	int span, i, cx, cy, cz, cIndex, index;
+
+	if (!Greedy_CanMerge(block, face)) return 1;
+	/* X faces are stretched along Z, all other faces are stretched along X */
+	if (face <= FACE_XMAX) {
+		uX = 0; uZ = 1; uChunk = EXTCHUNK_SIZE; uCount = CHUNK_SIZE * FACE_COUNT;
+	} else {
+		uX = 1; uZ = 0; uChunk = 1;             uCount = FACE_COUNT;
+	}
+
+	if (face >= FACE_YMIN) {
+		vY = 0; vZ = 1; vChunk = EXTCHUNK_SIZE;   vCount = CHUNK_SIZE * FACE_COUNT;   vEnd = ctx->chunkEndZ - z;
+	} else {
+		vY = 1; vZ = 0; vChunk = EXTCHUNK_SIZE_2; vCount = CHUNK_SIZE_2 * FACE_COUNT; vEnd = ctx->job->yMax - y;
+	}
+
+	for (span = 1; span < vEnd; span++) {
+		cIndex = chunkIndex + span * vChunk;
+		index  = countIndex + span * vCount;
+		cx = x; cy = y + span * vY; cz = z + span * vZ;
+
+		/* NOTE: The world border conditions in PrepareChunk can only change along X/Z, so don't need to be checked here */
+		for (i = 0; i < count; i++, cIndex += uChunk, index += uCount, cx += uX, cz += uZ) {
+			if (!ctx->counts[index] || !Normal_CanStretch(ctx, block, cIndex, cx, cy, cz, face)) break;
+			if (liquid && Builder_OccludedLiquid(ctx, cIndex)) break;
+		}
+		if (i < count) break;
+
+		index = countIndex + span * vCount;
+		for (i = 0; i < count; i++, index += uCount) { ctx->counts[index] = 0; }
+	}
+	return span;
+}
+
+static int GreedyBuilder_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+	int count = 1, index = countIndex; cc_bool stretchTile;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+
+	x++;
+	chunkIndex++;
+	countIndex += FACE_COUNT;
+	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
+
+	while (x < ctx->chunkEndX && stretchTile && ctx->counts[countIndex] && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
+		count++;
+		x++;
+		chunkIndex++;
+		countIndex += FACE_COUNT;
+	}
+
+	ctx->spans[index] = Greedy_Merge(ctx, index, ctx->x, y, z, chunkIndex - count, block, FACE_YMAX, count, true);
+	AddVertices(ctx, block, FACE_YMAX);
+	return count;
+}
+
+static int GreedyBuilder_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+	int count = 1, index = countIndex; cc_bool stretchTile;
+	x++;
+	chunkIndex++;
+	countIndex += FACE_COUNT;
+	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
+
+	while (x < ctx->chunkEndX && stretchTile && ctx->counts[countIndex] && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
+		count++;
+		x++;
+		chunkIndex++;
+		countIndex += FACE_COUNT;
+	}
+
+	ctx->spans[index] = Greedy_Merge(ctx, index, ctx->x, y, z, chunkIndex - count, block, face, count, false);
+	AddVertices(ctx, block, face);
+	return count;
+}
+
+static int GreedyBuilder_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+	int count = 1, index = countIndex; cc_bool stretchTile;
+	z++;
+	chunkIndex += EXTCHUNK_SIZE;
+	countIndex += CHUNK_SIZE * FACE_COUNT;
+	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
+
+	while (z < ctx->chunkEndZ && stretchTile && ctx->counts[countIndex] && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
+		count++;
+		z++;
+		chunkIndex += EXTCHUNK_SIZE;
+		countIndex += CHUNK_SIZE * FACE_COUNT;
+	}
+
+	ctx->spans[index] = Greedy_Merge(ctx, index, x, y, ctx->z, chunkIndex - count * EXTCHUNK_SIZE, block, face, count, false);
+	AddVertices(ctx, block, face);
+	return count;
+}
+
+static void GreedyBuilder_DrawFace(struct BuilderContext* ctx, Face face, int count, int span, PackedCol col, TextureLoc loc, struct VertexTextured** vertices) {
+	struct _DrawerData* state = &ctx->drawer;
+	float y2 = state->Y2, z2 = state->Z2;
+	float maxY = state->MaxBB.Y, maxZ = state->MaxBB.Z;
+
+	/* Extend the face across the merged rows/layers, with the texture repeating once per row/layer */
+	/* NOTE: MaxBB.Y is the V coordinate of the top of side faces, and MaxBB.Z is the V coordinate of Z2 for Y faces */
+	if (face >= FACE_YMIN) {
+		state->Z2 += span - 1; state->MaxBB.Z += (span - 1) / UV2_Scale;
+	} else {
+		state->Y2 += span - 1; state->MaxBB.Y -= span - 1;
+	}
+
+	switch (face) {
+	case FACE_XMIN: Drawer_XMinExt(count, col, loc, vertices, state); break;
+	case FACE_XMAX: Drawer_XMaxExt(count, col, loc, vertices, state); break;
+	case FACE_ZMIN: Drawer_ZMinExt(count, col, loc, vertices, state); break;
+	case FACE_ZMAX: Drawer_ZMaxExt(count, col, loc, vertices, state); break;
+	case FACE_YMIN: Drawer_YMinExt(count, col, loc, vertices, state); break;
+	case FACE_YMAX: Drawer_YMaxExt(count, col, loc, vertices, state); break;
+	}
+
+	state->Y2 = y2; state->Z2 = z2;
+	state->MaxBB.Y = maxY; state->MaxBB.Z = maxZ;
+}
+
+static void GreedyBuilder_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
+	struct Builder1DPart* part;
+	int baseOffset, count, face;
+	cc_bool fullBright;
+	TextureLoc loc;
+	PackedCol col;
+	Vec3 min, max;
+
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
+	}
+
+	fullBright = Blocks.FullBright[ctx->block];
+	baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+
+	ctx->drawer.MinBB = Blocks.MinBB[ctx->block]; ctx->drawer.MinBB.Y = 1.0f - ctx->drawer.MinBB.Y;
+	ctx->drawer.MaxBB = Blocks.MaxBB[ctx->block]; ctx->drawer.MaxBB.Y = 1.0f - ctx->drawer.MaxBB.Y;
+
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->drawer.X1 = x + min.X; ctx->drawer.Y1 = y + min.Y; ctx->drawer.Z1 = z + min.Z;
+	ctx->drawer.X2 = x + max.X; ctx->drawer.Y2 = y + max.Y; ctx->drawer.Z2 = z + max.Z;
+
+	ctx->drawer.Tinted  = Blocks.Tinted[ctx->block];
+	ctx->drawer.TintCol = Blocks.FogCol[ctx->block];
+
+	for (face = 0; face < FACE_COUNT; face++) {
+		count = ctx->counts[index + face];
+		if (!count) continue;
+
+		loc  = Block_Tex(ctx->block, face);
+		part = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
+		col  = fullBright ? PACKEDCOL_WHITE : Normal_LightCol(ctx, x, y, z, face, ctx->block);
+		GreedyBuilder_DrawFace(ctx, face, count, ctx->spans[index + face], col, loc, &part->fVertices[face]);
+	}
+}
+
+static void GreedyBuilder_SetActive(void) {
+	Builder_SetDefault();
+	Builder_StretchXLiquid = GreedyBuilder_StretchXLiquid;
+	Builder_StretchX       = GreedyBuilder_StretchX;
+	Builder_StretchZ       = GreedyBuilder_StretchZ;
+	Builder_RenderBlock    = GreedyBuilder_RenderBlock;
+	/* Changing a block can change how faces in any of the rows below/behind it are merged */
+	Builder_Incremental    = false;
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------Level of detail mesh builder----------------------------------------------*
+*#########################################################################################################################*/
+/* Builds simplified meshes for distant chunks, where each cell of 2^lod blocks along each axis is drawn as if */
+/*  it were a single large block. The blocks of each cell are replaced with the block that represents the cell, */
+/*  so that neighbouring cells (even in other chunks) hide each other's faces just like ordinary blocks do. */
+#define Lod_PackRegion(x, y, z) ((((y) + LOD_MAX_SIZE) * LOD_REGION_SIZE + ((z) + LOD_MAX_SIZE)) * LOD_REGION_SIZE + ((x) + LOD_MAX_SIZE))
+
+/* Copies the given row of blocks in the world */
+static void Lod_ReadRow(BlockID* dst, int x, int y, int z, int count) {
+	int i, index = World_Pack(x, y, z);
+	if (World.Sections) { World_GetSectionRow(x, y, z, count, dst); return; }
+
+#ifndef EXTENDED_BLOCKS
+	for (i = 0; i < count; i++) { dst[i] = World.Blocks[index + i]; }
+#else
+	if (World.IDMask <= 0xFF) {
+		for (i = 0; i < count; i++) { dst[i] = World.Blocks[index + i]; }
+	} else {
+		for (i = 0; i < count; i++) { dst[i] = World.Blocks[index + i] | (World.Blocks2[index + i] << 8); }
+	}
+#endif
+}
+
+/* Copies the blocks of the chunk and of the cells around it (only of cells that share a face with the chunk, */
+/*  as the edges and corners of the border are never used when building the mesh) */
+/* NOTE: The blocks are only combined into cells later when the mesh is built, see Lod_ReadCells */
+static cc_bool ReadLodChunkData(BlockID* blocks, int x1, int y1, int z1, int lod, cc_bool* outAllAir) {
+	int size = 1 << lod;
+	cc_bool allAir = true, allSolid = true, outY, outZ;
+	int xMin, count, xx, yy, zz, y, z, i;
+	BlockID* row;
+
+	for (yy = -size; yy < CHUNK_SIZE + size; yy++) {
+		y = y1 + yy;
+		if (y < 0 || y >= World.Height) continue;
+		outY = yy < 0 || yy >= CHUNK_SIZE;
+
+		for (zz = -size; zz < CHUNK_SIZE + size; zz++) {
+			z = z1 + zz;
+			if (z < 0 || z >= World.Length) continue;
+			outZ = zz < 0 || zz >= CHUNK_SIZE;
+			if (outY && outZ) continue;
+
+			/* Rows in the Y/Z border only need the blocks directly next to the chunk */
+			xx    = outY || outZ ? 0 : -size;
+			xMin  = max(x1 + xx, 0);
+			count = min(x1 + CHUNK_SIZE - xx, World.Width) - xMin;
+			row   = &blocks[Lod_PackRegion(xMin - x1, yy, zz)];
+			Lod_ReadRow(row, xMin, y, z, count);
+
+			for (i = 0; i < count; i++) {
+				allAir   = allAir   && Blocks.Draw[row[i]] == DRAW_GAS;
+				allSolid = allSolid && Blocks.FullOpaque[row[i]];
+			}
+		}
+	}
+
+	*outAllAir = allAir;
+	return allSolid;
+}
+
+/* Returns the most common block in the given blocks */
+/* NOTE: counts must be all 0, and are reset back to 0 afterwards */
+static BlockID Lod_MostCommon(const BlockID* blocks, int count, cc_uint8* counts) {
+	BlockID best = blocks[0];
+	int i, bestCount = 0;
+
+	for (i = 0; i < count; i++) { counts[blocks[i]]++; }
+	for (i = 0; i < count; i++) {
+		if (counts[blocks[i]] > bestCount) { best = blocks[i]; bestCount = counts[blocks[i]]; }
+		counts[blocks[i]] = 0;
+	}
+	return best;
+}
+
+/* Returns the block that represents the given cell (relative to the chunk), or air if the cell is mostly empty. */
+/* The most common block of the highest layer of the cell is used, so that e.g. grass instead of dirt is on top. */
+/* NOTE: Sprites are ignored, as they are too small to be seen from far away anyways */
+static BlockID Lod_CellBlock(struct BuilderJob* job, int x1, int y1, int z1, int size, cc_uint8* counts) {
+	BlockID layer[LOD_MAX_SIZE * LOD_MAX_SIZE];
+	BlockID block, top = BLOCK_AIR;
+	int x2 = min(x1 + size, World.Width  - job->x1);
+	int y2 = min(y1 + size, World.Height - job->y1);
+	int z2 = min(z1 + size, World.Length - job->z1);
+	int total = 0, filled = 0, count;
+	int x, y, z;
+	x1 = max(x1, -job->x1); y1 = max(y1, -job->y1); z1 = max(z1, -job->z1);
+
+	for (y = y2 - 1; y >= y1; y--) {
+		count = 0;
+		for (z = z1; z < z2; z++) {
+			for (x = x1; x < x2; x++) {
+				block = job->lodBlocks[Lod_PackRegion(x, y, z)];
+				total++;
+				if (Blocks.Draw[block] == DRAW_GAS || Blocks.Draw[block] == DRAW_SPRITE) continue;
+
+				layer[count++] = block;
+				filled++;
+			}
+		}
+		if (count && top == BLOCK_AIR) top = Lod_MostCommon(layer, count, counts);
+	}
+	return filled && filled * 2 >= total ? top : BLOCK_AIR;
+}
+
+/* Combines the blocks copied into the job into cells, with every block of each cell replaced by the cell's block */
+static void Lod_ReadCells(struct BuilderJob* job) {
+	int size = 1 << job->lod, cells = CHUNK_SIZE >> job->lod;
+	cc_uint8 counts[BLOCK_COUNT]; /* at most LOD_MAX_SIZE * LOD_MAX_SIZE of a block in a layer */
+	int cx, cy, cz, xx, yy, zz;
+	BlockID block;
+	Mem_Set(counts, 0, sizeof(counts));
+
+	for (cy = -1; cy <= cells; cy++) {
+		for (cz = -1; cz <= cells; cz++) {
+			for (cx = -1; cx <= cells; cx++) {
+				if ((cx < 0 || cx == cells) + (cy < 0 || cy == cells) + (cz < 0 || cz == cells) > 1) continue;
+				block = Lod_CellBlock(job, cx * size, cy * size, cz * size, size, counts);
+
+				for (yy = max(cy * size, -1); yy < min((cy + 1) * size, CHUNK_SIZE + 1); yy++) {
+					for (zz = max(cz * size, -1); zz < min((cz + 1) * size, CHUNK_SIZE + 1); zz++) {
+						for (xx = max(cx * size, -1); xx < min((cx + 1) * size, CHUNK_SIZE + 1); xx++) {
+							job->chunk[Builder_PackChunk(xx, yy, zz)] = block;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/* Whether a face of the given block on the border of the map is hidden by the map sides/edge */
+#define Lod_HiddenOnBorder(block, top) ((top) <= Builder_SidesLevel || ((block) >= BLOCK_WATER && (block) <= BLOCK_STILL_LAVA && (top) <= Builder_EdgeLevel))
+#define Lod_Hides(block, other, face) (Blocks.Hidden[(block) * BLOCK_COUNT + (other)] & (1 << (face)))
+
+/* Returns which faces of the given cell are visible (i.e. bit 1 << FACE_XMIN set if XMin face is visible) */
+static int Lod_VisibleFaces(struct BuilderContext* ctx, int cIndex, BlockID b, int x, int y, int z, int size, int ex, int ey, int ez) {
+	BlockID* chunk = ctx->chunk;
+	int faces = 0, top = y + ey;
+
+	if (!Lod_Hides(b, chunk[cIndex - 1], FACE_XMIN) && !(x == 0 && Lod_HiddenOnBorder(b, top)))
+		faces |= 1 << FACE_XMIN;
+	if (!Lod_Hides(b, chunk[cIndex + size], FACE_XMAX) && !(x + ex == World.Width && Lod_HiddenOnBorder(b, top)))
+		faces |= 1 << FACE_XMAX;
+	if (!Lod_Hides(b, chunk[cIndex - EXTCHUNK_SIZE], FACE_ZMIN) && !(z == 0 && Lod_HiddenOnBorder(b, top)))
+		faces |= 1 << FACE_ZMIN;
+	if (!Lod_Hides(b, chunk[cIndex + size * EXTCHUNK_SIZE], FACE_ZMAX) && !(z + ez == World.Length && Lod_HiddenOnBorder(b, top)))
+		faces |= 1 << FACE_ZMAX;
+
+	if (!Lod_Hides(b, chunk[cIndex - EXTCHUNK_SIZE_2], FACE_YMIN) && y > 0)
+		faces |= 1 << FACE_YMIN;
+	if (!Lod_Hides(b, chunk[cIndex + size * EXTCHUNK_SIZE_2], FACE_YMAX))
+		faces |= 1 << FACE_YMAX;
+	return faces;
+}
+
+static PackedCol Lod_LightCol(struct BuilderContext* ctx, Face face, int x, int y, int z, int ex, int ey, int ez) {
+	/* Side faces are lit depending on the top of the cell, since that is what's most visible from far away */
+	int top = y + ey - 1;
+
+	switch (face) {
+	case FACE_XMIN:
+		return x == 0                  ? Env.SunXSide : Builder_LightCol(ctx, x - 1,  top, z, Env.SunXSide, Env.ShadowXSide);
+	case FACE_XMAX:
+		return x + ex >= World.Width   ? Env.SunXSide : Builder_LightCol(ctx, x + ex, top, z, Env.SunXSide, Env.ShadowXSide);
+	case FACE_ZMIN:
+		return z == 0                  ? Env.SunZSide : Builder_LightCol(ctx, x, top, z - 1,  Env.SunZSide, Env.ShadowZSide);
+	case FACE_ZMAX:
+		return z + ez >= World.Length  ? Env.SunZSide : Builder_LightCol(ctx, x, top, z + ez, Env.SunZSide, Env.ShadowZSide);
+	case FACE_YMIN:
+		return y == 0                  ? Env.SunYMin  : Builder_LightCol(ctx, x, y - 1,  z, Env.SunYMin, Env.ShadowYMin);
+	case FACE_YMAX:
+		return Builder_LightCol(ctx, x, y + ey, z, Env.SunCol, Env.ShadowCol);
+	}
+	return 0; /* should never happen */
+}
+
+/* Draws a face of the given cell, with the face's texture stretched across the entire face */
+/* (or repeated once per block instead, if each 1D atlas contains a single tile - see the greedy mesh builder) */
+static void Lod_DrawFace(struct BuilderContext* ctx, Face face, int x, int y, int z, int ex, int ey, int ez, PackedCol col, TextureLoc loc, struct VertexTextured** vertices) {
+	struct _DrawerData* state = &ctx->drawer;
+	int count, span;
+
+	/* Drawer stretches X faces along Z and all other faces along X, */
+	/*  and the cell's bounds take care of the other axis of the face */
+	if (face <= FACE_XMAX) {
+		count = ez; span = ey;
+		state->X2 = (float)(x + ex); state->Z2 = (float)(z + 1);
+	} else {
+		count = ex; span = face >= FACE_YMIN ? ez : ey;
+		state->X2 = (float)(x + 1);  state->Z2 = (float)(z + ez);
+	}
+	state->X1 = (float)x; state->Y1 = (float)y; state->Z1 = (float)z;
+	state->Y2 = (float)(y + ey);
+
+	state->MinBB.X = 0.0f; state->MinBB.Y = 1.0f; state->MinBB.Z = 0.0f;
+	state->MaxBB.X = 1.0f; state->MaxBB.Y = 0.0f; state->MaxBB.Z = 1.0f;
+	if (Atlas1D.TilesPerAtlas == 1) {
+		if (face >= FACE_YMIN) {
+			state->MaxBB.Z += (span - 1) / UV2_Scale;
+		} else {
+			state->MaxBB.Y -= span - 1;
+		}
+	}
+
+	switch (face) {
+	case FACE_XMIN: Drawer_XMinExt(count, col, loc, vertices, state); break;
+	case FACE_XMAX: Drawer_XMaxExt(count, col, loc, vertices, state); break;
+	case FACE_ZMIN: Drawer_ZMinExt(count, col, loc, vertices, state); break;
+	case FACE_ZMAX: Drawer_ZMaxExt(count, col, loc, vertices, state); break;
+	case FACE_YMIN: Drawer_YMinExt(count, col, loc, vertices, state); break;
+	case FACE_YMAX: Drawer_YMaxExt(count, col, loc, vertices, state); break;
+	}
+}
+
+/* Counts the vertices of the visible faces of every cell in the chunk, or adds the vertices if 'draw' is true */
+static void Lod_AddCells(struct BuilderContext* ctx, cc_bool draw) {
+	struct BuilderJob* job = ctx->job;
+	int size = 1 << job->lod;
+	struct Builder1DPart* part;
+	int baseOffset, cIndex, faces;
+	int x, y, z, xx, yy, zz, ex, ey, ez;
+	TextureLoc loc;
+	PackedCol col;
+	BlockID b;
+	Face face;
+
+	for (y = job->y1, yy = 0; y < job->yMax; y += size, yy += size) {
+		ey = min(size, job->yMax - y);
+
+		for (z = job->z1, zz = 0; z < job->zMax; z += size, zz += size) {
+			ez = min(size, job->zMax - z);
+
+			for (x = job->x1, xx = 0; x < job->xMax; x += size, xx += size) {
+				ex = min(size, job->xMax - x);
+				cIndex = Builder_PackChunk(xx, yy, zz);
+				b      = ctx->chunk[cIndex];
+				if (Blocks.Draw[b] == DRAW_GAS) continue;
+
+				faces = Lod_VisibleFaces(ctx, cIndex, b, x, y, z, size, ex, ey, ez);
+				if (!faces) continue;
+				baseOffset = (Blocks.Draw[b] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+				ctx->drawer.Tinted  = Blocks.Tinted[b];
+				ctx->drawer.TintCol = Blocks.FogCol[b];
+
+				for (face = 0; face < FACE_COUNT; face++) {
+					if (!(faces & (1 << face))) continue;
+					if (!draw) { AddVertices(ctx, b, face); continue; }
+
+					loc  = Block_Tex(b, face);
+					part = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
+					col  = Blocks.FullBright[b] ? PACKEDCOL_WHITE : Lod_LightCol(ctx, face, x, y, z, ex, ey, ez);
+					Lod_DrawFace(ctx, face, x, y, z, ex, ey, ez, col, loc, &part->fVertices[face]);
+				}
+			}
+		}
+	}
+}
+
+static void LodBuilder_Build(struct BuilderContext* ctx, struct BuilderJob* job) {
+	Lod_ReadCells(job);
+	DefaultPrePrepateChunk(ctx);
+	job->occlusionFlags = ComputeOcclusion(ctx);
+	Lod_AddCells(ctx, false);
+
+	job->totalVerts = Builder_TotalVerticesCount(ctx);
+	if (!job->totalVerts) return;
+
+	job->vertices = (struct VertexTextured*)Mem_Alloc(job->totalVerts, SIZEOF_VERTEX_TEXTURED, "chunk vertices");
+	ctx->vertices = job->vertices;
+	DefaultPostStretchChunk(ctx);
+
+	Lod_AddCells(ctx, true);
+	SetJobParts(ctx, job);
+}
+
+
 /*########################################################################################################################*
 *-------------------------------------------------Advanced mesh builder---------------------------------------------------*
 *#########################################################################################################################*/
-static Vec3 adv_minBB, adv_maxBB;
-static int adv_initBitFlags, adv_baseOffset;
-static int* adv_bitFlags;
-static float adv_x1, adv_y1, adv_z1, adv_x2, adv_y2, adv_z2;
-static PackedCol adv_lerp[5], adv_lerpX[5], adv_lerpZ[5], adv_lerpY[5];
-static cc_bool adv_tinted;
 
 enum ADV_MASK {
 	/* z-1 cube points */
@@ -771,7 +1999,7 @@ enum ADV_MASK {
 	xP1_yM1_zP1, xP1_yCC_zP1, xP1_yP1_zP1,
 };
 
-static int Adv_Lit(int x, int y, int z, int cIndex) {
+static int Adv_Lit(struct BuilderContext* ctx, int x, int y, int z, int cIndex) {
 	int flags, offset, lightFlags;
 	BlockID block;
 	if (y < 0 || y >= World.Height) return 7; /* all faces lit */
@@ -782,40 +2010,69 @@ static int Adv_Lit(int x, int y, int z, int cIndex) {
 	}
 
 	flags = 0;
-	block = Builder_Chunk[cIndex];
+	block = ctx->chunk[cIndex];
 	lightFlags = Blocks.LightOffset[block];
 
 	/* Use fact Light(Y.YMin) == Light((Y-1).YMax) */
 	offset = (lightFlags >> FACE_YMIN) & 1;
-	flags |= Lighting_IsLit_Fast(x, y - offset, z) ? 1 : 0;
+	flags |= Builder_IsLit(ctx, x, y - offset, z) ? 1 : 0;
 
 	/* Light is same for all the horizontal faces */
-	flags |= Lighting_IsLit_Fast(x, y, z) ? 2 : 0;
+	flags |= Builder_IsLit(ctx, x, y, z) ? 2 : 0;
 
 	/* Use fact Light((Y+1).YMin) == Light(Y.YMax) */
 	offset = (lightFlags >> FACE_YMAX) & 1;
-	flags |= Lighting_IsLit_Fast(x, (y + 1) - offset, z) ? 4 : 0;
+	flags |= Builder_IsLit(ctx, x, (y + 1) - offset, z) ? 4 : 0;
 
 	/* Dynamic lighting */
 	if (Blocks.FullBright[block])                       flags |= 5;
-	if (Blocks.FullBright[Builder_Chunk[cIndex + 324]]) flags |= 4;
-	if (Blocks.FullBright[Builder_Chunk[cIndex - 324]]) flags |= 1;
+	if (Blocks.FullBright[ctx->chunk[cIndex + 324]]) flags |= 4;
+	if (Blocks.FullBright[ctx->chunk[cIndex - 324]]) flags |= 1;
 	return flags;
 }
 
-static int Adv_ComputeLightFlags(int x, int y, int z, int cIndex) {
-	if (Builder_FullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
+/* Offsets of the cube points around a block in the 18x18x18 chunk array */
+#define Adv_Offset(dx, dy, dz) ((dy) * EXTCHUNK_SIZE_2 + (dz) * EXTCHUNK_SIZE + (dx))
+static const int adv_offsets[27] = {
+	Adv_Offset(-1,-1,-1), Adv_Offset(-1, 0,-1), Adv_Offset(-1, 1,-1),
+	Adv_Offset( 0,-1,-1), Adv_Offset( 0, 0,-1), Adv_Offset( 0, 1,-1),
+	Adv_Offset( 1,-1,-1), Adv_Offset( 1, 0,-1), Adv_Offset( 1, 1,-1),
+	Adv_Offset(-1,-1, 0), Adv_Offset(-1, 0, 0), Adv_Offset(-1, 1, 0),
+	Adv_Offset( 0,-1, 0), Adv_Offset( 0, 0, 0), Adv_Offset( 0, 1, 0),
+	Adv_Offset( 1,-1, 0), Adv_Offset( 1, 0, 0), Adv_Offset( 1, 1, 0),
+	Adv_Offset(-1,-1, 1), Adv_Offset(-1, 0, 1), Adv_Offset(-1, 1, 1),
+	Adv_Offset( 0,-1, 1), Adv_Offset( 0, 0, 1), Adv_Offset( 0, 1, 1),
+	Adv_Offset( 1,-1, 1), Adv_Offset( 1, 0, 1), Adv_Offset( 1, 1, 1),
+};
+/* Set in the light flags of a block when every cube point around it has the same light level (in the lower 4 bits) */
+#define ADV_UNIFORM_LEVEL (1 << 30)
+
+/* When light levels are propagated, faces can only be stretched across blocks with the same uniform light level */
+static int Adv_ComputeLevelFlags(struct BuilderContext* ctx, int cIndex) {
+	cc_uint8* levels = ctx->job->levels + cIndex;
+	int i, level = levels[adv_offsets[0]];
+
+	for (i = 1; i < Array_Elems(adv_offsets); i++) {
+		if (levels[adv_offsets[i]] != level) return 0;
+	}
+	return ADV_UNIFORM_LEVEL | level;
+}
+
+static int Adv_ComputeLightFlags(struct BuilderContext* ctx, int x, int y, int z, int cIndex) {
+	if (ctx->fullBright && Lighting_Propagated) return ADV_UNIFORM_LEVEL | 15;
+	if (ctx->fullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
+	if (Lighting_Propagated) return Adv_ComputeLevelFlags(ctx, cIndex);
 
 	return
-		Adv_Lit(x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
-		Adv_Lit(x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
-		Adv_Lit(x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
-		Adv_Lit(x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
-		Adv_Lit(x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
-		Adv_Lit(x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
-		Adv_Lit(x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
-		Adv_Lit(x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
-		Adv_Lit(x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
+		Adv_Lit(ctx, x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
+		Adv_Lit(ctx, x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
+		Adv_Lit(ctx, x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
+		Adv_Lit(ctx, x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
+		Adv_Lit(ctx, x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
+		Adv_Lit(ctx, x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
+		Adv_Lit(ctx, x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
+		Adv_Lit(ctx, x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
+		Adv_Lit(ctx, x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
 }
 
 static int adv_masks[FACE_COUNT] = {
@@ -846,384 +2103,387 @@ static int adv_masks[FACE_COUNT] = {
 };
 
 
-static cc_bool Adv_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
-	adv_bitFlags[chunkIndex] = Adv_ComputeLightFlags(x, y, z, chunkIndex);
+static cc_bool Adv_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = ctx->chunk[chunkIndex];
+	ctx->bitFlags[chunkIndex] = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
 
-	return cur == initial
-		&& !Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)
-		&& (adv_initBitFlags == adv_bitFlags[chunkIndex]
-		/* Check that this face is either fully bright or fully in shadow */
-		&& (adv_initBitFlags == 0 || (adv_initBitFlags & adv_masks[face]) == adv_masks[face]));
+	if (cur != initial || Block_IsFaceHidden(cur, ctx->chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
+	if (ctx->initBitFlags != ctx->bitFlags[chunkIndex]) return false;
+	if (Lighting_Propagated) return (ctx->initBitFlags & ADV_UNIFORM_LEVEL) != 0;
+
+	/* Check that this face is either fully bright or fully in shadow */
+	return ctx->initBitFlags == 0 || (ctx->initBitFlags & adv_masks[face]) == adv_masks[face];
 }
 
-static int Adv_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int Adv_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; cc_bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, FACE_YMAX);
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int Adv_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int Adv_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < ctx->chunkEndZ && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
 		countIndex += CHUNK_SIZE * FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
 
-#define Adv_CountBits(F, a, b, c, d) (((F >> a) & 1) + ((F >> b) & 1) + ((F >> c) & 1) + ((F >> d) & 1))
+/* Light level (0 to 15) of the given cube point around the block being drawn */
+#define Adv_Level(ctx, F, p) (Lighting_Propagated ? (ctx)->job->levels[(ctx)->chunkIndex + adv_offsets[p]] : ((F >> (p)) & 1) * 15)
+/* Sum of the light levels of the 4 cube points around a vertex (0 to ADV_MAX_LIGHT) */
+#define Adv_SumLevels(ctx, F, a, b, c, d) (Adv_Level(ctx, F, a) + Adv_Level(ctx, F, b) + Adv_Level(ctx, F, c) + Adv_Level(ctx, F, d))
 
-static void Adv_DrawXMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMIN);
+static void Adv_DrawXMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.Z, u2 = (count - 1) + adv_maxBB.Z * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.Z, u2 = (count - 1) + ctx->maxBB.Z * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aY0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xM1_yM1_zCC, xM1_yCC_zCC);
-	int aY0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xM1_yM1_zCC, xM1_yCC_zCC);
-	int aY1_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xM1_yP1_zCC, xM1_yCC_zCC);
-	int aY1_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xM1_yP1_zCC, xM1_yCC_zCC);
+	int F = ctx->bitFlags[ctx->chunkIndex];
+	int aY0_Z0 = Adv_SumLevels(ctx, F, xM1_yM1_zM1, xM1_yCC_zM1, xM1_yM1_zCC, xM1_yCC_zCC);
+	int aY0_Z1 = Adv_SumLevels(ctx, F, xM1_yM1_zP1, xM1_yCC_zP1, xM1_yM1_zCC, xM1_yCC_zCC);
+	int aY1_Z0 = Adv_SumLevels(ctx, F, xM1_yP1_zM1, xM1_yCC_zM1, xM1_yP1_zCC, xM1_yCC_zCC);
+	int aY1_Z1 = Adv_SumLevels(ctx, F, xM1_yP1_zP1, xM1_yCC_zP1, xM1_yP1_zCC, xM1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpX[aY0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerpX[aY1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpX[aY1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerpX[aY0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->fVertices[FACE_XMIN];
-	v.X = adv_x1;
+	v.X = ctx->x1;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.Y = adv_y2; v.Z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.Z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
-		v.Y = adv_y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.Y = ctx->y2; v.Z = ctx->z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.Y = ctx->y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.Z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.Y = ctx->y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.Y = adv_y2; v.Z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		              v.Z = adv_z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.Z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.Y = ctx->y2; v.Z = ctx->z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		              v.Z = ctx->z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
+		v.Y = ctx->y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.Z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
 	}
 	part->fVertices[FACE_XMIN] = vertices;
 }
 
-static void Adv_DrawXMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMAX);
+static void Adv_DrawXMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.Z), u2 = (1 - adv_maxBB.Z) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->minBB.Z), u2 = (1 - ctx->maxBB.Z) * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aY0_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xP1_yM1_zCC, xP1_yCC_zCC);
-	int aY0_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xP1_yM1_zCC, xP1_yCC_zCC);
-	int aY1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xP1_yP1_zCC, xP1_yCC_zCC);
-	int aY1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xP1_yP1_zCC, xP1_yCC_zCC);
+	int F = ctx->bitFlags[ctx->chunkIndex];
+	int aY0_Z0 = Adv_SumLevels(ctx, F, xP1_yM1_zM1, xP1_yCC_zM1, xP1_yM1_zCC, xP1_yCC_zCC);
+	int aY0_Z1 = Adv_SumLevels(ctx, F, xP1_yM1_zP1, xP1_yCC_zP1, xP1_yM1_zCC, xP1_yCC_zCC);
+	int aY1_Z0 = Adv_SumLevels(ctx, F, xP1_yP1_zM1, xP1_yCC_zM1, xP1_yP1_zCC, xP1_yCC_zCC);
+	int aY1_Z1 = Adv_SumLevels(ctx, F, xP1_yP1_zP1, xP1_yCC_zP1, xP1_yP1_zCC, xP1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpX[aY0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerpX[aY1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpX[aY1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerpX[aY0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->fVertices[FACE_XMAX];
-	v.X = adv_x2;
+	v.X = ctx->x2;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.Y = adv_y2; v.Z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		              v.Z = adv_z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.Z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.Y = ctx->y2; v.Z = ctx->z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		              v.Z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.Y = ctx->y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.Z = ctx->z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
 	} else {
-		v.Y = adv_y2; v.Z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.Y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.Z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		v.Y = adv_y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.Y = ctx->y2; v.Z = ctx->z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.Y = ctx->y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.Z = ctx->z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.Y = ctx->y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_XMAX] = vertices;
 }
 
-static void Adv_DrawZMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMIN);
+static void Adv_DrawZMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.X), u2 = (1 - adv_maxBB.X) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->minBB.X), u2 = (1 - ctx->maxBB.X) * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
-	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
-	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
-	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
+	int F = ctx->bitFlags[ctx->chunkIndex];
+	int aX0_Y0 = Adv_SumLevels(ctx, F, xM1_yM1_zM1, xM1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
+	int aX0_Y1 = Adv_SumLevels(ctx, F, xM1_yP1_zM1, xM1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
+	int aX1_Y0 = Adv_SumLevels(ctx, F, xP1_yM1_zM1, xP1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
+	int aX1_Y1 = Adv_SumLevels(ctx, F, xP1_yP1_zM1, xP1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y0], col1_0 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y1], col0_1 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->fVertices[FACE_ZMIN];
-	v.Z = adv_z1;
+	v.Z = ctx->z1;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.X = adv_x2 + (count - 1); v.Y = adv_y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.Y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1); v.Y = ctx->y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.X = ctx->x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.Y = ctx->y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.X = adv_x1;               v.Y = adv_y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
-		                            v.Y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.Y = adv_y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.X = ctx->x1;               v.Y = ctx->y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
+		                            v.Y = ctx->y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.Y = ctx->y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_ZMIN] = vertices;
 }
 
-static void Adv_DrawZMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMAX);
+static void Adv_DrawZMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.X, u2 = (count - 1) + adv_maxBB.X * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.Y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.X, u2 = (count - 1) + ctx->maxBB.X * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.Y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.Y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
-	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
-	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
-	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
+	int F = ctx->bitFlags[ctx->chunkIndex];
+	int aX0_Y0 = Adv_SumLevels(ctx, F, xM1_yM1_zP1, xM1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
+	int aX1_Y0 = Adv_SumLevels(ctx, F, xP1_yM1_zP1, xP1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
+	int aX0_Y1 = Adv_SumLevels(ctx, F, xM1_yP1_zP1, xM1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
+	int aX1_Y1 = Adv_SumLevels(ctx, F, xP1_yP1_zP1, xP1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y1], col1_0 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y0];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y0], col0_1 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->fVertices[FACE_ZMAX];
-	v.Z = adv_z2;
+	v.Z = ctx->z2;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.X = adv_x1;               v.Y = adv_y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
-		                            v.Y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.Y = adv_y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.X = ctx->x1;               v.Y = ctx->y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
+		                            v.Y = ctx->y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.Y = ctx->y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.X = adv_x2 + (count - 1); v.Y = adv_y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.Y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1); v.Y = ctx->y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.X = ctx->x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.Y = ctx->y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_ZMAX] = vertices;
 }
 
-static void Adv_DrawYMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMIN);
+static void Adv_DrawYMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.X, u2 = (count - 1) + adv_maxBB.X * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.Z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.X, u2 = (count - 1) + ctx->maxBB.X * UV2_Scale;
+	float v1 = vOrigin + ctx->minBB.Z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->maxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
-	int aX1_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
-	int aX0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
-	int aX1_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
+	int F = ctx->bitFlags[ctx->chunkIndex];
+	int aX0_Z0 = Adv_SumLevels(ctx, F, xM1_yM1_zM1, xM1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
+	int aX1_Z0 = Adv_SumLevels(ctx, F, xP1_yM1_zM1, xP1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
+	int aX0_Z1 = Adv_SumLevels(ctx, F, xM1_yM1_zP1, xM1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
+	int aX1_Z1 = Adv_SumLevels(ctx, F, xP1_yM1_zP1, xP1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_1 = Builder_FullBright ? white : adv_lerpY[aX0_Z1], col1_1 = Builder_FullBright ? white : adv_lerpY[aX1_Z1];
-	PackedCol col1_0 = Builder_FullBright ? white : adv_lerpY[aX1_Z0], col0_0 = Builder_FullBright ? white : adv_lerpY[aX0_Z0];
+	PackedCol col0_1 = ctx->fullBright ? white : ctx->lerpY[aX0_Z1], col1_1 = ctx->fullBright ? white : ctx->lerpY[aX1_Z1];
+	PackedCol col1_0 = ctx->fullBright ? white : ctx->lerpY[aX1_Z0], col0_0 = ctx->fullBright ? white : ctx->lerpY[aX0_Z0];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->fVertices[FACE_YMIN];
-	v.Y = adv_y1;
+	v.Y = ctx->y1;
 	if (aX0_Z1 + aX1_Z0 > aX0_Z0 + aX1_Z1) {
-		v.X = adv_x2 + (count - 1); v.Z = adv_z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.Z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1); v.Z = ctx->z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.X = ctx->x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.Z = ctx->z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	} else {
-		v.X = adv_x1;               v.Z = adv_z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
-		                            v.Z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.Z = adv_z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.X = ctx->x1;               v.Z = ctx->z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
+		                            v.Z = ctx->z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.Z = ctx->z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
 	}
 	part->fVertices[FACE_YMIN] = vertices;
 }
 
-static void Adv_DrawYMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMAX);
+static void Adv_DrawYMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.X, u2 = (count - 1) + adv_maxBB.X * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.Z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.X, u2 = (count - 1) + ctx->maxBB.X * UV2_Scale;
+	float v1 = vOrigin + ctx->minBB.Z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->maxBB.Z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
-	int aX0_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
-	int aX1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
-	int aX0_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
-	int aX1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
+	int F = ctx->bitFlags[ctx->chunkIndex];
+	int aX0_Z0 = Adv_SumLevels(ctx, F, xM1_yP1_zM1, xM1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
+	int aX1_Z0 = Adv_SumLevels(ctx, F, xP1_yP1_zM1, xP1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
+	int aX0_Z1 = Adv_SumLevels(ctx, F, xM1_yP1_zP1, xM1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
+	int aX1_Z1 = Adv_SumLevels(ctx, F, xP1_yP1_zP1, xP1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerp[aX0_Z0], col1_0 = Builder_FullBright ? white : adv_lerp[aX1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerp[aX1_Z1], col0_1 = Builder_FullBright ? white : adv_lerp[aX0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerp[aX0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerp[aX1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerp[aX1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerp[aX0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->fVertices[FACE_YMAX];
-	v.Y = adv_y2;
+	v.Y = ctx->y2;
 	if (aX0_Z0 + aX1_Z1 > aX0_Z1 + aX1_Z0) {
-		v.X = adv_x2 + (count - 1); v.Z = adv_z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.X = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.Z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1); v.Z = ctx->z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.X = ctx->x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.Z = ctx->z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.X = adv_x1;               v.Z = adv_z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
-		                            v.Z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.X = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.Z = adv_z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.X = ctx->x1;               v.Z = ctx->z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
+		                            v.Z = ctx->z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.X = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.Z = ctx->z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->fVertices[FACE_YMAX] = vertices;
 }
 
-static void Adv_RenderBlock(int index, int x, int y, int z) {
+static void Adv_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
 	Vec3 min, max;
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	Builder_FullBright = Blocks.FullBright[Builder_Block];
-	adv_baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	adv_tinted     = Blocks.Tinted[Builder_Block];
+	ctx->fullBright = Blocks.FullBright[ctx->block];
+	ctx->baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	ctx->tinted     = Blocks.Tinted[ctx->block];
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	adv_x1 = x + min.X; adv_y1 = y + min.Y; adv_z1 = z + min.Z;
-	adv_x2 = x + max.X; adv_y2 = y + max.Y; adv_z2 = z + max.Z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->x1 = x + min.X; ctx->y1 = y + min.Y; ctx->z1 = z + min.Z;
+	ctx->x2 = x + max.X; ctx->y2 = y + max.Y; ctx->z2 = z + max.Z;
 
-	adv_minBB = Blocks.MinBB[Builder_Block]; adv_maxBB = Blocks.MaxBB[Builder_Block];
-	adv_minBB.Y = 1.0f - adv_minBB.Y; adv_maxBB.Y = 1.0f - adv_maxBB.Y;
+	ctx->minBB = Blocks.MinBB[ctx->block]; ctx->maxBB = Blocks.MaxBB[ctx->block];
+	ctx->minBB.Y = 1.0f - ctx->minBB.Y; ctx->maxBB.Y = 1.0f - ctx->maxBB.Y;
 
-	if (count_XMin) Adv_DrawXMin(count_XMin);
-	if (count_XMax) Adv_DrawXMax(count_XMax);
-	if (count_ZMin) Adv_DrawZMin(count_ZMin);
-	if (count_ZMax) Adv_DrawZMax(count_ZMax);
-	if (count_YMin) Adv_DrawYMin(count_YMin);
-	if (count_YMax) Adv_DrawYMax(count_YMax);
+	if (count_XMin) Adv_DrawXMin(ctx, count_XMin);
+	if (count_XMax) Adv_DrawXMax(ctx, count_XMax);
+	if (count_ZMin) Adv_DrawZMin(ctx, count_ZMin);
+	if (count_ZMax) Adv_DrawZMax(ctx, count_ZMax);
+	if (count_YMin) Adv_DrawYMin(ctx, count_YMin);
+	if (count_YMax) Adv_DrawYMax(ctx, count_YMax);
 }
 
-static void Adv_PrePrepareChunk(void) {
+static void Adv_PrePrepareChunk(struct BuilderContext* ctx) {
 	int i;
-	DefaultPrePrepateChunk();
-	adv_bitFlags = Builder_BitFlags;
+	DefaultPrePrepateChunk(ctx);
 
-	for (i = 0; i <= 4; i++) {
-		adv_lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / 4.0f);
-		adv_lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / 4.0f);
-		adv_lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / 4.0f);
-		adv_lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / 4.0f);
+	for (i = 0; i <= ADV_MAX_LIGHT; i++) {
+		ctx->lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / (float)ADV_MAX_LIGHT);
+		ctx->lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / (float)ADV_MAX_LIGHT);
+		ctx->lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / (float)ADV_MAX_LIGHT);
+		ctx->lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / (float)ADV_MAX_LIGHT);
 	}
 }
 
@@ -1241,9 +2501,17 @@ static void AdvBuilder_SetActive(void) {
 *---------------------------------------------------Builder interface-----------------------------------------------------*
 *#########################################################################################################################*/
 cc_bool Builder_SmoothLighting;
+cc_bool Builder_GreedyMeshing;
+cc_bool Builder_PropagatedLight;
 void Builder_ApplyActive(void) {
+	/* Chunks being built in the background may be using the current builder */
+	Builder_CancelAll();
+	Lighting_SetPropagated(Builder_SmoothLighting && Builder_PropagatedLight);
+
 	if (Builder_SmoothLighting) {
 		AdvBuilder_SetActive();
+	} else if (Builder_GreedyMeshing) {
+		GreedyBuilder_SetActive();
 	} else {
 		NormalBuilder_SetActive();
 	}
@@ -1258,9 +2526,14 @@ static void OnInit(void) {
 	Builder_Offsets[FACE_YMAX] =  EXTCHUNK_SIZE_2;
 
 	if (!Game_ClassicMode) Builder_SmoothLighting = Options_GetBool(OPT_SMOOTH_LIGHTING, false);
+	Builder_GreedyMeshing = Options_GetBool(OPT_GREEDY_MESHING, false);
+	if (!Game_ClassicMode) Builder_PropagatedLight = Options_GetBool(OPT_PROPAGATED_LIGHT, false);
 	Builder_ApplyActive();
+	StartWorkers();
 }
 
+static void OnFree(void) { StopWorkers(); }
+
 static void OnNewMapLoaded(void) {
 	Builder_SidesLevel = max(0, Env_SidesHeight);
 	Builder_EdgeLevel  = max(0, Env.EdgeHeight);
@@ -1268,7 +2541,7 @@ static void OnNewMapLoaded(void) {
 
 struct IGameComponent Builder_Component = {
 	OnInit, /* Init */
-	NULL, /* Free */
+	OnFree, /* Free */
 	NULL, /* Reset */
 	NULL, /* OnNewMap */
 	OnNewMapLoaded /* OnNewMapLoaded */
@@ -5,6 +5,8 @@
 NormalMeshBuilder:
    Implements a simple chunk mesh builder, where each block face is a single colour.
    (whatever lighting engine returns as light colour for given block face at given coordinates)
+GreedyMeshBuilder:
+   Same as NormalMeshBuilder, but also merges rows of identical faces into larger rectangles.
 
 Copyright 2014-2021 ClassiCube | Licensed under BSD-3
 */
@@ -15,9 +17,34 @@ extern struct IGameComponent Builder_Component;
 extern int Builder_SidesLevel, Builder_EdgeLevel;
 /* Whether smooth/advanced lighting mesh builder is used. */
 extern cc_bool Builder_SmoothLighting;
+/* Whether the greedy mesh builder is used when smooth lighting is off. */
+/* NOTE: Only read at startup, as it requires each tile to be in its own 1D atlas. */
+extern cc_bool Builder_GreedyMeshing;
+/* Whether smooth lighting uses light levels propagated from the sky and light emitting blocks. */
+/* NOTE: Only read at startup. (see Lighting_Propagated) */
+extern cc_bool Builder_PropagatedLight;
 
 /* Builds the mesh of vertices for the given chunk. */
-void Builder_MakeChunk(struct ChunkInfo* info);
+/* When background builder threads are used, the mesh is built asynchronously, */
+/*  and the chunk is later returned by Builder_FinishChunk once its mesh is ready. */
+/* Returns whether the chunk was queued to be built asynchronously. */
+cc_bool Builder_MakeChunk(struct ChunkInfo* info);
+/* Returns the number of background threads chunk meshes are built on, 0 if built on the main thread. */
+int Builder_WorkersCount(void);
+/* Calls the given function on every background chunk builder thread and on the main thread, */
+/*  and then waits until all of those calls have returned. Used to split up work done while loading maps. */
+/* NOTE: func must keep taking pieces of work from a shared list until there are none left, */
+/*  as it may be called any number of times, including after all the work has already been done. */
+void Builder_RunOnWorkers(void (*func)(void));
+/* Whether another chunk can be passed to Builder_MakeChunk at the moment. */
+cc_bool Builder_CanQueue(void);
+/* Uploads the mesh of a chunk that has finished building in the background. */
+/* Returns the chunk whose mesh was uploaded, or NULL if no chunks have finished building. */
+struct ChunkInfo* Builder_FinishChunk(void);
+/* Discards all chunks currently queued or being built in the background, */
+/*  and the cached state of recently changed chunks used to rebuild them incrementally. */
+/* NOTE: This must be called before any chunks are deleted, or whenever chunks must be completely rebuilt. */
+void Builder_CancelAll(void);
 
 void Builder_ApplyActive(void);
 #endif
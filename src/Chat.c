@@ -18,15 +18,16 @@
 #include "TexturePack.h"
 #include "Options.h"
 #include "Drawer2D.h"
+#include "MapRenderer.h"
 
-static char msgs[12][STRING_SIZE];
+static char msgs[13][STRING_SIZE];
 cc_string Chat_Status[4]       = { String_FromArray(msgs[0]), String_FromArray(msgs[1]), String_FromArray(msgs[2]), String_FromArray(msgs[3]) };
 cc_string Chat_BottomRight[3]  = { String_FromArray(msgs[4]), String_FromArray(msgs[5]), String_FromArray(msgs[6]) };
-cc_string Chat_ClientStatus[2] = { String_FromArray(msgs[7]), String_FromArray(msgs[8]) };
+cc_string Chat_ClientStatus[3] = { String_FromArray(msgs[7]), String_FromArray(msgs[8]), String_FromArray(msgs[9]) };
 
-cc_string Chat_Announcement = String_FromArray(msgs[9]);
-cc_string Chat_BigAnnouncement = String_FromArray(msgs[10]);
-cc_string Chat_SmallAnnouncement = String_FromArray(msgs[11]);
+cc_string Chat_Announcement = String_FromArray(msgs[10]);
+cc_string Chat_BigAnnouncement = String_FromArray(msgs[11]);
+cc_string Chat_SmallAnnouncement = String_FromArray(msgs[12]);
 
 double Chat_AnnouncementReceived;
 double Chat_BigAnnouncementReceived;
@@ -228,7 +229,7 @@ void Chat_AddOf(const cc_string* text, int msgType) {
 	} else if (msgType == MSG_TYPE_SMALLANNOUNCEMENT) {
 		String_Copy(&Chat_SmallAnnouncement, text);
 		Chat_SmallAnnouncementReceived = Game.Time;
-	} else if (msgType >= MSG_TYPE_CLIENTSTATUS_1 && msgType <= MSG_TYPE_CLIENTSTATUS_2) {
+	} else if (msgType >= MSG_TYPE_CLIENTSTATUS_1 && msgType <= MSG_TYPE_CLIENTSTATUS_3) {
 		String_Copy(&Chat_ClientStatus[msgType - MSG_TYPE_CLIENTSTATUS_1], text);
 	}
 
@@ -388,6 +389,26 @@ static struct ChatCommand GpuInfoCommand = {
 	}
 };
 
+static void ChunkMemCommand_Execute(const cc_string* args, int argsCount) {
+	char buffer[7 * STRING_SIZE];
+	cc_string str, line;
+	String_InitArray(str, buffer);
+	MapRenderer_GetArenaInfo(&str);
+	
+	while (str.length) {
+		String_UNSAFE_SplitBy(&str, '\n', &line);
+		if (line.length) Chat_Add1("&a%s", &line);
+	}
+}
+
+static struct ChatCommand ChunkMemCommand = {
+	"ChunkMem", ChunkMemCommand_Execute, false,
+	{
+		"&a/client chunkmem",
+		"&eDisplays how much GPU memory the meshes of chunks are using.",
+	}
+};
+
 static void RenderTypeCommand_Execute(const cc_string* args, int argsCount) {
 	int flags;
 	if (!argsCount) {
@@ -502,10 +523,27 @@ static cc_bool CuboidCommand_ParseArgs(const cc_string* args, int argsCount) {
 	return true;
 }
 
+/* Number of blocks changed at once using Game_UpdateBlocks */
+#define CUBOID_BATCH 256
+
+/* Changes the given blocks to the new blocks, then informs the server of the changes */
+static void CuboidCommand_ChangeBlocks(const int* indices, const BlockID* oldBlocks, const BlockID* newBlocks, int count) {
+	int i, x, y, z;
+	Game_UpdateBlocks(indices, newBlocks, count);
+
+	for (i = 0; i < count; i++) {
+		World_Unpack(indices[i], x, y, z);
+		Server.SendBlock(x, y, z, oldBlocks[i], newBlocks[i]);
+	}
+}
+
 static void CuboidCommand_DoCuboid(void) {
+	int indices[CUBOID_BATCH];
+	BlockID oldBlocks[CUBOID_BATCH];
+	BlockID newBlocks[CUBOID_BATCH];
 	IVec3 min, max;
 	BlockID toPlace;
-	int x, y, z;
+	int x, y, z, count = 0;
 
 	IVec3_Min(&min, &cuboid_mark1, &cuboid_mark2);
 	IVec3_Max(&max, &cuboid_mark1, &cuboid_mark2);
@@ -518,10 +556,17 @@ static void CuboidCommand_DoCuboid(void) {
 	for (y = min.Y; y <= max.Y; y++) {
 		for (z = min.Z; z <= max.Z; z++) {
 			for (x = min.X; x <= max.X; x++) {
-				Game_ChangeBlock(x, y, z, toPlace);
+				indices[count]   = World_Pack(x, y, z);
+				oldBlocks[count] = World_GetBlock(x, y, z);
+				newBlocks[count] = toPlace;
+				if (++count < CUBOID_BATCH) continue;
+
+				CuboidCommand_ChangeBlocks(indices, oldBlocks, newBlocks, count);
+				count = 0;
 			}
 		}
 	}
+	if (count) CuboidCommand_ChangeBlocks(indices, oldBlocks, newBlocks, count);
 }
 
 static void CuboidCommand_BlockChanged(void* obj, IVec3 coords, BlockID old, BlockID now) {
@@ -625,6 +670,7 @@ void Chat_Send(const cc_string* text, cc_bool logUsage) {
 
 static void OnInit(void) {
 	Commands_Register(&GpuInfoCommand);
+	Commands_Register(&ChunkMemCommand);
 	Commands_Register(&HelpCommand);
 	Commands_Register(&RenderTypeCommand);
 	Commands_Register(&ResolutionCommand);
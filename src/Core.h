@@ -249,6 +249,21 @@ Thus it is **NOT SAFE** to allocate a string on the stack. */
 #endif
 #endif
 
+/* Headless builds have no actual window or graphics context (e.g. for benchmarking) */
+#ifdef CC_BUILD_HEADLESS
+#undef CC_BUILD_GL
+#undef CC_BUILD_GLMODERN
+#undef CC_BUILD_GLES
+#undef CC_BUILD_EGL
+#undef CC_BUILD_D3D9
+#undef CC_BUILD_D3D11
+#undef CC_BUILD_X11
+#undef CC_BUILD_WINGUI
+#undef CC_BUILD_CARBON
+#undef CC_BUILD_COCOA
+#undef CC_BUILD_SDL
+#endif
+
 #if defined CC_BUILD_D3D9 || defined CC_BUILD_D3D11
 typedef void* GfxResourceID;
 #else
@@ -6,6 +6,8 @@
 #include "Stream.h"
 #include "Errors.h"
 #include "Utils.h"
+#include "Bitmap.h"
+#include "ExtMath.h"
 
 #define Header_ReadU8(value) if ((res = s->ReadU8(s, &value))) return res;
 /*########################################################################################################################*
@@ -142,17 +144,15 @@ enum INFLATE_STATE_ {
 };
 
 /* Insert next byte into the bit buffer */
-#define Inflate_GetByte(state) state->AvailIn--; state->Bits |= (cc_uint32)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
+#define Inflate_GetByte(state) state->AvailIn--; state->Bits |= (cc_uint64)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
 /* Retrieves bits from the bit buffer */
-#define Inflate_PeekBits(state, bits) (state->Bits & ((1UL << (bits)) - 1UL))
+#define Inflate_PeekBits(state, bits) (cc_uint32)(state->Bits & ((1UL << (bits)) - 1UL))
 /* Consumes/eats up bits from the bit buffer */
 #define Inflate_ConsumeBits(state, bits) state->Bits >>= (bits); state->NumBits -= (bits);
 /* Aligns bit buffer to be on a byte boundary */
 #define Inflate_AlignBits(state) cc_uint32 alignSkip = state->NumBits & 7; Inflate_ConsumeBits(state, alignSkip);
 /* Ensures there are 'bitsCount' bits, or returns if not */
 #define Inflate_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { if (!state->AvailIn) return; Inflate_GetByte(state); }
-/* Ensures there are 'bitsCount' bits */
-#define Inflate_UNSAFE_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { Inflate_GetByte(state); }
 /* Peeks then consumes given bits */
 #define Inflate_ReadBits(state, bitsCount) Inflate_PeekBits(state, bitsCount); Inflate_ConsumeBits(state, bitsCount);
 /* Sets to given result and sets state to DONE */
@@ -162,10 +162,25 @@ enum INFLATE_STATE_ {
 #define Inflate_NextBlockState(state) (state->LastBlock ? INFLATE_STATE_DONE : INFLATE_STATE_HEADER)
 /* Goes to the next state, after having finished reading a compressed entry */
 #define Inflate_NextCompressState(state) ((state->AvailIn >= INFLATE_FASTINF_IN && state->AvailOut >= INFLATE_FASTINF_OUT) ? INFLATE_STATE_FASTCOMPRESSED : INFLATE_STATE_COMPRESSED_LIT)
-/* The maximum amount of bytes that can be output is 258 */
-#define INFLATE_FASTINF_OUT 258
-/* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Add 3 extra bytes to account for putting data into the bit buffer. */
-#define INFLATE_FASTINF_IN 10
+/* The maximum amount of bytes that can be output is a literal followed by 258 bytes of a length/distance pair */
+#define INFLATE_FASTINF_OUT 259
+/* The bit buffer is refilled at most twice, with each refill reading 8 bytes but consuming at most 7 of them */
+#define INFLATE_FASTINF_IN 16
+
+/* Each entry in a huffman lookup table is packed as: */
+/*   bits 0-7   - number of bits in the codeword, or number of bits used to index the second level table */
+/*   bits 8-11  - number of extra bits that follow the codeword (for lengths and distances) */
+/*   bits 12-15 - flags for the type of entry */
+/*   bits 16-31 - literal value, base length/distance, code lengths symbol, or offset of the second level table */
+#define HUFF_ENTRY_LITERAL  0x1000
+#define HUFF_ENTRY_ENDBLOCK 0x2000
+#define HUFF_ENTRY_SUBTABLE 0x4000
+#define HUFF_ENTRY_INVALID  0x8000
+#define Huffman_EntryBits(entry)  ((entry) & 0xFF)
+#define Huffman_EntryExtra(entry) (((entry) >> 8) & 0x0F)
+#define Huffman_EntryValue(entry) ((entry) >> 16)
+
+enum HUFF_TABLE_ { HUFF_TABLE_CODELENS, HUFF_TABLE_LITS, HUFF_TABLE_DISTS };
 
 static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 	n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
@@ -175,165 +190,170 @@ static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 	return n >> (16 - bits);
 }
 
-/* Builds a huffman tree, based on input lengths of each codeword */
-static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLens, int count) {
+static const cc_uint16 len_base[31] = { 
+	3,4,5,6,7,8,9,10,11,13,
+	15,17,19,23,27,31,35,43,51,59,
+	67,83,99,115,131,163,195,227,258,0,0 
+};
+static const cc_uint8 len_bits[31] = { 
+	0,0,0,0,0,0,0,0,1,1,
+	1,1,2,2,2,2,3,3,3,3,
+	4,4,4,4,5,5,5,5,0,0,0 
+};
+static const cc_uint16 dist_base[32] = {
+	1,2,3,4,5,7,9,13,17,25,
+	33,49,65,97,129,193,257,385,513,769,
+	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0 
+};
+static const cc_uint8 dist_bits[32] = {
+	0,0,0,0,1,1,2,2,3,3,
+	4,4,5,5,6,6,7,7,8,8,
+	9,9,10,10,11,11,12,12,13,13,0,0 
+};
+
+/* Returns the table entry (without codeword length) for the given value of a huffman table */
+/* Lengths and distances store the base value and number of extra bits, so they can be decoded in one go */
+static cc_uint32 Huffman_MakeEntry(int type, int value) {
+	if (type == HUFF_TABLE_LITS) {
+		if (value <  256) return (value << 16) | HUFF_ENTRY_LITERAL;
+		if (value == 256) return HUFF_ENTRY_ENDBLOCK;
+
+		value -= 257;
+		if (value >= 29) return HUFF_ENTRY_INVALID;
+		return ((cc_uint32)len_base[value] << 16) | (len_bits[value] << 8);
+	} else if (type == HUFF_TABLE_DISTS) {
+		if (value >= 30) return HUFF_ENTRY_INVALID;
+		return ((cc_uint32)dist_base[value] << 16) | (dist_bits[value] << 8);
+	}
+	return value << 16;
+}
+
+/* Builds a two level huffman lookup table, based on input lengths of each codeword */
+/* Codewords of up to 'tableBits' bits are decoded with a single lookup in the main table, */
+/*  while longer codewords are decoded using a second lookup in a second level table. */
+static cc_result Huffman_Build(cc_uint32* table, int type, int tableBits, int maxEntries, const cc_uint8* bitLens, int count) {
 	int bl_count[INFLATE_MAX_BITS], bl_offsets[INFLATE_MAX_BITS];
-	int code, offset, value;
+	cc_uint16 sorted[INFLATE_MAX_LITS];
+	int len, maxLen, left, code, value;
+	int tableSize, subBits, subSize, next, prefix, curPrefix;
+	cc_uint32 entry, rev;
 	int i, j;
 
-	/* Initialise 'zero bit length' codewords */
-	table->FirstCodewords[0] = 0;
-	table->FirstOffsets[0]   = 0;
-	table->EndCodewords[0]   = 0;
-
 	/* Count number of codewords assigned to each bit length */
 	for (i = 0; i < INFLATE_MAX_BITS; i++) bl_count[i] = 0;
 	for (i = 0; i < count; i++) {
 		bl_count[bitLens[i]]++;
 	}
-
-	/* Ensure huffman tree actually makes sense */
 	bl_count[0] = 0;
+
+	maxLen = 0;
+	for (i = 1; i < INFLATE_MAX_BITS; i++) {
+		if (bl_count[i]) maxLen = i;
+	}
+
+	/* Ensure huffman tree actually makes sense (i.e. isn't over-subscribed or incomplete) */
+	/* Like zlib, an incomplete tree is only allowed for a tree of one bit codewords */
+	/*  (e.g. when a dynamic block only uses one distance code) */
+	left = 1;
 	for (i = 1; i < INFLATE_MAX_BITS; i++) {
-		/* Check if too many huffman codes for bit length */
-		if (bl_count[i] > (1 << i)) return INF_ERR_NUM_CODES;
+		left = (left << 1) - bl_count[i];
+		if (left < 0) return INF_ERR_NUM_CODES;
+	}
+	if (left > 0 && maxLen > 1) return INF_ERR_NUM_CODES;
+
+	/* Sort values by codeword length, so codewords can be assigned in order */
+	bl_offsets[1] = 0;
+	for (i = 1; i < INFLATE_MAX_BITS - 1; i++) {
+		bl_offsets[i + 1] = bl_offsets[i] + bl_count[i];
+	}
+	for (i = 0; i < count; i++) {
+		if (bitLens[i]) sorted[bl_offsets[bitLens[i]]++] = i;
 	}
 
+	tableSize = 1 << tableBits;
+	for (i = 0; i < tableSize; i++) table[i] = HUFF_ENTRY_INVALID;
+	next = tableSize; curPrefix = -1;
+	subBits = 0; subSize = 0;
+
 	/* Compute the codewords for the huffman tree.
 	*  Codewords are ordered, so consider this example tree:
 	*     2 of length 2, 3 of length 3, 1 of length 4
 	*  Codewords produced would be: 00,01 100,101,110, 1110 
+	*  As huffman codes are read backwards, the bit reversed codeword is used to index the tables,
+	*   with the entry then repeated for every index that ends with the reversed codeword
 	*/
-	code = 0; offset = 0;
-	for (i = 1; i < INFLATE_MAX_BITS; i++) {
-		code = (code + bl_count[i - 1]) << 1;
-		bl_offsets[i] = offset;
-
-		table->FirstCodewords[i] = code;
-		table->FirstOffsets[i]   = offset;
-		offset += bl_count[i];
-
-		/* Last codeword is actually: code + (bl_count[i] - 1)
-		*  However, when decoding we peform < against this value though, so need to add 1 here.
-		*  This way, don't need to special case bit lengths with 0 codewords when decoding.
-		*/
-		if (bl_count[i]) {
-			table->EndCodewords[i] = code + bl_count[i];
-		} else {
-			table->EndCodewords[i] = 0;
-		}
-	}
+	code = 0; value = 0;
+	for (len = 1; len <= maxLen; len++, code <<= 1) {
+		for (; bl_count[len]; bl_count[len]--, code++, value++) {
+			entry = Huffman_MakeEntry(type, sorted[value]);
+			rev   = Huffman_ReverseBits(code, len);
+
+			if (len <= tableBits) {
+				for (i = rev; i < tableSize; i += 1 << len) {
+					table[i] = entry | len;
+				}
+				continue;
+			}
 
-	/* Assigns values to each codeword.
-	*  Note that although codewords are ordered, values may not be.
-	*  Some values may also not be assigned to any codeword.
-	*/
-	value = 0;
-	Mem_Set(table->Fast, UInt8_MaxValue, sizeof(table->Fast));
-	for (i = 0; i < count; i++, value++) {
-		int len = bitLens[i];
-		if (!len) continue;
-		table->Values[bl_offsets[len]] = value;
-
-		/* Compute the accelerated lookup table values for this codeword.
-		* For example, assume len = 4 and codeword = 0100
-		* - Shift it left to be 0100_00000
-		* - Then, for all the indices from 0100_00000 to 0100_11111,
-		*   - bit reverse index, as huffman codes are read backwards
-		*   - set fast value to specify a 'value' value, and to skip 'len' bits
-		*/
-		if (len <= INFLATE_FAST_BITS) {
-			cc_int16 packed = (cc_int16)((len << INFLATE_FAST_BITS) | value);
-			int codeword = table->FirstCodewords[len] + (bl_offsets[len] - table->FirstOffsets[len]);
-			codeword <<= (INFLATE_FAST_BITS - len);
-
-			for (j = 0; j < 1 << (INFLATE_FAST_BITS - len); j++, codeword++) {
-				int index = Huffman_ReverseBits(codeword, INFLATE_FAST_BITS);
-				table->Fast[index] = packed;
+			/* Codewords sharing the same first 'tableBits' bits are consecutive, */
+			/*  so the second level table only needs to be created at the first codeword */
+			prefix = rev & (tableSize - 1);
+			if (prefix != curPrefix) {
+				/* Make the table just big enough for all the codewords with this prefix */
+				subBits = len - tableBits;
+				left    = 1 << subBits;
+				for (j = len + 1; j <= maxLen; j++) {
+					left -= bl_count[j - 1];
+					if (left <= 0) break;
+					subBits++; left <<= 1;
+				}
+
+				subSize = 1 << subBits;
+				if (next + subSize > maxEntries) return INF_ERR_NUM_CODES;
+				for (i = 0; i < subSize; i++) table[next + i] = HUFF_ENTRY_INVALID;
+
+				table[prefix] = (next << 16) | HUFF_ENTRY_SUBTABLE | subBits;
+				curPrefix     = prefix;
+				next += subSize;
+			}
+
+			j = Huffman_EntryValue(table[prefix]);
+			for (i = rev >> tableBits; i < subSize; i += 1 << (len - tableBits)) {
+				table[j + i] = entry | (len - tableBits);
 			}
 		}
-		bl_offsets[len]++;
 	}
 	return 0;
 }
 
 /* Attempts to read the next huffman encoded value from the bitstream, using given table */
-/* Returns -1 if there are insufficient bits to read the value */
-static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table) {
-	cc_uint32 i, j, codeword;
-	int packed, bits, offset;
+/* Returns -1 if there are insufficient bits to read the value, otherwise the table entry */
+static int Huffman_Decode(struct InflateState* state, const cc_uint32* table, int tableBits) {
+	cc_uint32 entry, bits;
 
 	/* Buffer as many bits as possible */
-	while (state->NumBits <= INFLATE_MAX_BITS) {
+	while (state->NumBits <= 56) {
 		if (!state->AvailIn) break;
 		Inflate_GetByte(state);
 	}
 
-	/* Try fast accelerated table lookup */
-	if (state->NumBits >= INFLATE_FAST_BITS) {
-		packed = table->Fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];
-		if (packed >= 0) {
-			bits = packed >> INFLATE_FAST_BITS;
-			Inflate_ConsumeBits(state, bits);
-			return packed & 0x1FF;
-		}
-	}
-
-	/* Slow, bit by bit lookup */
-	codeword = 0;
-	for (i = 1, j = 0; i < INFLATE_MAX_BITS; i++, j++) {
-		if (state->NumBits < i) return -1;
-		codeword = (codeword << 1) | ((state->Bits >> j) & 1);
-
-		if (codeword < table->EndCodewords[i]) {
-			offset = table->FirstOffsets[i] + (codeword - table->FirstCodewords[i]);
-			Inflate_ConsumeBits(state, i);
-			return table->Values[offset];
-		}
+	entry = table[Inflate_PeekBits(state, tableBits)];
+	bits  = Huffman_EntryBits(entry);
+	if (entry & HUFF_ENTRY_SUBTABLE) {
+		entry = table[Huffman_EntryValue(entry) + (cc_uint32)((state->Bits >> tableBits) & ((1UL << bits) - 1UL))];
+		bits  = tableBits + Huffman_EntryBits(entry);
 	}
+	if (bits > state->NumBits) return -1;
 
-	Inflate_Fail(state, INF_ERR_INVALID_CODE);
-	return -1;
-}
-
-/* Inline the common <= 9 bits case */
-#define Huffman_UNSAFE_Decode(state, table, result) \
-{\
-	Inflate_UNSAFE_EnsureBits(state, INFLATE_MAX_BITS);\
-	packed = table.Fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];\
-	if (packed >= 0) {\
-		consumedBits = packed >> INFLATE_FAST_BITS;\
-		Inflate_ConsumeBits(state, consumedBits);\
-		result = packed & 0x1FF;\
-	} else {\
-		result = Huffman_UNSAFE_Decode_Slow(state, &table);\
-	}\
-}
-
-static int Huffman_UNSAFE_Decode_Slow(struct InflateState* state, struct HuffmanTable* table) {
-	cc_uint32 i, j, codeword;
-	int offset;
-
-	/* Slow, bit by bit lookup. Need to reverse order for huffman. */
-	codeword = Inflate_PeekBits(state,       INFLATE_FAST_BITS);
-	codeword = Huffman_ReverseBits(codeword, INFLATE_FAST_BITS);
-
-	for (i = INFLATE_FAST_BITS + 1, j = INFLATE_FAST_BITS; i < INFLATE_MAX_BITS; i++, j++) {
-		codeword = (codeword << 1) | ((state->Bits >> j) & 1);
-
-		if (codeword < table->EndCodewords[i]) {
-			offset = table->FirstOffsets[i] + (codeword - table->FirstCodewords[i]);
-			Inflate_ConsumeBits(state, i);
-			return table->Values[offset];
-		}
+	if (entry & HUFF_ENTRY_INVALID) {
+		/* Missing bits of the codeword might have been looked up as 0 */
+		if (state->NumBits < INFLATE_MAX_BITS - 1) return -1;
+		Inflate_Fail(state, INF_ERR_INVALID_CODE);
+		return -1;
 	}
 
-	Inflate_Fail(state, INF_ERR_INVALID_CODE);
-	/* Need to exit the fast decode loop */
-	/* TODO: This means a few garbage bytes can get written */
-	/* to the output, but it probably doesn't matter */
-	state->AvailIn = 0;
-	return 0;
+	Inflate_ConsumeBits(state, bits);
+	return (int)entry;
 }
 
 void Inflate_Init2(struct InflateState* state, struct Stream* source) {
@@ -365,91 +385,147 @@ static const cc_uint8 fixed_dists[INFLATE_MAX_DISTS] = {
 	5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5, 5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5
 };
 
-static const cc_uint16 len_base[31] = { 
-	3,4,5,6,7,8,9,10,11,13,
-	15,17,19,23,27,31,35,43,51,59,
-	67,83,99,115,131,163,195,227,258,0,0 
-};
-static const cc_uint8 len_bits[31] = { 
-	0,0,0,0,0,0,0,0,1,1,
-	1,1,2,2,2,2,3,3,3,3,
-	4,4,4,4,5,5,5,5,0,0,0 
-};
-static const cc_uint16 dist_base[32] = {
-	1,2,3,4,5,7,9,13,17,25,
-	33,49,65,97,129,193,257,385,513,769,
-	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0 
-};
-static const cc_uint8 dist_bits[32] = {
-	0,0,0,0,1,1,2,2,3,3,
-	4,4,5,5,6,6,7,7,8,8,
-	9,9,10,10,11,11,12,12,13,13,0,0 
-};
 static const cc_uint8 codelens_order[INFLATE_MAX_CODELENS] = {
 	16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 
 };
 
+/* Reads 8 bytes as a little endian 64 bit integer */
+/* NOTE: Compilers usually turn this into a single load on little endian CPUs */
+#define Inflate_ReadU64_LE(p) \
+	(((cc_uint64)(p)[0])       | ((cc_uint64)(p)[1] <<  8) | ((cc_uint64)(p)[2] << 16) | ((cc_uint64)(p)[3] << 24) |\
+	 ((cc_uint64)(p)[4] << 32) | ((cc_uint64)(p)[5] << 40) | ((cc_uint64)(p)[6] << 48) | ((cc_uint64)(p)[7] << 56))
+
+/* Refills the bit buffer to have at least 56 bits, by reading 8 bytes at once */
+/* Bits from the one partially read byte are left above 'numBits', but that doesn't matter */
+/*  because those bits just get ORed in again when that byte is read by the next refill */
+#define Inflate_FastRefill() \
+	bits |= Inflate_ReadU64_LE(in) << numBits;\
+	in   += (63 - numBits) >> 3;\
+	numBits |= 56;
+
+/* Decodes the next huffman code and any extra bits of the code in one go */
+/* NOTE: Requires at least 15 + 13 bits in the bit buffer */
+#define Inflate_FastDecode(table, tableBits) \
+	entry = table[(cc_uint32)bits & ((1 << tableBits) - 1)];\
+	if (entry & HUFF_ENTRY_SUBTABLE) {\
+		bits >>= tableBits; numBits -= tableBits;\
+		entry = table[Huffman_EntryValue(entry) + ((cc_uint32)bits & ((1 << Huffman_EntryBits(entry)) - 1))];\
+	}\
+	n     = Huffman_EntryBits(entry);\
+	extra = Huffman_EntryExtra(entry);\
+	value = Huffman_EntryValue(entry) + ((cc_uint32)(bits >> n) & ((1 << extra) - 1));\
+	bits >>= n + extra; numBits -= n + extra;
+
 static void Inflate_InflateFast(struct InflateState* s) {
+	/* bit buffer variables */
+	/* NOTE: Kept in local variables, as otherwise the compiler has to assume */
+	/*  that writing to the window might change the contents of the state */
+	cc_uint64 bits;
+	cc_uint32 numBits;
+	const cc_uint8* in;
+	const cc_uint8* inEnd;
+
 	/* huffman variables */
-	cc_uint32 lit, len, dist;
-	cc_uint32 bits, lenIdx, distIdx;
-	int packed, consumedBits;
+	const cc_uint32* lits;
+	const cc_uint32* dists;
+	cc_uint32 entry, value, n, extra;
+	cc_uint32 len, dist;
 
 	/* window variables */
 	cc_uint8* window;
-	cc_uint32 i, curIdx, startIdx;
+	cc_uint8* src;
+	cc_uint8* dst;
+	cc_uint32 i, curIdx, startIdx, availOut;
 	cc_uint32 copyStart, copyLen, partLen;
 
-	window = s->Window;
-	curIdx = s->WindowIndex;
+	bits    = s->Bits;
+	numBits = s->NumBits;
+	in      = s->NextIn;
+	inEnd   = s->NextIn + s->AvailIn;
+	lits    = s->Table.Lits;
+	dists   = s->TableDists;
+
+	window   = s->Window;
+	curIdx   = s->WindowIndex;
+	availOut = s->AvailOut;
 	copyStart = s->WindowIndex;
 	copyLen   = 0;
 
 #define INFLATE_FAST_COPY_MAX (INFLATE_WINDOW_SIZE - INFLATE_FASTINF_OUT)
-	while (s->AvailOut >= INFLATE_FASTINF_OUT && s->AvailIn >= INFLATE_FASTINF_IN && copyLen < INFLATE_FAST_COPY_MAX) {
-		Huffman_UNSAFE_Decode(s, s->Table.Lits, lit);
-
-		if (lit <= 256) {
-			if (lit < 256) {
-				window[curIdx] = (cc_uint8)lit;
-				s->AvailOut--; copyLen++;
+	while (availOut >= INFLATE_FASTINF_OUT && (cc_uint32)(inEnd - in) >= INFLATE_FASTINF_IN && copyLen < INFLATE_FAST_COPY_MAX) {
+		Inflate_FastRefill();
+		Inflate_FastDecode(lits, INFLATE_LITS_BITS);
+
+		if (entry & HUFF_ENTRY_LITERAL) {
+			window[curIdx] = (cc_uint8)value;
+			availOut--; copyLen++;
+			curIdx = (curIdx + 1) & INFLATE_WINDOW_MASK;
+
+			/* At least 41 bits are still buffered, which is plenty for another literal/length */
+			Inflate_FastDecode(lits, INFLATE_LITS_BITS);
+			if (entry & HUFF_ENTRY_LITERAL) {
+				window[curIdx] = (cc_uint8)value;
+				availOut--; copyLen++;
 				curIdx = (curIdx + 1) & INFLATE_WINDOW_MASK;
+				continue;
+			}
+		}
+
+		if (entry & (HUFF_ENTRY_ENDBLOCK | HUFF_ENTRY_INVALID)) {
+			if (entry & HUFF_ENTRY_INVALID) {
+				Inflate_Fail(s, INF_ERR_INVALID_CODE);
 			} else {
 				s->State = Inflate_NextBlockState(s);
-				break;
 			}
-		} else {
-			lenIdx = lit - 257;
-			bits = len_bits[lenIdx];
-			Inflate_UNSAFE_EnsureBits(s, bits);
-			len  = len_base[lenIdx] + Inflate_ReadBits(s, bits);
-
-			Huffman_UNSAFE_Decode(s, s->TableDists, distIdx);
-			bits = dist_bits[distIdx];
-			Inflate_UNSAFE_EnsureBits(s, bits);
-			dist = dist_base[distIdx] + Inflate_ReadBits(s, bits);
-	
-			/* Window infinitely repeats like ...xyz|uvwxyz|uvwxyz|uvw... */
-			/* If start and end don't cross a boundary, can avoid masking index */
-			startIdx = (curIdx - dist) & INFLATE_WINDOW_MASK;
-			if (curIdx >= startIdx && (curIdx + len) < INFLATE_WINDOW_SIZE) {
-				cc_uint8* src = &window[startIdx]; 
-				cc_uint8* dst = &window[curIdx];
+			break;
+		}
+		len = value;
 
+		Inflate_FastRefill();
+		Inflate_FastDecode(dists, INFLATE_DISTS_BITS);
+		if (entry & HUFF_ENTRY_INVALID) {
+			Inflate_Fail(s, INF_ERR_INVALID_CODE); break;
+		}
+		dist = value;
+
+		/* Window infinitely repeats like ...xyz|uvwxyz|uvwxyz|uvw... */
+		/* If start and end don't cross a boundary, can avoid masking index */
+		startIdx = (curIdx - dist) & INFLATE_WINDOW_MASK;
+		if (curIdx >= startIdx && (curIdx + len) < INFLATE_WINDOW_SIZE) {
+			src = &window[startIdx]; 
+			dst = &window[curIdx];
+
+			if (dist == 1) {
+				/* Run of the same byte (very common in map data) */
+				Mem_Set(dst, *src, len);
+			} else if (dist >= 16 && len >= 16) {
+				/* Each part copied never overlaps itself, since it is at most 'dist' long */
+				for (i = 0; i < len; i += n) {
+					n = min(len - i, dist);
+					Mem_Copy(dst + i, src + i, n);
+				}
+			} else {
 				for (i = 0; i < (len & ~0x3); i += 4) {
 					*dst++ = *src++; *dst++ = *src++; *dst++ = *src++; *dst++ = *src++;
 				}
 				for (; i < len; i++) { *dst++ = *src++; }
-			} else {
-				for (i = 0; i < len; i++) {
-					window[(curIdx + i) & INFLATE_WINDOW_MASK] = window[(startIdx + i) & INFLATE_WINDOW_MASK];
-				}
 			}
-			curIdx = (curIdx + len) & INFLATE_WINDOW_MASK;
-			s->AvailOut -= len; copyLen += len;
+		} else {
+			for (i = 0; i < len; i++) {
+				window[(curIdx + i) & INFLATE_WINDOW_MASK] = window[(startIdx + i) & INFLATE_WINDOW_MASK];
+			}
 		}
+		curIdx = (curIdx + len) & INFLATE_WINDOW_MASK;
+		availOut -= len; copyLen += len;
 	}
 
+	/* Discard the bits from the partially read byte, since the slow path expects them to be 0 */
+	s->Bits     = bits & (((cc_uint64)1 << numBits) - 1);
+	s->NumBits  = numBits;
+	s->AvailIn -= (cc_uint32)(in - s->NextIn);
+	s->NextIn   = (cc_uint8*)in;
+	s->AvailOut = availOut;
+
 	s->WindowIndex = curIdx;
 	if (!copyLen) return;
 
@@ -471,9 +547,8 @@ void Inflate_Process(struct InflateState* s) {
 	cc_uint32 blockHeader;
 	cc_result res;
 
-	/* len/dist table variables */
-	cc_uint32 distIdx, lenIdx;
-	int lit;
+	/* huffman table variables */
+	int entry;
 	/* code lens table variables */
 	cc_uint32 count, repeatCount;
 	cc_uint8  repeatValue;
@@ -495,8 +570,10 @@ void Inflate_Process(struct InflateState* s) {
 			} break;
 
 			case 1: { /* Fixed/static huffman compressed */
-				(void)Huffman_Build(&s->Table.Lits, fixed_lits,  INFLATE_MAX_LITS);
-				(void)Huffman_Build(&s->TableDists, fixed_dists, INFLATE_MAX_DISTS);
+				(void)Huffman_Build(s->Table.Lits, HUFF_TABLE_LITS,   INFLATE_LITS_BITS,
+									INFLATE_LITS_ENTRIES,  fixed_lits,  INFLATE_MAX_LITS);
+				(void)Huffman_Build(s->TableDists, HUFF_TABLE_DISTS, INFLATE_DISTS_BITS,
+									INFLATE_DISTS_ENTRIES, fixed_dists, INFLATE_MAX_DISTS);
 				s->State = Inflate_NextCompressState(s);
 			} break;
 
@@ -579,16 +656,19 @@ void Inflate_Process(struct InflateState* s) {
 
 			s->Index = 0;
 			s->State = INFLATE_STATE_DYNAMIC_LITSDISTS;
-			res = Huffman_Build(&s->Table.CodeLens, s->Buffer, INFLATE_MAX_CODELENS);
+			res = Huffman_Build(s->Table.CodeLens, HUFF_TABLE_CODELENS, INFLATE_CODELENS_BITS,
+								INFLATE_CODELENS_ENTRIES, s->Buffer, INFLATE_MAX_CODELENS);
 			if (res) { Inflate_Fail(s, res); return; }
 		}
 
 		case INFLATE_STATE_DYNAMIC_LITSDISTS: {
 			count = s->NumLits + s->NumDists;
 			while (s->Index < count) {
-				int bits = Huffman_Decode(s, &s->Table.CodeLens);
+				int bits = Huffman_Decode(s, s->Table.CodeLens, INFLATE_CODELENS_BITS);
+				if (bits == -1) return;
+				bits = Huffman_EntryValue(bits);
+
 				if (bits < 16) {
-					if (bits == -1) return;
 					s->Buffer[s->Index] = (cc_uint8)bits;
 					s->Index++;
 				} else {
@@ -602,9 +682,11 @@ void Inflate_Process(struct InflateState* s) {
 				s->Index = 0;
 				s->State = Inflate_NextCompressState(s);
 
-				res = Huffman_Build(&s->Table.Lits, s->Buffer, s->NumLits);
+				res = Huffman_Build(s->Table.Lits, HUFF_TABLE_LITS,   INFLATE_LITS_BITS,
+									INFLATE_LITS_ENTRIES,  s->Buffer, s->NumLits);
 				if (res) { Inflate_Fail(s, res); return; }
-				res = Huffman_Build(&s->TableDists, s->Buffer + s->NumLits, s->NumDists);
+				res = Huffman_Build(s->TableDists, HUFF_TABLE_DISTS, INFLATE_DISTS_BITS,
+									INFLATE_DISTS_ENTRIES, s->Buffer + s->NumLits, s->NumDists);
 				if (res) { Inflate_Fail(s, res); return; }
 			}
 			break;
@@ -645,43 +727,42 @@ void Inflate_Process(struct InflateState* s) {
 
 		case INFLATE_STATE_COMPRESSED_LIT: {
 			if (!s->AvailOut) return;
-			lit = Huffman_Decode(s, &s->Table.Lits);
+			entry = Huffman_Decode(s, s->Table.Lits, INFLATE_LITS_BITS);
+			if (entry == -1) return;
 
-			if (lit < 256) {
-				if (lit == -1) return;
-				*s->Output = (cc_uint8)lit;
-				s->Window[s->WindowIndex] = (cc_uint8)lit;
+			if (entry & HUFF_ENTRY_LITERAL) {
+				*s->Output = (cc_uint8)Huffman_EntryValue(entry);
+				s->Window[s->WindowIndex] = *s->Output;
 				s->Output++; s->AvailOut--;
 				s->WindowIndex = (s->WindowIndex + 1) & INFLATE_WINDOW_MASK;
 				break;
-			} else if (lit == 256) {
+			} else if (entry & HUFF_ENTRY_ENDBLOCK) {
 				s->State = Inflate_NextBlockState(s);
 				break;
 			} else {
-				s->TmpLit = lit - 257;
+				s->TmpLit = entry;
 				s->State  = INFLATE_STATE_COMPRESSED_LITEXTRA;
 			}
 		}
 
 		case INFLATE_STATE_COMPRESSED_LITEXTRA: {
-			lenIdx = s->TmpLit;
-			bits   = len_bits[lenIdx];
+			bits = Huffman_EntryExtra(s->TmpLit);
 			Inflate_EnsureBits(s, bits);
-			s->TmpLit = len_base[lenIdx] + Inflate_ReadBits(s, bits);
+			s->TmpLit = Huffman_EntryValue(s->TmpLit) + Inflate_ReadBits(s, bits);
 			s->State  = INFLATE_STATE_COMPRESSED_DIST;
 		}
 
 		case INFLATE_STATE_COMPRESSED_DIST: {
-			s->TmpDist = Huffman_Decode(s, &s->TableDists);
-			if (s->TmpDist == -1) return;
-			s->State = INFLATE_STATE_COMPRESSED_DISTEXTRA;
+			entry = Huffman_Decode(s, s->TableDists, INFLATE_DISTS_BITS);
+			if (entry == -1) return;
+			s->TmpDist = entry;
+			s->State   = INFLATE_STATE_COMPRESSED_DISTEXTRA;
 		}
 
 		case INFLATE_STATE_COMPRESSED_DISTEXTRA: {
-			distIdx = s->TmpDist;
-			bits    = dist_bits[distIdx];
+			bits = Huffman_EntryExtra(s->TmpDist);
 			Inflate_EnsureBits(s, bits);
-			s->TmpDist = dist_base[distIdx] + Inflate_ReadBits(s, bits);
+			s->TmpDist = Huffman_EntryValue(s->TmpDist) + Inflate_ReadBits(s, bits);
 			s->State   = INFLATE_STATE_COMPRESSED_DATA;
 		}
 
@@ -768,28 +849,145 @@ void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, stru
 	stream->Read = Inflate_StreamRead;
 }
 
+/* Number of times each file is decompressed when benchmarking */
+#define INFLATE_BENCHMARK_RUNS 10
+#define INFLATE_BENCHMARK_BUFFER (256 * 1024)
+
+static cc_result Inflate_BenchmarkLoad(const cc_string* path, cc_uint8** data, cc_uint32* len) {
+	struct Stream stream;
+	cc_result res;
+
+	if ((res = Stream_OpenFile(&stream, path))) return res;
+	if (!(res = stream.Length(&stream, len))) {
+		*data = (cc_uint8*)Mem_Alloc(*len + 1, 1, "inflate benchmark data");
+		res   = Stream_Read(&stream, *data, *len);
+	}
+	(void)stream.Close(&stream);
+	return res;
+}
+
+/* Replaces the contents of a PNG file with just the ZLIB compressed data in its IDAT chunks */
+static void Inflate_BenchmarkPng(cc_uint8* data, cc_uint32* len) {
+	cc_uint32 src = 8, dst = 0, size;
+	cc_uint8* tmp = (cc_uint8*)Mem_Alloc(*len, 1, "PNG data");
+
+	for (; src + 12 <= *len; src += size + 12) {
+		size = Stream_GetU32_BE(data + src);
+		if (size > *len - src - 12) break;
+
+		if (Mem_Equal(data + src + 4, "IDAT", 4)) {
+			Mem_Copy(tmp + dst, data + src + 8, size);
+			dst += size;
+		}
+	}
+
+	Mem_Copy(data, tmp, dst);
+	Mem_Free(tmp);
+	*len = dst;
+}
+
+/* Skips the GZIP or ZLIB header, then sets up a stream for decompressing the data */
+static cc_result Inflate_BenchmarkOpen(cc_uint8* data, cc_uint32 len, cc_bool gzip, struct InflateState* state,
+									struct Stream* mem, struct Stream* inflate) {
+	struct GZipHeader gzHeader;
+	struct ZLibHeader zlHeader;
+	cc_result res;
+
+	Stream_ReadonlyMemory(mem, data, len);
+	if (gzip) {
+		GZipHeader_Init(&gzHeader);
+		while (!gzHeader.done) {
+			if ((res = GZipHeader_Read(mem, &gzHeader))) return res;
+		}
+	} else {
+		ZLibHeader_Init(&zlHeader);
+		while (!zlHeader.done) {
+			if ((res = ZLibHeader_Read(mem, &zlHeader))) return res;
+		}
+	}
+
+	Inflate_MakeStream2(inflate, state, mem);
+	return 0;
+}
+
+/* Decompresses all the data, also computing the CRC32 of the decompressed data if 'crc' is non-NULL */
+static cc_result Inflate_BenchmarkRun(cc_uint8* data, cc_uint32 len, cc_bool gzip, struct InflateState* state, 
+									cc_uint8* buffer, cc_uint32* size, cc_uint32* crc) {
+	struct Stream mem, inflate;
+	cc_uint32 read;
+	cc_result res;
+
+	if ((res = Inflate_BenchmarkOpen(data, len, gzip, state, &mem, &inflate))) return res;
+	*size = 0;
+	if (crc) *crc = 0xFFFFFFFFUL;
+
+	for (;;) {
+		res = inflate.Read(&inflate, buffer, INFLATE_BENCHMARK_BUFFER, &read);
+		if (res) return res;
+		if (!read) break;
+
+		*size += read;
+		if (crc) *crc = Utils_Crc32Update(*crc, buffer, read);
+	}
+
+	if (crc) *crc ^= 0xFFFFFFFFUL;
+	return 0;
+}
+
+void Inflate_Benchmark(const cc_string* paths, int count) {
+	struct InflateState* state;
+	cc_uint8* buffer;
+	cc_uint8* data;
+	cc_uint32 len, size, crc;
+	cc_uint64 beg, elapsed;
+	cc_bool gzip;
+	float ms;
+	int i, j, rate;
+	cc_result res;
+
+	state  = (struct InflateState*)Mem_Alloc(1, sizeof(struct InflateState), "inflate state");
+	buffer = (cc_uint8*)Mem_Alloc(INFLATE_BENCHMARK_BUFFER, 1, "inflate output");
+
+	for (i = 0; i < count; i++) {
+		data = NULL;
+		res  = Inflate_BenchmarkLoad(&paths[i], &data, &len);
+		if (res) { Logger_SysWarn2(res, "loading", &paths[i]); Mem_Free(data); continue; }
+
+		/* .cw and .lvl maps are GZIP compressed, PNG images are ZLIB compressed */
+		gzip = len >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+		if (Png_Detect(data, len)) Inflate_BenchmarkPng(data, &len);
+
+		/* First run also checks the data is valid, and computes CRC32 to compare output with */
+		res = Inflate_BenchmarkRun(data, len, gzip, state, buffer, &size, &crc);
+		if (res) { Logger_SysWarn2(res, "decompressing", &paths[i]); Mem_Free(data); continue; }
+
+		beg = Stopwatch_Measure();
+		for (j = 0; j < INFLATE_BENCHMARK_RUNS; j++) {
+			Inflate_BenchmarkRun(data, len, gzip, state, buffer, &size, NULL);
+		}
+		elapsed = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+
+		ms   = elapsed / (1000.0f * INFLATE_BENCHMARK_RUNS);
+		rate = (int)((double)size * INFLATE_BENCHMARK_RUNS / (elapsed ? elapsed : 1));
+		Platform_Log4("Decompressing %s: %i bytes to %i bytes, CRC32 %h", &paths[i], &len, &size, &crc);
+		Platform_Log2("  %f3 ms per run, %i MB/sec", &ms, &rate);
+		Mem_Free(data);
+	}
+
+	Mem_Free(buffer);
+	Mem_Free(state);
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Deflate (compress)----------------------------------------------------*
 *#########################################################################################################################*/
-/* these are copies of len_base and dist_base, with UINT16_MAX instead of 0 for sentinel cutoff */
-static const cc_uint16 deflate_len[30] = {
-	3,4,5,6,7,8,9,10,11,13,
-	15,17,19,23,27,31,35,43,51,59,
-	67,83,99,115,131,163,195,227,258,UInt16_MaxValue
-};
-static const cc_uint16 deflate_dist[31] = {
-	1,2,3,4,5,7,9,13,17,25,
-	33,49,65,97,129,193,257,385,513,769,
-	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,UInt16_MaxValue
-};
-
 /* Pushes given bits, but does not write them */
 #define Deflate_PushBits(state, value, bits) state->Bits |= (value) << state->NumBits; state->NumBits += (bits);
 /* Pushes bits of the huffman codeword bits for the given literal, but does not write them */
 #define Deflate_PushLit(state, value) Deflate_PushBits(state, state->LitsCodewords[value], state->LitsLens[value])
-/* Pushes given bits (reversing for huffman code), but does not write them */
-#define Deflate_PushHuff(state, value, bits) Deflate_PushBits(state, Huffman_ReverseBits(value, bits), bits)
+/* Pushes bits of the huffman codeword bits for the given distance code, but does not write them */
+#define Deflate_PushDist(state, value) Deflate_PushBits(state, state->DistsCodewords[value], state->DistsLens[value])
 /* Writes given byte to output */
 #define Deflate_WriteByte(state) *state->NextOut++ = state->Bits; state->AvailOut--; state->Bits >>= 8; state->NumBits -= 8;
 /* Flushes bits in buffer to output buffer */
@@ -797,186 +995,600 @@ static const cc_uint16 deflate_dist[31] = {
 
 #define MIN_MATCH_LEN 3
 #define MAX_MATCH_LEN 258
+/* Maximum number of codes in a dynamic huffman block (lits/dists codes 286-287 and 30-31 are never used) */
+#define DEFLATE_MAX_LITS  286
+#define DEFLATE_MAX_DISTS 30
+
+/* Settings for how hard to look for matches at each compression level */
+/* (these are the same settings that zlib uses for each level) */
+struct DeflateLevel {
+	cc_uint16 goodLen;  /* Searches fewer hash chain entries when previous match is at least this long */
+	cc_uint16 lazyLen;  /* Lazy matching: Doesn't look for a longer match when match is at least this long */
+	                    /* Greedy matching: Only inserts bytes of a match into hash chain when this long */
+	cc_uint16 niceLen;  /* Stops searching hash chain when match is at least this long */
+	cc_uint16 maxChain; /* Maximum number of hash chain entries searched */
+};
+/* Levels 1-3 use greedy matching, levels 4-9 use lazy matching */
+#define DEFLATE_LAZY_LEVEL 4
+
+static const struct DeflateLevel deflate_levels[DEFLATE_LEVEL_BEST + 1] = {
+	{  0,   0,   0,    0 },
+	{  4,   4,   8,    4 }, {  4,   5,  16,    8 }, {  4,   6,  32,   32 },
+	{  4,   4,  16,   16 }, {  8,  16,  32,   32 }, {  8,  16, 128,  128 },
+	{  8,  32, 128,  256 }, { 32, 128, 258, 1024 }, { 32, 258, 258, 4096 }
+};
 
 /* Number of bytes that match (are the same) from a and b */
+#ifdef __GNUC__
+/* Compares 8 bytes at a time, with the first differing bit giving the first differing byte */
+static int Deflate_MatchLen(cc_uint8* a, cc_uint8* b, int maxLen) {
+	cc_uint64 x, y, diff;
+	int i = 0;
+
+	for (; i + 8 <= maxLen; i += 8) {
+		__builtin_memcpy(&x, a + i, 8);
+		__builtin_memcpy(&y, b + i, 8);
+		diff = x ^ y;
+		if (!diff) continue;
+#ifdef CC_BIG_ENDIAN
+		return i + (__builtin_clzll(diff) >> 3);
+#else
+		return i + (__builtin_ctzll(diff) >> 3);
+#endif
+	}
+
+	while (i < maxLen && a[i] == b[i]) i++;
+	return i;
+}
+#else
 static int Deflate_MatchLen(cc_uint8* a, cc_uint8* b, int maxLen) {
 	int i = 0;
 	while (i < maxLen && *a == *b) { i++; a++; b++; }
 	return i;
 }
+#endif
 
 /* Hashes 3 bytes of data */
 static cc_uint32 Deflate_Hash(cc_uint8* src) {
-	return (cc_uint32)((src[0] << 8) ^ (src[1] << 4) ^ (src[2])) & DEFLATE_HASH_MASK;
+	cc_uint32 value = src[0] | (src[1] << 8) | (src[2] << 16);
+	return (cc_uint32)(value * 0x9E3779B1UL) >> (32 - DEFLATE_HASH_BITS);
 }
 
-/* Writes a literal to state->Output */
-static void Deflate_Lit(struct DeflateState* state, int lit) {
-	Deflate_PushLit(state, lit);
-	Deflate_FlushBits(state);
-}
+/* Inserts the given position into the hash chain for the 3 bytes at that position */
+#define Deflate_Insert(state, pos) \
+	hash = Deflate_Hash(&state->Input[pos]);\
+	state->Prev[pos]  = state->Head[hash];\
+	state->Head[hash] = pos;
 
-/* Writes a length-distance pair to state->Output */
-static void Deflate_LenDist(struct DeflateState* state, int len, int dist) {
-	int j;
-	/* TODO: Do we actually need the if (len_bits[j]) ????????? does writing 0 bits matter??? */
+/* Returns the code (i.e. index into len_base) for the given match length */
+static int Deflate_LenCode(int len) {
+	int l = len - MIN_MATCH_LEN, bits = 0;
+	if (len == MAX_MATCH_LEN) return 28;
+	if (l < 8) return l;
 
-	for (j = 0; len >= deflate_len[j + 1]; j++);
-	Deflate_PushLit(state, j + 257);
-	if (len_bits[j]) { Deflate_PushBits(state, len - deflate_len[j], len_bits[j]); }
-	Deflate_FlushBits(state);
+	while ((l >> bits) > 7) bits++;
+	return 4 * bits + (l >> bits);
+}
 
-	for (j = 0; dist >= deflate_dist[j + 1]; j++);
-	Deflate_PushHuff(state, j, 5);
-	if (dist_bits[j]) { Deflate_PushBits(state, dist - deflate_dist[j], dist_bits[j]); }
-	Deflate_FlushBits(state);
+/* Returns the code (i.e. index into dist_base) for the given match distance */
+static int Deflate_DistCode(int dist) {
+	int d = dist - 1, bits = 0;
+	if (d < 4) return d;
+
+	while ((d >> bits) > 3) bits++;
+	return 2 * bits + (d >> bits);
 }
 
-/* Moves "current block" to "previous block", adjusting state if needed. */
-static void Deflate_MoveBlock(struct DeflateState* state) {
-	int i;
-	Mem_Copy(state->Input, state->Input + DEFLATE_BLOCK_SIZE, DEFLATE_BLOCK_SIZE);
-	state->InputPosition = DEFLATE_BLOCK_SIZE;
+/* Adds a literal to the list of symbols for the current block */
+#define Deflate_Lit(state, lit) \
+	state->SymbolLens[state->NumSymbols]  = lit;\
+	state->SymbolDists[state->NumSymbols] = 0;\
+	state->NumSymbols++; state->LitsFreqs[lit]++;
 
-	/* adjust hash table offsets, removing offsets that are no longer in data at all */
-	for (i = 0; i < Array_Elems(state->Head); i++) {
-		state->Head[i] = state->Head[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Head[i] - DEFLATE_BLOCK_SIZE);
-	}
-	for (i = 0; i < Array_Elems(state->Prev); i++) {
-		state->Prev[i] = state->Prev[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Prev[i] - DEFLATE_BLOCK_SIZE);
+/* Adds a length-distance pair to the list of symbols for the current block */
+static void Deflate_LenDist(struct DeflateState* state, int len, int dist) {
+	state->SymbolLens[state->NumSymbols]  = len - MIN_MATCH_LEN;
+	state->SymbolDists[state->NumSymbols] = dist;
+	state->NumSymbols++;
+
+	state->LitsFreqs[257 + Deflate_LenCode(len)]++;
+	state->DistsFreqs[Deflate_DistCode(dist)]++;
+}
+
+/* Returns length of the longest match found for the data at the given position */
+static int Deflate_FindMatch(struct DeflateState* state, int pos, int maxLen, int chain, int niceLen, int* matchPos) {
+	cc_uint8* input = state->Input;
+	cc_uint8* cur   = input + pos;
+	int bestLen = MIN_MATCH_LEN - 1; /* Match must be at least 3 bytes */
+	int len, prev;
+
+	prev = state->Head[Deflate_Hash(cur)];
+	for (; prev != 0 && chain > 0; chain--) {
+		/* Only a match that's longer than the best match so far is useful */
+		if (input[prev + bestLen] == cur[bestLen] && input[prev] == cur[0]) {
+			len = Deflate_MatchLen(&input[prev], cur, maxLen);
+
+			if (len > bestLen) {
+				bestLen = len; *matchPos = prev;
+				if (len >= niceLen || len == maxLen) break;
+			}
+		}
+		prev = state->Prev[prev];
 	}
+	return bestLen;
 }
 
-/* Compresses current block of data */
-static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
-	cc_uint32 hash, nextHash;
-	int bestLen, maxLen, matchLen, depth;
-	int bestPos, pos, nextPos;
-	cc_uint16 oldHead;
-	cc_uint8* input;
-	cc_uint8* cur;
-	cc_result res;
+/* Finds literals and length-distance pairs for current block, using greedy matching */
+/* i.e. always uses the longest match at the current byte */
+static void Deflate_FindGreedy(struct DeflateState* state, int len, const struct DeflateLevel* level) {
+	int pos = DEFLATE_BLOCK_SIZE, end = DEFLATE_BLOCK_SIZE + len;
+	int matchLen, matchPos, i;
+	cc_uint32 hash;
+
+	/* Use > instead of >=, so there's always enough data to hash */
+	while (end - pos > MIN_MATCH_LEN) {
+		matchLen = Deflate_FindMatch(state, pos, min(end - pos, MAX_MATCH_LEN), 
+									level->maxChain, level->niceLen, &matchPos);
+		Deflate_Insert(state, pos);
+
+		if (matchLen < MIN_MATCH_LEN) {
+			Deflate_Lit(state, state->Input[pos]);
+			pos++; continue;
+		}
+		Deflate_LenDist(state, matchLen, pos - matchPos);
 
-	if (!state->WroteHeader) {
-		state->WroteHeader = true;
-		Deflate_PushBits(state, 3, 3); /* final block TRUE, block type FIXED */
+		/* Inserting every byte of long matches is slow, and rarely makes output smaller */
+		if (matchLen <= level->lazyLen) {
+			for (i = 1; i < matchLen && end - (pos + i) >= MIN_MATCH_LEN; i++) {
+				Deflate_Insert(state, pos + i);
+			}
+		}
+		pos += matchLen;
 	}
 
-	/* Based off descriptions from http://www.gzip.org/algorithm.txt and
-	https://github.com/nothings/stb/blob/master/stb_image_write.h */
-	input = state->Input;
-	cur   = input + DEFLATE_BLOCK_SIZE;
-
-	/* Compress current block of data */
-	/* Use > instead of >=, because also try match at one byte after current */
-	while (len > MIN_MATCH_LEN) {
-		hash   = Deflate_Hash(cur);
-		maxLen = min(len, MAX_MATCH_LEN);
-
-		bestLen = MIN_MATCH_LEN - 1; /* Match must be at least 3 bytes */
-		bestPos = 0;
-
-		/* Find longest match starting at this byte */
-		/* Only explore up to 5 previous matches, to avoid slow performance */
-		/* (i.e prefer quickly saving maps/screenshots to completely optimal filesize) */
-		pos = state->Head[hash];
-		for (depth = 0; pos != 0 && depth < 5; depth++) {
-			matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
-			if (matchLen > bestLen) { bestLen = matchLen; bestPos = pos; }
-			pos = state->Prev[pos];
+	/* literals for last few bytes */
+	for (; pos < end; pos++) {
+		Deflate_Lit(state, state->Input[pos]);
+	}
+}
+
+/* Finds literals and length-distance pairs for current block, using lazy matching */
+/* i.e. uses a literal instead of the match at the current byte, when the next byte has a longer match */
+static void Deflate_FindLazy(struct DeflateState* state, int len, const struct DeflateLevel* level) {
+	int pos = DEFLATE_BLOCK_SIZE, end = DEFLATE_BLOCK_SIZE + len;
+	int matchLen, matchPos, prevLen, prevPos, chain, i;
+	cc_bool hasPrev = false;
+	cc_uint32 hash;
+	prevLen = MIN_MATCH_LEN - 1; prevPos = 0;
+
+	/* Use > instead of >=, so there's always enough data to hash */
+	while (end - pos > MIN_MATCH_LEN) {
+		matchLen = MIN_MATCH_LEN - 1;
+
+		if (prevLen < level->lazyLen) {
+			chain    = prevLen >= level->goodLen ? level->maxChain >> 2 : level->maxChain;
+			matchLen = Deflate_FindMatch(state, pos, min(end - pos, MAX_MATCH_LEN), 
+										chain, level->niceLen, &matchPos);
 		}
+		Deflate_Insert(state, pos);
 
-		/* Insert this entry into the hash chain */
-		pos = (int)(cur - input);
-		oldHead = state->Head[hash];
-		state->Head[hash] = pos;
-		state->Prev[pos]  = oldHead;
-
-		/* Lazy evaluation: Find longest match starting at next byte */
-		/* If that's longer than the longest match at current byte, throwaway this match */
-		if (bestPos) {
-			nextHash = Deflate_Hash(cur + 1);
-			nextPos  = state->Head[nextHash];
-			maxLen   = min(len - 1, MAX_MATCH_LEN);
-
-			for (depth = 0; nextPos != 0 && depth < 5; depth++) {
-				matchLen = Deflate_MatchLen(&input[nextPos], cur + 1, maxLen);
-				if (matchLen > bestLen) { bestPos = 0; break; }
-				nextPos = state->Prev[nextPos];
+		/* Match at previous byte is at least as long, so use that match instead */
+		if (prevLen >= MIN_MATCH_LEN && matchLen <= prevLen) {
+			Deflate_LenDist(state, prevLen, (pos - 1) - prevPos);
+
+			for (i = 1; i < prevLen - 1 && end - (pos + i) >= MIN_MATCH_LEN; i++) {
+				Deflate_Insert(state, pos + i);
 			}
+			pos    += prevLen - 1;
+			hasPrev = false;
+			prevLen = MIN_MATCH_LEN - 1;
+			continue;
 		}
 
-		if (bestPos) {
-			Deflate_LenDist(state, bestLen, pos - bestPos);
-			len -= bestLen; cur += bestLen;
-		} else {
-			Deflate_Lit(state, *cur);
-			len--; cur++;
-		}
+		/* Otherwise output the previous byte, and check if next byte has a longer match */
+		if (hasPrev) { Deflate_Lit(state, state->Input[pos - 1]); }
+		hasPrev = true;
+		prevLen = matchLen; prevPos = matchPos;
+		pos++;
+	}
 
-		/* leave room for a few bytes and literals at end */
-		if (state->AvailOut >= 20) continue;
-		res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
-		state->NextOut  = state->Output;
-		state->AvailOut = DEFLATE_OUT_SIZE;
-		if (res) return res;
+	if (hasPrev && prevLen >= MIN_MATCH_LEN) {
+		Deflate_LenDist(state, prevLen, (pos - 1) - prevPos);
+		pos += prevLen - 1;
+	} else if (hasPrev) {
+		Deflate_Lit(state, state->Input[pos - 1]);
 	}
 
 	/* literals for last few bytes */
-	while (len > 0) {
-		Deflate_Lit(state, *cur);
-		len--; cur++;
+	for (; pos < end; pos++) {
+		Deflate_Lit(state, state->Input[pos]);
 	}
-
-	res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
-	state->NextOut  = state->Output;
-	state->AvailOut = DEFLATE_OUT_SIZE;
-
-	Deflate_MoveBlock(state);
-	return res;
 }
 
-/* Adds data to buffered output data, flushing if needed */
-static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 total, cc_uint32* modified) {
-	struct DeflateState* state;
-	cc_result res;
+/* Calculates the optimal bit length of each codeword (for the given frequencies of each value), */
+/*  with the length of each codeword then limited to at most 'maxBits' bits */
+static void Deflate_BuildLengths(const cc_uint32* freqs, int count, int maxBits, cc_uint8* lens) {
+	int keys[INFLATE_MAX_LITS], values[INFLATE_MAX_LITS];
+	int tmpKeys[INFLATE_MAX_LITS], tmpValues[INFLATE_MAX_LITS];
+	int offsets[256], bl_count[33];
+	int root, leaf, next, avail, used, depth;
+	cc_uint32 total;
+	int i, n, pass, shift;
+
+	n = 0;
+	for (i = 0; i < count; i++) {
+		lens[i] = 0;
+		if (!freqs[i]) continue;
+		keys[n] = freqs[i]; values[n] = i; n++;
+	}
 
-	state = (struct DeflateState*)stream->Meta.Inflate;
-	*modified = 0;
+	/* Huffman tree needs at least two codewords */
+	if (n == 0) {
+		lens[0] = 1; lens[1] = 1; return;
+	} else if (n == 1) {
+		lens[values[0]] = 1; lens[values[0] ? 0 : 1] = 1; return;
+	}
 
-	while (total > 0) {
-		cc_uint8* dst = &state->Input[state->InputPosition];
-		cc_uint32 len = total;
-		if (state->InputPosition + len >= DEFLATE_BUFFER_SIZE) {
-			len = DEFLATE_BUFFER_SIZE - state->InputPosition;
+	/* Sort values by frequency, using radix sort (frequencies are less than 65536) */
+	for (pass = 0, shift = 0; pass < 2; pass++, shift += 8) {
+		for (i = 0; i < 256; i++) offsets[i] = 0;
+		for (i = 0; i < n; i++) offsets[(keys[i] >> shift) & 0xFF]++;
+
+		for (i = 0, total = 0; i < 256; i++) {
+			next = offsets[i]; offsets[i] = total; total += next;
+		}
+		for (i = 0; i < n; i++) {
+			next = offsets[(keys[i] >> shift) & 0xFF]++;
+			tmpKeys[next] = keys[i]; tmpValues[next] = values[i];
 		}
+		Mem_Copy(keys,   tmpKeys,   n * sizeof(int));
+		Mem_Copy(values, tmpValues, n * sizeof(int));
+	}
 
-		Mem_Copy(dst, data, len);
-		total -= len;
-		state->InputPosition += len;
-		*modified += len;
-		data += len;
+	/* Compute the depth of each leaf in the huffman tree, by building the tree in place */
+	/* (based on 'In-Place Calculation of Minimum-Redundancy Codes' by Moffat and Katajainen) */
+	keys[0] += keys[1]; root = 0; leaf = 2;
+	for (next = 1; next < n - 1; next++) {
+		if (leaf >= n || keys[root] < keys[leaf]) {
+			keys[next] = keys[root]; keys[root++] = next;
+		} else {
+			keys[next] = keys[leaf++];
+		}
 
-		if (state->InputPosition == DEFLATE_BUFFER_SIZE) {
-			res = Deflate_FlushBlock(state, DEFLATE_BLOCK_SIZE);
-			if (res) return res;
+		if (leaf >= n || (root < next && keys[root] < keys[leaf])) {
+			keys[next] += keys[root]; keys[root++] = next;
+		} else {
+			keys[next] += keys[leaf++];
 		}
 	}
-	return 0;
-}
 
-/* Flushes any buffered data, then writes terminating symbol */
-static cc_result Deflate_StreamClose(struct Stream* stream) {
-	struct DeflateState* state;
-	cc_result res;
+	keys[n - 2] = 0;
+	for (next = n - 3; next >= 0; next--) { keys[next] = keys[keys[next]] + 1; }
 
-	state = (struct DeflateState*)stream->Meta.Inflate;
-	res   = Deflate_FlushBlock(state, state->InputPosition - DEFLATE_BLOCK_SIZE);
-	if (res) return res;
+	avail = 1; used = 0; depth = 0; root = n - 2; next = n - 1;
+	while (avail > 0) {
+		while (root >= 0 && keys[root] == depth) { used++; root--; }
+		while (avail > used) { keys[next--] = depth; avail--; }
+		avail = 2 * used; depth++; used = 0;
+	}
+
+	/* Limit codewords to 'maxBits' bits, by moving codewords deeper in the tree */
+	/*  until the tree is complete again (i.e. sum of 2^-length is 1) */
+	for (i = 0; i <= 32; i++) bl_count[i] = 0;
+	for (i = 0; i < n; i++) bl_count[min(keys[i], 32)]++;
+
+	for (i = maxBits + 1; i <= 32; i++) { bl_count[maxBits] += bl_count[i]; }
+	for (i = maxBits, total = 0; i > 0; i--) { total += (cc_uint32)bl_count[i] << (maxBits - i); }
+
+	for (; total != (1UL << maxBits); total--) {
+		bl_count[maxBits]--;
+		for (i = maxBits - 1; i > 0; i--) {
+			if (!bl_count[i]) continue;
+			bl_count[i]--; bl_count[i + 1] += 2; break;
+		}
+	}
+
+	/* Most frequent values get the shortest codewords */
+	for (i = 1, next = n; i <= maxBits; i++) {
+		for (used = bl_count[i]; used > 0; used--) { lens[values[--next]] = i; }
+	}
+}
+
+/* Constructs a huffman encoding table (for values to codewords) */
+static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
+	int bl_count[INFLATE_MAX_BITS], next_code[INFLATE_MAX_BITS];
+	int i, len, code;
+
+	for (i = 0; i < INFLATE_MAX_BITS; i++) bl_count[i] = 0;
+	for (i = 0; i < count; i++) {
+		bl_count[lens[i]]++;
+	}
+	bl_count[0] = 0;
+
+	/* Compute the first codeword for each bit length */
+	code = 0;
+	for (i = 1; i < INFLATE_MAX_BITS; i++) {
+		code = (code + bl_count[i - 1]) << 1;
+		next_code[i] = code;
+	}
+
+	/* Codewords are assigned in order of value within each bit length */
+	for (i = 0; i < count; i++) {
+		len = lens[i];
+		bitlens[i] = len;
+		if (!len) continue;
+
+		codewords[i] = Huffman_ReverseBits(next_code[len]++, len);
+	}
+}
+
+/* Writes all the data in the output buffer to the destination stream */
+static cc_result Deflate_WriteOutput(struct DeflateState* state) {
+	cc_result res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
+	state->NextOut  = state->Output;
+	state->AvailOut = DEFLATE_OUT_SIZE;
+	return res;
+}
+
+/* Writes the huffman codewords for all the symbols in the current block */
+static cc_result Deflate_WriteSymbols(struct DeflateState* state) {
+	int i, len, dist, code;
+	cc_result res;
+
+	for (i = 0; i < state->NumSymbols; i++) {
+		dist = state->SymbolDists[i];
+		if (!dist) {
+			Deflate_PushLit(state, state->SymbolLens[i]);
+			Deflate_FlushBits(state);
+		} else {
+			len  = state->SymbolLens[i] + MIN_MATCH_LEN;
+			code = Deflate_LenCode(len);
+			Deflate_PushLit(state, code + 257);
+			Deflate_PushBits(state, len - len_base[code], len_bits[code]);
+			Deflate_FlushBits(state);
+
+			code = Deflate_DistCode(dist);
+			Deflate_PushDist(state, code);
+			Deflate_FlushBits(state);
+			Deflate_PushBits(state, dist - dist_base[code], dist_bits[code]);
+			Deflate_FlushBits(state);
+		}
+
+		/* leave room for a few bytes and literals at end */
+		if (state->AvailOut >= 20) continue;
+		if ((res = Deflate_WriteOutput(state))) return res;
+	}
 
 	/* Write huffman encoded "literal 256" to terminate symbols */
 	Deflate_PushLit(state, 256);
 	Deflate_FlushBits(state);
+	return 0;
+}
+
+/* Writes the current block as uncompressed data */
+static cc_result Deflate_WriteStored(struct DeflateState* state, cc_uint8* data, int len) {
+	int count;
+	cc_result res;
+
+	/* Uncompressed data starts on a byte boundary */
+	if (state->NumBits & 7) { Deflate_PushBits(state, 0, 8 - (state->NumBits & 7)); }
+	Deflate_PushBits(state, len, 16);
+	Deflate_FlushBits(state);
+	Deflate_PushBits(state, len ^ 0xFFFF, 16);
+	Deflate_FlushBits(state);
+
+	while (len > 0) {
+		if (!state->AvailOut && (res = Deflate_WriteOutput(state))) return res;
+		count = min(len, (int)state->AvailOut);
+
+		Mem_Copy(state->NextOut, data, count);
+		state->NextOut += count; state->AvailOut -= count;
+		data += count; len -= count;
+	}
+	return 0;
+}
+
+/* Writes the current block, using whichever of dynamic huffman, fixed huffman, */
+/*  or no compression results in the smallest output */
+static cc_result Deflate_WriteBlock(struct DeflateState* state, cc_uint8* data, int len, cc_bool last) {
+	cc_uint8 lens[DEFLATE_MAX_LITS + DEFLATE_MAX_DISTS];
+	cc_uint8 runs[DEFLATE_MAX_LITS + DEFLATE_MAX_DISTS], runExtra[DEFLATE_MAX_LITS + DEFLATE_MAX_DISTS];
+	cc_uint32 codeLensFreqs[INFLATE_MAX_CODELENS];
+	cc_uint8 codeLensLens[INFLATE_MAX_CODELENS];
+	cc_uint16 codeLensCodewords[INFLATE_MAX_CODELENS];
+	cc_uint32 extraBits, fixedBits, dynamicBits, storedBits;
+	int numLits, numDists, numCodeLens, numRuns, count;
+	int i, j, run, value;
+	cc_result res;
+
+	/* Previous block may have completely filled the output buffer */
+	if (state->AvailOut < 20 && (res = Deflate_WriteOutput(state))) return res;
+
+	state->LitsFreqs[256] = 1;
+	Deflate_BuildLengths(state->LitsFreqs,  DEFLATE_MAX_LITS,  15, state->LitsLens);
+	Deflate_BuildLengths(state->DistsFreqs, DEFLATE_MAX_DISTS, 15, state->DistsLens);
+
+	for (numLits  = DEFLATE_MAX_LITS;  numLits  > 257 && !state->LitsLens[numLits   - 1]; numLits--)  {}
+	for (numDists = DEFLATE_MAX_DISTS; numDists > 1   && !state->DistsLens[numDists - 1]; numDists--) {}
+	Mem_Copy(lens,           state->LitsLens,  numLits);
+	Mem_Copy(lens + numLits, state->DistsLens, numDists);
+	count = numLits + numDists;
+
+	/* Run length encode the codeword lengths */
+	for (i = 0; i < INFLATE_MAX_CODELENS; i++) codeLensFreqs[i] = 0;
+	for (i = 0, numRuns = 0; i < count; i += run) {
+		value = lens[i];
+		for (run = 1; i + run < count && lens[i + run] == value; run++) {}
+		j = run;
+
+		if (!value) {
+			for (; j >= 11; j -= min(j, 138)) {
+				runs[numRuns] = 18; runExtra[numRuns++] = min(j, 138) - 11;
+			}
+			if (j >= 3) {
+				runs[numRuns] = 17; runExtra[numRuns++] = j - 3; j = 0;
+			}
+		} else {
+			runs[numRuns] = value; runExtra[numRuns++] = 0; j--;
+			for (; j >= 3; j -= min(j, 6)) {
+				runs[numRuns] = 16; runExtra[numRuns++] = min(j, 6) - 3;
+			}
+		}
+		for (; j > 0; j--) { runs[numRuns] = value; runExtra[numRuns++] = 0; }
+	}
+
+	for (i = 0; i < numRuns; i++) codeLensFreqs[runs[i]]++;
+	Deflate_BuildLengths(codeLensFreqs, INFLATE_MAX_CODELENS, 7, codeLensLens);
+	for (numCodeLens = INFLATE_MAX_CODELENS; numCodeLens > 4 && !codeLensLens[codelens_order[numCodeLens - 1]]; numCodeLens--) {}
+
+	/* Calculate number of bits each type of block would use */
+	extraBits = 0; fixedBits = 0; dynamicBits = 0;
+	for (i = 0; i < 29; i++) { extraBits += state->LitsFreqs[257 + i] * len_bits[i]; }
+	for (i = 0; i < 30; i++) { extraBits += state->DistsFreqs[i] * dist_bits[i]; }
+
+	for (i = 0; i < DEFLATE_MAX_LITS; i++) {
+		fixedBits   += state->LitsFreqs[i] * fixed_lits[i];
+		dynamicBits += state->LitsFreqs[i] * state->LitsLens[i];
+	}
+	for (i = 0; i < DEFLATE_MAX_DISTS; i++) {
+		fixedBits   += state->DistsFreqs[i] * fixed_dists[i];
+		dynamicBits += state->DistsFreqs[i] * state->DistsLens[i];
+	}
+	
+	dynamicBits += 5 + 5 + 4 + 3 * numCodeLens;
+	for (i = 0; i < numRuns; i++) {
+		dynamicBits += codeLensLens[runs[i]];
+		if (runs[i] >= 16) dynamicBits += runs[i] == 16 ? 2 : (runs[i] == 17 ? 3 : 7);
+	}
+	dynamicBits += extraBits;
+	fixedBits   += extraBits;
+	storedBits   = 7 + 32 + len * 8;
+
+	if (storedBits < fixedBits && storedBits < dynamicBits) {
+		Deflate_PushBits(state, last, 3); /* block type STORED */
+		res = Deflate_WriteStored(state, data, len);
+	} else if (fixedBits <= dynamicBits) {
+		Deflate_PushBits(state, last | (1 << 1), 3); /* block type FIXED */
+		Deflate_BuildTable(fixed_lits,  INFLATE_MAX_LITS,  state->LitsCodewords,  state->LitsLens);
+		Deflate_BuildTable(fixed_dists, INFLATE_MAX_DISTS, state->DistsCodewords, state->DistsLens);
+		res = Deflate_WriteSymbols(state);
+	} else {
+		Deflate_PushBits(state, last | (2 << 1), 3); /* block type DYNAMIC */
+		/* NOTE: Lengths of lits 286-287 and dists 30-31 may be left over from a previous fixed block */
+		Deflate_BuildTable(state->LitsLens,  DEFLATE_MAX_LITS,     state->LitsCodewords,  state->LitsLens);
+		Deflate_BuildTable(state->DistsLens, DEFLATE_MAX_DISTS,    state->DistsCodewords, state->DistsLens);
+		Deflate_BuildTable(codeLensLens,     INFLATE_MAX_CODELENS, codeLensCodewords,     codeLensLens);
+
+		Deflate_PushBits(state, numLits  - 257, 5);
+		Deflate_PushBits(state, numDists - 1,   5);
+		Deflate_PushBits(state, numCodeLens - 4, 4);
+		Deflate_FlushBits(state);
+
+		for (i = 0; i < numCodeLens; i++) {
+			Deflate_PushBits(state, codeLensLens[codelens_order[i]], 3);
+			Deflate_FlushBits(state);
+		}
+
+		for (i = 0; i < numRuns; i++) {
+			value = runs[i];
+			Deflate_PushBits(state, codeLensCodewords[value], codeLensLens[value]);
+			if (value == 16) { Deflate_PushBits(state, runExtra[i], 2); }
+			if (value == 17) { Deflate_PushBits(state, runExtra[i], 3); }
+			if (value == 18) { Deflate_PushBits(state, runExtra[i], 7); }
+			Deflate_FlushBits(state);
+
+			if (state->AvailOut < 20 && (res = Deflate_WriteOutput(state))) return res;
+		}
+		res = Deflate_WriteSymbols(state);
+	}
+
+	state->NumSymbols = 0;
+	Mem_Set(state->LitsFreqs,  0, sizeof(state->LitsFreqs));
+	Mem_Set(state->DistsFreqs, 0, sizeof(state->DistsFreqs));
+	return res;
+}
+
+/* Moves "current block" to "previous block", adjusting state if needed. */
+static void Deflate_MoveBlock(struct DeflateState* state) {
+	int i, pos;
+	Mem_Copy(state->Input, state->Input + DEFLATE_BLOCK_SIZE, DEFLATE_BLOCK_SIZE);
+	state->InputPosition = DEFLATE_BLOCK_SIZE;
+
+	/* adjust hash table offsets, removing offsets that are no longer in data at all */
+	for (i = 0; i < Array_Elems(state->Head); i++) {
+		pos = state->Head[i];
+		state->Head[i] = pos < DEFLATE_BLOCK_SIZE ? 0 : (pos - DEFLATE_BLOCK_SIZE);
+	}
+	/* hash chain entries for current block also need to be moved to previous block */
+	for (i = 0; i < DEFLATE_BLOCK_SIZE; i++) {
+		pos = state->Prev[i + DEFLATE_BLOCK_SIZE];
+		state->Prev[i] = pos < DEFLATE_BLOCK_SIZE ? 0 : (pos - DEFLATE_BLOCK_SIZE);
+	}
+}
+
+/* Compresses current block of data */
+static cc_result Deflate_FlushBlock(struct DeflateState* state, int len, cc_bool last) {
+	const struct DeflateLevel* level;
+	cc_result res;
+	/* Based off descriptions from http://www.gzip.org/algorithm.txt, zlib's deflate.c, and
+	https://github.com/nothings/stb/blob/master/stb_image_write.h */
+	level = &deflate_levels[state->Level];
+
+	if (state->Level >= DEFLATE_LAZY_LEVEL) {
+		Deflate_FindLazy(state, len, level);
+	} else {
+		Deflate_FindGreedy(state, len, level);
+	}
+
+	res = Deflate_WriteBlock(state, state->Input + DEFLATE_BLOCK_SIZE, len, last);
+	if (res) return res;
+	res = Deflate_WriteOutput(state);
+
+	Deflate_MoveBlock(state);
+	return res;
+}
+
+/* Adds data to buffered output data, flushing if needed */
+static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 total, cc_uint32* modified) {
+	struct DeflateState* state;
+	cc_result res;
+
+	state = (struct DeflateState*)stream->Meta.Inflate;
+	*modified = 0;
+
+	while (total > 0) {
+		cc_uint8* dst = &state->Input[state->InputPosition];
+		cc_uint32 len = total;
+		if (state->InputPosition + len >= DEFLATE_BUFFER_SIZE) {
+			len = DEFLATE_BUFFER_SIZE - state->InputPosition;
+		}
+
+		Mem_Copy(dst, data, len);
+		total -= len;
+		state->InputPosition += len;
+		*modified += len;
+		data += len;
+
+		if (state->InputPosition == DEFLATE_BUFFER_SIZE) {
+			res = Deflate_FlushBlock(state, DEFLATE_BLOCK_SIZE, false);
+			if (res) return res;
+		}
+	}
+	return 0;
+}
+
+/* Flushes any buffered data as a block, then writes all remaining compressed data */
+/* NOTE: If not the last block, an empty uncompressed block is also written, so the */
+/*  compressed data ends on a byte boundary and more DEFLATE data can be appended after it */
+static cc_result Deflate_Finish(struct DeflateState* state, cc_bool last) {
+	cc_result res = Deflate_FlushBlock(state, state->InputPosition - DEFLATE_BLOCK_SIZE, last);
+	if (res) return res;
+
+	if (!last) {
+		if (state->AvailOut < 20 && (res = Deflate_WriteOutput(state))) return res;
+		Deflate_PushBits(state, 0, 3); /* block type STORED */
+		if ((res = Deflate_WriteStored(state, NULL, 0))) return res;
+	}
 
 	/* In case last byte still has a few extra bits */
 	if (state->NumBits) {
@@ -987,24 +1599,10 @@ static cc_result Deflate_StreamClose(struct Stream* stream) {
 	return Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
 }
 
-/* Constructs a huffman encoding table (for values to codewords) */
-static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
-	int i, j, offset, codeword;
-	struct HuffmanTable table;
-
-	/* NOTE: Can ignore since lens table is not user controlled */
-	(void)Huffman_Build(&table, lens, count);
-	for (i = 0; i < INFLATE_MAX_BITS; i++) {
-		if (!table.EndCodewords[i]) continue;
-		count = table.EndCodewords[i] - table.FirstCodewords[i];
-
-		for (j = 0; j < count; j++) {
-			offset   = table.Values[table.FirstOffsets[i] + j];
-			codeword = table.FirstCodewords[i] + j;
-			bitlens[offset]   = i;
-			codewords[offset] = Huffman_ReverseBits(codeword, i);
-		}
-	}
+/* Flushes any buffered data as the last block */
+static cc_result Deflate_StreamClose(struct Stream* stream) {
+	struct DeflateState* state = (struct DeflateState*)stream->Meta.Inflate;
+	return Deflate_Finish(state, true);
 }
 
 void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying) {
@@ -1017,15 +1615,167 @@ void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struc
 	state->InputPosition = DEFLATE_BLOCK_SIZE;
 	state->Bits    = 0;
 	state->NumBits = 0;
+	state->Level   = DEFLATE_LEVEL_DEFAULT;
 
 	state->NextOut  = state->Output;
 	state->AvailOut = DEFLATE_OUT_SIZE;
 	state->Dest     = underlying;
-	state->WroteHeader = false;
+	state->NumSymbols = 0;
 
 	Mem_Set(state->Head, 0, sizeof(state->Head));
 	Mem_Set(state->Prev, 0, sizeof(state->Prev));
-	Deflate_BuildTable(fixed_lits, INFLATE_MAX_LITS, state->LitsCodewords, state->LitsLens);
+	Mem_Set(state->LitsFreqs,  0, sizeof(state->LitsFreqs));
+	Mem_Set(state->DistsFreqs, 0, sizeof(state->DistsFreqs));
+}
+
+/* Number of times each file is compressed at each level when benchmarking */
+#define DEFLATE_BENCHMARK_RUNS 3
+static const cc_uint8 deflate_benchmarkLevels[] = { 1, 3, 6, 9 };
+
+/* Loads the data to compress from the given file, decompressing it first if it is a map or PNG image */
+static cc_result Deflate_BenchmarkLoad(const cc_string* path, struct InflateState* state, cc_uint8** raw, cc_uint32* rawLen) {
+	struct Stream mem, inflate;
+	cc_uint8* data = NULL;
+	cc_uint32 len;
+	cc_bool gzip, png;
+	cc_result res;
+
+	res = Inflate_BenchmarkLoad(path, &data, &len);
+	if (res) { Mem_Free(data); return res; }
+
+	gzip = len >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+	png  = Png_Detect(data, len);
+	if (!gzip && !png) { *raw = data; *rawLen = len; return 0; }
+	if (png) Inflate_BenchmarkPng(data, &len);
+
+	/* Decompress once to find out the decompressed size, then again to actually get the data */
+	*raw = (cc_uint8*)Mem_Alloc(INFLATE_BENCHMARK_BUFFER, 1, "inflate output");
+	res  = Inflate_BenchmarkRun(data, len, gzip, state, *raw, rawLen, NULL);
+	Mem_Free(*raw);
+	*raw = NULL;
+	if (res) { Mem_Free(data); return res; }
+	*raw = (cc_uint8*)Mem_Alloc(*rawLen + 1, 1, "deflate benchmark data");
+
+	if (!(res = Inflate_BenchmarkOpen(data, len, gzip, state, &mem, &inflate))) {
+		res = Stream_Read(&inflate, *raw, *rawLen);
+	}
+	Mem_Free(data);
+	return res;
+}
+
+/* Compresses the data at the given level, returning compressed size or 0 on error */
+static cc_uint32 Deflate_BenchmarkRun(cc_uint8* raw, cc_uint32 rawLen, int level, struct DeflateState* state, 
+									cc_uint8* out, cc_uint32 outLen) {
+	struct Stream mem, deflate;
+	Stream_WriteonlyMemory(&mem, out, outLen);
+	Deflate_MakeStream(&deflate, state, &mem);
+	state->Level = level;
+
+	if (Stream_Write(&deflate, raw, rawLen)) return 0;
+	if (deflate.Close(&deflate))             return 0;
+	return mem.Meta.Mem.Length - mem.Meta.Mem.Left;
+}
+
+/* Compresses the data at the given level using a parallel GZIP stream, returning compressed size or 0 on error */
+static cc_uint32 Deflate_BenchmarkParallel(cc_uint8* raw, cc_uint32 rawLen, int level, cc_uint8* out, cc_uint32 outLen) {
+	struct Stream mem, gzip;
+	cc_result res;
+	Stream_WriteonlyMemory(&mem, out, outLen);
+	if (GZip_MakeParallelStream(&gzip, &mem, level)) return 0;
+
+	res = Stream_Write(&gzip, raw, rawLen);
+	if (gzip.Close(&gzip) || res) return 0;
+	return mem.Meta.Mem.Length - mem.Meta.Mem.Left;
+}
+
+/* Checks that decompressing the data gives back the original data */
+static cc_bool Deflate_BenchmarkCheck(cc_uint8* data, cc_uint32 len, cc_bool gzip, struct InflateState* state,
+									cc_uint8* raw, cc_uint32 rawLen, cc_uint8* check) {
+	struct Stream mem, inflate;
+	if (!len) return false;
+
+	if (gzip) {
+		/* GZIP footer has CRC32 and length of the original data */
+		if (len < 8 || Stream_GetU32_LE(data + len - 8) != Utils_CRC32(raw, rawLen)) return false;
+		if (Stream_GetU32_LE(data + len - 4) != rawLen) return false;
+		if (Inflate_BenchmarkOpen(data, len, true, state, &mem, &inflate)) return false;
+	} else {
+		Stream_ReadonlyMemory(&mem, data, len);
+		Inflate_MakeStream2(&inflate, state, &mem);
+	}
+	return !Stream_Read(&inflate, check, rawLen) && Mem_Equal(check, raw, rawLen);
+}
+
+/* Logs how long compressing took, and whether the compressed data is valid */
+static void Deflate_BenchmarkLog(const char* type, int level, cc_uint32 size, cc_uint32 rawLen, cc_uint64 elapsed, cc_bool valid) {
+	float ms    = elapsed / (1000.0f * DEFLATE_BENCHMARK_RUNS);
+	float ratio = rawLen ? (float)size / rawLen : 0.0f;
+	int rate    = (int)((double)rawLen * DEFLATE_BENCHMARK_RUNS / (elapsed ? elapsed : 1));
+
+	Platform_Log4("  %c level %i: %i bytes (ratio %f3)", type, &level, &size, &ratio);
+	Platform_Log3("    %f3 ms per run, %i MB/sec, %c", &ms, &rate, valid ? "decompresses correctly" : "DECOMPRESSES INCORRECTLY");
+}
+
+void Deflate_Benchmark(const cc_string* paths, int count) {
+	struct InflateState* inflateState;
+	struct DeflateState* deflateState;
+	cc_uint8* raw;
+	cc_uint8* out;
+	cc_uint8* check;
+	cc_uint32 rawLen, outLen, size;
+	cc_uint64 beg, elapsed;
+	int i, j, k, level;
+	cc_bool valid;
+	cc_result res;
+	int threads = Thread_CoresCount();
+
+	inflateState = (struct InflateState*)Mem_Alloc(1, sizeof(struct InflateState), "inflate state");
+	deflateState = (struct DeflateState*)Mem_Alloc(1, sizeof(struct DeflateState), "deflate state");
+
+	for (i = 0; i < count; i++) {
+		raw = NULL;
+		res = Deflate_BenchmarkLoad(&paths[i], inflateState, &raw, &rawLen);
+		if (res) { Logger_SysWarn2(res, "loading", &paths[i]); continue; }
+
+		/* Uncompressed blocks have 5 bytes of overhead for every 16 kilobytes */
+		outLen = rawLen + rawLen / 1024 + 1024;
+		out    = (cc_uint8*)Mem_Alloc(outLen, 1, "deflate benchmark output");
+		check  = (cc_uint8*)Mem_Alloc(rawLen + 1, 1, "deflate benchmark check");
+		Platform_Log3("Compressing %s: %i bytes (%i threads)", &paths[i], &rawLen, &threads);
+
+		for (j = 0; j < Array_Elems(deflate_benchmarkLevels); j++) {
+			level = deflate_benchmarkLevels[j];
+
+			beg = Stopwatch_Measure();
+			for (k = 0; k < DEFLATE_BENCHMARK_RUNS; k++) {
+				size = Deflate_BenchmarkRun(raw, rawLen, level, deflateState, out, outLen);
+			}
+			elapsed = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+
+			valid = Deflate_BenchmarkCheck(out, size, false, inflateState, raw, rawLen, check);
+			Deflate_BenchmarkLog("DEFLATE", level, size, rawLen, elapsed, valid);
+		}
+
+		for (j = 0; j < Array_Elems(deflate_benchmarkLevels); j++) {
+			level = deflate_benchmarkLevels[j];
+
+			beg = Stopwatch_Measure();
+			for (k = 0; k < DEFLATE_BENCHMARK_RUNS; k++) {
+				size = Deflate_BenchmarkParallel(raw, rawLen, level, out, outLen);
+			}
+			elapsed = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+
+			valid = Deflate_BenchmarkCheck(out, size, true, inflateState, raw, rawLen, check);
+			Deflate_BenchmarkLog("Parallel GZIP", level, size, rawLen, elapsed, valid);
+		}
+
+		Mem_Free(raw);
+		Mem_Free(out);
+		Mem_Free(check);
+	}
+
+	Mem_Free(inflateState);
+	Mem_Free(deflateState);
 }
 
 
@@ -1045,15 +1795,8 @@ static cc_result GZip_StreamClose(struct Stream* stream) {
 
 static cc_result GZip_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct GZipState* state = (struct GZipState*)stream->Meta.Inflate;
-	cc_uint32 i, crc32 = state->Crc32;
 	state->Size += count;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		crc32 = Utils_Crc32Table[(crc32 ^ data[i]) & 0xFF] ^ (crc32 >> 8);
-	}
-
-	state->Crc32 = crc32;
+	state->Crc32 = Utils_Crc32Update(state->Crc32, data, count);
 	return Deflate_StreamWrite(stream, data, count, modified);
 }
 
@@ -1076,6 +1819,213 @@ void GZip_MakeStream(struct Stream* stream, struct GZipState* state, struct Stre
 }
 
 
+/*########################################################################################################################*
+*------------------------------------------------Parallel GZip (compress)-------------------------------------------------*
+*#########################################################################################################################*/
+/* Large amounts of data are compressed much quicker by compressing pieces of the data on multiple threads. */
+/* Each piece is compressed independently of the others (similar to pigz), which is valid DEFLATE */
+/*  data as long as every piece except the last ends with a non-final block on a byte boundary. */
+#define GZIP_MAX_JOBS 16
+/* Upper limit on size of a compressed piece (uncompressed blocks have 5 bytes of overhead per 16 kilobytes) */
+#define GZIP_CHUNK_OUT_SIZE (GZIP_CHUNK_SIZE + GZIP_CHUNK_SIZE / 1024 + 64)
+
+struct GZipJob {
+	cc_uint8* Input;  cc_uint32 InputLen;
+	cc_uint8* Output; cc_uint32 OutputLen;
+	struct DeflateState* State;
+	cc_uint32 Crc32;
+	cc_result Result;
+	cc_bool Last;
+};
+
+struct ParallelGZipState {
+	struct Stream* Dest;
+	int Level, NumJobs, UsedJobs;
+	cc_uint32 Crc32, Size;
+	cc_bool WroteHeader;
+	cc_result Result; /* Error from compressing or writing previous pieces */
+	struct GZipJob Jobs[GZIP_MAX_JOBS];
+};
+
+/* Parallel stream whose pieces are currently being compressed */
+static struct ParallelGZipState* gzip_running;
+/* Index of next job in gzip_running which has not been started yet */
+static int gzip_nextJob;
+/* gzipMutex protects gzip_nextJob */
+static void* gzipMutex;
+
+static void GZip_RunJob(struct GZipJob* job, int level) {
+	struct Stream mem, deflate;
+	cc_result res;
+	Stream_WriteonlyMemory(&mem, job->Output, GZIP_CHUNK_OUT_SIZE);
+	Deflate_MakeStream(&deflate, job->State, &mem);
+	job->State->Level = level;
+	job->Crc32 = Utils_CRC32(job->Input, job->InputLen);
+
+	res = Stream_Write(&deflate, job->Input, job->InputLen);
+	if (!res) res = Deflate_Finish(job->State, job->Last);
+
+	job->OutputLen = mem.Meta.Mem.Length - mem.Meta.Mem.Left;
+	job->Result    = res;
+}
+
+/* Compresses the next piece of data. Returns false if there are no pieces left to compress. */
+static cc_bool GZip_RunNextJob(void) {
+	int i;
+	Mutex_Lock(gzipMutex);
+	{
+		i = gzip_nextJob++;
+	}
+	Mutex_Unlock(gzipMutex);
+	if (i >= gzip_running->UsedJobs) return false;
+
+	GZip_RunJob(&gzip_running->Jobs[i], gzip_running->Level);
+	return true;
+}
+
+static void GZip_JobWorker(void) {
+	while (GZip_RunNextJob()) { }
+}
+
+/* Compresses all the filled pieces of data, then writes the compressed pieces in order */
+static cc_result GZip_RunJobs(struct ParallelGZipState* state) {
+	static cc_uint8 header[10] = { 0x1F, 0x8B, 0x08 }; /* GZip header */
+	void* threads[GZIP_MAX_JOBS];
+	struct GZipJob* job;
+	int i, count;
+	cc_result res;
+
+	count = state->UsedJobs - 1;
+#ifdef CC_BUILD_WEB
+	/* No background threads, so the current thread compresses all the pieces */
+	count = 0;
+#endif
+
+	gzip_running = state;
+	gzip_nextJob = 0;
+	gzipMutex    = Mutex_Create();
+	for (i = 0; i < count; i++) {
+		threads[i] = Thread_Start(GZip_JobWorker);
+	}
+
+	/* Current thread compresses pieces too, rather than just waiting for the workers */
+	GZip_JobWorker();
+	for (i = 0; i < count; i++) {
+		Thread_Join(threads[i]);
+	}
+	Mutex_Free(gzipMutex);
+	gzip_running = NULL;
+
+	if (!state->WroteHeader) {
+		if ((res = Stream_Write(state->Dest, header, sizeof(header)))) return res;
+		state->WroteHeader = true;
+	}
+
+	for (i = 0; i < state->UsedJobs; i++) {
+		job = &state->Jobs[i];
+		if ((res = job->Result)) return res;
+
+		state->Crc32 = Utils_Crc32Combine(state->Crc32, job->Crc32, job->InputLen);
+		state->Size += job->InputLen;
+		if ((res = Stream_Write(state->Dest, job->Output, job->OutputLen))) return res;
+		job->InputLen = 0;
+	}
+	state->UsedJobs = 0;
+	return 0;
+}
+
+static cc_result GZip_ParallelWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 total, cc_uint32* modified) {
+	struct ParallelGZipState* state = (struct ParallelGZipState*)stream->Meta.Inflate;
+	struct GZipJob* job;
+	cc_uint32 len;
+	cc_result res;
+	*modified = 0;
+	if (state->Result) return state->Result;
+
+	while (total > 0) {
+		job = &state->Jobs[state->UsedJobs];
+		len = min(total, GZIP_CHUNK_SIZE - job->InputLen);
+
+		Mem_Copy(job->Input + job->InputLen, data, len);
+		job->InputLen += len;
+		*modified     += len;
+		data += len; total -= len;
+		if (job->InputLen < GZIP_CHUNK_SIZE) continue;
+
+		/* Only start compressing once there is a piece for every thread */
+		job->Last = false;
+		if (++state->UsedJobs < state->NumJobs) continue;
+		if ((res = GZip_RunJobs(state))) { state->Result = res; return res; }
+	}
+	return 0;
+}
+
+static void GZip_FreeParallel(struct ParallelGZipState* state) {
+	int i;
+	for (i = 0; i < GZIP_MAX_JOBS; i++) {
+		Mem_Free(state->Jobs[i].Input);
+		Mem_Free(state->Jobs[i].Output);
+		Mem_Free(state->Jobs[i].State);
+	}
+	Mem_Free(state);
+}
+
+static cc_result GZip_ParallelClose(struct Stream* stream) {
+	struct ParallelGZipState* state = (struct ParallelGZipState*)stream->Meta.Inflate;
+	cc_uint8 data[8];
+	cc_result res = state->Result;
+
+	/* Last piece may be partially filled, or even empty */
+	if (!res) {
+		state->Jobs[state->UsedJobs].Last = true;
+		state->UsedJobs++;
+		res = GZip_RunJobs(state);
+	}
+
+	if (!res) {
+		Stream_SetU32_LE(&data[0], state->Crc32);
+		Stream_SetU32_LE(&data[4], state->Size);
+		res = Stream_Write(state->Dest, data, sizeof(data));
+	}
+
+	GZip_FreeParallel(state);
+	return res;
+}
+
+cc_result GZip_MakeParallelStream(struct Stream* stream, struct Stream* underlying, int level) {
+	struct ParallelGZipState* state;
+	struct GZipJob* job;
+	int i, count;
+
+	count = Thread_CoresCount();
+	Math_Clamp(count, 1, GZIP_MAX_JOBS);
+	state = (struct ParallelGZipState*)Mem_TryAllocCleared(1, sizeof(struct ParallelGZipState));
+	if (!state) return ERR_OUT_OF_MEMORY;
+
+	for (i = 0; i < count; i++) {
+		job = &state->Jobs[i];
+		job->Input  = (cc_uint8*)Mem_TryAlloc(GZIP_CHUNK_SIZE,     1);
+		job->Output = (cc_uint8*)Mem_TryAlloc(GZIP_CHUNK_OUT_SIZE, 1);
+		job->State  = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+
+		if (!job->Input || !job->Output || !job->State) {
+			GZip_FreeParallel(state);
+			return ERR_OUT_OF_MEMORY;
+		}
+	}
+
+	Stream_Init(stream);
+	stream->Meta.Inflate = state;
+	stream->Write = GZip_ParallelWrite;
+	stream->Close = GZip_ParallelClose;
+
+	state->Dest    = underlying;
+	state->Level   = level;
+	state->NumJobs = count;
+	return 0;
+}
+
+
 /*########################################################################################################################*
 *-----------------------------------------------------ZLib (compress)-----------------------------------------------------*
 *#########################################################################################################################*/
@@ -1207,36 +2157,16 @@ static cc_result Zip_ReadCentralDirectory(struct ZipState* state) {
 	return 0;
 }
 
-static cc_result Zip_ReadEndOfCentralDirectory(struct ZipState* state) {
-	struct Stream* stream = state->input;
-	cc_uint8 header[18];
-
-	cc_result res;
-	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
-
-	state->_totalEntries  = Stream_GetU16_LE(&header[6]);
-	state->_centralDirBeg = Stream_GetU32_LE(&header[12]);
-	return 0;
-}
-
 enum ZipSig {
 	ZIP_SIG_ENDOFCENTRALDIR = 0x06054b50,
 	ZIP_SIG_CENTRALDIR      = 0x02014b50,
 	ZIP_SIG_LOCALFILEHEADER = 0x04034b50
 };
 
-static cc_result Zip_DefaultProcessor(const cc_string* path, struct Stream* data, struct ZipState* s) { return 0; }
-static cc_bool Zip_DefaultSelector(const cc_string* path) { return true; }
-void Zip_Init(struct ZipState* state, struct Stream* input) {
-	state->input = input;
-	state->obj   = NULL;
-	state->ProcessEntry = Zip_DefaultProcessor;
-	state->SelectEntry  = Zip_DefaultSelector;
-}
-
-cc_result Zip_Extract(struct ZipState* state) {
-	struct Stream* stream = state->input;
-	cc_uint32 stream_len;
+/* Finds the end of central directory record, then seeks to the first central directory entry */
+static cc_result Zip_SeekCentralDirectory(struct Stream* stream, int* totalEntries, cc_uint32* centralDirSize) {
+	cc_uint8 header[18];
+	cc_uint32 stream_len, centralDirBeg;
 	cc_uint32 sig = 0;
 	int i, count;
 
@@ -1254,11 +2184,33 @@ cc_result Zip_Extract(struct ZipState* state) {
 	}
 
 	if (sig != ZIP_SIG_ENDOFCENTRALDIR) return ZIP_ERR_NO_END_OF_CENTRAL_DIR;
-	res = Zip_ReadEndOfCentralDirectory(state);
-	if (res) return res;
+	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
+
+	*totalEntries   = Stream_GetU16_LE(&header[6]);
+	*centralDirSize = Stream_GetU32_LE(&header[8]);
+	centralDirBeg   = Stream_GetU32_LE(&header[12]);
 
-	res = stream->Seek(stream, state->_centralDirBeg);
+	res = stream->Seek(stream, centralDirBeg);
 	if (res) return ZIP_ERR_SEEK_CENTRAL_DIR;
+	return 0;
+}
+
+static cc_result Zip_DefaultProcessor(const cc_string* path, struct Stream* data, struct ZipState* s) { return 0; }
+static cc_bool Zip_DefaultSelector(const cc_string* path) { return true; }
+void Zip_Init(struct ZipState* state, struct Stream* input) {
+	state->input = input;
+	state->obj   = NULL;
+	state->ProcessEntry = Zip_DefaultProcessor;
+	state->SelectEntry  = Zip_DefaultSelector;
+}
+
+cc_result Zip_Extract(struct ZipState* state) {
+	struct Stream* stream = state->input;
+	cc_uint32 sig = 0, centralDirSize;
+	int i;
+
+	cc_result res = Zip_SeekCentralDirectory(stream, &state->_totalEntries, &centralDirSize);
+	if (res) return res;
 	state->_usedEntries = 0;
 
 	/* Read all the central directory entries */
@@ -1289,3 +2241,176 @@ cc_result Zip_Extract(struct ZipState* state) {
 	}
 	return 0;
 }
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------ZipArchive-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Caseless hash of the filename of the given path */
+/* NOTE: Only the filename is hashed, so that entries can also be found by just their filename */
+static cc_uint32 ZipArchive_Hash(const cc_string* path) {
+	cc_string name = *path;
+	cc_uint32 hash = 2166136261UL;
+	char c;
+	int i;
+
+	Utils_UNSAFE_GetFilename(&name);
+	for (i = 0; i < name.length; i++) {
+		c = name.buffer[i]; Char_MakeLower(c);
+		hash = (hash ^ (cc_uint8)c) * 16777619UL;
+	}
+	return hash;
+}
+
+static cc_result ZipArchive_ReadEntry(struct ZipArchive* zip, cc_uint32* pathsUsed, cc_uint32 pathsSize) {
+	struct Stream* stream = zip->Input;
+	struct ZipArchiveEntry* entry;
+	cc_uint8 header[42];
+	cc_string path;
+	int pathLen, extraLen, commentLen, bucket;
+	cc_result res;
+	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
+
+	pathLen = Stream_GetU16_LE(&header[24]);
+	if (pathLen > pathsSize - *pathsUsed) return ZIP_ERR_FILENAME_LEN;
+
+	entry = &zip->Entries[zip->Count];
+	entry->Method            = Stream_GetU16_LE(&header[6]);
+	entry->CRC32             = Stream_GetU32_LE(&header[12]);
+	entry->CompressedSize    = Stream_GetU32_LE(&header[16]);
+	entry->UncompressedSize  = Stream_GetU32_LE(&header[20]);
+	entry->LocalHeaderOffset = Stream_GetU32_LE(&header[38]);
+	entry->PathOffset        = *pathsUsed;
+	entry->PathLength        = pathLen;
+
+	/* NOTE: ZIP spec says path uses code page 437 for encoding */
+	if ((res = Stream_Read(stream, (cc_uint8*)zip->_paths + *pathsUsed, pathLen))) return res;
+	*pathsUsed += pathLen;
+
+	/* skip data following central directory entry header */
+	extraLen   = Stream_GetU16_LE(&header[26]);
+	commentLen = Stream_GetU16_LE(&header[28]);
+	if ((res = stream->Skip(stream, extraLen + commentLen))) return res;
+
+	path   = ZipArchive_GetPath(zip, zip->Count);
+	bucket = ZipArchive_Hash(&path) & zip->_bucketsMask;
+	entry->_next = zip->_buckets[bucket];
+	zip->_buckets[bucket] = zip->Count++;
+	return 0;
+}
+
+cc_result ZipArchive_Open(struct ZipArchive* zip, struct Stream* input) {
+	cc_uint32 sig, centralDirSize, pathsUsed = 0;
+	int i, totalEntries, numBuckets;
+	cc_result res;
+
+	Mem_Set(zip, 0, sizeof(struct ZipArchive));
+	zip->Input = input;
+	res = Zip_SeekCentralDirectory(input, &totalEntries, &centralDirSize);
+	if (res) return res;
+
+	/* Keep hash buckets at most half full, so lookups rarely need to check more than one entry */
+	for (numBuckets = 16; numBuckets < totalEntries * 2; numBuckets *= 2) { }
+	zip->_bucketsMask = numBuckets - 1;
+
+	/* Paths are always smaller than the central directory they are stored in */
+	zip->Entries  = (struct ZipArchiveEntry*)Mem_TryAlloc(totalEntries + 1, sizeof(struct ZipArchiveEntry));
+	zip->_paths   = (char*)Mem_TryAlloc(centralDirSize + 1, 1);
+	zip->_buckets = (int*)Mem_TryAlloc(numBuckets, sizeof(int));
+
+	if (!zip->Entries || !zip->_paths || !zip->_buckets) {
+		ZipArchive_Close(zip); return ERR_OUT_OF_MEMORY;
+	}
+	for (i = 0; i < numBuckets; i++) zip->_buckets[i] = -1;
+
+	for (i = 0; i < totalEntries; i++) {
+		if ((res = Stream_ReadU32_LE(input, &sig))) break;
+
+		if (sig == ZIP_SIG_CENTRALDIR) {
+			res = ZipArchive_ReadEntry(zip, &pathsUsed, centralDirSize);
+			if (res) break;
+		} else if (sig == ZIP_SIG_ENDOFCENTRALDIR) {
+			break;
+		} else {
+			res = ZIP_ERR_INVALID_CENTRAL_DIR; break;
+		}
+	}
+
+	if (res) ZipArchive_Close(zip);
+	return res;
+}
+
+cc_string ZipArchive_GetPath(struct ZipArchive* zip, int index) {
+	struct ZipArchiveEntry* entry = &zip->Entries[index];
+	return String_Init(zip->_paths + entry->PathOffset, entry->PathLength, entry->PathLength);
+}
+
+int ZipArchive_Find(struct ZipArchive* zip, const cc_string* path) {
+	cc_string entryPath;
+	int i;
+	if (!zip->Count) return -1;
+
+	i = zip->_buckets[ZipArchive_Hash(path) & zip->_bucketsMask];
+	for (; i >= 0; i = zip->Entries[i]._next) {
+		entryPath = ZipArchive_GetPath(zip, i);
+		if (String_CaselessEquals(&entryPath, path)) return i;
+	}
+	return -1;
+}
+
+int ZipArchive_FindFilename(struct ZipArchive* zip, const cc_string* name) {
+	cc_string entryName;
+	int i;
+	if (!zip->Count) return -1;
+
+	i = zip->_buckets[ZipArchive_Hash(name) & zip->_bucketsMask];
+	for (; i >= 0; i = zip->Entries[i]._next) {
+		entryName = ZipArchive_GetPath(zip, i);
+		Utils_UNSAFE_GetFilename(&entryName);
+		if (String_CaselessEquals(&entryName, name)) return i;
+	}
+	return -1;
+}
+
+cc_result ZipArchive_OpenEntry(struct ZipArchive* zip, int index, struct Stream* stream, struct InflateState* inflate) {
+	struct ZipArchiveEntry* entry = &zip->Entries[index];
+	struct Stream* input = zip->Input;
+	cc_uint8 header[26];
+	cc_uint32 sig = 0;
+	int pathLen, extraLen;
+	cc_result res;
+
+	res = input->Seek(input, entry->LocalHeaderOffset);
+	if (res) return ZIP_ERR_SEEK_LOCAL_DIR;
+
+	if ((res = Stream_ReadU32_LE(input, &sig))) return res;
+	if (sig != ZIP_SIG_LOCALFILEHEADER) return ZIP_ERR_INVALID_LOCAL_DIR;
+	if ((res = Stream_Read(input, header, sizeof(header)))) return res;
+
+	/* local file may have extra data before actual data (e.g. ZIP64) */
+	pathLen  = Stream_GetU16_LE(&header[22]);
+	extraLen = Stream_GetU16_LE(&header[24]);
+	if ((res = input->Skip(input, pathLen + extraLen))) return res;
+
+	/* NOTE: Sizes from central directory are used, as some .zip files don't set them in local file header */
+	if (entry->Method == 0) {
+		Stream_ReadonlyPortion(stream, input, entry->UncompressedSize);
+		return 0;
+	} else if (entry->Method == 8) {
+		/* DEFLATE data marks its own end, so no need to limit reading to CompressedSize */
+		Inflate_MakeStream2(stream, inflate, input);
+		return 0;
+	}
+	return ZIP_ERR_COMP_METHOD;
+}
+
+void ZipArchive_Close(struct ZipArchive* zip) {
+	Mem_Free(zip->Entries);
+	Mem_Free(zip->_paths);
+	Mem_Free(zip->_buckets);
+
+	zip->Entries  = NULL;
+	zip->_paths   = NULL;
+	zip->_buckets = NULL;
+	zip->Count    = 0;
+}
@@ -27,22 +27,23 @@ cc_result ZLibHeader_Read(struct Stream* s, struct ZLibHeader* header);
 #define INFLATE_MAX_DISTS 32
 #define INFLATE_MAX_LITS_DISTS (INFLATE_MAX_LITS + INFLATE_MAX_DISTS)
 #define INFLATE_MAX_BITS 16
-#define INFLATE_FAST_BITS 9
 #define INFLATE_WINDOW_SIZE 0x8000UL
 #define INFLATE_WINDOW_MASK 0x7FFFUL
 
-struct HuffmanTable {
-	cc_int16 Fast[1 << INFLATE_FAST_BITS];      /* Fast lookup table for huffman codes */
-	cc_uint16 FirstCodewords[INFLATE_MAX_BITS]; /* Starting codeword for each bit length */
-	cc_uint16 EndCodewords[INFLATE_MAX_BITS];   /* (Last codeword + 1) for each bit length. 0 is ignored. */
-	cc_uint16 FirstOffsets[INFLATE_MAX_BITS];   /* Base offset into Values for codewords of each bit length. */
-	cc_uint16 Values[INFLATE_MAX_LITS];         /* Values/Symbols list */
-};
+/* Number of bits looked up at once in the main/first level table of each huffman table */
+#define INFLATE_CODELENS_BITS 7
+#define INFLATE_LITS_BITS     10
+#define INFLATE_DISTS_BITS    8
+/* Maximum number of entries in the main table and all second level tables combined */
+/* (computed using zlib's 'enough' tool - e.g. 'enough 288 10 15' for lits) */
+#define INFLATE_CODELENS_ENTRIES 128
+#define INFLATE_LITS_ENTRIES     1334
+#define INFLATE_DISTS_ENTRIES    402
 
 struct InflateState {
 	cc_uint8 State;
 	cc_bool LastBlock; /* Whether the last DEFLATE block has been encounted in the stream */
-	cc_uint32 Bits;    /* Holds bits across byte boundaries */
+	cc_uint64 Bits;    /* Holds bits across byte boundaries */
 	cc_uint32 NumBits; /* Number of bits in Bits buffer */
 
 	cc_uint8* NextIn;   /* Pointer within Input buffer to next byte that can be read */
@@ -59,10 +60,10 @@ struct InflateState {
 	cc_uint8 Input[INFLATE_MAX_INPUT];       /* Buffer for input to DEFLATE */
 	cc_uint8 Buffer[INFLATE_MAX_LITS_DISTS]; /* General purpose temp array */
 	union {
-		struct HuffmanTable CodeLens;       /* Values represent codeword lengths of lits/dists codewords */
-		struct HuffmanTable Lits;           /* Values represent literal or lengths */
+		cc_uint32 CodeLens[INFLATE_CODELENS_ENTRIES]; /* Values represent codeword lengths of lits/dists codewords */
+		cc_uint32 Lits[INFLATE_LITS_ENTRIES];         /* Values represent literal or lengths */
 	} Table; /* union to save on memory */
-	struct HuffmanTable TableDists;         /* Values represent distances back */
+	cc_uint32 TableDists[INFLATE_DISTS_ENTRIES];      /* Values represent distances back */
 	cc_uint8 Window[INFLATE_WINDOW_SIZE];    /* Holds circular buffer of recent output data, used for LZ77 */
 	cc_result result;
 };
@@ -76,40 +77,70 @@ void Inflate_Process(struct InflateState* s);
 /* NOTE: This only uncompresses pure DEFLATE compressed data. */
 /* If data starts with a GZIP or ZLIB header, use GZipHeader_Read or ZLibHeader_Read to first skip it. */
 CC_API void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, struct Stream* underlying);
+/* Logs how quickly the DEFLATE compressed data in the given files is decompressed. */
+/* Supports GZIP compressed files (e.g. .cw and .lvl maps) and PNG images. */
+void Inflate_Benchmark(const cc_string* paths, int count);
 
 
 #define DEFLATE_BLOCK_SIZE  16384
 #define DEFLATE_BUFFER_SIZE 32768
 #define DEFLATE_OUT_SIZE 8192
-#define DEFLATE_HASH_SIZE 0x1000UL
-#define DEFLATE_HASH_MASK 0x0FFFUL
+#define DEFLATE_HASH_BITS 14
+#define DEFLATE_HASH_SIZE (1UL << DEFLATE_HASH_BITS)
+/* Compression levels, from fastest to compressing the most */
+#define DEFLATE_LEVEL_FASTEST 1
+#define DEFLATE_LEVEL_DEFAULT 6
+#define DEFLATE_LEVEL_BEST    9
+
 struct DeflateState {
 	cc_uint32 Bits;         /* Holds bits across byte boundaries */
 	cc_uint32 NumBits;      /* Number of bits in Bits buffer */
 	cc_uint32 InputPosition;
+	/* Compression level, from DEFLATE_LEVEL_FASTEST to DEFLATE_LEVEL_BEST */
+	/* NOTE: Defaults to DEFLATE_LEVEL_DEFAULT, change after calling Deflate_MakeStream */
+	int Level;
 
 	cc_uint8* NextOut;    /* Pointer within Output buffer to next byte that can be written */
 	cc_uint32 AvailOut;   /* Max number of bytes that can be written to Output buffer */
 	struct Stream* Dest; /* Destination that Output buffer is written to */
 
-	cc_uint16 LitsCodewords[INFLATE_MAX_LITS]; /* Codewords for each value */
-	cc_uint8 LitsLens[INFLATE_MAX_LITS];       /* Bit lengths of each codeword */
+	cc_uint16 LitsCodewords[INFLATE_MAX_LITS];   /* Codewords for each value */
+	cc_uint8 LitsLens[INFLATE_MAX_LITS];         /* Bit lengths of each codeword */
+	cc_uint16 DistsCodewords[INFLATE_MAX_DISTS]; /* Codewords for each distance code */
+	cc_uint8 DistsLens[INFLATE_MAX_DISTS];       /* Bit lengths of each codeword */
+	cc_uint32 LitsFreqs[INFLATE_MAX_LITS];       /* Number of times each literal/length is used in current block */
+	cc_uint32 DistsFreqs[INFLATE_MAX_DISTS];     /* Number of times each distance code is used in current block */
+
+	cc_uint32 NumSymbols;                        /* Number of literals and matches found in current block */
+	cc_uint8 SymbolLens[DEFLATE_BLOCK_SIZE];     /* Literal value, or length of match minus 3 */
+	cc_uint16 SymbolDists[DEFLATE_BLOCK_SIZE];   /* 0 for literals, otherwise distance back of match */
 	
 	cc_uint8 Input[DEFLATE_BUFFER_SIZE];
 	cc_uint8 Output[DEFLATE_OUT_SIZE];
-	int Head[DEFLATE_HASH_SIZE];
-	int Prev[DEFLATE_BUFFER_SIZE];
-	cc_bool WroteHeader;
+	cc_uint16 Head[DEFLATE_HASH_SIZE];
+	cc_uint16 Prev[DEFLATE_BUFFER_SIZE];
 };
 /* Compresses input data using DEFLATE, then writes compressed output to another stream. Write only stream. */
 /* DEFLATE compression is pure compressed data, there is no header or footer. */
 CC_API void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying);
+/* Logs how quickly and how well the data in the given files is compressed at several levels, */
+/*  both as plain DEFLATE data and using a parallel GZIP stream. */
+/* Maps and PNG images are first decompressed, other files are compressed as is. */
+void Deflate_Benchmark(const cc_string* paths, int count);
 
 struct GZipState { struct DeflateState Base; cc_uint32 Crc32, Size; };
 /* Compresses input data using GZIP, then writes compressed output to another stream. Write only stream. */
 /* GZIP compression is GZIP header, followed by DEFLATE compressed data, followed by GZIP footer. */
 CC_API void GZip_MakeStream(struct Stream* stream, struct GZipState* state, struct Stream* underlying);
 
+/* Size of each piece of data compressed by a parallel GZIP stream */
+#define GZIP_CHUNK_SIZE (1024 * 1024)
+/* Compresses input data using GZIP on all cores, then writes compressed output to another stream. Write only stream. */
+/* Input is split into GZIP_CHUNK_SIZE pieces, which are compressed independently of each other at the given level. */
+/* NOTE: Returns ERR_OUT_OF_MEMORY if there isn't enough memory, in which case use GZip_MakeStream instead. */
+/* NOTE: Only one parallel GZIP stream can be written to at a time, and Close must always be called. */
+CC_API cc_result GZip_MakeParallelStream(struct Stream* stream, struct Stream* underlying, int level);
+
 struct ZLibState { struct DeflateState Base; cc_uint32 Adler32; };
 /* Compresses input data using ZLIB, then writes compressed output to another stream. Write only stream. */
 /* ZLIB compression is ZLIB header, followed by DEFLATE compressed data, followed by ZLIB footer. */
@@ -151,4 +182,46 @@ CC_API void Zip_Init(struct ZipState* state, struct Stream* input);
 /* Reads and processes the entries in a .zip archive. */
 /* NOTE: Must have been initialised with Zip_Init first. */
 CC_API cc_result Zip_Extract(struct ZipState* state);
+
+struct ZipArchiveEntry {
+	cc_uint32 CompressedSize, UncompressedSize, LocalHeaderOffset, CRC32;
+	cc_uint32 PathOffset;          /* Offset of the path of this entry within archive's path data */
+	cc_uint16 PathLength, Method;  /* Method is 0 for uncompressed, 8 for DEFLATE compressed */
+	int _next;                     /* (internal) Next entry in the same hash bucket, -1 if none */
+};
+
+/* Index of all the entries in a .zip archive, so that any entry can be found and read on demand */
+/*  (unlike Zip_Extract, which processes all the selected entries one after another) */
+struct ZipArchive {
+	/* Source of the .zip archive data. Must be seekable. */
+	struct Stream* Input;
+	/* Number of entries in the archive. */
+	int Count;
+	/* Data for each entry in the archive, in the order they are stored in the central directory. */
+	struct ZipArchiveEntry* Entries;
+
+	/* (internal) Paths of all the entries. */
+	char* _paths;
+	/* (internal) Index of first entry in each hash bucket, -1 if none. */
+	int* _buckets;
+	/* (internal) Number of hash buckets minus 1. */
+	int _bucketsMask;
+};
+
+/* Reads the central directory of a .zip archive, and builds an index of all its entries. */
+/* NOTE: Only the central directory is read, the data of each entry is only read when opened. */
+CC_API cc_result ZipArchive_Open(struct ZipArchive* zip, struct Stream* input);
+/* Returns the path of the given entry. */
+CC_API cc_string ZipArchive_GetPath(struct ZipArchive* zip, int index);
+/* Returns the index of the entry with the given path (case insensitive), or -1 if there is no such entry. */
+CC_API int ZipArchive_Find(struct ZipArchive* zip, const cc_string* path);
+/* Returns the index of an entry whose filename (i.e. path without any directories) */
+/*  is the given filename (case insensitive), or -1 if there is no such entry. */
+CC_API int ZipArchive_FindFilename(struct ZipArchive* zip, const cc_string* name);
+/* Seeks to the data of the given entry, and sets up 'stream' to read (and decompress if needed) it. */
+/* NOTE: All entries are read from Input, so 'stream' is only valid until another entry is opened. */
+/* (to read multiple entries at the same time, use another ZipArchive with a different Input stream) */
+CC_API cc_result ZipArchive_OpenEntry(struct ZipArchive* zip, int index, struct Stream* stream, struct InflateState* inflate);
+/* Frees the index of the entries. (does NOT close Input) */
+CC_API void ZipArchive_Close(struct ZipArchive* zip);
 #endif
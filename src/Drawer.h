@@ -34,4 +34,13 @@ CC_API void Drawer_ZMax(int count, PackedCol col, TextureLoc texLoc, struct Vert
 CC_API void Drawer_YMin(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices);
 /* Draws maximum Y face of the cuboid. (i.e. at Y2) */
 CC_API void Drawer_YMax(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices);
+
+/* The Drawer_XXXExt functions are the same as above, but use the given state instead of Drawer. */
+/* (This is so chunk meshes can be built on several background threads at once) */
+void Drawer_XMinExt(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices, const struct _DrawerData* state);
+void Drawer_XMaxExt(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices, const struct _DrawerData* state);
+void Drawer_ZMinExt(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices, const struct _DrawerData* state);
+void Drawer_ZMaxExt(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices, const struct _DrawerData* state);
+void Drawer_YMinExt(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices, const struct _DrawerData* state);
+void Drawer_YMaxExt(int count, PackedCol col, TextureLoc texLoc, struct VertexTextured** vertices, const struct _DrawerData* state);
 #endif
@@ -379,9 +379,15 @@ static int CalcRainHeightAt(int x, int maxY, int z, int hIndex) {
 	cc_uint8 draw;
 
 #ifndef EXTENDED_BLOCKS
-	RainCalcBody(World.Blocks[i]);
+	if (World.Sections) {
+		RainCalcBody(World_GetSectionBlock(x, y, z));
+	} else {
+		RainCalcBody(World.Blocks[i]);
+	}
 #else
-	if (World.IDMask <= 0xFF) {
+	if (World.Sections) {
+		RainCalcBody(World_GetSectionBlock(x, y, z));
+	} else if (World.IDMask <= 0xFF) {
 		RainCalcBody(World.Blocks[i]);
 	} else {
 		RainCalcBody(World.Blocks[i] | (World.Blocks2[i] << 8));
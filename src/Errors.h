@@ -108,6 +108,8 @@ enum CC_ERRORS {
 	INF_ERR_NUM_CODES    = 0xCCDED056UL, /* Too many codewords specified for bit length */
 
 	ERR_DOWNLOAD_INVALID = 0xCCDED057UL, /* Unspecified error occurred downloading data */
-	ERR_NO_AUDIO_OUTPUT  = 0xCCDED058UL  /* No audio output devices are connected */
+	ERR_NO_AUDIO_OUTPUT  = 0xCCDED058UL, /* No audio output devices are connected */
+
+	ZIP_ERR_COMP_METHOD  = 0xCCDED059UL  /* ZIP entry uses unsupported compression method */
 };
 #endif
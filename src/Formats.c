@@ -16,17 +16,35 @@
 #include "Chat.h"
 #include "Inventory.h"
 #include "TexturePack.h"
+#include "Options.h"
 
 
 /*########################################################################################################################*
 *--------------------------------------------------------General----------------------------------------------------------*
 *#########################################################################################################################*/
+/* Whether the blocks of a map with the given volume should be read into sections */
+static cc_bool Map_UseSections(int volume) {
+	return volume > WORLD_MAX_FLAT_VOLUME;
+}
+
 static cc_result Map_ReadBlocks(struct Stream* stream) {
 	World.Volume = World.Width * World.Length * World.Height;
-	World.Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+	if (!Map_UseSections(World.Volume)) {
+		World.Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+		if (World.Blocks) return Stream_Read(stream, World.Blocks, World.Volume);
+	}
+	/* Map is too large for (or there isn't enough memory for) a flat array */
+	return World_ReadSections(stream);
+}
 
-	if (!World.Blocks) return ERR_OUT_OF_MEMORY;
-	return Stream_Read(stream, World.Blocks, World.Volume);
+static cc_result Map_WriteBlocks(struct Stream* stream) {
+	if (World.Sections) return World_WriteSections(stream);
+	return Stream_Write(stream, World.Blocks, World.Volume);
+}
+
+/* Whether the upper 8 bits of blocks also need to be written */
+static cc_bool Map_HasUpperBlocks(void) {
+	return World.Sections ? World.IDMask > 0xFF : World.Blocks != World.Blocks2;
 }
 
 static cc_result Map_SkipGZipHeader(struct Stream* stream) {
@@ -137,7 +155,7 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 				if ((res = Stream_Read(stream, chunk, sizeof(chunk)))) return res;
 				baseIndex = World_Pack(x, y, z);
 
-				if ((x + LVL_CHUNKSIZE) <= adjWidth && (y + LVL_CHUNKSIZE) <= adjHeight && (z + LVL_CHUNKSIZE) <= adjLength) {
+				if (World.Blocks && (x + LVL_CHUNKSIZE) <= adjWidth && (y + LVL_CHUNKSIZE) <= adjHeight && (z + LVL_CHUNKSIZE) <= adjLength) {
 					for (i = 0; i < sizeof(chunk); i++) {
 						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
 
@@ -149,8 +167,8 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
 						if ((x + xx) >= World.Width || (y + yy) >= World.Height || (z + zz) >= World.Length) continue;
 
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+						if (World_GetBlock(x + xx, y + yy, z + zz) != LVL_CUSTOMTILE) continue;
+						World_SetBlock(x + xx, y + yy, z + zz, chunk[i]);
 					}
 				}
 			}
@@ -159,15 +177,23 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 	return 0;
 }
 
+/* Converts the .lvl block IDs read from the source stream into classic block IDs */
+static cc_result Lvl_ConvertRead(struct Stream* s, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	struct Stream* source = s->Meta.Portion.Source;
+	cc_result res = source->Read(source, data, count, modified);
+	cc_uint32 i;
+
+	for (i = 0; i < *modified; i++) { data[i] = Lvl_table[data[i]]; }
+	return res;
+}
+
 cc_result Lvl_Load(struct Stream* stream) {
 	cc_uint8 header[18];
-	cc_uint8* blocks;
 	cc_uint8 section;
 	cc_result res;
-	int i;
 
 	struct LocalPlayer* p = &LocalPlayer_Instance;
-	struct Stream compStream;
+	struct Stream compStream, convStream;
 	struct InflateState state;
 	Inflate_MakeStream2(&compStream, &state, stream);
 	
@@ -186,18 +212,11 @@ cc_result Lvl_Load(struct Stream* stream) {
 	p->SpawnPitch = Math_Packed2Deg(header[15]);
 	/* (2) pervisit, perbuild permissions */
 
-	if ((res = Map_ReadBlocks(&compStream))) return res;
-	blocks = World.Blocks;
-	/* Bulk convert 4 blocks at once */
-	for (i = 0; i < (World.Volume & ~3); i += 4) {
-		*blocks = Lvl_table[*blocks]; blocks++;
-		*blocks = Lvl_table[*blocks]; blocks++;
-		*blocks = Lvl_table[*blocks]; blocks++;
-		*blocks = Lvl_table[*blocks]; blocks++;
-	}
-	for (; i < World.Volume; i++) {
-		*blocks = Lvl_table[*blocks]; blocks++;
-	}
+	/* Blocks are converted as they are read, as they may be read straight into world sections */
+	Stream_Init(&convStream);
+	convStream.Read = Lvl_ConvertRead;
+	convStream.Meta.Portion.Source = &compStream;
+	if ((res = Map_ReadBlocks(&convStream))) return res;
 
 	/* 0xBD section type is not present in older .lvl files */
 	res = compStream.ReadU8(&compStream, &section);
@@ -368,6 +387,7 @@ static cc_result Nbt_ReadString(struct Stream* stream, cc_string* str) {
 }
 
 typedef void (*Nbt_Callback)(struct NbtTag* tag);
+static cc_bool Cw_ReadBlockArray(struct NbtTag* tag, struct Stream* stream, cc_result* res);
 static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream* stream, struct NbtTag* parent, Nbt_Callback callback) {
 	struct NbtTag tag;
 	cc_uint8 childType;
@@ -408,6 +428,8 @@ static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream
 
 		if (NbtTag_IsSmall(&tag)) {
 			res = Stream_Read(stream, tag.value.small, tag.dataSize);
+		} else if (Cw_ReadBlockArray(&tag, stream, &res)) {
+			tag.value.big = NULL;
 		} else {
 			tag.value.big = (cc_uint8*)Mem_TryAlloc(tag.dataSize, 1);
 			if (!tag.value.big) return ERR_OUT_OF_MEMORY;
@@ -525,11 +547,30 @@ static void Cw_Callback_1(struct NbtTag* tag) {
 
 	if (IsTag(tag, "BlockArray")) {
 		World.Volume = tag->dataSize;
-		World.Blocks = Cw_GetBlocks(tag);
+		/* Blocks of large maps were already read into sections by Cw_ReadBlockArray */
+		if (!World.Sections) World.Blocks = Cw_GetBlocks(tag);
+	}
+#ifdef EXTENDED_BLOCKS
+	if (IsTag(tag, "BlockArray2") && !World.Sections) World_SetMapUpper(Cw_GetBlocks(tag));
+#endif
+}
+
+/* Reads the blocks of large maps straight into world sections, instead of allocating memory for the whole array */
+static cc_bool Cw_ReadBlockArray(struct NbtTag* tag, struct Stream* stream, cc_result* res) {
+	int volume = World.Width * World.Height * World.Length;
+	/* Only for ClassicWorld -> BlockArray, when dimensions were given before the blocks */
+	if (!tag->parent || tag->parent->parent) return false;
+	if (!volume || tag->dataSize != volume)  return false;
+
+	if (IsTag(tag, "BlockArray") && Map_UseSections(volume)) {
+		*res = World_ReadSections(stream); return true;
 	}
 #ifdef EXTENDED_BLOCKS
-	if (IsTag(tag, "BlockArray2")) World_SetMapUpper(Cw_GetBlocks(tag));
+	if (IsTag(tag, "BlockArray2") && World.Sections) {
+		*res = World_ReadSectionsUpper(stream); return true;
+	}
 #endif
+	return false;
 }
 
 static void Cw_Callback_2(struct NbtTag* tag) {
@@ -1123,14 +1164,15 @@ cc_result Cw_Save(struct Stream* stream) {
 		tmp[112] = Math_Deg2Packed(p->SpawnPitch);
 	}
 	if ((res = Stream_Write(stream, tmp,      sizeof(cw_begin)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume))) return res;
+	if ((res = Map_WriteBlocks(stream)))                     return res;
 
-	if (World.Blocks != World.Blocks2) {
+	if (Map_HasUpperBlocks()) {
 		Mem_Copy(tmp, cw_map2, sizeof(cw_map2));
 		Stream_SetU32_BE(&tmp[14], World.Volume);
 
 		if ((res = Stream_Write(stream, tmp,        sizeof(cw_map2)))) return res;
-		if ((res = Stream_Write(stream, World.Blocks2, World.Volume))) return res;
+		res = World.Sections ? World_WriteSectionsUpper(stream) : Stream_Write(stream, World.Blocks2, World.Volume);
+		if (res) return res;
 	}
 
 	Mem_Copy(tmp, cw_meta_cpe, sizeof(cw_meta_cpe));
@@ -1196,7 +1238,7 @@ cc_result Schematic_Save(struct Stream* stream) {
 		Stream_SetU32_BE(&tmp[74], World.Volume);
 	}
 	if ((res = Stream_Write(stream, tmp, sizeof(sc_begin)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume))) return res;
+	if ((res = Map_WriteBlocks(stream)))                  return res;
 
 	Mem_Copy(tmp, sc_data, sizeof(sc_data));
 	{
@@ -1210,3 +1252,220 @@ cc_result Schematic_Save(struct Stream* stream) {
 	}
 	return Stream_Write(stream, sc_end, sizeof(sc_end));
 }
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------Map saving-------------------------------------------------------*
+*#########################################################################################################################*/
+#ifdef CC_BUILD_WEB
+/* Web client saves maps in the save level menu instead, as the saved map may need to be downloaded */
+struct IGameComponent Formats_Component = { NULL };
+#else
+static cc_result Map_Encode(struct Stream* stream, const cc_string* path) {
+	static const cc_string cw = String_FromConst(".cw");
+	if (String_CaselessEnds(path, &cw)) return Cw_Save(stream);
+	return Schematic_Save(stream);
+}
+
+/* Compression level used when saving maps (1 is fastest, 9 gives smallest files) */
+static int Map_SaveLevel(void) {
+	return Options_GetInt(OPT_MAP_SAVE_LEVEL, DEFLATE_LEVEL_FASTEST, DEFLATE_LEVEL_BEST, DEFLATE_LEVEL_DEFAULT);
+}
+
+/* Encodes and compresses the map directly into the given file, then closes it */
+static cc_result Map_SaveDirectly(struct Stream* stream, const cc_string* path) {
+	struct Stream compStream;
+	struct GZipState state;
+	cc_result res;
+	GZip_MakeStream(&compStream, &state, stream);
+	state.Base.Level = Map_SaveLevel();
+
+	if ((res = Map_Encode(&compStream, path))) {
+		stream->Close(stream);
+		Logger_SysWarn2(res, "encoding", path); return res;
+	}
+
+	if ((res = compStream.Close(&compStream))) {
+		stream->Close(stream);
+		Logger_SysWarn2(res, "closing", path); return res;
+	}
+
+	res = stream->Close(stream);
+	if (res) { Logger_SysWarn2(res, "closing", path); return res; }
+
+	Chat_Add1("&eSaved map to: %s", path);
+	return 0;
+}
+
+/* Compressing a large map can take several seconds, so the map is instead first encoded into memory */
+/*  (which is quick, since the blocks just need to be copied), and then the encoded map is compressed */
+/*  and written to disc on a background thread, so that the game can continue to run meanwhile. */
+/* Size of each part of the encoded map that is compressed at once (progress is updated after each part) */
+#define MAP_SAVE_PART_SIZE (64 * 1024)
+/* Upper limit on size of the map metadata (dimensions, environment settings) other than block definitions */
+#define MAP_SAVE_METADATA_SIZE 4096
+/* Upper limit on size of each block definition (see tmp in Cw_WriteBockDef) */
+#define MAP_SAVE_BLOCKDEF_SIZE 512
+
+static struct Stream save_file;
+static struct GZipState* save_state;
+static cc_uint8* save_data;
+static cc_uint32 save_length;
+static void* save_thread;
+static cc_result save_result;
+static volatile cc_uint32 save_written;
+static volatile cc_bool save_done;
+static int save_lastProgress, save_level;
+static char save_pathBuffer[FILENAME_SIZE];
+static cc_string save_path = String_FromArray(save_pathBuffer);
+
+static void MapSave_Run(void) {
+	struct Stream compStream;
+	cc_uint32 i, count;
+	cc_result res, closeRes;
+
+	/* Compress on all cores if possible, otherwise just on this thread */
+	res = GZip_MakeParallelStream(&compStream, &save_file, save_level);
+	if (res) {
+		GZip_MakeStream(&compStream, save_state, &save_file);
+		save_state->Base.Level = save_level;
+		res = 0;
+	}
+
+	for (i = 0; i < save_length && !res; i += count) {
+		count = min(save_length - i, MAP_SAVE_PART_SIZE);
+		res   = Stream_Write(&compStream, save_data + i, count);
+		save_written = i + count;
+	}
+
+	/* Parallel stream must always be closed, as that frees its memory */
+	closeRes = compStream.Close(&compStream);
+	if (!res) res = closeRes;
+	save_result = res;
+	save_done   = true;
+}
+
+static void MapSave_FreeData(void) {
+	Mem_Free(save_data);
+	Mem_Free(save_state);
+	save_data  = NULL;
+	save_state = NULL;
+}
+
+/* Waits for the background thread to finish compressing, then closes the file */
+static cc_result MapSave_Wait(void) {
+	cc_result res;
+	Thread_Join(save_thread);
+	save_thread = NULL;
+	MapSave_FreeData();
+
+	res = save_result;
+	if (res) { save_file.Close(&save_file); return res; }
+	return save_file.Close(&save_file);
+}
+
+static void MapSave_Finish(void) {
+	cc_result res = MapSave_Wait();
+	Chat_AddOf(&String_Empty, MSG_TYPE_CLIENTSTATUS_3);
+
+	if (res) {
+		Logger_SysWarn2(res, "saving", &save_path);
+	} else {
+		Chat_Add1("&eSaved map to: %s", &save_path);
+	}
+}
+
+static void MapSave_Tick(struct ScheduledTask* task) {
+	cc_string msg; char msgBuffer[STRING_SIZE];
+	int progress;
+	if (!save_thread) return;
+	if (save_done) { MapSave_Finish(); return; }
+
+	progress = (int)((float)save_written / save_length * 100);
+	if (progress == save_lastProgress) return;
+	save_lastProgress = progress;
+
+	String_InitArray(msg, msgBuffer);
+	String_Format1(&msg, "&eSaving map (&7%i&e%%)", &progress);
+	Chat_AddOf(&msg, MSG_TYPE_CLIENTSTATUS_3);
+}
+
+/* Returns an upper limit on the size of everything in the encoded map other than the blocks */
+static cc_uint32 Map_MetadataSize(void) {
+	cc_uint32 size = MAP_SAVE_METADATA_SIZE;
+	int b;
+
+	for (b = 1; b <= BLOCK_MAX_DEFINED; b++) {
+		if (Block_IsCustomDefined(b)) size += MAP_SAVE_BLOCKDEF_SIZE;
+	}
+	return size;
+}
+
+cc_result Map_SaveTo(const cc_string* path) {
+	static const cc_string cw = String_FromConst(".cw");
+	struct Stream stream;
+	cc_uint64 size;
+	cc_result res;
+	/* Only one map is saved at a time */
+	if (save_thread) MapSave_Finish();
+
+	res = Stream_CreateFile(&save_file, path);
+	if (res) { Logger_SysWarn2(res, "creating", path); return res; }
+
+	/* .schematic maps also have a 'Data' array, .cw maps may also have the upper 8 bits of blocks */
+	size = (cc_uint64)World.Volume * 2;
+	if (String_CaselessEnds(path, &cw) && !Map_HasUpperBlocks()) size = World.Volume;
+	size += Map_MetadataSize();
+
+	if (size <= 0x7FFFFFFFUL) {
+		save_data  = (cc_uint8*)Mem_TryAlloc((cc_uint32)size, 1);
+		save_state = (struct GZipState*)Mem_TryAlloc(1, sizeof(struct GZipState));
+	}
+
+	/* Not enough memory to copy the map, so just save it directly instead */
+	if (!save_data || !save_state) {
+		MapSave_FreeData();
+		return Map_SaveDirectly(&save_file, path);
+	}
+
+	Stream_WriteonlyMemory(&stream, save_data, (cc_uint32)size);
+	res = Map_Encode(&stream, path);
+
+	/* Encoded map didn't fit in the buffer, so just save it directly instead */
+	/* (nothing has been written to the file yet, so it can still be used) */
+	if (res == ERR_END_OF_STREAM) {
+		MapSave_FreeData();
+		return Map_SaveDirectly(&save_file, path);
+	}
+
+	if (res) {
+		MapSave_FreeData();
+		save_file.Close(&save_file);
+		Logger_SysWarn2(res, "encoding", path); return res;
+	}
+
+	save_length  = stream.Meta.Mem.Length - stream.Meta.Mem.Left;
+	save_written = 0;
+	save_done    = false;
+	save_lastProgress = -1;
+	save_level = Map_SaveLevel();
+	String_Copy(&save_path, path);
+
+	save_thread = Thread_Start(MapSave_Run);
+	return 0;
+}
+
+static void MapSave_Init(void) {
+	ScheduledTask_Add(GAME_DEF_TICKS, MapSave_Tick);
+}
+
+/* Make sure the map has been completely written to disc before exiting */
+static void MapSave_Free(void) {
+	if (save_thread) MapSave_Wait();
+}
+
+struct IGameComponent Formats_Component = {
+	MapSave_Init, /* Init */
+	MapSave_Free  /* Free */
+};
+#endif
@@ -6,6 +6,9 @@
 */
 
 struct Stream;
+struct IGameComponent;
+extern struct IGameComponent Formats_Component;
+
 /* Imports a world encoded in a particular map file format. */
 typedef cc_result (*IMapImporter)(struct Stream* stream);
 /* Attempts to find a suitable importer based on filename. */
@@ -14,6 +17,11 @@ CC_API IMapImporter Map_FindImporter(const cc_string* path);
 /* Attempts to import the map from the given file. */
 /* NOTE: Uses Map_FindImporter to import based on filename. */
 CC_API void Map_LoadFrom(const cc_string* path);
+/* Saves the map to the given file. (.cw format if filename ends with .cw, otherwise .schematic format) */
+/* NOTE: The map is copied to memory first, then compressed and written to disc on a background thread. */
+/*  (changes made to the map after this returns are not saved, and a chat message is shown once saved) */
+/* NOTE: Not available in the web client. */
+CC_API cc_result Map_SaveTo(const cc_string* path);
 
 /* Imports a world from a .lvl MCSharp server map file. */
 /* Used by MCSharp/MCLawl/MCForge/MCDzienny/MCGalaxy. */
@@ -36,6 +36,8 @@
 #include "Protocol.h"
 #include "Picking.h"
 #include "Animations.h"
+#include "BlockPhysics.h"
+#include "Formats.h"
 
 struct _GameData Game;
 cc_bool Game_UseCPEBlocks;
@@ -180,6 +182,38 @@ void Game_UpdateBlock(int x, int y, int z, BlockID block) {
 	}
 	Lighting_OnBlockChanged(x, y, z, old, block);
 	MapRenderer_OnBlockChanged(x, y, z, block);
+	Physics_OnBlockUpdated(x, y, z, old, block);
+}
+
+void Game_UpdateBlocks(const int* indices, const BlockID* blocks, int count) {
+	int i, index, chunk, lastChunk = -1;
+	int x, y, z;
+	BlockID old, now;
+
+	for (i = 0; i < count; i++) {
+		index = indices[i];
+		now   = blocks[i];
+		/* Same as World_Unpack, but with fewer divisions */
+		y = index / World.OneY; index -= y * World.OneY;
+		z = index / World.Width;
+		x = index - z * World.Width;
+
+		old = World_GetBlock(x, y, z);
+		World_SetBlock(x, y, z, now);
+
+		if (Weather_Heightmap) {
+			EnvRenderer_OnBlockChanged(x, y, z, old, now);
+		}
+		Lighting_OnBlockChanged(x, y, z, old, now);
+
+		/* Consecutive blocks are usually in the same chunk, which only needs to be marked for rebuilding once */
+		chunk = MapRenderer_Pack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+		if (chunk != lastChunk || Blocks.Draw[now] != DRAW_GAS) {
+			MapRenderer_OnBlockChanged(x, y, z, now);
+			lastChunk = chunk;
+		}
+		Physics_OnBlockUpdated(x, y, z, old, now);
+	}
 }
 
 void Game_ChangeBlock(int x, int y, int z, BlockID block) {
@@ -392,6 +426,7 @@ static void Game_Load(void) {
 	Game_AddComponent(&PickedPosRenderer_Component);
 	Game_AddComponent(&Audio_Component);
 	Game_AddComponent(&AxisLinesRenderer_Component);
+	Game_AddComponent(&Formats_Component);
 
 	LoadPlugins();
 	for (comp = comps_head; comp; comp = comp->next) {
@@ -429,14 +464,17 @@ static void UpdateViewMatrix(void) {
 }
 
 static void Game_Render3D(double delta, float t) {
+	cc_uint64 beg;
 	Vec3 pos;
 
 	EnvRenderer_UpdateFog();
 	if (EnvRenderer_ShouldRenderSkybox()) EnvRenderer_RenderSkybox();
 
 	AxisLinesRenderer_Render();
+	beg = Game_BeginStage();
 	Entities_RenderModels(delta, t);
 	Entities_RenderNames();
+	Game_EndStage(GAME_STAGE_ENTITIES, beg);
 
 	Particles_Render(t);
 	Camera.Active->GetPickedBlock(&Game_SelectedPos); /* TODO: only pick when necessary */
@@ -444,7 +482,9 @@ static void Game_Render3D(double delta, float t) {
 	EnvRenderer_RenderClouds();
 
 	MapRenderer_Update(delta);
+	beg = Game_BeginStage();
 	MapRenderer_RenderNormal(delta);
+	Game_EndStage(GAME_STAGE_NORMAL, beg);
 	EnvRenderer_RenderMapSides();
 
 	Entities_DrawShadows();
@@ -535,6 +575,7 @@ void Game_TakeScreenshot(void) {
 
 static void Game_RenderFrame(double delta) {
 	struct ScheduledTask entTask;
+	cc_uint64 beg;
 	float t;
 
 	/* TODO: Should other tasks get called back too? */
@@ -581,9 +622,11 @@ static void Game_RenderFrame(double delta) {
 		RayTracer_SetInvalid(&Game_SelectedPos);
 	}
 
+	beg = Game_BeginStage();
 	Gfx_Begin2D(Game.Width, Game.Height);
 	Gui_RenderGui(delta);
 	Gfx_End2D();
+	Game_EndStage(GAME_STAGE_GUI, beg);
 
 	if (Game_ScreenshotRequested) Game_TakeScreenshot();
 	Gfx_EndFrame();
@@ -606,6 +649,77 @@ void Game_Free(void* obj) {
 	Options_SaveIfChanged();
 }
 
+int Game_BenchmarkFrames;
+static cc_uint64 stageTimes[GAME_STAGE_COUNT];
+static const char* const stageNames[GAME_STAGE_COUNT] = {
+	"Chunk sorting", "Chunk building", "Normal chunks", "Entities", "GUI"
+};
+/* Fixed time between frames, so every run renders exactly the same frames */
+#define BENCHMARK_DELTA (1.0 / 60.0)
+
+cc_uint64 Game_BeginStage(void) {
+	return Game_BenchmarkFrames ? Stopwatch_Measure() : 0;
+}
+
+void Game_EndStage(int stage, cc_uint64 beg) {
+	if (!Game_BenchmarkFrames) return;
+	stageTimes[stage] += Stopwatch_Measure() - beg;
+}
+
+/* Moves the camera along a circle around the map, always looking down towards the map centre */
+static void Benchmark_MoveCamera(int frame) {
+	struct LocalPlayer* p = &LocalPlayer_Instance;
+	struct LocationUpdate update;
+	float angle  = (2.0f * MATH_PI * frame) / Game_BenchmarkFrames;
+	float radius = min(World.Width, World.Length) * 0.4f;
+	float dx, dz, yaw;
+	Vec3 pos;
+
+	dx = Math_CosF(angle) * radius;
+	dz = Math_SinF(angle) * radius;
+	pos.X = World.Width  * 0.5f + dx;
+	pos.Y = World.Height * 0.75f;
+	pos.Z = World.Length * 0.5f + dz;
+	/* Direction to centre is (-dx, -dz) */
+	yaw = (float)Math_Atan2(dz, -dx) * MATH_RAD2DEG;
+
+	p->Hacks.Flying = true;
+	LocationUpdate_MakePosAndOri(&update, pos, yaw, 30.0f, false);
+	p->Base.VTABLE->SetLocation(&p->Base, &update, false);
+}
+
+static void Game_RunBenchmark(void) {
+	cc_uint64 beg, end;
+	float totalMs, stageMs, frameMs;
+	int i, threads;
+
+	Gfx_SetFpsLimit(false, 0);
+	beg = Stopwatch_Measure();
+
+	for (i = 0; i < Game_BenchmarkFrames; i++) {
+		Window_ProcessEvents();
+		if (!WindowInfo.Exists) return;
+
+		Benchmark_MoveCamera(i);
+		Game_RenderFrame(BENCHMARK_DELTA);
+	}
+
+	end     = Stopwatch_Measure();
+	totalMs = Stopwatch_ElapsedMicroseconds(beg, end) / 1000.0f;
+	frameMs = totalMs / Game_BenchmarkFrames;
+	Platform_Log3("Benchmark: %i frames took %f2 ms (%f3 ms per frame)", &Game_BenchmarkFrames, &totalMs, &frameMs);
+	/* Chunk building times depend on how many background threads chunks were built on */
+	threads = Builder_WorkersCount();
+	Platform_Log1("  Chunk builder threads: %i", &threads);
+
+	for (i = 0; i < GAME_STAGE_COUNT; i++) {
+		stageMs = Stopwatch_ElapsedMicroseconds(0, stageTimes[i]) / 1000.0f;
+		frameMs = stageMs / Game_BenchmarkFrames;
+		Platform_Log3("  %c: %f2 ms (%f3 ms per frame)", stageNames[i], &stageMs, &frameMs);
+	}
+	Window_Close();
+}
+
 #define Game_DoFrameBody() \
 	Window_ProcessEvents();\
 	if (!WindowInfo.Exists) return;\
@@ -657,5 +771,10 @@ void Game_Run(int width, int height, const cc_string* title) {
 
 	Game_Load();
 	Event_RaiseVoid(&WindowEvents.Resized);
-	Game_RunLoop();
+
+	if (Game_BenchmarkFrames) {
+		Game_RunBenchmark();
+	} else {
+		Game_RunLoop();
+	}
 }
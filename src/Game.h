@@ -63,6 +63,9 @@ void Game_Reset(void);
 /* (updating state means recalculating light, redrawing chunk block is in, etc) */
 /* NOTE: This does NOT notify the server, use Game_ChangeBlock for that. */
 CC_API void Game_UpdateBlock(int x, int y, int z, BlockID block);
+/* Same as calling Game_UpdateBlock for each block in turn, but cheaper for large numbers of blocks. */
+/* (indices are packed coordinates, see World_Pack) */
+CC_API void Game_UpdateBlocks(const int* indices, const BlockID* blocks, int count);
 /* Calls Game_UpdateBlock, then informs server connection of the block change. */
 /* In multiplayer this is sent to the server, in singleplayer just activates physics. */
 CC_API void Game_ChangeBlock(int x, int y, int z, BlockID block);
@@ -80,6 +83,19 @@ void Game_SetFpsLimit(int method);
 
 /* Runs the main game loop until the window is closed. */
 void Game_Run(int width, int height, const cc_string* title);
+
+/* Stages of rendering a frame whose time taken is measured when benchmarking. */
+enum GameStage {
+	GAME_STAGE_SORT, GAME_STAGE_BUILD, GAME_STAGE_NORMAL, GAME_STAGE_ENTITIES, GAME_STAGE_GUI, GAME_STAGE_COUNT
+};
+/* Number of frames Game_Run renders before exiting, or 0 to run until the window is closed. */
+/* When non-zero, the camera flies along a fixed path around the map with a fixed time between frames, */
+/*  and the total time taken by each rendering stage is logged once all frames have been rendered. */
+extern int Game_BenchmarkFrames;
+/* Returns the time the given stage started at, if rendering stages are being measured. */
+cc_uint64 Game_BeginStage(void);
+/* Adds the time elapsed since the given start time to the total time taken by the given stage. */
+void Game_EndStage(int stage, cc_uint64 beg);
 /* Whether the game should be allowed to automatically close */
 cc_bool Game_ShouldClose(void);
 
@@ -641,9 +641,10 @@ void NotchyGen_Generate(void) {
 BlockRaw* Tree_Blocks;
 RNGState* Tree_Rnd;
 
+#define TreeGen_GetBlock(x, y, z) (Tree_Blocks ? Tree_Blocks[World_Pack(x, y, z)] : World_GetBlock(x, y, z))
+
 cc_bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 	int baseHeight = treeHeight - 4;
-	int index;
 	int x, y, z;
 
 	/* check tree base */
@@ -652,8 +653,7 @@ cc_bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 			for (x = treeX - 1; x <= treeX + 1; x++) {
 
 				if (!World_Contains(x, y, z)) return false;
-				index = World_Pack(x, y, z);
-				if (Tree_Blocks[index] != BLOCK_AIR) return false;
+				if (TreeGen_GetBlock(x, y, z) != BLOCK_AIR) return false;
 			}
 		}
 	}
@@ -664,8 +664,7 @@ cc_bool TreeGen_CanGrow(int treeX, int treeY, int treeZ, int treeHeight) {
 			for (x = treeX - 2; x <= treeX + 2; x++) {
 
 				if (!World_Contains(x, y, z)) return false;
-				index = World_Pack(x, y, z);
-				if (Tree_Blocks[index] != BLOCK_AIR) return false;
+				if (TreeGen_GetBlock(x, y, z) != BLOCK_AIR) return false;
 			}
 		}
 	}
@@ -21,6 +21,7 @@ extern BlockRaw* Gen_Blocks;
 void FlatgrassGen_Generate(void);
 void NotchyGen_Generate(void);
 
+/* Blocks checked by TreeGen_CanGrow. NULL to check the blocks in the world instead. */
 extern BlockRaw* Tree_Blocks;
 extern RNGState* Tree_Rnd;
 /* Appropriate buffer size to hold positions and blocks generated by the tree generator. */
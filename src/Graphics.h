@@ -12,7 +12,7 @@ struct IGameComponent;
 extern struct IGameComponent Gfx_Component;
 
 typedef enum VertexFormat_ {
-	VERTEX_FORMAT_COLOURED, VERTEX_FORMAT_TEXTURED
+	VERTEX_FORMAT_COLOURED, VERTEX_FORMAT_TEXTURED, VERTEX_FORMAT_PACKED
 } VertexFormat;
 typedef enum FogFunc_ {
 	FOG_LINEAR, FOG_EXP, FOG_EXP2
@@ -23,11 +23,22 @@ typedef enum MatrixType_ {
 
 #define SIZEOF_VERTEX_COLOURED 16
 #define SIZEOF_VERTEX_TEXTURED 24
+#define SIZEOF_VERTEX_PACKED   16
+/* Number of fixed point units per 1.0 in the position of packed vertices */
+/* NOTE: Positions can therefore only be between -64 and 64 (relative to the origin of the vertices) */
+#define PACKED_VERTEX_POS_SCALE 512
+/* Number of fixed point units per 1.0 in the U texture coordinate of packed vertices */
+#define PACKED_VERTEX_UV_SCALE 1024
 
 /* 3 floats for position (XYZ), 4 bytes for colour. */
 struct VertexColoured { float X, Y, Z; PackedCol Col; };
 /* 3 floats for position (XYZ), 2 floats for texture coordinates (UV), 4 bytes for colour. */
 struct VertexTextured { float X, Y, Z; PackedCol Col; float U, V; };
+/* 3 shorts for position (XYZ), 1 short for texture U, 4 bytes for colour, 1 float for texture V. */
+/* Position and U are fixed point, and position is usually relative to some origin (e.g. a chunk), */
+/*  so the view matrix must be adjusted to account for this before drawing the vertices. */
+/* NOTE: V is left as a float, because 16 bits isn't precise enough for tall 1D terrain atlases */
+struct VertexPacked { cc_int16 X, Y, Z, U; PackedCol Col; float V; };
 
 void Gfx_Create(void);
 void Gfx_Free(void);
@@ -46,6 +57,8 @@ CC_VAR extern struct _GfxData {
 	/* Whether graphics context has been created */
 	cc_bool Created;
 	struct Matrix View, Projection;
+	/* Whether vertices in VERTEX_FORMAT_PACKED format can be drawn. */
+	cc_bool PackedVertices;
 } Gfx;
 
 extern GfxResourceID Gfx_defaultIb;
@@ -170,6 +183,12 @@ CC_API void  Gfx_UnlockDynamicVb(GfxResourceID vb);
 CC_API void Gfx_SetVertexFormat(VertexFormat fmt);
 /* Updates the data of a dynamic vertex buffer. */
 CC_API void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount);
+#ifndef CC_BUILD_GL11
+/* Updates the data of a portion of a dynamic vertex buffer, leaving the rest of its data unchanged. */
+/* NOTE: Unlike Gfx_SetDynamicVbData, this does not bind the vertex buffer. */
+/* NOTE: The portion must not be used by any frame that the GPU may still be drawing. */
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount);
+#endif
 /* Renders vertices from the currently bound vertex buffer as lines. */
 CC_API void Gfx_DrawVb_Lines(int verticesCount);
 /* Renders vertices from the currently bound vertex and index buffer as triangles. */
@@ -179,6 +198,11 @@ CC_API void Gfx_DrawVb_IndexedTris_Range(int verticesCount, int startVertex);
 CC_API void Gfx_DrawVb_IndexedTris(int verticesCount);
 /* Special case Gfx_DrawVb_IndexedTris_Range for map renderer */
 void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex);
+#ifndef CC_BUILD_GL11
+/* Special case Gfx_DrawIndexedTris_T2fC4b for drawing many ranges of the same vertex buffer at once */
+/* NOTE: Every range must end within the first GFX_MAX_VERTICES vertices of the vertex buffer. */
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount);
+#endif
 
 /* Loads the given matrix over the currently active matrix. */
 CC_API void Gfx_LoadMatrix(MatrixType type, const struct Matrix* matrix);
@@ -350,6 +350,14 @@ void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 	ID3D11DeviceContext_DrawIndexed(context, ICOUNT(verticesCount), 0, startVertex);
 }
 
+/* Direct3D 11 has no multi draw, so just draw each range separately */
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	int i;
+	for (i = 0; i < rangesCount; i++) {
+		ID3D11DeviceContext_DrawIndexed(context, ICOUNT(verticesCounts[i]), 0, startVertices[i]);
+	}
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------Dynamic vertex buffers-------------------------------------------------*
@@ -381,6 +389,21 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	Gfx_UnlockDynamicVb(vb);
 }
 
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	ID3D11Buffer* buffer = (ID3D11Buffer*)vb;
+	cc_uint8* dst;
+	mapDesc.pData = NULL;
+
+	/* Can't use D3D11_MAP_WRITE_DISCARD, as that would discard the rest of the buffer's contents */
+	/* (NO_OVERWRITE is fine, as callers never write to a portion frames in flight may still be drawing) */
+	HRESULT hr = ID3D11DeviceContext_Map(context, buffer, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapDesc);
+	if (hr) Logger_Abort2(hr, "Failed to lock dynamic VB range");
+
+	dst = (cc_uint8*)mapDesc.pData + startVertex * strideSizes[fmt];
+	Mem_Copy(dst, vertices, vCount * strideSizes[fmt]);
+	ID3D11DeviceContext_Unmap(context, buffer, 0);
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------------Matrices--------------------------------------------------------*
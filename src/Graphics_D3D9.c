@@ -657,6 +657,15 @@ void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 		startVertex, 0, verticesCount, 0, verticesCount >> 1);
 }
 
+/* Direct3D 9 has no multi draw, so just draw each range separately */
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	int i;
+	for (i = 0; i < rangesCount; i++) {
+		IDirect3DDevice9_DrawIndexedPrimitive(device, D3DPT_TRIANGLELIST,
+			startVertices[i], 0, verticesCounts[i], 0, verticesCounts[i] >> 1);
+	}
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------Dynamic vertex buffers-------------------------------------------------*
@@ -684,6 +693,21 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	if (res) Logger_Abort2(res, "D3D9_SetDynamicVbData - Bind");
 }
 
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	IDirect3DVertexBuffer9* buffer = (IDirect3DVertexBuffer9*)vb;
+	int offset = startVertex * strideSizes[fmt];
+	int size   = vCount      * strideSizes[fmt];
+	void* dst  = NULL;
+
+	/* Can't use D3DLOCK_DISCARD, as that would discard the rest of the buffer's contents */
+	cc_result res = IDirect3DVertexBuffer9_Lock(buffer, offset, size, &dst, 0);
+	if (res) Logger_Abort2(res, "D3D9_SetDynamicVbRange - Lock");
+
+	Mem_Copy(dst, vertices, size);
+	res = IDirect3DVertexBuffer9_Unlock(buffer);
+	if (res) Logger_Abort2(res, "D3D9_SetDynamicVbRange - Unlock");
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------------Matrices--------------------------------------------------------*
@@ -154,6 +154,8 @@ static void (APIENTRY *_glDeleteBuffers)(GLsizei n, const GLuint *buffers);
 static void (APIENTRY *_glGenBuffers)(GLsizei n, GLuint *buffers);
 static void (APIENTRY *_glBufferData)(GLenum target, cc_uintptr size, const GLvoid* data, GLenum usage);
 static void (APIENTRY *_glBufferSubData)(GLenum target, cc_uintptr offset, cc_uintptr size, const GLvoid* data);
+/* NULL when multi draw isn't supported (OpenGL 1.4 or GL_EXT_multi_draw_arrays is required) */
+static void (APIENTRY *_glMultiDrawElements)(GLenum mode, const GLsizei* count, GLenum type, const GLvoid* const* indices, GLsizei drawcount);
 #endif
 #include "_GLShared.h"
 
@@ -315,6 +317,13 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	_glBindBuffer(GL_ARRAY_BUFFER, (GLuint)vb);
 	_glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
 }
+
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	cc_uint32 offset = startVertex * strideSizes[fmt];
+	cc_uint32 size   = vCount      * strideSizes[fmt];
+	_glBindBuffer(GL_ARRAY_BUFFER, (GLuint)vb);
+	_glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
+}
 #else
 GfxResourceID Gfx_CreateDynamicVb(VertexFormat fmt, int maxVertices) { 
 	return (GfxResourceID)Mem_Alloc(maxVertices, strideSizes[fmt], "creating dynamic vb");
@@ -501,7 +510,7 @@ static void APIENTRY fake_bufferData(GLenum target, cc_uintptr size, const GLvoi
 }
 static void APIENTRY fake_bufferSubData(GLenum target, cc_uintptr offset, cc_uintptr size, const GLvoid* data) {
 	fake_buffer* buffer = *fake_GetBuffer(target);
-	Mem_Copy(buffer->data, data, size);
+	Mem_Copy(buffer->data + offset, data, size);
 }
 
 /* wglGetProcAddress doesn't work with OpenGL 1.1 software rasteriser, so call GL functions directly */
@@ -545,7 +554,14 @@ static void GLBackend_Init(void) {
 		DynamicLib_Sym2("glGenBuffersARB",    glGenBuffers), DynamicLib_Sym2("glBufferDataARB",    glBufferData),
 		DynamicLib_Sym2("glBufferSubDataARB", glBufferSubData)
 	};
-	static const cc_string vboExt = String_FromConst("GL_ARB_vertex_buffer_object");
+	static const struct DynamicLibSym coreDrawFuncs[] = {
+		DynamicLib_Sym2("glMultiDrawElements",    glMultiDrawElements)
+	};
+	static const struct DynamicLibSym extDrawFuncs[] = {
+		DynamicLib_Sym2("glMultiDrawElementsEXT", glMultiDrawElements)
+	};
+	static const cc_string vboExt  = String_FromConst("GL_ARB_vertex_buffer_object");
+	static const cc_string drawExt = String_FromConst("GL_EXT_multi_draw_arrays");
 	cc_string extensions = String_FromReadonly((const char*)glGetString(GL_EXTENSIONS));
 	const GLubyte* ver   = glGetString(GL_VERSION);
 
@@ -554,6 +570,7 @@ static void GLBackend_Init(void) {
 #ifdef CC_BUILD_WIN
 	LoadCoreFuncs();
 #endif
+	customMipmapsLevels = true;
 
 	/* Supported in core since 1.5 */
 	if (major > 1 || (major == 1 && minor >= 5)) {
@@ -561,9 +578,16 @@ static void GLBackend_Init(void) {
 	} else if (String_CaselessContains(&extensions, &vboExt)) {
 		GLContext_GetAll(arbVboFuncs,  Array_Elems(arbVboFuncs));
 	} else {
-		OpenGL11Fallback();
+		/* Fake client side vertex buffers can't be drawn from with glMultiDrawElements */
+		OpenGL11Fallback(); return;
+	}
+
+	/* Supported in core since 1.4 */
+	if (major > 1 || (major == 1 && minor >= 4)) {
+		GLContext_GetAll(coreDrawFuncs, Array_Elems(coreDrawFuncs));
+	} else if (String_CaselessContains(&extensions, &drawExt)) {
+		GLContext_GetAll(extDrawFuncs,  Array_Elems(extDrawFuncs));
 	}
-	customMipmapsLevels = true;
 }
 #endif
 
@@ -652,5 +676,31 @@ void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 	_glTexCoordPointer(2, GL_FLOAT,      SIZEOF_VERTEX_TEXTURED, (void*)(VB_PTR + offset + 16));
 	_glDrawElements(GL_TRIANGLES,        ICOUNT(verticesCount),   GL_UNSIGNED_SHORT, IB_PTR);
 }
+
+#define GL_MAX_MULTI_DRAWS 256
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	GLsizei counts[GL_MAX_MULTI_DRAWS];
+	const GLvoid* offsets[GL_MAX_MULTI_DRAWS];
+	int i, j, count;
+
+	if (!_glMultiDrawElements) {
+		for (i = 0; i < rangesCount; i++) {
+			Gfx_DrawIndexedTris_T2fC4b(verticesCounts[i], startVertices[i]);
+		}
+		return;
+	}
+
+	/* Ranges all start within first GFX_MAX_VERTICES vertices, so can offset into index buffer instead */
+	/* ICOUNT(startVertex) * 2 = startVertex * 3 */
+	GL_SetupVbTextured();
+	for (i = 0; i < rangesCount; i += count) {
+		count = min(rangesCount - i, GL_MAX_MULTI_DRAWS);
+		for (j = 0; j < count; j++) {
+			counts[j]  = ICOUNT(verticesCounts[i + j]);
+			offsets[j] = (const GLvoid*)(cc_uintptr)(startVertices[i + j] * 3);
+		}
+		_glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, offsets, count);
+	}
+}
 #endif /* !CC_BUILD_GL11 */
 #endif
@@ -111,6 +111,13 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
 }
 
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	cc_uint32 offset = startVertex * strideSizes[fmt];
+	cc_uint32 size   = vCount      * strideSizes[fmt];
+	glBindBuffer(GL_ARRAY_BUFFER, (GLuint)vb);
+	glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
+}
+
 
 /*########################################################################################################################*
 *------------------------------------------------------OpenGL modern------------------------------------------------------*
@@ -121,6 +128,7 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 #define FTR_LINEAR_FOG (1 << 3)
 #define FTR_DENSIT_FOG (1 << 4)
 #define FTR_HASANY_FOG (FTR_LINEAR_FOG | FTR_DENSIT_FOG)
+#define FTR_PACKED_VTX (1 << 5)
 #define FTR_FS_MEDIUMP (1 << 7)
 
 #define UNI_MVP_MATRIX (1 << 0)
@@ -144,7 +152,7 @@ static struct GLShader {
 	int uniforms;     /* which associated uniforms need to be resent to GPU */
 	GLuint program;   /* OpenGL program ID (0 if not yet compiled) */
 	int locations[5]; /* location of uniforms (not constant) */
-} shaders[6 * 3] = {
+} shaders[8 * 3] = {
 	/* no fog */
 	{ 0              },
 	{ 0              | FTR_ALPHA_TEST },
@@ -152,6 +160,8 @@ static struct GLShader {
 	{ FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_TEXTURE_UV | FTR_TEX_OFFSET },
 	{ FTR_TEXTURE_UV | FTR_TEX_OFFSET | FTR_ALPHA_TEST },
+	{ FTR_TEXTURE_UV | FTR_PACKED_VTX },
+	{ FTR_TEXTURE_UV | FTR_PACKED_VTX | FTR_ALPHA_TEST },
 	/* linear fog */
 	{ FTR_LINEAR_FOG | 0              },
 	{ FTR_LINEAR_FOG | 0              | FTR_ALPHA_TEST },
@@ -159,6 +169,8 @@ static struct GLShader {
 	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET },
 	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET | FTR_ALPHA_TEST },
+	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_PACKED_VTX },
+	{ FTR_LINEAR_FOG | FTR_TEXTURE_UV | FTR_PACKED_VTX | FTR_ALPHA_TEST },
 	/* density fog */
 	{ FTR_DENSIT_FOG | 0              },
 	{ FTR_DENSIT_FOG | 0              | FTR_ALPHA_TEST },
@@ -166,6 +178,8 @@ static struct GLShader {
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET | FTR_ALPHA_TEST },
+	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_PACKED_VTX },
+	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_PACKED_VTX | FTR_ALPHA_TEST },
 };
 static struct GLShader* gfx_activeShader;
 
@@ -173,19 +187,26 @@ static struct GLShader* gfx_activeShader;
 static void GenVertexShader(const struct GLShader* shader, cc_string* dst) {
 	int uv = shader->features & FTR_TEXTURE_UV;
 	int tm = shader->features & FTR_TEX_OFFSET;
+	int pv = shader->features & FTR_PACKED_VTX;
 
-	String_AppendConst(dst,         "attribute vec3 in_pos;\n");
+	/* Packed vertices store U in the 4th position component, and V as a separate float */
+	if (pv) String_AppendConst(dst, "attribute vec4 in_pos;\n");
+	else    String_AppendConst(dst, "attribute vec3 in_pos;\n");
 	String_AppendConst(dst,         "attribute vec4 in_col;\n");
-	if (uv) String_AppendConst(dst, "attribute vec2 in_uv;\n");
+	if (pv) String_AppendConst(dst, "attribute float in_uv;\n");
+	else if (uv) String_AppendConst(dst, "attribute vec2 in_uv;\n");
 	String_AppendConst(dst,         "varying vec4 out_col;\n");
 	if (uv) String_AppendConst(dst, "varying vec2 out_uv;\n");
 	String_AppendConst(dst,         "uniform mat4 mvp;\n");
 	if (tm) String_AppendConst(dst, "uniform vec2 texOffset;\n");
 
 	String_AppendConst(dst,         "void main() {\n");
-	String_AppendConst(dst,         "  gl_Position = mvp * vec4(in_pos, 1.0);\n");
+	if (pv) String_AppendConst(dst, "  gl_Position = mvp * vec4(in_pos.xyz, 1.0);\n");
+	else    String_AppendConst(dst, "  gl_Position = mvp * vec4(in_pos, 1.0);\n");
 	String_AppendConst(dst,         "  out_col = in_col;\n");
-	if (uv) String_AppendConst(dst, "  out_uv  = in_uv;\n");
+	/* 1024 = PACKED_VERTEX_UV_SCALE */
+	if (pv) String_AppendConst(dst, "  out_uv  = vec2(in_pos.w / 1024.0, in_uv);\n");
+	else if (uv) String_AppendConst(dst, "  out_uv  = in_uv;\n");
 	if (tm) String_AppendConst(dst, "  out_uv  = out_uv + texOffset;\n");
 	String_AppendConst(dst,         "}");
 }
@@ -368,13 +389,17 @@ static void SwitchProgram(void) {
 	int index = 0;
 
 	if (gfx_fogEnabled) {
-		index += 6;                       /* linear fog */
-		if (gfx_fogMode >= 1) index += 6; /* exp fog */
+		index += 8;                       /* linear fog */
+		if (gfx_fogMode >= 1) index += 8; /* exp fog */
 	}
 
-	if (gfx_format == VERTEX_FORMAT_TEXTURED) index += 2;
-	if (gfx_texTransform) index += 2;
-	if (gfx_alphaTest)    index += 1;
+	if (gfx_format == VERTEX_FORMAT_PACKED) {
+		index += 6;
+	} else {
+		if (gfx_format == VERTEX_FORMAT_TEXTURED) index += 2;
+		if (gfx_texTransform) index += 2;
+	}
+	if (gfx_alphaTest) index += 1;
 
 	shader = &shaders[index];
 	if (shader == gfx_activeShader) { ReloadUniforms(); return; }
@@ -456,6 +481,7 @@ static void GLBackend_Init(void) {
 #ifndef CC_BUILD_GLES
 	customMipmapsLevels = true;
 #endif
+	Gfx.PackedVertices = true;
 }
 
 static void Gfx_FreeState(void) {
@@ -502,6 +528,12 @@ static void GL_SetupVbTextured(void) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, SIZEOF_VERTEX_TEXTURED, (void*)16);
 }
 
+static void GL_SetupVbPacked(void) {
+	glVertexAttribPointer(0, 4, GL_SHORT,         false, SIZEOF_VERTEX_PACKED, (void*)0);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true,  SIZEOF_VERTEX_PACKED, (void*)8);
+	glVertexAttribPointer(2, 1, GL_FLOAT,         false, SIZEOF_VERTEX_PACKED, (void*)12);
+}
+
 static void GL_SetupVbColoured_Range(int startVertex) {
 	cc_uint32 offset = startVertex * SIZEOF_VERTEX_COLOURED;
 	glVertexAttribPointer(0, 3, GL_FLOAT,         false, SIZEOF_VERTEX_COLOURED, (void*)(offset));
@@ -515,6 +547,13 @@ static void GL_SetupVbTextured_Range(int startVertex) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, SIZEOF_VERTEX_TEXTURED, (void*)(offset + 16));
 }
 
+static void GL_SetupVbPacked_Range(int startVertex) {
+	cc_uint32 offset = startVertex * SIZEOF_VERTEX_PACKED;
+	glVertexAttribPointer(0, 4, GL_SHORT,         false, SIZEOF_VERTEX_PACKED, (void*)(offset));
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true,  SIZEOF_VERTEX_PACKED, (void*)(offset + 8));
+	glVertexAttribPointer(2, 1, GL_FLOAT,         false, SIZEOF_VERTEX_PACKED, (void*)(offset + 12));
+}
+
 void Gfx_SetVertexFormat(VertexFormat fmt) {
 	if (fmt == gfx_format) return;
 	gfx_format = fmt;
@@ -524,6 +563,10 @@ void Gfx_SetVertexFormat(VertexFormat fmt) {
 		glEnableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbTextured;
 		gfx_setupVBRangeFunc = GL_SetupVbTextured_Range;
+	} else if (fmt == VERTEX_FORMAT_PACKED) {
+		glEnableVertexAttribArray(2);
+		gfx_setupVBFunc      = GL_SetupVbPacked;
+		gfx_setupVBRangeFunc = GL_SetupVbPacked_Range;
 	} else {
 		glDisableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbColoured;
@@ -547,19 +590,46 @@ void Gfx_DrawVb_IndexedTris(int verticesCount) {
 	glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
 }
 
+/* NOTE: Chunk meshes may also use VERTEX_FORMAT_PACKED, so these use the current vertex format */
 void Gfx_BindVb_Textured(GfxResourceID vb) {
 	Gfx_BindVb(vb);
-	GL_SetupVbTextured();
+	gfx_setupVBFunc();
 }
 
 void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 	if (startVertex + verticesCount > GFX_MAX_VERTICES) {
-		GL_SetupVbTextured_Range(startVertex);
+		gfx_setupVBRangeFunc(startVertex);
 		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
-		GL_SetupVbTextured();
+		gfx_setupVBFunc();
 	} else {
 		/* ICOUNT(startVertex) * 2 = startVertex * 3  */
 		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, (void*)(startVertex * 3));
 	}
 }
+
+#ifdef CC_BUILD_GLES
+/* glMultiDrawElements isn't part of OpenGL ES 2.0 / WebGL */
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	int i;
+	for (i = 0; i < rangesCount; i++) {
+		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCounts[i]), GL_UNSIGNED_SHORT, (void*)(startVertices[i] * 3));
+	}
+}
+#else
+#define GL_MAX_MULTI_DRAWS 256
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	GLsizei counts[GL_MAX_MULTI_DRAWS];
+	const void* offsets[GL_MAX_MULTI_DRAWS];
+	int i, j, count;
+
+	for (i = 0; i < rangesCount; i += count) {
+		count = min(rangesCount - i, GL_MAX_MULTI_DRAWS);
+		for (j = 0; j < count; j++) {
+			counts[j]  = ICOUNT(verticesCounts[i + j]);
+			offsets[j] = (void*)(cc_uintptr)(startVertices[i + j] * 3);
+		}
+		glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, offsets, count);
+	}
+}
+#endif
 #endif
@@ -0,0 +1,274 @@
+#include "Core.h"
+#if defined CC_BUILD_HEADLESS
+#include "_GraphicsBase.h"
+#include "Errors.h"
+#include "Logger.h"
+#include "Window.h"
+/* Graphics backend which does not actually render anything. (e.g. for headless benchmarking)
+ * Vertex buffers and textures are still stored in system memory, so that the CPU side
+ *  cost of building and uploading meshes/textures remains comparable to an actual backend.
+*/
+
+/* Tracks how much memory and how many resources are currently allocated */
+static int null_texCount, null_vbCount, null_vbSize;
+/* Tracks how much work would have been submitted to the GPU in the last frame */
+static int null_drawCalls, null_drawVertices, null_lastDrawCalls, null_lastDrawVertices;
+
+void Gfx_Create(void) {
+	Gfx.MaxTexWidth  = 8192;
+	Gfx.MaxTexHeight = 8192;
+	Gfx.Created      = true;
+	Gfx.PackedVertices = true;
+	Gfx_RestoreState();
+}
+
+cc_bool Gfx_TryRestoreContext(void) { return true; }
+
+void Gfx_Free(void) {
+	Gfx_FreeState();
+}
+
+static void Gfx_FreeState(void) { FreeDefaultResources(); }
+static void Gfx_RestoreState(void) {
+	InitDefaultResources();
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------Textures--------------------------------------------------------*
+*#########################################################################################################################*/
+struct NullTexture { int width, height; BitmapCol pixels[1]; };
+
+/* Mipmaps are still generated (but not stored), so that the CPU side cost remains comparable */
+static void Null_DoMipmaps(struct Bitmap* bmp, int rowWidth) {
+	BitmapCol* prev = bmp->scan0;
+	BitmapCol* cur;
+
+	int lvls = CalcMipmapsLevels(bmp->width, bmp->height);
+	int lvl, width = bmp->width, height = bmp->height;
+
+	for (lvl = 1; lvl <= lvls; lvl++) {
+		if (width > 1)  width  /= 2;
+		if (height > 1) height /= 2;
+
+		cur = (BitmapCol*)Mem_Alloc(width * height, 4, "mipmaps");
+		GenMipmaps(width, height, cur, prev, rowWidth);
+
+		if (prev != bmp->scan0) Mem_Free(prev);
+		prev     = cur;
+		rowWidth = width;
+	}
+	if (prev != bmp->scan0) Mem_Free(prev);
+}
+
+GfxResourceID Gfx_CreateTexture(struct Bitmap* bmp, cc_uint8 flags, cc_bool mipmaps) {
+	struct NullTexture* tex;
+	int size = bmp->width * bmp->height * 4;
+
+	if (!Math_IsPowOf2(bmp->width) || !Math_IsPowOf2(bmp->height)) {
+		Logger_Abort("Textures must have power of two dimensions");
+	}
+	if (Gfx.LostContext) return 0;
+
+	tex = (struct NullTexture*)Mem_Alloc(1, sizeof(struct NullTexture) + size, "null texture");
+	tex->width  = bmp->width;
+	tex->height = bmp->height;
+	Mem_Copy(tex->pixels, bmp->scan0, size);
+	if (mipmaps) Null_DoMipmaps(bmp, bmp->width);
+
+	null_texCount++;
+	return (GfxResourceID)tex;
+}
+
+void Gfx_UpdateTexture(GfxResourceID texId, int x, int y, struct Bitmap* part, int rowWidth, cc_bool mipmaps) {
+	struct NullTexture* tex = (struct NullTexture*)texId;
+	BitmapCol* dst;
+	if (!tex) return;
+
+	dst = tex->pixels + y * tex->width + x;
+	CopyTextureData(dst, tex->width << 2, part, rowWidth << 2);
+	if (mipmaps) Null_DoMipmaps(part, rowWidth);
+}
+
+void Gfx_UpdateTexturePart(GfxResourceID texId, int x, int y, struct Bitmap* part, cc_bool mipmaps) {
+	Gfx_UpdateTexture(texId, x, y, part, part->width, mipmaps);
+}
+
+void Gfx_BindTexture(GfxResourceID texId) { }
+
+void Gfx_DeleteTexture(GfxResourceID* texId) {
+	if (!(*texId)) return;
+	Mem_Free((void*)(*texId));
+	*texId = 0;
+	null_texCount--;
+}
+
+void Gfx_SetTexturing(cc_bool enabled) { }
+void Gfx_EnableMipmaps(void)  { }
+void Gfx_DisableMipmaps(void) { }
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------State management----------------------------------------------------*
+*#########################################################################################################################*/
+void Gfx_SetFaceCulling(cc_bool enabled)   { }
+void Gfx_SetAlphaBlending(cc_bool enabled) { }
+void Gfx_SetAlphaArgBlend(cc_bool enabled) { }
+void Gfx_SetAlphaTest(cc_bool enabled)     { }
+
+void Gfx_ClearCol(PackedCol color) { }
+void Gfx_SetColWriteMask(cc_bool r, cc_bool g, cc_bool b, cc_bool a) { }
+void Gfx_SetDepthWrite(cc_bool enabled) { }
+void Gfx_SetDepthTest(cc_bool enabled)  { }
+
+void Gfx_SetFog(cc_bool enabled)      { gfx_fogEnabled = enabled; }
+void Gfx_SetFogCol(PackedCol color)   { }
+void Gfx_SetFogDensity(float value)   { }
+void Gfx_SetFogEnd(float value)       { }
+void Gfx_SetFogMode(FogFunc func)     { }
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------Index buffers-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Indices are always the default {0,1,2} {2,3,0} pattern, so no need to actually store them */
+GfxResourceID Gfx_CreateIb(void* indices, int indicesCount) { return 1; }
+void Gfx_BindIb(GfxResourceID ib)    { }
+void Gfx_DeleteIb(GfxResourceID* ib) { *ib = 0; }
+
+
+/*########################################################################################################################*
+*------------------------------------------------------Vertex buffers-----------------------------------------------------*
+*#########################################################################################################################*/
+struct NullVb { int size; cc_uint8 data[1]; };
+static VertexFormat gfx_format = -1;
+
+static GfxResourceID Null_CreateVb(int size) {
+	struct NullVb* vb;
+	if (Gfx.LostContext) return 0;
+
+	vb = (struct NullVb*)Mem_TryAlloc(1, sizeof(struct NullVb) + size);
+	if (!vb) { Event_RaiseVoid(&GfxEvents.LowVRAMDetected); return 0; }
+	vb->size = size;
+
+	null_vbCount++;
+	null_vbSize += size;
+	return (GfxResourceID)vb;
+}
+
+GfxResourceID Gfx_CreateVb(VertexFormat fmt, int count) {
+	return Null_CreateVb(count * strideSizes[fmt]);
+}
+
+GfxResourceID Gfx_CreateDynamicVb(VertexFormat fmt, int maxVertices) {
+	return Null_CreateVb(maxVertices * strideSizes[fmt]);
+}
+
+void Gfx_BindVb(GfxResourceID vb) { }
+
+void Gfx_DeleteVb(GfxResourceID* vb) {
+	struct NullVb* data = (struct NullVb*)(*vb);
+	if (!data) return;
+
+	null_vbCount--;
+	null_vbSize -= data->size;
+	Mem_Free(data);
+	*vb = 0;
+}
+
+void* Gfx_LockVb(GfxResourceID vb, VertexFormat fmt, int count) {
+	return ((struct NullVb*)vb)->data;
+}
+void Gfx_UnlockVb(GfxResourceID vb) { }
+
+void* Gfx_LockDynamicVb(GfxResourceID vb, VertexFormat fmt, int count) {
+	return ((struct NullVb*)vb)->data;
+}
+void Gfx_UnlockDynamicVb(GfxResourceID vb) { }
+
+void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
+	struct NullVb* data = (struct NullVb*)vb;
+	int size = vCount * strideSizes[gfx_format];
+	Mem_Copy(data->data, vertices, min(size, data->size));
+}
+
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	struct NullVb* data = (struct NullVb*)vb;
+	int offset = startVertex * strideSizes[fmt];
+	int size   = vCount      * strideSizes[fmt];
+	Mem_Copy(data->data + offset, vertices, min(size, data->size - offset));
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------Vertex rendering----------------------------------------------------*
+*#########################################################################################################################*/
+void Gfx_SetVertexFormat(VertexFormat fmt) { gfx_format = fmt; }
+
+#define Null_AddDraw(verticesCount) null_drawCalls++; null_drawVertices += (verticesCount);
+void Gfx_DrawVb_Lines(int verticesCount)                              { Null_AddDraw(verticesCount); }
+void Gfx_DrawVb_IndexedTris(int verticesCount)                        { Null_AddDraw(verticesCount); }
+void Gfx_DrawVb_IndexedTris_Range(int verticesCount, int startVertex) { Null_AddDraw(verticesCount); }
+void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex)   { Null_AddDraw(verticesCount); }
+
+void Gfx_MultiDrawIndexedTris_T2fC4b(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	int i;
+	/* A multi draw is submitted to the GPU as a single draw call */
+	null_drawCalls++;
+	for (i = 0; i < rangesCount; i++) { null_drawVertices += verticesCounts[i]; }
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------Matrices--------------------------------------------------------*
+*#########################################################################################################################*/
+void Gfx_LoadMatrix(MatrixType type, const struct Matrix* matrix) { }
+void Gfx_LoadIdentityMatrix(MatrixType type) { }
+void Gfx_EnableTextureOffset(float x, float y) { }
+void Gfx_DisableTextureOffset(void) { }
+
+void Gfx_CalcOrthoMatrix(float width, float height, struct Matrix* matrix) {
+	Matrix_Orthographic(matrix, 0.0f, width, 0.0f, height, ORTHO_NEAR, ORTHO_FAR);
+}
+void Gfx_CalcPerspectiveMatrix(float fov, float aspect, float zFar, struct Matrix* matrix) {
+	float zNear = 0.1f;
+	Matrix_PerspectiveFieldOfView(matrix, fov, aspect, zNear, zFar);
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------------Misc----------------------------------------------------------*
+*#########################################################################################################################*/
+cc_result Gfx_TakeScreenshot(struct Stream* output) { return ERR_NOT_SUPPORTED; }
+cc_bool Gfx_WarnIfNecessary(void) { return false; }
+
+void Gfx_SetFpsLimit(cc_bool vsync, float minFrameMs) {
+	gfx_minFrameMs = minFrameMs;
+	gfx_vsync      = vsync;
+}
+
+void Gfx_BeginFrame(void) {
+	frameStart     = Stopwatch_Measure();
+	null_drawCalls = 0; null_drawVertices = 0;
+}
+void Gfx_Clear(void) { }
+
+void Gfx_EndFrame(void) {
+	null_lastDrawCalls    = null_drawCalls;
+	null_lastDrawVertices = null_drawVertices;
+	if (gfx_minFrameMs) LimitFPS();
+}
+
+void Gfx_GetApiInfo(cc_string* info) {
+	int pointerSize = sizeof(void*) * 8;
+	float vbMem     = null_vbSize / (1024.0f * 1024.0f);
+
+	String_Format1(info, "-- Using Null (%i bit) --\n", &pointerSize);
+	String_Format2(info, "Vertex buffers: %i (%f2 MB)\n", &null_vbCount, &vbMem);
+	String_Format1(info, "Textures: %i\n", &null_texCount);
+	String_Format2(info, "Last frame: %i draw calls, %i vertices\n", &null_lastDrawCalls, &null_lastDrawVertices);
+	String_Format2(info, "Max texture size: (%i, %i)", &Gfx.MaxTexWidth, &Gfx.MaxTexHeight);
+}
+
+void Gfx_OnWindowResize(void) { }
+#endif
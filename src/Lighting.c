@@ -1,5 +1,6 @@
 #include "Lighting.h"
 #include "Block.h"
+#include "Builder.h"
 #include "Funcs.h"
 #include "MapRenderer.h"
 #include "Platform.h"
@@ -7,9 +8,13 @@
 #include "Logger.h"
 #include "Event.h"
 #include "Game.h"
+#include "Options.h"
 
 static cc_int16* light_heightmap;
 #define HEIGHT_UNCALCULATED Int16_MaxValue
+/* Defined in the 'Propagated lighting' section */
+static void LightLevels_OnBlockChanged(int x, int y, int z, BlockID block, int oldHeight, int newHeight);
+static void LightLevels_Invalidate(void);
 
 #define Lighting_CalcBody(get_block)\
 for (y = maxY; y >= 0; y--, i -= World.OneY) {\
@@ -28,9 +33,15 @@ static int Lighting_CalcHeightAt(int x, int maxY, int z, int hIndex) {
 	int y, offset;
 
 #ifndef EXTENDED_BLOCKS
-	Lighting_CalcBody(World.Blocks[i]);
+	if (World.Sections) {
+		Lighting_CalcBody(World_GetSectionBlock(x, y, z));
+	} else {
+		Lighting_CalcBody(World.Blocks[i]);
+	}
 #else
-	if (World.IDMask <= 0xFF) {
+	if (World.Sections) {
+		Lighting_CalcBody(World_GetSectionBlock(x, y, z));
+	} else if (World.IDMask <= 0xFF) {
 		Lighting_CalcBody(World.Blocks[i]);
 	} else {
 		Lighting_CalcBody(World.Blocks[i] | (World.Blocks2[i] << 8));
@@ -52,10 +63,6 @@ cc_bool Lighting_IsLit(int x, int y, int z) {
 	return y > Lighting_GetLightHeight(x, z);
 }
 
-cc_bool Lighting_IsLit_Fast(int x, int y, int z) {
-	return y > light_heightmap[Lighting_Pack(x, z)];
-}
-
 PackedCol Lighting_Color(int x, int y, int z) {
 	if (!World_Contains(x, y, z)) return Env.SunCol;
 	return y > Lighting_GetLightHeight(x, z) ? Env.SunCol : Env.ShadowCol;
@@ -66,31 +73,12 @@ PackedCol Lighting_Color_XSide(int x, int y, int z) {
 	return y > Lighting_GetLightHeight(x, z) ? Env.SunXSide : Env.ShadowXSide;
 }
 
-PackedCol Lighting_Color_Sprite_Fast(int x, int y, int z) {
-	return y > light_heightmap[Lighting_Pack(x, z)] ? Env.SunCol : Env.ShadowCol;
-}
-
-PackedCol Lighting_Color_YMax_Fast(int x, int y, int z) {
-	return y > light_heightmap[Lighting_Pack(x, z)] ? Env.SunCol : Env.ShadowCol;
-}
-
-PackedCol Lighting_Color_YMin_Fast(int x, int y, int z) {
-	return y > light_heightmap[Lighting_Pack(x, z)] ? Env.SunYMin : Env.ShadowYMin;
-}
-
-PackedCol Lighting_Color_XSide_Fast(int x, int y, int z) {
-	return y > light_heightmap[Lighting_Pack(x, z)] ? Env.SunXSide : Env.ShadowXSide;
-}
-
-PackedCol Lighting_Color_ZSide_Fast(int x, int y, int z) {
-	return y > light_heightmap[Lighting_Pack(x, z)] ? Env.SunZSide : Env.ShadowZSide;
-}
-
 void Lighting_Refresh(void) {
 	int i;
 	for (i = 0; i < World.Width * World.Length; i++) {
 		light_heightmap[i] = HEIGHT_UNCALCULATED;
 	}
+	LightLevels_Invalidate();
 }
 
 
@@ -144,14 +132,21 @@ for (; y >= minY; y--, i -= World.OneY) {\
 	if (affected) return true;\
 }
 
-static cc_bool Lighting_NeedsNeighour(BlockID block, int i, int minY, int y, int nY) {
+static cc_bool Lighting_NeedsNeighour(BlockID block, int x, int y, int z, int minY, int nY) {
+	int i = World_Pack(x, y, z);
 	BlockID other;
 	cc_bool affected;
 
 #ifndef EXTENDED_BLOCKS
-	Lighting_NeedsNeighourBody(World.Blocks[i]);
+	if (World.Sections) {
+		Lighting_NeedsNeighourBody(World_GetSectionBlock(x, y, z));
+	} else {
+		Lighting_NeedsNeighourBody(World.Blocks[i]);
+	}
 #else
-	if (World.IDMask <= 0xFF) {
+	if (World.Sections) {
+		Lighting_NeedsNeighourBody(World_GetSectionBlock(x, y, z));
+	} else if (World.IDMask <= 0xFF) {
 		Lighting_NeedsNeighourBody(World.Blocks[i]);
 	} else {
 		Lighting_NeedsNeighourBody(World.Blocks[i] | (World.Blocks2[i] << 8));
@@ -166,7 +161,7 @@ static void Lighting_ResetNeighbour(int x, int y, int z, BlockID block, int cx,
 	if (minCy == maxCy) {
 		minY = cy << CHUNK_SHIFT;
 
-		if (Lighting_NeedsNeighour(block, World_Pack(x, y, z), minY, y, y)) {
+		if (Lighting_NeedsNeighour(block, x, y, z, minY, y)) {
 			MapRenderer_RefreshChunk(cx, cy, cz);
 		}
 	} else {
@@ -175,7 +170,7 @@ static void Lighting_ResetNeighbour(int x, int y, int z, BlockID block, int cx,
 			maxY = (cy << CHUNK_SHIFT) + CHUNK_MAX;
 			if (maxY > World.MaxY) maxY = World.MaxY;
 
-			if (Lighting_NeedsNeighour(block, World_Pack(x, maxY, z), minY, maxY, y)) {
+			if (Lighting_NeedsNeighour(block, x, maxY, z, minY, y)) {
 				MapRenderer_RefreshChunk(cx, cy, cz);
 			}
 		}
@@ -236,6 +231,7 @@ void Lighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newB
 	Lighting_UpdateLighting(x, y, z, oldBlock, newBlock, hIndex, lightH);
 	newHeight = light_heightmap[hIndex] + 1;
 	Lighting_RefreshAffected(x, y, z, newBlock, lightH + 1, newHeight);
+	if (Lighting_Propagated) LightLevels_OnBlockChanged(x, y, z, newBlock, lightH, newHeight - 1);
 }
 
 
@@ -316,9 +312,15 @@ static cc_bool Lighting_CalculateHeightmapCoverage(int x1, int z1, int xCount, i
 	int x, y, z;
 
 #ifndef EXTENDED_BLOCKS
-	Lighting_CalculateBody(World.Blocks[mapIndex]);
+	if (World.Sections) {
+		Lighting_CalculateBody(World_GetSectionBlock(x1 + x, y, z1 + z));
+	} else {
+		Lighting_CalculateBody(World.Blocks[mapIndex]);
+	}
 #else
-	if (World.IDMask <= 0xFF) {
+	if (World.Sections) {
+		Lighting_CalculateBody(World_GetSectionBlock(x1 + x, y, z1 + z));
+	} else if (World.IDMask <= 0xFF) {
 		Lighting_CalculateBody(World.Blocks[mapIndex]);
 	} else {
 		Lighting_CalculateBody(World.Blocks[mapIndex] | (World.Blocks2[mapIndex] << 8));
@@ -342,7 +344,7 @@ static void Lighting_FinishHeightmapCoverage(int x1, int z1, int xCount, int zCo
 	}
 }
 
-void Lighting_LightHint(int startX, int startZ) {
+static void Lighting_CalcHint(int startX, int startZ) {
 	int x1 = max(startX, 0), x2 = min(World.Width,  startX + EXTCHUNK_SIZE);
 	int z1 = max(startZ, 0), z2 = min(World.Length, startZ + EXTCHUNK_SIZE);
 	int xCount = x2 - x1, zCount = z2 - z1;
@@ -354,26 +356,558 @@ void Lighting_LightHint(int startX, int startZ) {
 	}
 }
 
+/* Defined in the 'Propagated lighting' section */
+static void LightLevels_Flush(void);
+
+void Lighting_LightHint(int startX, int startZ) {
+	if (Lighting_Propagated) LightLevels_Flush();
+	Lighting_CalcHint(startX, startZ);
+}
+
+void Lighting_CopyHint(int startX, int startZ, cc_int16* heights) {
+	int x1 = max(startX, 0), x2 = min(World.Width,  startX + EXTCHUNK_SIZE);
+	int z1 = max(startZ, 0), z2 = min(World.Length, startZ + EXTCHUNK_SIZE);
+	int z;
+	if (x1 >= x2) return;
+
+	for (z = z1; z < z2; z++) {
+		Mem_Copy(&heights[(z - startZ) * EXTCHUNK_SIZE + (x1 - startX)],
+				&light_heightmap[Lighting_Pack(x1, z)], (x2 - x1) * 2);
+	}
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------Eager heightmap-----------------------------------------------------*
+*#########################################################################################################################*/
+const char* const HeightmapMode_Names[HEIGHTMAP_MODE_COUNT] = { "Lazy", "Columns", "Layers" };
+int Lighting_HeightmapMode;
+
+/* Number of Z rows of the heightmap calculated by each job */
+#define HEIGHTMAP_JOB_ROWS 16
+
+/* Next Z row of the heightmap which has not been calculated yet */
+static int heightmap_nextRow;
+/* heightmapMutex protects heightmap_nextRow */
+static void* heightmapMutex;
+
+/* Calculates the light height of each column in the given rows, scanning down one column at a time */
+static void Lighting_CalcColumns(int z1, int z2) {
+	int x, z;
+	for (z = z1; z < z2; z++) {
+		for (x = 0; x < World.Width; x++) {
+			Lighting_CalcHeightAt(x, World.MaxY, z, Lighting_Pack(x, z));
+		}
+	}
+}
+
+#define Lighting_LayersBody(get_block)\
+for (y = World.MaxY; y >= 0 && elemsLeft > 0; y--) {\
+	for (z = z1; z < z2; z++) {\
+		hIndex = Lighting_Pack(0, z);\
+		i      = World_Pack(0, y, z);\
+\
+		for (x = 0; x < World.Width; x++, hIndex++, i++) {\
+			if (light_heightmap[hIndex] != HEIGHT_UNCALCULATED) continue;\
+			block = get_block;\
+			if (!Blocks.BlocksLight[block]) continue;\
+\
+			offset = (Blocks.LightOffset[block] >> FACE_YMAX) & 1;\
+			light_heightmap[hIndex] = (cc_int16)(y - offset);\
+			elemsLeft--;\
+		}\
+	}\
+}
+
+/* Calculates the light height of each column in the given rows, scanning down one horizontal layer at a time */
+/*  (so blocks are read in the same order as they are stored in memory) */
+static void Lighting_CalcLayers(int z1, int z2) {
+	int elemsLeft = 0;
+	int x, y, z, i, hIndex, offset;
+	BlockID block;
+
+	/* Some columns may have already been calculated lazily */
+	for (i = Lighting_Pack(0, z1); i < Lighting_Pack(0, z2); i++) {
+		if (light_heightmap[i] == HEIGHT_UNCALCULATED) elemsLeft++;
+	}
+
+#ifndef EXTENDED_BLOCKS
+	if (World.Sections) {
+		Lighting_LayersBody(World_GetSectionBlock(x, y, z));
+	} else {
+		Lighting_LayersBody(World.Blocks[i]);
+	}
+#else
+	if (World.Sections) {
+		Lighting_LayersBody(World_GetSectionBlock(x, y, z));
+	} else if (World.IDMask <= 0xFF) {
+		Lighting_LayersBody(World.Blocks[i]);
+	} else {
+		Lighting_LayersBody(World.Blocks[i] | (World.Blocks2[i] << 8));
+	}
+#endif
+
+	if (!elemsLeft) return;
+	for (i = Lighting_Pack(0, z1); i < Lighting_Pack(0, z2); i++) {
+		if (light_heightmap[i] == HEIGHT_UNCALCULATED) light_heightmap[i] = -10;
+	}
+}
+
+/* Calculates the next few rows of the heightmap. Returns false if there are no rows left to calculate. */
+static cc_bool Lighting_RunHeightmapJob(void) {
+	int z1, z2;
+
+	Mutex_Lock(heightmapMutex);
+	{
+		z1 = heightmap_nextRow;
+		z2 = min(z1 + HEIGHTMAP_JOB_ROWS, World.Length);
+		heightmap_nextRow = z2;
+	}
+	Mutex_Unlock(heightmapMutex);
+	if (z1 >= z2) return false;
+
+	if (Lighting_HeightmapMode == HEIGHTMAP_COLUMNS) {
+		Lighting_CalcColumns(z1, z2);
+	} else {
+		Lighting_CalcLayers(z1, z2);
+	}
+	return true;
+}
+
+static void Lighting_HeightmapWorker(void) {
+	while (Lighting_RunHeightmapJob()) { }
+}
+
+/* Calculates the entire heightmap up front, rather than lazily as chunks are built */
+/* NOTE: Columns are independent of each other, so rows of the heightmap are calculated on all cores */
+static void Lighting_CalcHeightmap(void) {
+	heightmapMutex    = Mutex_Create();
+	heightmap_nextRow = 0;
+	Builder_RunOnWorkers(Lighting_HeightmapWorker);
+	Mutex_Free(heightmapMutex);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Propagated lighting---------------------------------------------------*
+*#########################################################################################################################*/
+cc_bool Lighting_Propagated;
+/* Light levels of the blocks in each 16x16x16 chunk, or NULL if all the blocks in the chunk have no light. */
+/* Each level is stored as (sky light << 4) | block light, where sky light is only stored for blocks */
+/*  at or below the light height of their column. (blocks above are always fully lit by the sky) */
+static cc_uint8** light_levels;
+static int light_chunksX, light_chunksY, light_chunksZ, light_chunksCount;
+/* Whether the light levels of every block need to be calculated again (e.g. after loading a new map) */
+static cc_bool light_recalc;
+
+#define LIGHT_BLOCK 0
+#define LIGHT_SKY   4
+#define LIGHT_MAX  15
+#define LightLevels_ChunkIndex(x, y, z) ((((y) >> CHUNK_SHIFT) * light_chunksZ + ((z) >> CHUNK_SHIFT)) * light_chunksX + ((x) >> CHUNK_SHIFT))
+#define LightLevels_BlockIndex(x, y, z) ((((y) & CHUNK_MASK) << 8) | (((z) & CHUNK_MASK) << 4) | ((x) & CHUNK_MASK))
+
+/* Growable queue of packed block coordinates, used when propagating light. */
+struct LightQueue { int* entries; int count, capacity; };
+/* Blocks whose light must be removed, as (index, old level) pairs */
+static struct LightQueue light_removeBlock, light_removeSky;
+/* Blocks whose light must be spread to their neighbours */
+static struct LightQueue light_spreadBlock, light_spreadSky;
+/* Chunks whose meshes must be rebuilt, due to light levels in or next to them changing */
+static struct LightQueue light_changedChunks;
+static cc_uint8* light_changedFlags;
+
+static void LightQueue_Add(struct LightQueue* queue, int value) {
+	if (queue->count == queue->capacity) {
+		queue->capacity = queue->capacity ? queue->capacity * 2 : 512;
+		queue->entries  = (int*)Mem_Realloc(queue->entries, queue->capacity, 4, "light queue");
+	}
+	queue->entries[queue->count++] = value;
+}
+
+static void LightQueue_Free(struct LightQueue* queue) {
+	Mem_Free(queue->entries);
+	queue->entries  = NULL;
+	queue->count    = 0;
+	queue->capacity = 0;
+}
+
+static void LightLevels_Free(void) {
+	int i;
+	if (light_levels) {
+		for (i = 0; i < light_chunksCount; i++) { Mem_Free(light_levels[i]); }
+	}
+	Mem_Free(light_levels);
+	Mem_Free(light_changedFlags);
+	light_levels       = NULL;
+	light_changedFlags = NULL;
+
+	LightQueue_Free(&light_removeBlock); LightQueue_Free(&light_removeSky);
+	LightQueue_Free(&light_spreadBlock); LightQueue_Free(&light_spreadSky);
+	LightQueue_Free(&light_changedChunks);
+}
+
+static void LightLevels_Alloc(void) {
+	light_chunksX = (World.Width  + CHUNK_MAX) >> CHUNK_SHIFT;
+	light_chunksY = (World.Height + CHUNK_MAX) >> CHUNK_SHIFT;
+	light_chunksZ = (World.Length + CHUNK_MAX) >> CHUNK_SHIFT;
+	light_chunksCount = light_chunksX * light_chunksY * light_chunksZ;
+
+	light_levels       = (cc_uint8**)Mem_AllocCleared(light_chunksCount, sizeof(cc_uint8*), "light levels");
+	light_changedFlags = (cc_uint8*)Mem_AllocCleared(light_chunksCount, 1, "light changed flags");
+	light_recalc = true;
+}
+
+static void LightLevels_Invalidate(void) { light_recalc = true; }
+
+/* Marks all the chunks whose meshes use the light level of the given block as needing to be rebuilt. */
+static void LightLevels_MarkChanged(int x, int y, int z) {
+	int cx, cy, cz, i;
+	if (light_recalc) return;
+
+	for (cy = max(y - 1, 0) >> CHUNK_SHIFT; cy <= min(y + 1, World.MaxY) >> CHUNK_SHIFT; cy++) {
+		for (cz = max(z - 1, 0) >> CHUNK_SHIFT; cz <= min(z + 1, World.MaxZ) >> CHUNK_SHIFT; cz++) {
+			for (cx = max(x - 1, 0) >> CHUNK_SHIFT; cx <= min(x + 1, World.MaxX) >> CHUNK_SHIFT; cx++) {
+				i = (cy * light_chunksZ + cz) * light_chunksX + cx;
+				if (light_changedFlags[i]) continue;
+
+				light_changedFlags[i] = true;
+				LightQueue_Add(&light_changedChunks, i);
+			}
+		}
+	}
+}
+
+/* Returns the sky or block light level of the given block. */
+static int LightLevels_Get(int x, int y, int z, int shift) {
+	cc_uint8* levels;
+	if (shift == LIGHT_SKY && y > light_heightmap[Lighting_Pack(x, z)]) return LIGHT_MAX;
+
+	levels = light_levels[LightLevels_ChunkIndex(x, y, z)];
+	return levels ? (levels[LightLevels_BlockIndex(x, y, z)] >> shift) & LIGHT_MAX : 0;
+}
+
+/* Sets the sky or block light level of the given block. */
+/* NOTE: Sky light must only be set to 0 for blocks above the light height of their column */
+static void LightLevels_Set(int x, int y, int z, int shift, int level) {
+	cc_uint8** levels = &light_levels[LightLevels_ChunkIndex(x, y, z)];
+	int index = LightLevels_BlockIndex(x, y, z);
+
+	if (!(*levels)) {
+		if (!level) return;
+		*levels = (cc_uint8*)Mem_AllocCleared(CHUNK_SIZE_3, 1, "chunk light levels");
+	}
+	(*levels)[index] = ((*levels)[index] & ~(LIGHT_MAX << shift)) | (level << shift);
+	LightLevels_MarkChanged(x, y, z);
+}
+
+static void LightLevels_SpreadTo(int x, int y, int z, int shift, int level, struct LightQueue* spread) {
+	if (!World_Contains(x, y, z) || Blocks.BlocksLight[World_GetBlock(x, y, z)]) return;
+	if (LightLevels_Get(x, y, z, shift) >= level) return;
+
+	LightLevels_Set(x, y, z, shift, level);
+	LightQueue_Add(spread, World_Pack(x, y, z));
+}
+
+/* Spreads light from each block in the given queue to its neighbours, and then from their neighbours, etc */
+static void LightLevels_Spread(struct LightQueue* spread, int shift) {
+	int i, x, y, z, level;
+	BlockID block;
+
+	for (i = 0; i < spread->count; i++) {
+		World_Unpack(spread->entries[i], x, y, z);
+		level = LightLevels_Get(x, y, z, shift) - 1;
+		if (level <= 0) continue;
+
+		/* Light only spreads out of blocks that it can pass through, or that emit it */
+		block = World_GetBlock(x, y, z);
+		if (Blocks.BlocksLight[block] && !(shift == LIGHT_BLOCK && Blocks.FullBright[block])) continue;
+
+		LightLevels_SpreadTo(x - 1, y, z, shift, level, spread);
+		LightLevels_SpreadTo(x + 1, y, z, shift, level, spread);
+		LightLevels_SpreadTo(x, y - 1, z, shift, level, spread);
+		LightLevels_SpreadTo(x, y + 1, z, shift, level, spread);
+		LightLevels_SpreadTo(x, y, z - 1, shift, level, spread);
+		LightLevels_SpreadTo(x, y, z + 1, shift, level, spread);
+	}
+	spread->count = 0;
+}
+
+static void LightLevels_RemoveFrom(int x, int y, int z, int shift, int level, struct LightQueue* remove, struct LightQueue* spread) {
+	int other;
+	if (!World_Contains(x, y, z)) return;
+	other = LightLevels_Get(x, y, z, shift);
+	if (!other) return;
+
+	/* Light that is as bright as the removed light must have come from elsewhere, so needs to be spread again */
+	if (other >= level) {
+		LightQueue_Add(spread, World_Pack(x, y, z));
+	} else {
+		LightLevels_Set(x, y, z, shift, 0);
+		LightQueue_Add(remove, World_Pack(x, y, z));
+		LightQueue_Add(remove, other);
+	}
+}
+
+/* Removes the light that came from each block in the given queue, and queues up any neighbouring */
+/*  light sources whose light needs to be spread again to fill in the gaps */
+static void LightLevels_Remove(struct LightQueue* remove, struct LightQueue* spread, int shift) {
+	int i, x, y, z, level;
+
+	for (i = 0; i < remove->count; i += 2) {
+		World_Unpack(remove->entries[i], x, y, z);
+		level = remove->entries[i + 1];
+
+		LightLevels_RemoveFrom(x - 1, y, z, shift, level, remove, spread);
+		LightLevels_RemoveFrom(x + 1, y, z, shift, level, remove, spread);
+		LightLevels_RemoveFrom(x, y - 1, z, shift, level, remove, spread);
+		LightLevels_RemoveFrom(x, y + 1, z, shift, level, remove, spread);
+		LightLevels_RemoveFrom(x, y, z - 1, shift, level, remove, spread);
+		LightLevels_RemoveFrom(x, y, z + 1, shift, level, remove, spread);
+	}
+	remove->count = 0;
+}
+
+static void LightLevels_SpreadNeighbours(int x, int y, int z) {
+	if (x > 0)          { LightQueue_Add(&light_spreadBlock, World_Pack(x - 1, y, z)); LightQueue_Add(&light_spreadSky, World_Pack(x - 1, y, z)); }
+	if (x < World.MaxX) { LightQueue_Add(&light_spreadBlock, World_Pack(x + 1, y, z)); LightQueue_Add(&light_spreadSky, World_Pack(x + 1, y, z)); }
+	if (y > 0)          { LightQueue_Add(&light_spreadBlock, World_Pack(x, y - 1, z)); LightQueue_Add(&light_spreadSky, World_Pack(x, y - 1, z)); }
+	if (y < World.MaxY) { LightQueue_Add(&light_spreadBlock, World_Pack(x, y + 1, z)); LightQueue_Add(&light_spreadSky, World_Pack(x, y + 1, z)); }
+	if (z > 0)          { LightQueue_Add(&light_spreadBlock, World_Pack(x, y, z - 1)); LightQueue_Add(&light_spreadSky, World_Pack(x, y, z - 1)); }
+	if (z < World.MaxZ) { LightQueue_Add(&light_spreadBlock, World_Pack(x, y, z + 1)); LightQueue_Add(&light_spreadSky, World_Pack(x, y, z + 1)); }
+}
+
+/* Queues up the light changes caused by the given block changing. */
+/* NOTE: Light is only actually propagated by LightLevels_Flush, so that many changes can be handled at once */
+static void LightLevels_OnBlockChanged(int x, int y, int z, BlockID block, int oldHeight, int newHeight) {
+	int index = World_Pack(x, y, z), level, i;
+	if (light_recalc) return;
+
+	/* Light from or passing through the old block must be removed first */
+	level = LightLevels_Get(x, y, z, LIGHT_BLOCK);
+	if (level) {
+		LightLevels_Set(x, y, z, LIGHT_BLOCK, 0);
+		LightQueue_Add(&light_removeBlock, index);
+		LightQueue_Add(&light_removeBlock, level);
+	}
+	/* NOTE: Blocks such as slabs can be above the light height of their column, but still block light */
+	level = LightLevels_Get(x, y, z, LIGHT_SKY);
+	if (level) {
+		if (y <= newHeight) LightLevels_Set(x, y, z, LIGHT_SKY, 0);
+		LightQueue_Add(&light_removeSky, index);
+		LightQueue_Add(&light_removeSky, level);
+	}
+
+	if (Blocks.FullBright[block]) {
+		LightLevels_Set(x, y, z, LIGHT_BLOCK, LIGHT_MAX);
+		LightQueue_Add(&light_spreadBlock, index);
+	}
+	/* Light can now spread out of the new block, and into it from its neighbours */
+	if (!Blocks.BlocksLight[block]) {
+		LightQueue_Add(&light_spreadSky, index);
+		LightLevels_SpreadNeighbours(x, y, z);
+	}
+
+	/* Blocks in the column now in shadow lose their sky light, and blocks now in sunlight spread it */
+	for (i = max(oldHeight, -1) + 1; i <= newHeight; i++) {
+		LightLevels_MarkChanged(x, i, z);
+		LightQueue_Add(&light_removeSky, World_Pack(x, i, z));
+		LightQueue_Add(&light_removeSky, LIGHT_MAX);
+	}
+	for (i = max(newHeight, -1) + 1; i <= oldHeight; i++) {
+		LightLevels_Set(x, i, z, LIGHT_SKY, 0);
+		LightQueue_Add(&light_spreadSky, World_Pack(x, i, z));
+	}
+}
+
+/* Queues up the sunlit blocks in the given column that are next to shadowed blocks at or below the given height */
+static void LightLevels_SeedSky(int x, int z, int height) {
+	int y = max(light_heightmap[Lighting_Pack(x, z)] + 1, 0);
+	for (; y <= height; y++) { LightQueue_Add(&light_spreadSky, World_Pack(x, y, z)); }
+}
+
+/* Next Z row of chunks whose light emitting blocks have not been found yet */
+static int light_nextRow;
+/* light_rowsMutex protects light_nextRow */
+static void* light_rowsMutex;
+
+/* Sets the block light of each light emitting block in the given Z row of chunks to the maximum */
+static void LightLevels_FindSources(int cz) {
+	int z1 = cz << CHUNK_SHIFT, z2 = min(z1 + CHUNK_SIZE, World.Length);
+	int x, y, z;
+
+	for (y = 0; y < World.Height; y++) {
+		for (z = z1; z < z2; z++) {
+			for (x = 0; x < World.Width; x++) {
+				if (Blocks.FullBright[World_GetBlock(x, y, z)]) LightLevels_Set(x, y, z, LIGHT_BLOCK, LIGHT_MAX);
+			}
+		}
+	}
+}
+
+/* NOTE: Each row only sets the light levels of its own chunks, so rows can be searched on all cores */
+static void LightLevels_SourcesWorker(void) {
+	int cz;
+	for (;;) {
+		Mutex_Lock(light_rowsMutex);
+		{
+			cz = light_nextRow++;
+		}
+		Mutex_Unlock(light_rowsMutex);
+
+		if (cz >= light_chunksZ) return;
+		LightLevels_FindSources(cz);
+	}
+}
+
+/* Queues up the light emitting blocks in the given chunk to spread their light */
+static void LightLevels_QueueSources(int index) {
+	cc_uint8* levels = light_levels[index];
+	int cx = index % light_chunksX;
+	int cz = (index / light_chunksX) % light_chunksZ;
+	int cy = index / (light_chunksX * light_chunksZ);
+	int i, x, y, z;
+
+	for (i = 0; i < CHUNK_SIZE_3; i++) {
+		if (!levels[i]) continue;
+		x = (cx << CHUNK_SHIFT) | (i & CHUNK_MASK);
+		z = (cz << CHUNK_SHIFT) | ((i >> 4) & CHUNK_MASK);
+		y = (cy << CHUNK_SHIFT) | (i >> 8);
+		LightQueue_Add(&light_spreadBlock, World_Pack(x, y, z));
+	}
+}
+
+/* Calculates the light levels of every block in the map from scratch. */
+/* NOTE: This is done as soon as the map is loaded or propagated lighting is turned on, */
+/*  rather than when the light levels are first needed, so that it doesn't stall rendering later on */
+static void LightLevels_CalcAll(void) {
+	int x, z, i, height;
+	for (i = 0; i < light_chunksCount; i++) {
+		Mem_Free(light_levels[i]);
+		light_levels[i] = NULL;
+	}
+	light_removeBlock.count = 0; light_removeSky.count = 0;
+	light_spreadBlock.count = 0; light_spreadSky.count = 0;
+	light_recalc = true;
+
+	/* Lazily calculated columns of the heightmap are calculated in parallel too */
+	Lighting_CalcHeightmap();
+
+	light_rowsMutex = Mutex_Create();
+	light_nextRow   = 0;
+	Builder_RunOnWorkers(LightLevels_SourcesWorker);
+	Mutex_Free(light_rowsMutex);
+
+	/* Only chunks containing light emitting blocks have any light levels at this point */
+	for (i = 0; i < light_chunksCount; i++) {
+		if (light_levels[i]) LightLevels_QueueSources(i);
+	}
+
+	/* Sky light spreads sideways into shadowed blocks from sunlit blocks in neighbouring columns */
+	for (z = 0; z < World.Length; z++) {
+		for (x = 0; x < World.Width; x++) {
+			height = min(light_heightmap[Lighting_Pack(x, z)], World.MaxY);
+
+			if (x > 0)          LightLevels_SeedSky(x - 1, z, height);
+			if (x < World.MaxX) LightLevels_SeedSky(x + 1, z, height);
+			if (z > 0)          LightLevels_SeedSky(x, z - 1, height);
+			if (z < World.MaxZ) LightLevels_SeedSky(x, z + 1, height);
+		}
+	}
+
+	LightLevels_Spread(&light_spreadBlock, LIGHT_BLOCK);
+	LightLevels_Spread(&light_spreadSky,   LIGHT_SKY);
+	light_recalc = false;
+}
+
+static void LightLevels_Flush(void) {
+	int i, index, cx, cy, cz;
+	if (!light_levels) return;
+
+	/* Light levels are only invalidated when a block stops or starts blocking light, which is rare */
+	if (light_recalc) { LightLevels_CalcAll(); return; }
+
+	/* Light must be removed before it is spread again */
+	LightLevels_Remove(&light_removeBlock, &light_spreadBlock, LIGHT_BLOCK);
+	LightLevels_Spread(&light_spreadBlock, LIGHT_BLOCK);
+	LightLevels_Remove(&light_removeSky,   &light_spreadSky,   LIGHT_SKY);
+	LightLevels_Spread(&light_spreadSky,   LIGHT_SKY);
+
+	/* Each chunk is only refreshed once, no matter how many of its blocks changed */
+	for (i = 0; i < light_changedChunks.count; i++) {
+		index = light_changedChunks.entries[i];
+		light_changedFlags[index] = false;
+
+		cx = index % light_chunksX;
+		cz = (index / light_chunksX) % light_chunksZ;
+		cy = index / (light_chunksX * light_chunksZ);
+		MapRenderer_RefreshChunk(cx, cy, cz);
+	}
+	light_changedChunks.count = 0;
+}
+
+void Lighting_SetPropagated(cc_bool enabled) {
+	if (Lighting_Propagated == enabled) return;
+	Lighting_Propagated = enabled;
+
+	LightLevels_Free();
+	if (!enabled || !light_heightmap) return;
+	LightLevels_Alloc();
+	LightLevels_CalcAll();
+}
+
+void Lighting_CopyLevels(int startX, int startY, int startZ, cc_uint8* levels) {
+	int x, y, z, sky, block;
+
+	for (y = startY; y < startY + EXTCHUNK_SIZE; y++) {
+		for (z = startZ; z < startZ + EXTCHUNK_SIZE; z++) {
+			for (x = startX; x < startX + EXTCHUNK_SIZE; x++) {
+				if (!World_ContainsXZ(x, z)) {
+					*levels++ = y >= Env.EdgeHeight ? LIGHT_MAX : 0;
+				} else if (y < 0 || y >= World.Height) {
+					*levels++ = LIGHT_MAX;
+				} else {
+					sky   = LightLevels_Get(x, y, z, LIGHT_SKY);
+					block = LightLevels_Get(x, y, z, LIGHT_BLOCK);
+					*levels++ = max(sky, block);
+				}
+			}
+		}
+	}
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Lighting component----------------------------------------------------*
 *#########################################################################################################################*/
+static void OnInit(void) {
+	Lighting_HeightmapMode = Options_GetEnum(OPT_HEIGHTMAP_MODE, HEIGHTMAP_LAZY,
+											HeightmapMode_Names, HEIGHTMAP_MODE_COUNT);
+}
+
 static void OnReset(void) {
 	Mem_Free(light_heightmap);
 	light_heightmap = NULL;
+	LightLevels_Free();
 }
 
 static void OnNewMapLoaded(void) {
 	light_heightmap = (cc_int16*)Mem_TryAlloc(World.Width * World.Length, 2);
 	if (light_heightmap) {
 		Lighting_Refresh();
+		/* Calculating the light levels calculates the entire heightmap too */
+		if (Lighting_Propagated) {
+			LightLevels_Alloc();
+			LightLevels_CalcAll();
+		} else if (Lighting_HeightmapMode != HEIGHTMAP_LAZY) {
+			Lighting_CalcHeightmap();
+		}
 	} else {
 		World_OutOfMemory();
 	}
 }
 
 struct IGameComponent Lighting_Component = {
-	NULL,    /* Init  */
+	OnInit,  /* Init  */
 	OnReset, /* Free  */
 	OnReset, /* Reset */
 	OnReset, /* OnNewMap */
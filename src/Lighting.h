@@ -3,6 +3,7 @@
 #include "PackedCol.h"
 /* Manages lighting of blocks in the world.
 BasicLighting: Uses a simple heightmap, where each block is either in sun or shadow.
+PropagatedLighting: Also spreads light levels from the sky and light emitting blocks to nearby blocks.
    Copyright 2014-2021 ClassiCube | Licensed under BSD-3
 */
 struct IGameComponent;
@@ -20,6 +21,15 @@ void Lighting_LightHint(int startX, int startZ);
 void Lighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
 void Lighting_Refresh(void);
 
+enum HeightmapMode { HEIGHTMAP_LAZY, HEIGHTMAP_COLUMNS, HEIGHTMAP_LAYERS, HEIGHTMAP_MODE_COUNT };
+extern const char* const HeightmapMode_Names[HEIGHTMAP_MODE_COUNT];
+/* How the light heightmap is calculated when a new map is loaded. */
+/* Lazy calculates each column's light height only when first needed (e.g. when building the chunk it is in) */
+/* Columns and Layers instead calculate the entire heightmap once the map has loaded, using the chunk */
+/*  builder threads as well as the main thread, and either scanning down one column at a time or */
+/*  scanning down one horizontal layer at a time. */
+extern int Lighting_HeightmapMode;
+
 /* Returns whether the block at the given coordinates is fully in sunlight. */
 /* NOTE: Does ***NOT*** check that the coordinates are inside the map. */
 cc_bool Lighting_IsLit(int x, int y, int z);
@@ -28,14 +38,20 @@ PackedCol Lighting_Color(int x, int y, int z);
 /* Returns the light colour at the given coordinates. */
 PackedCol Lighting_Color_XSide(int x, int y, int z);
 
-/* _Fast functions assume Lighting_LightHint has already been called */
-/* and performed the necessary calculations for the given x/z coords */
-/* _Fast functions also do NOT check coordinates are inside the map */
+/* Copies the light heights of the 18x18 columns starting at startX/startZ into the given buffer. */
+/* (i.e. heights[(z - startZ) * 18 + (x - startX)] is the light height of column x,z) */
+/* NOTE: Lighting_LightHint must have been called for the same coordinates beforehand. */
+/* NOTE: Entries for columns outside the map are left unchanged. */
+void Lighting_CopyHint(int startX, int startZ, cc_int16* heights);
 
-cc_bool Lighting_IsLit_Fast(int x, int y, int z);
-PackedCol Lighting_Color_Sprite_Fast(int x, int y, int z);
-PackedCol Lighting_Color_YMax_Fast(int x, int y, int z);
-PackedCol Lighting_Color_YMin_Fast(int x, int y, int z);
-PackedCol Lighting_Color_XSide_Fast(int x, int y, int z);
-PackedCol Lighting_Color_ZSide_Fast(int x, int y, int z);
+/* Whether light levels are propagated from the sky and from light emitting blocks. */
+/* NOTE: Light levels are only used by the smooth lighting mesh builder. */
+extern cc_bool Lighting_Propagated;
+/* Sets whether light levels are propagated, allocating or freeing the light levels as needed. */
+/* NOTE: When enabled, the light levels of the entire map are calculated immediately. */
+void Lighting_SetPropagated(cc_bool enabled);
+/* Copies the light levels (0 to 15) of the 18x18x18 blocks starting at startX/startY/startZ into the given buffer. */
+/* (i.e. levels[((y - startY) * 18 + (z - startZ)) * 18 + (x - startX)] is the light level of block x,y,z) */
+/* NOTE: Lighting_LightHint must have been called beforehand, so that queued light changes have been propagated. */
+void Lighting_CopyLevels(int startX, int startY, int startZ, cc_uint8* levels);
 #endif
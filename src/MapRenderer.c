@@ -43,20 +43,41 @@ static struct ChunkInfo** renderChunks;
 static int renderChunksCount;
 /* Distance of each chunk from the camera. */
 static cc_uint32* distances;
+/* Number of chunks in each distance shell, then the index in sortedChunks each shell starts at */
+static int* sortBuckets;
+static int sortBucketsCount;
 /* Maximum number of chunk updates that can be performed in one frame. */
 static int maxChunkUpdates;
+/* Whether chunks hidden behind other chunks are skipped when rendering. */
+static cc_bool occlusionCulling;
+/* Whether which chunks are occluded needs to be recalculated. (e.g. because a chunk was rebuilt) */
+static cc_bool occlusionDirty;
+
+/* Describes a chunk that is visited when calculating which chunks are occluded. */
+struct OcclusionEntry {
+	int index;      /* Index of the chunk in mapChunks */
+	cc_uint8 face;  /* Face the chunk was entered through, FACE_COUNT for the chunks visiting starts from */
+	cc_uint8 dirs;  /* Directions travelled in to reach the chunk (i.e. 1 << face left through) */
+};
+/* Queue of chunks to visit when calculating which chunks are occluded. */
+static struct OcclusionEntry* occlusionQueue;
 
 static void ChunkInfo_Reset(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->CentreX = x + HALF_CHUNK_SIZE; chunk->CentreY = y + HALF_CHUNK_SIZE; 
 	chunk->CentreZ = z + HALF_CHUNK_SIZE;
 #ifndef CC_BUILD_GL11
 	chunk->Vb = 0;
+	chunk->VbOffset = 0; chunk->VbCount = 0;
+	chunk->Slab = -1;
 #endif
 
 	chunk->Visible = true;        chunk->Empty = false;
 	chunk->PendingDelete = false; chunk->AllAir = false;
+	chunk->Building = false;      chunk->Occluded = false;
+	chunk->OcclusionFlags = CHUNKINFO_ALL_CONNECTED;
 	chunk->DrawXMin = false; chunk->DrawXMax = false; chunk->DrawZMin = false;
 	chunk->DrawZMax = false; chunk->DrawYMin = false; chunk->DrawYMax = false;
+	chunk->Lod      = 0;
 
 	chunk->NormalParts      = NULL;
 	chunk->TranslucentParts = NULL;
@@ -74,6 +95,382 @@ CC_NOINLINE static int MapRenderer_UsedAtlases(void) {
 }
 
 
+#ifndef CC_BUILD_GL11
+/*########################################################################################################################*
+*----------------------------------------------------Chunk mesh arena-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Chunk meshes are sub-allocated from a few large vertex buffers ('slabs') shared between chunks, */
+/*  so that the visible ranges of many chunks can be drawn with just one multi draw call, and so that */
+/*  deleting and rebuilding chunks doesn't constantly create and destroy small vertex buffers */
+/* Slabs are GFX_MAX_VERTICES large, so every range in them can be drawn using the shared index buffer */
+#define ARENA_MAX_SLABS 128
+/* Meshes are allocated in units of 'granules' of 16 vertices (i.e. 4 quads) */
+#define ARENA_GRANULE_SHIFT 4
+#define ARENA_GRANULE_MASK ((1 << ARENA_GRANULE_SHIFT) - 1)
+#define ARENA_SLAB_GRANULES (GFX_MAX_VERTICES >> ARENA_GRANULE_SHIFT)
+/* Free ranges are kept in a separate list for each size class (i.e. floor(log2(granules))) */
+#define ARENA_SIZE_CLASSES 13
+
+/* Describes a free range of granules in a slab */
+struct ArenaRange { cc_uint16 slab, start, count; int next; };
+
+struct ArenaSlab {
+	GfxResourceID vb;
+	int used; /* Number of granules allocated to chunk meshes */
+	int top;  /* Granules from this onwards are unused, and aren't in any free list */
+};
+static struct ArenaSlab arenaSlabs[ARENA_MAX_SLABS];
+static int arenaSlabsCount;
+
+/* Pool of free range entries, with unused entries linked together starting at arenaUnused */
+static struct ArenaRange* arenaRanges;
+static int arenaRangesCapacity, arenaUnused = -1;
+/* First free range in each size class, or -1 if no free ranges */
+static int arenaFreeLists[ARENA_SIZE_CLASSES];
+/* Total number of granules in all free ranges */
+static int arenaFreeGranules;
+/* Whether no ranges have been freed since adjacent free ranges were last merged */
+static cc_bool arenaCoalesced;
+/* Number of chunk meshes allocated from slabs, and number of meshes with their own vertex buffer */
+static int arenaMeshes, arenaOwnVbs;
+
+/* Freed ranges may still be read by frames the GPU hasn't finished drawing yet, */
+/*  so they are only reused after this many frames (as slabs are written without syncing with the GPU) */
+#define ARENA_RETIRE_FRAMES 4
+/* Describes a range of granules in a slab that was freed in the given frame */
+struct ArenaRetired { cc_uint16 slab, start, count; cc_uint32 frame; };
+/* Ranges that have been freed but can't be reused yet, in the order they were freed */
+static struct ArenaRetired* arenaRetired;
+static int arenaRetiredCount, arenaRetiredCapacity;
+static cc_uint32 arenaFrame;
+
+#define Arena_Format() (Gfx.PackedVertices ? VERTEX_FORMAT_PACKED : VERTEX_FORMAT_TEXTURED)
+#define Arena_Stride() (Gfx.PackedVertices ? SIZEOF_VERTEX_PACKED : SIZEOF_VERTEX_TEXTURED)
+
+static int Arena_SizeClass(int granules) {
+	int cls = 0;
+	while (granules >>= 1) cls++;
+	return cls;
+}
+
+static void Arena_ResetRanges(void) {
+	int i;
+	for (i = 0; i < ARENA_SIZE_CLASSES; i++) { arenaFreeLists[i] = -1; }
+	for (i = 0; i < arenaRangesCapacity; i++) { arenaRanges[i].next = i + 1; }
+
+	if (arenaRangesCapacity) arenaRanges[arenaRangesCapacity - 1].next = -1;
+	arenaUnused       = arenaRangesCapacity ? 0 : -1;
+	arenaFreeGranules = 0;
+	arenaCoalesced    = true;
+}
+
+static void Arena_AddFree(int slab, int start, int count) {
+	struct ArenaRange* r;
+	int i, cls, oldCapacity = arenaRangesCapacity;
+
+	if (arenaUnused == -1) {
+		arenaRangesCapacity = max(256, oldCapacity * 2);
+		if (arenaRanges) {
+			arenaRanges = (struct ArenaRange*)Mem_Realloc(arenaRanges, arenaRangesCapacity, sizeof(struct ArenaRange), "arena ranges");
+		} else {
+			arenaRanges = (struct ArenaRange*)Mem_Alloc(arenaRangesCapacity, sizeof(struct ArenaRange), "arena ranges");
+		}
+
+		for (i = oldCapacity; i < arenaRangesCapacity; i++) { arenaRanges[i].next = i + 1; }
+		arenaRanges[arenaRangesCapacity - 1].next = -1;
+		arenaUnused = oldCapacity;
+	}
+
+	i   = arenaUnused;
+	r   = &arenaRanges[i];
+	cls = Arena_SizeClass(count);
+	arenaUnused = r->next;
+
+	r->slab  = slab;
+	r->start = start;
+	r->count = count;
+	r->next  = arenaFreeLists[cls];
+	arenaFreeLists[cls] = i;
+	arenaFreeGranules  += count;
+}
+
+/* Takes the first free range in the smallest size class that is large enough */
+static cc_bool Arena_TakeFree(int granules, int* slab, int* start) {
+	struct ArenaRange* r;
+	int cls, i, prev, count;
+
+	for (cls = Arena_SizeClass(granules); cls < ARENA_SIZE_CLASSES; cls++) {
+		for (prev = -1, i = arenaFreeLists[cls]; i >= 0; prev = i, i = r->next) {
+			r = &arenaRanges[i];
+			if (r->count < granules) continue;
+
+			if (prev >= 0) {
+				arenaRanges[prev].next = r->next;
+			} else {
+				arenaFreeLists[cls] = r->next;
+			}
+			*slab = r->slab; *start = r->start; count = r->count;
+
+			r->next     = arenaUnused;
+			arenaUnused = i;
+			arenaFreeGranules -= count;
+
+			/* Return the leftover part of the range to the free lists */
+			if (count > granules) Arena_AddFree(*slab, *start + granules, count - granules);
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Takes unused space from the first slab with enough unused space at its end */
+static cc_bool Arena_TakeTop(int granules, int* slab, int* start) {
+	int i;
+	for (i = 0; i < arenaSlabsCount; i++) {
+		if (arenaSlabs[i].top + granules > ARENA_SLAB_GRANULES) continue;
+
+		*slab  = i;
+		*start = arenaSlabs[i].top;
+		arenaSlabs[i].top += granules;
+		return true;
+	}
+	return false;
+}
+
+static cc_bool Arena_TryTake(int granules, int* slab, int* start) {
+	return Arena_TakeFree(granules, slab, start) || Arena_TakeTop(granules, slab, start);
+}
+
+static cc_bool Arena_TakeNewSlab(int granules, int* slab, int* start) {
+	struct ArenaSlab* s;
+	if (arenaSlabsCount == ARENA_MAX_SLABS) return false;
+	s = &arenaSlabs[arenaSlabsCount];
+
+	s->vb = Gfx_CreateDynamicVb(Arena_Format(), GFX_MAX_VERTICES);
+	if (!s->vb) return false;
+	s->used = 0;
+	s->top  = granules;
+
+	*slab  = arenaSlabsCount++;
+	*start = 0;
+	return true;
+}
+
+/* Merges together adjacent free ranges, and returns free ranges at the end of slabs to unused space */
+static void Arena_Coalesce(void) {
+	cc_uint8* isFree;
+	struct ArenaRange* r;
+	int cls, i, j, beg;
+	if (!arenaSlabsCount) return;
+	isFree = (cc_uint8*)Mem_AllocCleared(arenaSlabsCount, ARENA_SLAB_GRANULES, "arena coalesce");
+
+	for (cls = 0; cls < ARENA_SIZE_CLASSES; cls++) {
+		for (i = arenaFreeLists[cls]; i >= 0; i = r->next) {
+			r = &arenaRanges[i];
+			Mem_Set(isFree + r->slab * ARENA_SLAB_GRANULES + r->start, 1, r->count);
+		}
+	}
+	Arena_ResetRanges();
+
+	for (i = 0; i < arenaSlabsCount; i++) {
+		cc_uint8* slabFree = isFree + i * ARENA_SLAB_GRANULES;
+
+		for (j = 0; j < arenaSlabs[i].top; ) {
+			if (!slabFree[j]) { j++; continue; }
+			for (beg = j; j < arenaSlabs[i].top && slabFree[j]; j++) { }
+
+			if (j == arenaSlabs[i].top) {
+				arenaSlabs[i].top = beg;
+			} else {
+				Arena_AddFree(i, beg, j - beg);
+			}
+		}
+	}
+	Mem_Free(isFree);
+}
+
+/* Allocates vertices for the given chunk's mesh from the arena */
+static cc_bool Arena_Alloc(struct ChunkInfo* info, int count) {
+	int granules = (count + ARENA_GRANULE_MASK) >> ARENA_GRANULE_SHIFT;
+	int slab, start;
+
+	if (!Arena_TryTake(granules, &slab, &start)) {
+		/* There may be enough free space, but fragmented into smaller ranges */
+		if (!arenaCoalesced && arenaFreeGranules >= granules) Arena_Coalesce();
+
+		if (!Arena_TryTake(granules, &slab, &start) && !Arena_TakeNewSlab(granules, &slab, &start)) return false;
+	}
+
+	arenaSlabs[slab].used += granules;
+	arenaMeshes++;
+
+	info->Vb       = arenaSlabs[slab].vb;
+	info->VbOffset = start    << ARENA_GRANULE_SHIFT;
+	info->VbCount  = granules << ARENA_GRANULE_SHIFT;
+	info->Slab     = slab;
+	return true;
+}
+
+/* Removes all the free ranges of the given empty slab, so the entire slab is unused space again */
+static void Arena_ReclaimSlab(int slab) {
+	struct ArenaRange* r;
+	int cls, i, next, prev;
+
+	for (cls = 0; cls < ARENA_SIZE_CLASSES; cls++) {
+		for (prev = -1, i = arenaFreeLists[cls]; i >= 0; i = next) {
+			r    = &arenaRanges[i];
+			next = r->next;
+			if (r->slab != slab) { prev = i; continue; }
+
+			if (prev >= 0) {
+				arenaRanges[prev].next = next;
+			} else {
+				arenaFreeLists[cls] = next;
+			}
+			arenaFreeGranules -= r->count;
+			r->next     = arenaUnused;
+			arenaUnused = i;
+		}
+	}
+	arenaSlabs[slab].top = 0;
+}
+
+/* Returns a retired range to unused space or the free lists, so it can be reused */
+static void Arena_Release(int slab, int start, int granules) {
+	struct ArenaSlab* s = &arenaSlabs[slab];
+	s->used -= granules;
+
+	if (!s->used) {
+		Arena_ReclaimSlab(slab);
+	} else if (start + granules == s->top) {
+		s->top = start;
+	} else {
+		Arena_AddFree(slab, start, granules);
+		arenaCoalesced = false;
+	}
+}
+
+static void Arena_Free(int slab, int offset, int count) {
+	struct ArenaRetired* r;
+	arenaMeshes--;
+
+	if (arenaRetiredCount == arenaRetiredCapacity) {
+		arenaRetiredCapacity = max(256, arenaRetiredCapacity * 2);
+		if (arenaRetired) {
+			arenaRetired = (struct ArenaRetired*)Mem_Realloc(arenaRetired, arenaRetiredCapacity, sizeof(struct ArenaRetired), "arena retired");
+		} else {
+			arenaRetired = (struct ArenaRetired*)Mem_Alloc(arenaRetiredCapacity, sizeof(struct ArenaRetired), "arena retired");
+		}
+	}
+
+	r = &arenaRetired[arenaRetiredCount++];
+	r->slab  = slab;
+	r->start = offset >> ARENA_GRANULE_SHIFT;
+	r->count = count  >> ARENA_GRANULE_SHIFT;
+	r->frame = arenaFrame;
+}
+
+/* Releases ranges retired long enough ago that the GPU can no longer be drawing from them */
+static void Arena_NextFrame(void) {
+	struct ArenaRetired* r;
+	int i, j;
+	arenaFrame++;
+
+	for (i = 0; i < arenaRetiredCount; i++) {
+		r = &arenaRetired[i];
+		if (arenaFrame - r->frame < ARENA_RETIRE_FRAMES) break;
+		Arena_Release(r->slab, r->start, r->count);
+	}
+	if (!i) return;
+
+	arenaRetiredCount -= i;
+	for (j = 0; j < arenaRetiredCount; j++) { arenaRetired[j] = arenaRetired[j + i]; }
+}
+
+static void Arena_FreeAll(void) {
+	int i;
+	for (i = 0; i < arenaSlabsCount; i++) {
+		Gfx_DeleteDynamicVb(&arenaSlabs[i].vb);
+	}
+	arenaSlabsCount   = 0;
+	arenaMeshes       = 0;
+	arenaOwnVbs       = 0;
+	arenaRetiredCount = 0;
+	Arena_ResetRanges();
+}
+
+static void FreeMesh(struct ChunkInfo* info) {
+	if (info->Slab >= 0) {
+		Arena_Free(info->Slab, info->VbOffset, info->VbCount);
+		info->Vb   = 0;
+		info->Slab = -1;
+	} else if (info->Vb) {
+		Gfx_DeleteVb(&info->Vb);
+		arenaOwnVbs--;
+	}
+	info->VbOffset = 0; info->VbCount = 0;
+}
+
+void MapRenderer_UploadMesh(struct ChunkInfo* info, void* vertices, int count) {
+	void* data;
+	FreeMesh(info);
+	/* add an extra element to fix crashing on some GPUs */
+	count++;
+
+	if (count <= GFX_MAX_VERTICES && Arena_Alloc(info, count)) {
+		Gfx_SetDynamicVbRange(info->Vb, Arena_Format(), vertices, info->VbOffset, count - 1);
+		return;
+	}
+
+	/* Mesh is too large to fit in a slab (or there are too many slabs) */
+	data = Gfx_RecreateAndLockVb(&info->Vb, Arena_Format(), count);
+	Mem_Copy(data, vertices, (count - 1) * Arena_Stride());
+	Gfx_UnlockVb(info->Vb);
+
+	info->VbCount = count;
+	if (info->Vb) arenaOwnVbs++;
+}
+
+void MapRenderer_GetArenaInfo(cc_string* info) {
+	float slabsMB, usedMB, freeMB, largestMB;
+	int i, cls, largest = 0, unused = 0, used = 0, ranges = 0, frag;
+	struct ArenaRange* r;
+	/* Free ranges and unused space are measured in granules, but reported in megabytes */
+	float granuleMB = ((1 << ARENA_GRANULE_SHIFT) * Arena_Stride()) / (1024.0f * 1024.0f);
+
+	for (i = 0; i < arenaSlabsCount; i++) {
+		used    += arenaSlabs[i].used;
+		unused  += ARENA_SLAB_GRANULES - arenaSlabs[i].top;
+		largest  = max(largest, ARENA_SLAB_GRANULES - arenaSlabs[i].top);
+	}
+	for (cls = 0; cls < ARENA_SIZE_CLASSES; cls++) {
+		for (i = arenaFreeLists[cls]; i >= 0; i = r->next) {
+			r = &arenaRanges[i];
+			largest = max(largest, r->count);
+			ranges++;
+		}
+	}
+
+	slabsMB   = arenaSlabsCount * ARENA_SLAB_GRANULES * granuleMB;
+	usedMB    = used * granuleMB;
+	freeMB    = (arenaFreeGranules + unused) * granuleMB;
+	largestMB = largest * granuleMB;
+	/* Fragmentation = how much of the free space isn't in the largest free range */
+	frag = (arenaFreeGranules + unused) ? 100 - (100 * largest) / (arenaFreeGranules + unused) : 0;
+
+	String_Format2(info, "Chunk mesh slabs: %i (%f2 MB)\n", &arenaSlabsCount, &slabsMB);
+	String_Format2(info, "Used: %f2 MB by %i meshes\n", &usedMB, &arenaMeshes);
+	String_Format3(info, "Free: %f2 MB in %i ranges (largest %f2 MB)\n", &freeMB, &ranges, &largestMB);
+	String_Format1(info, "Fragmentation: %i%%\n", &frag);
+	String_Format1(info, "Meshes with their own vertex buffer: %i", &arenaOwnVbs);
+}
+#else
+void MapRenderer_GetArenaInfo(cc_string* info) {
+	String_AppendConst(info, "Chunk meshes aren't sub-allocated with OpenGL 1.1");
+}
+#endif
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------Map rendering-----------------------------------------------------*
 *#########################################################################################################################*/
@@ -97,16 +494,18 @@ static void CheckWeather(double delta) {
 #ifdef CC_BUILD_GL11
 #define DrawFace(face, ign)    Gfx_BindVb(part.Vbs[face]); Gfx_DrawIndexedTris_T2fC4b(0, 0);
 #define DrawFaces(f1, f2, ign) DrawFace(f1, ign); DrawFace(f2, ign);
+#define DrawCulledFaces(f1, f2, ign) Gfx_SetFaceCulling(true); DrawFaces(f1, f2, ign); Gfx_SetFaceCulling(false);
+#define BeginChunkRanges(info)
+#define EndChunkRanges()
 #else
-#define DrawFace(face, offset)    Gfx_DrawIndexedTris_T2fC4b(part.Counts[face], offset);
-#define DrawFaces(f1, f2, offset) Gfx_DrawIndexedTris_T2fC4b(part.Counts[f1] + part.Counts[f2], offset);
+#define DrawFace(face, offset)          AddDrawRange(false, part.Counts[face], offset);
+#define DrawFaces(f1, f2, offset)       AddDrawRange(false, part.Counts[f1] + part.Counts[f2], offset);
+#define DrawCulledFaces(f1, f2, offset) AddDrawRange(true,  part.Counts[f1] + part.Counts[f2], offset);
 #endif
 
 #define DrawNormalFaces(minFace, maxFace) \
 if (drawMin && drawMax) { \
-	Gfx_SetFaceCulling(true); \
-	DrawFaces(minFace, maxFace, offset); \
-	Gfx_SetFaceCulling(false); \
+	DrawCulledFaces(minFace, maxFace, offset); \
 	Game_Vertices += (part.Counts[minFace] + part.Counts[maxFace]); \
 } else if (drawMin) { \
 	DrawFace(minFace, offset); \
@@ -116,6 +515,153 @@ if (drawMin && drawMax) { \
 	Game_Vertices += part.Counts[maxFace]; \
 }
 
+/* Packed vertices have fixed point positions relative to their chunk, which the view matrix must account for */
+static void LoadChunkMatrix(struct ChunkInfo* info) {
+	struct Matrix scale, translate, m;
+	Matrix_Scale(&scale, 1.0f / PACKED_VERTEX_POS_SCALE, 1.0f / PACKED_VERTEX_POS_SCALE, 1.0f / PACKED_VERTEX_POS_SCALE);
+	Matrix_Translate(&translate, info->CentreX - 8, info->CentreY - 8, info->CentreZ - 8);
+
+	Matrix_Mul(&m, &scale, &translate);
+	Matrix_Mul(&m, &m, &Gfx.View);
+	Gfx_LoadMatrix(MATRIX_VIEW, &m);
+}
+
+#ifndef CC_BUILD_GL11
+/* Ranges of vertices in chunk meshes that are queued to be drawn */
+/* Ranges are grouped by 'key' (arena slab index * 2 + whether face culling must be enabled) */
+#define MAX_DRAW_RANGES 4096
+#define MAX_DRAW_KEYS (ARENA_MAX_SLABS * 2)
+struct DrawRange { int key, start, count; };
+static struct DrawRange drawRanges[MAX_DRAW_RANGES];
+static int drawRangesCount, drawKeysCount;
+/* Queued ranges after being sorted by key, in the format expected by Gfx_MultiDrawIndexedTris_T2fC4b */
+static int sortedCounts[MAX_DRAW_RANGES], sortedStarts[MAX_DRAW_RANGES];
+static int keyOffsets[MAX_DRAW_KEYS + 1];
+
+/* Offset of the current chunk's mesh in its vertex buffer, and slab index used for its ranges' keys */
+static int drawBase, drawSlab;
+/* Whether ranges of many chunks are being queued, with each slab only bound when the ranges are drawn */
+/* (otherwise only ranges of one chunk are queued, whose vertex buffer is already bound) */
+static cc_bool drawGrouped;
+/* Whether the queued ranges are in arena slabs (i.e. can be drawn using a multi draw) */
+static cc_bool drawMulti;
+/* Whether the queued ranges must be drawn in the order they were queued (e.g. translucent chunks) */
+static cc_bool drawOrdered;
+
+static void DrawRanges(int beg, int end) {
+	int i;
+	if (drawMulti) {
+		Gfx_MultiDrawIndexedTris_T2fC4b(sortedCounts + beg, sortedStarts + beg, end - beg);
+	} else {
+		for (i = beg; i < end; i++) { Gfx_DrawIndexedTris_T2fC4b(sortedCounts[i], sortedStarts[i]); }
+	}
+}
+
+static void DrawKeyRanges(int key, int beg, int end, int* boundSlab) {
+	if (drawGrouped && (key >> 1) != *boundSlab) {
+		*boundSlab = key >> 1;
+		Gfx_BindVb_Textured(arenaSlabs[*boundSlab].vb);
+	}
+
+	if (key & 1) Gfx_SetFaceCulling(true);
+	DrawRanges(beg, end);
+	if (key & 1) Gfx_SetFaceCulling(false);
+}
+
+/* Draws all queued ranges in the order they were queued, with one draw call for each run of ranges with the same key */
+static void FlushOrderedRanges(void) {
+	int i, key, beg, end, boundSlab = -1;
+
+	for (i = 0; i < drawRangesCount; i++) {
+		sortedCounts[i] = drawRanges[i].count;
+		sortedStarts[i] = drawRanges[i].start;
+	}
+
+	for (beg = 0; beg < drawRangesCount; beg = end) {
+		key = drawRanges[beg].key;
+		for (end = beg + 1; end < drawRangesCount && drawRanges[end].key == key; end++) { }
+		DrawKeyRanges(key, beg, end, &boundSlab);
+	}
+}
+
+/* Draws all queued ranges, with one draw call for each slab and face culling state */
+static void FlushDrawRanges(void) {
+	struct DrawRange* r;
+	int i, key, beg, end, boundSlab = -1;
+	if (!drawRangesCount) return;
+
+	/* Sorting would change the order chunks are blended in */
+	if (drawOrdered) {
+		FlushOrderedRanges();
+		drawRangesCount = 0;
+		drawKeysCount   = 0;
+		return;
+	}
+
+	/* Counting sort ranges by their keys */
+	for (key = 0; key <= drawKeysCount; key++) { keyOffsets[key] = 0; }
+	for (i = 0; i < drawRangesCount; i++) { keyOffsets[drawRanges[i].key + 1]++; }
+	for (key = 1; key <= drawKeysCount; key++) { keyOffsets[key] += keyOffsets[key - 1]; }
+
+	for (i = 0; i < drawRangesCount; i++) {
+		r = &drawRanges[i];
+		sortedCounts[keyOffsets[r->key]] = r->count;
+		sortedStarts[keyOffsets[r->key]] = r->start;
+		keyOffsets[r->key]++;
+	}
+
+	/* keyOffsets[key] is now the end of the key's ranges */
+	for (key = 0, beg = 0; key < drawKeysCount; key++, beg = end) {
+		end = keyOffsets[key];
+		if (beg == end) continue;
+		DrawKeyRanges(key, beg, end, &boundSlab);
+	}
+	drawRangesCount = 0;
+	drawKeysCount   = 0;
+}
+
+static void AddDrawRange(cc_bool culled, int count, int offset) {
+	int key   = drawSlab * 2 + culled;
+	int start = drawBase + offset;
+	struct DrawRange* last;
+
+	/* Extend the previous range instead when contiguous (e.g. consecutive faces) */
+	if (drawRangesCount) {
+		last = &drawRanges[drawRangesCount - 1];
+		if (last->key == key && last->start + last->count == start) { last->count += count; return; }
+	}
+	if (drawRangesCount == MAX_DRAW_RANGES) FlushDrawRanges();
+
+	drawRanges[drawRangesCount].key   = key;
+	drawRanges[drawRangesCount].start = start;
+	drawRanges[drawRangesCount].count = count;
+	drawRangesCount++;
+	drawKeysCount = max(drawKeysCount, key + 1);
+}
+
+/* Prepares to queue ranges of the given chunk's mesh, drawing previously queued ranges if necessary */
+static void BeginChunkRanges(struct ChunkInfo* info) {
+	/* Packed vertices are relative to their chunk, so can't be drawn together with other chunks */
+	cc_bool grouped = info->Slab >= 0 && !Gfx.PackedVertices;
+	drawBase = info->VbOffset;
+	drawSlab = grouped ? info->Slab : 0;
+	if (grouped && drawGrouped) return;
+
+	FlushDrawRanges();
+	drawGrouped = grouped;
+	drawMulti   = info->Slab >= 0;
+	if (grouped) return;
+
+	Gfx_BindVb_Textured(info->Vb);
+	if (Gfx.PackedVertices) LoadChunkMatrix(info);
+}
+
+static void EndChunkRanges(void) {
+	FlushDrawRanges();
+	drawGrouped = false;
+}
+#endif
+
 static void RenderNormalBatch(int batch) {
 	int batchOffset = MapRenderer_ChunksCount * batch;
 	struct ChunkInfo* info;
@@ -130,10 +676,7 @@ static void RenderNormalBatch(int batch) {
 		part = info->NormalParts[batchOffset];
 		if (part.Offset < 0) continue;
 		hasNormParts[batch] = true;
-
-#ifndef CC_BUILD_GL11
-		Gfx_BindVb_Textured(info->Vb);
-#endif
+		BeginChunkRanges(info);
 
 		offset  = part.Offset + part.SpriteCount;
 		drawMin = info->DrawXMin && part.Counts[FACE_XMIN];
@@ -154,38 +697,38 @@ static void RenderNormalBatch(int batch) {
 		offset = part.Offset;
 		count  = part.SpriteCount >> 2; /* 4 per sprite */
 
-		Gfx_SetFaceCulling(true);
 		/* TODO: fix to not render them all */
 #ifdef CC_BUILD_GL11
+		Gfx_SetFaceCulling(true);
 		Gfx_DrawIndexedTris_T2fC4b(part.Vbs[FACE_COUNT], 0);
 		Game_Vertices += count * 4;
 		Gfx_SetFaceCulling(false);
-		continue;
-#endif
+#else
 		if (info->DrawXMax || info->DrawZMin) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			AddDrawRange(true, count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->DrawXMin || info->DrawZMax) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			AddDrawRange(true, count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->DrawXMin || info->DrawZMin) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			AddDrawRange(true, count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->DrawXMax || info->DrawZMax) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			AddDrawRange(true, count, offset); Game_Vertices += count;
 		}
-		Gfx_SetFaceCulling(false);
+#endif
 	}
+	EndChunkRanges();
 }
 
 void MapRenderer_RenderNormal(double delta) {
 	int batch;
 	if (!mapChunks) return;
 
-	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	Gfx_SetVertexFormat(Gfx.PackedVertices ? VERTEX_FORMAT_PACKED : VERTEX_FORMAT_TEXTURED);
 	Gfx_SetTexturing(true);
 	Gfx_SetAlphaTest(true);
 	
@@ -199,13 +742,11 @@ void MapRenderer_RenderNormal(double delta) {
 		}
 	}
 	Gfx_DisableMipmaps();
+	if (Gfx.PackedVertices) Gfx_LoadMatrix(MATRIX_VIEW, &Gfx.View);
 
 	CheckWeather(delta);
 	Gfx_SetAlphaTest(false);
 	Gfx_SetTexturing(false);
-#if DEBUG_OCCLUSION
-	DebugPickedPos();
-#endif
 }
 
 #define DrawTranslucentFaces(minFace, maxFace) \
@@ -226,6 +767,10 @@ static void RenderTranslucentBatch(int batch) {
 	struct ChunkPartInfo part;
 	cc_bool drawMin, drawMax;
 	int i, offset;
+#ifndef CC_BUILD_GL11
+	/* Translucent chunks must be blended in distance order */
+	drawOrdered = true;
+#endif
 
 	for (i = 0; i < renderChunksCount; i++) {
 		info = renderChunks[i];
@@ -234,10 +779,7 @@ static void RenderTranslucentBatch(int batch) {
 		part = info->TranslucentParts[batchOffset];
 		if (part.Offset < 0) continue;
 		hasTranParts[batch] = true;
-
-#ifndef CC_BUILD_GL11
-		Gfx_BindVb_Textured(info->Vb);
-#endif
+		BeginChunkRanges(info);
 
 		offset  = part.Offset;
 		drawMin = (inTranslucent || info->DrawXMin) && part.Counts[FACE_XMIN];
@@ -254,6 +796,10 @@ static void RenderTranslucentBatch(int batch) {
 		drawMax = (inTranslucent || info->DrawYMax) && part.Counts[FACE_YMAX];
 		DrawTranslucentFaces(FACE_YMIN, FACE_YMAX);
 	}
+	EndChunkRanges();
+#ifndef CC_BUILD_GL11
+	drawOrdered = false;
+#endif
 }
 
 void MapRenderer_RenderTranslucent(double delta) {
@@ -262,7 +808,7 @@ void MapRenderer_RenderTranslucent(double delta) {
 
 	/* First fill depth buffer */
 	vertices = Game_Vertices;
-	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	Gfx_SetVertexFormat(Gfx.PackedVertices ? VERTEX_FORMAT_PACKED : VERTEX_FORMAT_TEXTURED);
 	Gfx_SetTexturing(false);
 	Gfx_SetAlphaBlending(false);
 	Gfx_SetColWriteMask(false, false, false, false);
@@ -290,6 +836,7 @@ void MapRenderer_RenderTranslucent(double delta) {
 		RenderTranslucentBatch(batch);
 	}
 	Gfx_DisableMipmaps();
+	if (Gfx.PackedVertices) Gfx_LoadMatrix(MATRIX_VIEW, &Gfx.View);
 
 	Gfx_SetDepthWrite(true);
 	/* If we weren't under water, render weather after to blend properly */
@@ -306,20 +853,13 @@ void MapRenderer_RenderTranslucent(double delta) {
 /*########################################################################################################################*
 *---------------------------------------------------Chunk functionality---------------------------------------------------*
 *#########################################################################################################################*/
-/* Deletes vertex buffer associated with the given chunk and updates internal state */
-static void DeleteChunk(struct ChunkInfo* info) {
+void MapRenderer_DeleteMesh(struct ChunkInfo* info) {
 	struct ChunkPartInfo* ptr;
 	int i;
 #ifdef CC_BUILD_GL11
 	int j;
 #else
-	Gfx_DeleteVb(&info->Vb);
-#endif
-
-	info->Empty = false; info->AllAir = false;
-#ifdef OCCLUSION
-	info.OcclusionFlags = 0;
-	info.OccludedFlags = 0;
+	FreeMesh(info);
 #endif
 
 	if (info->NormalParts) {
@@ -347,18 +887,27 @@ static void DeleteChunk(struct ChunkInfo* info) {
 	}
 }
 
-/* Builds the mesh (hence vertex buffer) for the given chunk, and updates internal state */
-static void BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
+void MapRenderer_SetOcclusionFlags(struct ChunkInfo* info, cc_uint32 flags) {
+	if (info->OcclusionFlags == flags) return;
+	info->OcclusionFlags = flags;
+	occlusionDirty = true;
+}
+
+/* Deletes vertex buffer associated with the given chunk and updates internal state */
+static void DeleteChunk(struct ChunkInfo* info) {
+	info->Empty = false; info->AllAir = false;
+	MapRenderer_DeleteMesh(info);
+}
+
+/* Updates internal state after the mesh for the given chunk has been built */
+static void AddChunkParts(struct ChunkInfo* info) {
 	struct ChunkPartInfo* ptr;
 	int i;
 
-	Game.ChunkUpdates++;
-	(*chunkUpdates)++;
-	info->PendingDelete = false;
-	Builder_MakeChunk(info);
-
 	if (!info->NormalParts && !info->TranslucentParts) {
-		info->Empty = true; return;
+		/* Chunk may have been changed again while its mesh was being built */
+		if (!info->PendingDelete) info->Empty = true;
+		return;
 	}
 	
 	if (info->NormalParts) {
@@ -376,6 +925,34 @@ static void BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
 	}
 }
 
+/* Builds the mesh (hence vertex buffer) for the given chunk, and updates internal state */
+static void BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
+	cc_bool queued;
+	Game.ChunkUpdates++;
+	(*chunkUpdates)++;
+
+	/* NOTE: The chunk's current mesh is still drawn until the builder replaces it */
+	info->Empty = false;
+	/* NOTE: Builder checks PendingDelete to tell whether the chunk was changed */
+	queued = Builder_MakeChunk(info);
+	info->PendingDelete = false;
+
+	/* Chunk is instead finished later in FinishChunks when built in the background */
+	if (!queued) AddChunkParts(info);
+}
+
+/* Updates internal state for all chunks that have finished being built in the background */
+static int FinishChunks(void) {
+	struct ChunkInfo* info;
+	int finished = 0;
+
+	while ((info = Builder_FinishChunk())) {
+		AddChunkParts(info);
+		finished++;
+	}
+	return finished;
+}
+
 
 /*########################################################################################################################*
 *----------------------------------------------------Chunks mangagement---------------------------------------------------*
@@ -391,11 +968,15 @@ static void FreeChunks(void) {
 	Mem_Free(sortedChunks);
 	Mem_Free(renderChunks);
 	Mem_Free(distances);
+	Mem_Free(occlusionQueue);
+	Mem_Free(sortBuckets);
 
 	mapChunks    = NULL;
 	sortedChunks = NULL;
 	renderChunks = NULL;
 	distances    = NULL;
+	occlusionQueue = NULL;
+	sortBuckets    = NULL;
 }
 
 static void AllocateParts(void) {
@@ -412,6 +993,12 @@ static void AllocateChunks(void) {
 	sortedChunks = (struct ChunkInfo**)Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct ChunkInfo*), "sorted chunk info");
 	renderChunks = (struct ChunkInfo**)Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct ChunkInfo*), "render chunk info");
 	distances    = (cc_uint32*)Mem_Alloc(MapRenderer_ChunksCount, 4, "chunk distances");
+	occlusionQueue = (struct OcclusionEntry*)Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct OcclusionEntry), "chunk occlusion");
+
+	/* Furthest distance shell from a camera inside the map is from one corner to the opposite corner */
+	sortBucketsCount = (MapRenderer_ChunksX - 1) * (MapRenderer_ChunksX - 1) + (MapRenderer_ChunksY - 1) * (MapRenderer_ChunksY - 1)
+		+ (MapRenderer_ChunksZ - 1) * (MapRenderer_ChunksZ - 1) + 1;
+	sortBuckets = (int*)Mem_Alloc(sortBucketsCount, sizeof(int), "chunk sort buckets");
 }
 
 static void ResetPartFlags(void) {
@@ -445,6 +1032,7 @@ static void InitChunks(void) {
 			}
 		}
 	}
+	occlusionDirty = true;
 }
 
 static void ResetChunks(void) {
@@ -457,23 +1045,28 @@ static void ResetChunks(void) {
 			}
 		}
 	}
+	occlusionDirty = true;
 }
 
 static void DeleteChunks(void) {
 	int i;
 	if (!mapChunks) return;
+	Builder_CancelAll();
 
 	for (i = 0; i < MapRenderer_ChunksCount; i++) {
 		DeleteChunk(&mapChunks[i]);
 	}
 	ResetPartCounts();
+#ifndef CC_BUILD_GL11
+	Arena_FreeAll();
+#endif
 }
 
 void MapRenderer_Refresh(void) {
 	int oldCount;
 	chunkPos = IVec3_MaxValue();
 
-	if (mapChunks && World.Blocks) {
+	if (mapChunks && World_HasBlocks()) {
 		DeleteChunks();
 		ResetChunks();
 
@@ -494,7 +1087,7 @@ static void RefreshBorderChunks(int maxHeight) {
 	cc_bool onBorder;
 
 	chunkPos = IVec3_MaxValue();
-	if (!mapChunks || !World.Blocks) return;
+	if (!mapChunks || !World_HasBlocks()) return;
 
 	for (cz = 0; cz < MapRenderer_ChunksZ; cz++) {
 		for (cy = 0; cy < MapRenderer_ChunksY; cy++) {
@@ -523,6 +1116,18 @@ static int renderDistSquared;
 /* Max distance from camera that chunks are built within */
 /* Chunks past this distance are automatically unloaded */
 static int buildDistSquared;
+/* Distance from camera that chunks start being built with simplified meshes, 0 to always use full detail */
+static int lodDistance;
+
+/* Returns the level of detail that a chunk at the given distance from the camera should be built at */
+/* Each further level of detail starts at twice the distance of the previous level */
+static int CalcLod(int distSqr) {
+	int lod, dist = lodDistance;
+	if (!dist) return 0;
+
+	for (lod = 0; lod < CHUNK_MAX_LOD && distSqr >= dist * dist; lod++) { dist *= 2; }
+	return lod;
+}
 
 static int AdjustDist(int dist) {
 	if (dist < CHUNK_SIZE) dist = CHUNK_SIZE;
@@ -540,28 +1145,30 @@ static int UpdateChunksAndVisibility(int* chunkUpdates) {
 	int buildDistSqr  = buildDistSquared;
 
 	struct ChunkInfo* info;
-	int i, j = 0, distSqr;
+	int i, j = 0, distSqr, lod;
 	cc_bool noData;
 
 	for (i = 0; i < MapRenderer_ChunksCount; i++) {
-		info = sortedChunks[i];
-		if (info->Empty) continue;
-
+		info    = sortedChunks[i];
 		distSqr = distances[i];
+		lod     = CalcLod(distSqr);
+		/* Chunks with no mesh at a level of detail also have no mesh at any lower level of detail */
+		if (info->Empty && (info->AllAir || info->Lod <= lod)) continue;
+
 		noData  = !info->NormalParts && !info->TranslucentParts;
 		
 		/* Auto unload chunks far away chunks */
 		if (!noData && distSqr >= buildDistSqr + 32 * 16) {
 			DeleteChunk(info); continue;
 		}
-		noData |= info->PendingDelete;
+		noData |= info->PendingDelete || info->Lod != lod;
 
-		if (noData && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			DeleteChunk(info);
+		if (noData && !info->Building && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget && Builder_CanQueue()) {
+			info->Lod = lod;
 			BuildChunk(info, chunkUpdates);
 		}
 
-		info->Visible = distSqr <= renderDistSqr &&
+		info->Visible = !info->Occluded && distSqr <= renderDistSqr &&
 			FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
 		if (info->Visible && !info->Empty) { renderChunks[j] = info; j++; }
 	}
@@ -573,50 +1180,170 @@ static int UpdateChunksStill(int* chunkUpdates) {
 	int buildDistSqr  = buildDistSquared;
 
 	struct ChunkInfo* info;
-	int i, j = 0, distSqr;
+	int i, j = 0, distSqr, lod;
 	cc_bool noData;
 
 	for (i = 0; i < MapRenderer_ChunksCount; i++) {
-		info = sortedChunks[i];
-		if (info->Empty) continue;
-
+		info    = sortedChunks[i];
 		distSqr = distances[i];
+		lod     = CalcLod(distSqr);
+		/* Chunks with no mesh at a level of detail also have no mesh at any lower level of detail */
+		if (info->Empty && (info->AllAir || info->Lod <= lod)) continue;
+
 		noData  = !info->NormalParts && !info->TranslucentParts;
 
 		/* Auto unload chunks far away chunks */
 		if (!noData && distSqr >= buildDistSqr + 32 * 16) {
 			DeleteChunk(info); continue;
 		}
-		noData |= info->PendingDelete;
+		noData |= info->PendingDelete || info->Lod != lod;
 
-		if (noData && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			DeleteChunk(info);
+		if (noData && !info->Building && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget && Builder_CanQueue()) {
+			info->Lod = lod;
 			BuildChunk(info, chunkUpdates);
 
 			/* only need to update the visibility of chunks in range. */
-			info->Visible = distSqr <= renderDistSqr &&
+			info->Visible = !info->Occluded && distSqr <= renderDistSqr &&
 				FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
 			if (info->Visible && !info->Empty) { renderChunks[j] = info; j++; }
-		} else if (info->Visible) {
+		} else if (info->Visible && !info->Empty) {
 			renderChunks[j] = info; j++;
 		}
 	}
 	return j;
 }
 
+static const cc_int8 occlusionDirX[FACE_COUNT] = { -1,1, 0,0,  0,0 };
+static const cc_int8 occlusionDirY[FACE_COUNT] = {  0,0, 0,0, -1,1 };
+static const cc_int8 occlusionDirZ[FACE_COUNT] = {  0,0, -1,1, 0,0 };
+
+/* Whether the given chunk is within render distance of the camera and inside the view frustum */
+static cc_bool OcclusionInView(struct ChunkInfo* info) {
+	/* Camera may be far outside the map, so squared distance could overflow an int */
+	float dx = (float)(info->CentreX - chunkPos.X);
+	float dy = (float)(info->CentreY - chunkPos.Y);
+	float dz = (float)(info->CentreZ - chunkPos.Z);
+
+	return dx * dx + dy * dy + dz * dz <= renderDistSquared &&
+		FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14);
+}
+
+/* Adds the chunks on the sides of the map facing the camera as the chunks to start visiting from */
+/* (any chunk visible from outside the map must be seen through one of those chunks) */
+static int AddOutsideStartChunks(int cx, int cy, int cz) {
+	int x, y, z, index, tail = 0;
+	int dirs = 0;
+	cc_bool onSide;
+
+	/* Only travel away from the camera along the axes the camera is outside the map on */
+	if (cx < 0) dirs |= 1 << FACE_XMAX; else if (cx >= MapRenderer_ChunksX) dirs |= 1 << FACE_XMIN;
+	if (cy < 0) dirs |= 1 << FACE_YMAX; else if (cy >= MapRenderer_ChunksY) dirs |= 1 << FACE_YMIN;
+	if (cz < 0) dirs |= 1 << FACE_ZMAX; else if (cz >= MapRenderer_ChunksZ) dirs |= 1 << FACE_ZMIN;
+
+	for (y = 0; y < MapRenderer_ChunksY; y++) {
+		for (z = 0; z < MapRenderer_ChunksZ; z++) {
+			for (x = 0; x < MapRenderer_ChunksX; x++) {
+				onSide =
+					(cx < 0 && x == 0) || (cx >= MapRenderer_ChunksX && x == MapRenderer_ChunksX - 1) ||
+					(cy < 0 && y == 0) || (cy >= MapRenderer_ChunksY && y == MapRenderer_ChunksY - 1) ||
+					(cz < 0 && z == 0) || (cz >= MapRenderer_ChunksZ && z == MapRenderer_ChunksZ - 1);
+				if (!onSide) continue;
+
+				index = MapRenderer_Pack(x, y, z);
+				if (!OcclusionInView(&mapChunks[index])) continue;
+
+				mapChunks[index].Occluded  = false;
+				occlusionQueue[tail].index = index;
+				occlusionQueue[tail].face  = FACE_COUNT;
+				occlusionQueue[tail].dirs  = dirs;
+				tail++;
+			}
+		}
+	}
+	return tail;
+}
+
+/* Marks all chunks that cannot be seen from the chunk the camera is in as occluded. */
+/* Chunks are visited outwards from the camera chunk, only ever travelling away from the camera, */
+/*  and only leaving a chunk through faces that can be seen from the face the chunk was entered through. */
+static void CalcOcclusion(void) {
+	struct OcclusionEntry* entry;
+	struct ChunkInfo* info;
+	struct ChunkInfo* next;
+	int head = 0, tail = 0;
+	int cx, cy, cz, x, y, z;
+	int i, face, index;
+
+	occlusionDirty = false;
+	cx = chunkPos.X >> CHUNK_SHIFT; cy = chunkPos.Y >> CHUNK_SHIFT; cz = chunkPos.Z >> CHUNK_SHIFT;
+
+	if (!occlusionCulling) {
+		for (i = 0; i < MapRenderer_ChunksCount; i++) { mapChunks[i].Occluded = false; }
+		return;
+	}
+	for (i = 0; i < MapRenderer_ChunksCount; i++) { mapChunks[i].Occluded = true; }
+
+	if (cx < 0 || cy < 0 || cz < 0 || cx >= MapRenderer_ChunksX
+		|| cy >= MapRenderer_ChunksY || cz >= MapRenderer_ChunksZ) {
+		tail = AddOutsideStartChunks(cx, cy, cz);
+	} else {
+		index = MapRenderer_Pack(cx, cy, cz);
+		mapChunks[index].Occluded = false;
+		occlusionQueue[tail].index = index;
+		occlusionQueue[tail].face  = FACE_COUNT;
+		occlusionQueue[tail].dirs  = 0;
+		tail++;
+	}
+
+	while (head < tail) {
+		entry = &occlusionQueue[head++];
+		info  = &mapChunks[entry->index];
+		x = info->CentreX >> CHUNK_SHIFT; y = info->CentreY >> CHUNK_SHIFT; z = info->CentreZ >> CHUNK_SHIFT;
+
+		for (face = 0; face < FACE_COUNT; face++) {
+			/* Never travel back towards the camera (face ^ 1 is the opposite face) */
+			if (entry->dirs & (1 << (face ^ 1))) continue;
+			if (entry->face != FACE_COUNT && !(info->OcclusionFlags & ChunkInfo_ConnectedBit(entry->face, face))) continue;
+
+			cx = x + occlusionDirX[face]; cy = y + occlusionDirY[face]; cz = z + occlusionDirZ[face];
+			if (cx < 0 || cy < 0 || cz < 0 || cx >= MapRenderer_ChunksX
+				|| cy >= MapRenderer_ChunksY || cz >= MapRenderer_ChunksZ) continue;
+
+			index = MapRenderer_Pack(cx, cy, cz);
+			next  = &mapChunks[index];
+			if (!next->Occluded) continue; /* already visited */
+
+			if (!OcclusionInView(next)) continue;
+
+			next->Occluded = false;
+			occlusionQueue[tail].index = index;
+			occlusionQueue[tail].face  = face ^ 1;
+			occlusionQueue[tail].dirs  = entry->dirs | (1 << face);
+			tail++;
+		}
+	}
+}
+
 static void UpdateChunks(double delta) {
 	struct LocalPlayer* p;
 	cc_bool samePos;
-	int chunkUpdates = 0;
+	int chunkUpdates = 0, finished;
 
 	/* Build more chunks if 30 FPS or over, otherwise slowdown */
 	chunksTarget += delta < CHUNK_TARGET_TIME ? 1 : -1; 
 	Math_Clamp(chunksTarget, 4, maxChunkUpdates);
+	finished = FinishChunks();
 
 	p = &LocalPlayer_Instance;
 	samePos = Vec3_Equals(&Camera.CurrentPos, &lastCamPos)
 		&& p->Base.Pitch == lastPitch && p->Base.Yaw == lastYaw;
 
+	/* Visibility of all chunks must be recalculated when occlusion changes */
+	if (!samePos || occlusionDirty) {
+		CalcOcclusion();
+		samePos = false;
+	}
+
 	renderChunksCount = samePos ?
 		UpdateChunksStill(&chunkUpdates) :
 		UpdateChunksAndVisibility(&chunkUpdates);
@@ -625,7 +1352,7 @@ static void UpdateChunks(double delta) {
 	lastPitch  = p->Base.Pitch;
 	lastYaw    = p->Base.Yaw;
 
-	if (!samePos || chunkUpdates) ResetPartFlags();
+	if (!samePos || chunkUpdates || finished) ResetPartFlags();
 }
 
 static void SortMapChunks(int left, int right) {
@@ -647,11 +1374,106 @@ static void SortMapChunks(int left, int right) {
 	}
 }
 
-static void UpdateSortOrder(void) {
+/* Calculates which faces of the given chunk can be seen from the chunk at the given offset from it */
+static void CalcDrawFaces(struct ChunkInfo* info, int dx, int dy, int dz) {
+	/* Consider these 3 chunks: */
+	/* |       X-1      |        X        |       X+1      | */
+	/* |################|########@########|################| */
+	/* Assume the player is standing at @, then DrawXMin/XMax is calculated as this */
+	/*    X-1: DrawXMin = false, DrawXMax = true  */
+	/*    X  : DrawXMin = true,  DrawXMax = true  */
+	/*    X+1: DrawXMin = true,  DrawXMax = false */
+
+	info->DrawXMin = dx >= 0; info->DrawXMax = dx <= 0;
+	info->DrawZMin = dz >= 0; info->DrawZMax = dz <= 0;
+	info->DrawYMin = dy >= 0; info->DrawYMax = dy <= 0;
+}
+
+static void QuickSortChunks(IVec3 pos) {
 	struct ChunkInfo* info;
-	IVec3 pos;
 	int i, dx, dy, dz;
 
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		info = sortedChunks[i];
+		/* Calculate distance to chunk centre */
+		dx = info->CentreX - pos.X; dy = info->CentreY - pos.Y; dz = info->CentreZ - pos.Z;
+		distances[i] = dx * dx + dy * dy + dz * dz;
+		CalcDrawFaces(info, dx, dy, dz);
+	}
+	SortMapChunks(0, MapRenderer_ChunksCount - 1);
+}
+
+/* Chunks further away than this from the camera are sorted using quicksort instead */
+#define SORT_MAX_CHUNK_DIST 16384
+
+/* Calculates the closest and furthest distance (in chunks) from the given chunk coordinate */
+/*  to any of the chunks along an axis of the map (i.e. coordinates 0 to count - 1) */
+static void CalcAxisRange(int coord, int count, int* minDist, int* maxDist) {
+	int last = count - 1;
+	*minDist = coord < 0 ? -coord : (coord > last ? coord - last : 0);
+	*maxDist = max(Math_AbsI(coord), Math_AbsI(last - coord));
+}
+
+/* Sorts chunks by grouping them into shells of equal squared distance (in chunks) from the camera chunk. */
+/* Since all chunks are the same size, squared distances between chunk centres are always 256 * integer, */
+/*  so the number of distinct shells is small and a counting sort orders all chunks in two linear passes. */
+static cc_bool BucketSortChunks(IVec3 pos) {
+	struct ChunkInfo* info;
+	int cx, cy, cz, minX, minY, minZ, maxX, maxY, maxZ;
+	int minKey, maxKey, i, key, sum, count, dx, dy, dz;
+
+	/* pos is centre of a chunk, so it is always an exact multiple of CHUNK_SIZE away from chunk centres */
+	cx = (pos.X - HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
+	cy = (pos.Y - HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
+	cz = (pos.Z - HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
+	if (Math_AbsI(cx) > SORT_MAX_CHUNK_DIST || Math_AbsI(cy) > SORT_MAX_CHUNK_DIST) return false;
+	if (Math_AbsI(cz) > SORT_MAX_CHUNK_DIST) return false;
+
+	CalcAxisRange(cx, MapRenderer_ChunksX, &minX, &maxX);
+	CalcAxisRange(cy, MapRenderer_ChunksY, &minY, &maxY);
+	CalcAxisRange(cz, MapRenderer_ChunksZ, &minZ, &maxZ);
+	minKey = minX * minX + minY * minY + minZ * minZ;
+	maxKey = maxX * maxX + maxY * maxY + maxZ * maxZ;
+	/* Camera is far enough outside the map that the shells don't fit in the buckets */
+	if (maxKey - minKey >= sortBucketsCount) return false;
+
+	count = maxKey - minKey + 1;
+	Mem_Set(sortBuckets, 0, count * sizeof(int));
+
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		info = &mapChunks[i];
+		dx = (info->CentreX - pos.X) >> CHUNK_SHIFT;
+		dy = (info->CentreY - pos.Y) >> CHUNK_SHIFT;
+		dz = (info->CentreZ - pos.Z) >> CHUNK_SHIFT;
+
+		sortBuckets[dx * dx + dy * dy + dz * dz - minKey]++;
+		CalcDrawFaces(info, dx, dy, dz);
+	}
+
+	for (i = 0, sum = 0; i < count; i++) {
+		key = sortBuckets[i];
+		sortBuckets[i] = sum;
+		sum += key;
+	}
+
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		info = &mapChunks[i];
+		dx = (info->CentreX - pos.X) >> CHUNK_SHIFT;
+		dy = (info->CentreY - pos.Y) >> CHUNK_SHIFT;
+		dz = (info->CentreZ - pos.Z) >> CHUNK_SHIFT;
+		key = dx * dx + dy * dy + dz * dz;
+
+		sum = sortBuckets[key - minKey]++;
+		sortedChunks[sum] = info;
+		/* Distances are still in blocks, as other code compares them against view distance */
+		distances[sum]    = (cc_uint32)key << (CHUNK_SHIFT * 2);
+	}
+	return true;
+}
+
+static void UpdateSortOrder(void) {
+	IVec3 pos;
+
 	/* pos is centre coordinate of chunk camera is in */
 	IVec3_Floor(&pos, &Camera.CurrentPos);
 	pos.X = (pos.X & ~CHUNK_MASK) + HALF_CHUNK_SIZE;
@@ -663,34 +1485,67 @@ static void UpdateSortOrder(void) {
 	chunkPos = pos;
 	if (!MapRenderer_ChunksCount) return;
 
-	for (i = 0; i < MapRenderer_ChunksCount; i++) {
-		info = sortedChunks[i];
-		/* Calculate distance to chunk centre */
-		dx = info->CentreX - pos.X; dy = info->CentreY - pos.Y; dz = info->CentreZ - pos.Z;
-		distances[i] = dx * dx + dy * dy + dz * dz;
+	if (!BucketSortChunks(pos)) QuickSortChunks(pos);
+	ResetPartFlags();
+}
 
-		/* Consider these 3 chunks: */
-		/* |       X-1      |        X        |       X+1      | */
-		/* |################|########@########|################| */
-		/* Assume the player is standing at @, then DrawXMin/XMax is calculated as this */
-		/*    X-1: DrawXMin = false, DrawXMax = true  */
-		/*    X  : DrawXMin = true,  DrawXMax = true  */
-		/*    X+1: DrawXMin = true,  DrawXMax = false */
+#define SORT_BENCHMARK_STEPS 64
+void MapRenderer_BenchmarkSort(void) {
+	static const int sizes[][3] = { { 128, 64, 128 }, { 256, 64, 256 }, { 512, 128, 512 }, { 1024, 256, 1024 } };
+	cc_uint64 beg, quickTime, bucketTime;
+	float quickMs, bucketMs;
+	IVec3 pos;
+	int i, j;
 
-		info->DrawXMin = dx >= 0; info->DrawXMax = dx <= 0;
-		info->DrawZMin = dz >= 0; info->DrawZMax = dz <= 0;
-		info->DrawYMin = dy >= 0; info->DrawYMax = dy <= 0;
-	}
+	for (i = 0; i < Array_Elems(sizes); i++) {
+		World_SetDimensions(sizes[i][0], sizes[i][1], sizes[i][2]);
+		MapRenderer_ChunksX = (World.Width  + CHUNK_MAX) >> CHUNK_SHIFT;
+		MapRenderer_ChunksY = (World.Height + CHUNK_MAX) >> CHUNK_SHIFT;
+		MapRenderer_ChunksZ = (World.Length + CHUNK_MAX) >> CHUNK_SHIFT;
+		MapRenderer_ChunksCount = MapRenderer_ChunksX * MapRenderer_ChunksY * MapRenderer_ChunksZ;
 
-	SortMapChunks(0, MapRenderer_ChunksCount - 1);
-	ResetPartFlags();
-	/*SimpleOcclusionCulling();*/
+		AllocateChunks();
+		InitChunks();
+		quickTime = 0; bucketTime = 0;
+
+		/* Camera flies diagonally across the map, crossing into a different chunk every step */
+		for (j = 0; j < SORT_BENCHMARK_STEPS; j++) {
+			pos.X = ((j * World.Width  / SORT_BENCHMARK_STEPS) & ~CHUNK_MASK) + HALF_CHUNK_SIZE;
+			pos.Y = ((World.Height / 2) & ~CHUNK_MASK) + HALF_CHUNK_SIZE;
+			pos.Z = ((j * World.Length / SORT_BENCHMARK_STEPS) & ~CHUNK_MASK) + HALF_CHUNK_SIZE;
+
+			beg = Stopwatch_Measure();
+			QuickSortChunks(pos);
+			quickTime += Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+
+			beg = Stopwatch_Measure();
+			BucketSortChunks(pos);
+			bucketTime += Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+		}
+
+		quickMs  = quickTime  / (1000.0f * SORT_BENCHMARK_STEPS);
+		bucketMs = bucketTime / (1000.0f * SORT_BENCHMARK_STEPS);
+		Platform_Log3("Sorting %i chunks: quicksort %f3 ms, buckets %f3 ms per sort",
+			&MapRenderer_ChunksCount, &quickMs, &bucketMs);
+		FreeChunks();
+	}
+	MapRenderer_ChunksCount = 0;
 }
 
 void MapRenderer_Update(double delta) {
+	cc_uint64 beg;
 	if (!mapChunks) return;
+
+	beg = Game_BeginStage();
 	UpdateSortOrder();
+	Game_EndStage(GAME_STAGE_SORT, beg);
+
+	beg = Game_BeginStage();
+#ifndef CC_BUILD_GL11
+	Arena_NextFrame();
+#endif
 	UpdateChunks(delta);
+	Game_EndStage(GAME_STAGE_BUILD, beg);
 }
 
 
@@ -723,6 +1578,8 @@ static void OnEnvVariableChanged(void* obj, int envVar) {
 		MapRenderer_Refresh();
 	} else if (envVar == ENV_VAR_EDGE_HEIGHT || envVar == ENV_VAR_SIDES_OFFSET) {
 		int oldClip        = Builder_EdgeLevel;
+		/* Chunks on the map borders being built or cached depend on edge level */
+		Builder_CancelAll();
 		Builder_SidesLevel = max(0, Env_SidesHeight);
 		Builder_EdgeLevel  = max(0, Env.EdgeHeight);
 
@@ -800,7 +1657,12 @@ static void OnInit(void) {
 	MapRenderer_1DUsedCount = 87; /* Atlas1D_UsedAtlasesCount(); */
 	chunkPos   = IVec3_MaxValue();
 	maxChunkUpdates = Options_GetInt(OPT_MAX_CHUNK_UPDATES, 4, 1024, 30);
+	occlusionCulling = Options_GetBool(OPT_OCCLUSION_CULLING, true);
+	lodDistance      = Options_GetInt(OPT_LOD_DISTANCE, 0, 4096, 256);
 	CalcViewDists();
+#ifndef CC_BUILD_GL11
+	Arena_ResetRanges();
+#endif
 }
 
 struct IGameComponent MapRenderer_Component = {
@@ -36,6 +36,14 @@ struct ChunkPartInfo {
 	cc_uint16 Counts[FACE_COUNT]; /* Counts per face */
 };
 
+/* Bit in ChunkInfo.OcclusionFlags for whether the two given faces of a chunk can see each other */
+#define ChunkInfo_ConnectedBit(a, b) ((a) < (b) ? 1u << ((a) * FACE_COUNT + (b)) : 1u << ((b) * FACE_COUNT + (a)))
+#define CHUNKINFO_ALL_CONNECTED 0xFFFFFFFFu
+
+/* Max level of detail of chunk meshes. At level N, each 2^N x 2^N x 2^N cell of blocks in the chunk */
+/*  is drawn as a single large block instead. (so that distant chunks have much simpler meshes) */
+#define CHUNK_MAX_LOD 2
+
 /* Describes data necessary for rendering a chunk. */
 struct ChunkInfo {	
 	cc_uint16 CentreX, CentreY, CentreZ; /* Centre coordinates of the chunk */
@@ -44,6 +52,8 @@ struct ChunkInfo {
 	cc_uint8 Empty : 1;         /* Whether the chunk is empty of data */
 	cc_uint8 PendingDelete : 1; /* Whether chunk is pending deletion */
 	cc_uint8 AllAir : 1;        /* Whether chunk is completely air */
+	cc_uint8 Building : 1;      /* Whether chunk's mesh is being built on a background thread */
+	cc_uint8 Occluded : 1;      /* Whether chunk is hidden behind other chunks */
 	cc_uint8 : 0;               /* pad to next byte*/
 
 	cc_uint8 DrawXMin : 1;
@@ -52,18 +62,32 @@ struct ChunkInfo {
 	cc_uint8 DrawZMax : 1;
 	cc_uint8 DrawYMin : 1;
 	cc_uint8 DrawYMax : 1;
+	cc_uint8 Lod : 2;      /* Level of detail the chunk's mesh is built at (0 is full detail, see CHUNK_MAX_LOD) */
 	cc_uint8 : 0;          /* pad to next byte */
-#ifdef OCCLUSION
-	public cc_bool Visited = false, Occluded = false;
-	public byte OcclusionFlags, OccludedFlags, DistanceFlags;
-#endif
+	cc_uint32 OcclusionFlags; /* Which faces are connected through non-opaque blocks (see ChunkInfo_ConnectedBit) */
 #ifndef CC_BUILD_GL11
-	GfxResourceID Vb;
+	GfxResourceID Vb; /* Vertex buffer the chunk's mesh is stored in */
+	int VbOffset;     /* Index of the first vertex of the chunk's mesh in Vb */
+	int VbCount;      /* Number of vertices reserved for the chunk's mesh in Vb */
+	int Slab;         /* Index of the shared arena slab Vb belongs to, -1 if Vb is only used by this chunk */
 #endif
 	struct ChunkPartInfo* NormalParts;
 	struct ChunkPartInfo* TranslucentParts;
 };
 
+#ifndef CC_BUILD_GL11
+/* Uploads the given vertices as the mesh of the given chunk, replacing any previous mesh. */
+/* NOTE: Meshes are sub-allocated from large vertex buffers shared between chunks where possible. */
+void MapRenderer_UploadMesh(struct ChunkInfo* info, void* vertices, int count);
+#endif
+/* Sets which faces of the given chunk are connected, recalculating occluded chunks if they changed. */
+void MapRenderer_SetOcclusionFlags(struct ChunkInfo* info, cc_uint32 flags);
+/* Deletes the mesh of the given chunk, and removes its parts from the parts to be drawn. */
+/* NOTE: Chunks being rebuilt keep their mesh until this is called when the new mesh is ready. */
+void MapRenderer_DeleteMesh(struct ChunkInfo* info);
+/* Outputs statistics about the memory used by chunk meshes. (e.g. number of vertex buffers, fragmentation) */
+void MapRenderer_GetArenaInfo(cc_string* info);
+
 /* Renders the meshes of non-translucent blocks in visible chunks. */
 void MapRenderer_RenderNormal(double delta);
 /* Renders the meshes of translucent blocks in visible chunks. */
@@ -72,6 +96,9 @@ void MapRenderer_RenderTranslucent(double delta);
 /* Potentially builds meshes for several nearby chunks. */
 /* NOTE: This should be called once per frame. */
 void MapRenderer_Update(double delta);
+/* Logs how long sorting chunks by distance from the camera takes for several map sizes. */
+/* NOTE: Replaces the current map's chunks, so must only be called before the game has started. */
+void MapRenderer_BenchmarkSort(void);
 
 /* Marks the given chunk as needing to be rebuilt/redrawn. */
 /* NOTE: Coordinates outside the map are simply ignored. */
@@ -1339,6 +1339,7 @@ static void DownloadMap(const cc_string* path) {
 #endif
 
 static void SaveLevelScreen_SaveMap(struct SaveLevelScreen* s, const cc_string* path) {
+#ifdef CC_BUILD_WEB
 	static const cc_string cw = String_FromConst(".cw");
 	struct Stream stream, compStream;
 	struct GZipState state;
@@ -1347,16 +1348,7 @@ static void SaveLevelScreen_SaveMap(struct SaveLevelScreen* s, const cc_string*
 	res = Stream_CreateFile(&stream, path);
 	if (res) { Logger_SysWarn2(res, "creating", path); return; }
 	GZip_MakeStream(&compStream, &state, &stream);
-
-#ifdef CC_BUILD_WEB
 	res = Cw_Save(&compStream);
-#else
-	if (String_CaselessEnds(path, &cw)) {
-		res = Cw_Save(&compStream);
-	} else {
-		res = Schematic_Save(&compStream);
-	}
-#endif
 
 	if (res) {
 		stream.Close(&stream);
@@ -1371,14 +1363,13 @@ static void SaveLevelScreen_SaveMap(struct SaveLevelScreen* s, const cc_string*
 	res = stream.Close(&stream);
 	if (res) { Logger_SysWarn2(res, "closing", path); return; }
 
-#ifdef CC_BUILD_WEB
 	if (String_CaselessEnds(path, &cw)) {
 		Chat_Add1("&eSaved map to: %s", path);
 	} else {
 		DownloadMap(path);
 	}
 #else
-	Chat_Add1("&eSaved map to: %s", path);
+	if (Map_SaveTo(path)) return;
 #endif
 	World.LastSave = Game.Time;
 	Gui_ShowPauseMenu();
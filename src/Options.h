@@ -13,6 +13,8 @@
 
 #define OPT_VIEW_DISTANCE "viewdist"
 #define OPT_BLOCK_PHYSICS "singleplayerphysics"
+#define OPT_PHYSICS_THREADS "physics-threads"
+#define OPT_PHYSICS_RANDOM_TICKS "physics-randomticks"
 #define OPT_NAMES_MODE "namesmode"
 #define OPT_INVERT_MOUSE "invertmouse"
 #define OPT_SENSITIVITY "mousesensitivity"
@@ -23,6 +25,9 @@
 #define OPT_ENTITY_SHADOW "entityshadow"
 #define OPT_RENDER_TYPE "normal"
 #define OPT_SMOOTH_LIGHTING "gfx-smoothlighting"
+#define OPT_GREEDY_MESHING "gfx-greedymeshing"
+#define OPT_PROPAGATED_LIGHT "gfx-propagatedlight"
+#define OPT_HEIGHTMAP_MODE "gfx-heightmapmode"
 #define OPT_MIPMAPS "gfx-mipmaps"
 #define OPT_CHAT_LOGGING "chat-logging"
 #define OPT_WINDOW_WIDTH "window-width"
@@ -65,6 +70,9 @@
 #define OPT_CLASSIC_ARM_MODEL "nostalgia-classicarm"
 #define OPT_CLASSIC_CHAT "nostalgia-classicchat"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_BUILDER_THREADS "gfx-builderthreads"
+#define OPT_OCCLUSION_CULLING "gfx-occlusionculling"
+#define OPT_LOD_DISTANCE "gfx-loddistance"
 #define OPT_CAMERA_MASS "cameramass"
 #define OPT_CAMERA_SMOOTH "camera-smooth"
 #define OPT_GRAB_CURSOR "win-grab-cursor"
@@ -72,6 +80,7 @@
 #define OPT_TOUCH_SCALE "gui-touchscale"
 #define OPT_HTTP_ONLY "http-no-https"
 #define OPT_RAW_INPUT "win-raw-input"
+#define OPT_MAP_SAVE_LEVEL "map-savelevel"
 
 #define LOPT_SESSION  "launcher-session"
 #define LOPT_USERNAME "launcher-cc-username"
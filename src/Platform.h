@@ -194,6 +194,8 @@ CC_API void Thread_Detach(void* handle);
 /* Blocks the current thread, until the given thread has finished. */
 /* NOTE: This cannot be used on a thread that has been detached. */
 CC_API void Thread_Join(void* handle);
+/* Returns the number of logical CPU cores the current process can run on. (at least 1) */
+CC_API int Thread_CoresCount(void);
 
 /* Allocates a new mutex. (used to synchronise access to a shared resource) */
 CC_API void* Mutex_Create(void);
@@ -304,6 +304,11 @@ void Thread_Join(void* handle) {
 	Mem_Free(ptr);
 }
 
+int Thread_CoresCount(void) {
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (int)cores : 1;
+}
+
 void* Mutex_Create(void) {
 	pthread_mutex_t* ptr = (pthread_mutex_t*)Mem_Alloc(1, sizeof(pthread_mutex_t), "mutex");
 	int res = pthread_mutex_init(ptr, NULL);
@@ -235,6 +235,7 @@ void Thread_Sleep(cc_uint32 milliseconds) { }
 void* Thread_Start(Thread_StartFunc func) { func(); return NULL; }
 void Thread_Detach(void* handle) { }
 void Thread_Join(void* handle) { }
+int Thread_CoresCount(void) { return 1; }
 
 void* Mutex_Create(void) { return NULL; }
 void Mutex_Free(void* handle) { }
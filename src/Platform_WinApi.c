@@ -315,6 +315,12 @@ void Thread_Join(void* handle) {
 	Thread_Detach(handle);
 }
 
+int Thread_CoresCount(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return max(1, (int)info.dwNumberOfProcessors);
+}
+
 void* Mutex_Create(void) {
 	CRITICAL_SECTION* ptr = (CRITICAL_SECTION*)Mem_Alloc(1, sizeof(CRITICAL_SECTION), "mutex");
 	InitializeCriticalSection(ptr);
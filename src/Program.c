@@ -9,6 +9,9 @@
 #include "Launcher.h"
 #include "Server.h"
 #include "Options.h"
+#include "MapRenderer.h"
+#include "BlockPhysics.h"
+#include "Deflate.h"
 
 static void RunGame(void) {
 	cc_string title; char titleBuffer[STRING_SIZE];
@@ -90,9 +93,32 @@ static int RunProgram(int argc, char** argv) {
 		String_Copy(&Launcher_AutoHash, &args[0]);
 		Launcher_Run();
 #endif
+	/* --benchmark-sort to time sorting chunks by distance for several map sizes */
+	} else if (String_CaselessEqualsConst(&args[0], "--benchmark-sort")) {
+		MapRenderer_BenchmarkSort();
+	/* --benchmark-physics to time flooding several generated maps with water */
+	} else if (String_CaselessEqualsConst(&args[0], "--benchmark-physics")) {
+		Physics_Benchmark();
+	/* --benchmark-inflate [files] to time decompressing the given maps/PNG images */
+	} else if (String_CaselessEqualsConst(&args[0], "--benchmark-inflate")) {
+		Inflate_Benchmark(args + 1, argsCount - 1);
+	/* --benchmark-deflate [files] to time compressing the given files at several levels */
+	} else if (String_CaselessEqualsConst(&args[0], "--benchmark-deflate")) {
+		Deflate_Benchmark(args + 1, argsCount - 1);
 	} else if (argsCount == 1) {
 		String_Copy(&Game_Username, &args[0]);
 		RunGame();		
+	/* --benchmark [map] [frames] to time rendering the given map */
+	} else if (String_CaselessEqualsConst(&args[0], "--benchmark")) {
+		Game_BenchmarkFrames = 1000;
+		if (argsCount >= 3 && !Convert_ParseInt(&args[2], &Game_BenchmarkFrames)) {
+			WarnInvalidArg("Invalid frames count", &args[2]);
+			return 1;
+		}
+		if (Game_BenchmarkFrames <= 0) Game_BenchmarkFrames = 1;
+
+		String_Copy(&Game_Username, &args[1]);
+		RunGame();
 	} else if (argsCount < 4) {
 		WarnMissingArgs(argsCount, args);
 		return 1;
@@ -416,7 +416,15 @@ static void MapState_Init(struct MapState* m) {
 	m->allocFailed = false;
 }
 
+static void WarnMapOutOfMemory(void) {
+	Window_ShowDialog("Out of memory", "Not enough free memory to join that map.\nTry joining a different map.");
+}
+
+/* Defined in the 'Map decompression' section */
+static void MapDecompress_Stop(cc_bool cancel);
+
 static void FreeMapStates(void) {
+	MapDecompress_Stop(true);
 	Mem_Free(map.blocks);
 	map.blocks  = NULL;
 #ifdef EXTENDED_BLOCKS
@@ -425,28 +433,198 @@ static void FreeMapStates(void) {
 #endif
 }
 
-static void MapState_Read(struct MapState* m) {
+/* Decompresses as much of the received map data as possible into the given map state */
+/* NOTE: Called on the map decompression thread, so must not show dialogs or disconnect */
+static cc_result MapState_Read(struct MapState* m) {
 	cc_uint32 left, read;
 	cc_result res;
-	if (m->allocFailed) return;
+	if (m->allocFailed) return 0;
 
 	if (!m->blocks) {
 		m->blocks = (BlockRaw*)Mem_TryAlloc(map_volume, 1);
 		/* unlikely but possible */
-		if (!m->blocks) {
-			Window_ShowDialog("Out of memory", "Not enough free memory to join that map.\nTry joining a different map.");
-			m->allocFailed = true;
-			return;
-		}
+		if (!m->blocks) { m->allocFailed = true; return 0; }
 	}
 
 	left = map_volume - m->index;
 	res  = m->stream.Read(&m->stream, &m->blocks[m->index], left, &read);
-
-	if (res) DisconnectInvalidMap(res);
 	m->index += read;
+	return res;
 }
 
+
+/*########################################################################################################################*
+*---------------------------------------------------Map decompression-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Map data received in LevelDataChunk packets is queued by the game thread into a ring of chunks, */
+/*  which are then decompressed on a background thread. (so decompressing overlaps downloading the map) */
+struct MapChunk { cc_uint16 length; cc_uint8 value; cc_uint8 data[1024]; };
+#define MAP_RING_CHUNKS 256
+
+static struct MapChunk* map_ring;
+/* Chunks from map_ringTail up to map_ringHead are waiting to be decompressed */
+/* NOTE: Only the game thread changes map_ringHead, and only the decompression thread changes map_ringTail */
+static int map_ringHead, map_ringTail;
+/* Whether no more chunks will be added, and whether chunks not yet decompressed should be discarded */
+static cc_bool map_ringEnded, map_ringCancelled;
+/* First error that occurred while decompressing, and how much of the map has been decompressed */
+static cc_result map_result;
+static float map_progress;
+/* map_mutex protects all of the decompression state above */
+static void* map_mutex;
+static void* map_chunkAdded;
+static void* map_chunkRemoved;
+static void* map_thread;
+
+static cc_result MapChunk_Decompress(struct MapChunk* chunk) {
+	cc_uint32 left, read;
+	cc_result res;
+
+	map_part.Meta.Mem.Cur    = chunk->data;
+	map_part.Meta.Mem.Base   = chunk->data;
+	map_part.Meta.Mem.Left   = chunk->length;
+	map_part.Meta.Mem.Length = chunk->length;
+
+	if (!map_gzHeader.done) {
+		res = GZipHeader_Read(&map_part, &map_gzHeader);
+		if (res && res != ERR_END_OF_STREAM) return res;
+		if (!map_gzHeader.done) return 0;
+	}
+
+	if (map_sizeIndex < MAP_SIZE_LEN) {
+		left = MAP_SIZE_LEN - map_sizeIndex;
+		res  = map.stream.Read(&map.stream, &map_size[map_sizeIndex], left, &read); 
+
+		if (res) return res;
+		map_sizeIndex += read;
+		if (map_sizeIndex < MAP_SIZE_LEN) return 0;
+	}
+	if (!map_volume) map_volume = Stream_GetU32_BE(map_size);
+
+#ifdef EXTENDED_BLOCKS
+	if (cpe_extBlocks && chunk->value) return MapState_Read(&map2);
+#endif
+	return MapState_Read(&map);
+}
+
+/* Decompresses all the chunks currently in the ring. Returns false if no more chunks will be added. */
+static cc_bool MapDecompress_Drain(void) {
+	struct MapChunk* chunk;
+	cc_bool ended, cancelled;
+	cc_result res;
+
+	for (;;) {
+		Mutex_Lock(map_mutex);
+		{
+			chunk     = map_ringTail < map_ringHead ? &map_ring[map_ringTail % MAP_RING_CHUNKS] : NULL;
+			ended     = map_ringEnded;
+			cancelled = map_ringCancelled;
+			res       = map_result;
+		}
+		Mutex_Unlock(map_mutex);
+
+		if (cancelled) return false;
+		if (!chunk)    return !ended;
+		/* Remaining chunks are skipped once the map data is known to be corrupted */
+		if (!res) res = MapChunk_Decompress(chunk);
+
+		Mutex_Lock(map_mutex);
+		{
+			map_ringTail++;
+			map_result   = res;
+			map_progress = !map.blocks ? 0.0f : (float)map.index / map_volume;
+		}
+		Mutex_Unlock(map_mutex);
+		Waitable_Signal(map_chunkRemoved);
+	}
+}
+
+static void MapDecompress_Run(void) {
+	/* Block until the game thread receives another chunk */
+	while (MapDecompress_Drain()) { Waitable_Wait(map_chunkAdded); }
+}
+
+static void MapDecompress_Start(void) {
+	/* in case the previous map never finished loading */
+	MapDecompress_Stop(true);
+	map_ring     = (struct MapChunk*)Mem_Alloc(MAP_RING_CHUNKS, sizeof(struct MapChunk), "map chunks");
+	map_ringHead = 0; map_ringEnded     = false;
+	map_ringTail = 0; map_ringCancelled = false;
+	map_result   = 0; map_progress      = 0.0f;
+
+	map_mutex        = Mutex_Create();
+	map_chunkAdded   = Waitable_Create();
+	map_chunkRemoved = Waitable_Create();
+#ifndef CC_BUILD_WEB
+	map_thread = Thread_Start(MapDecompress_Run);
+#else
+	/* Chunks are instead decompressed on the main thread as they are received (see MapDecompress_Add) */
+	map_thread = NULL;
+#endif
+}
+
+/* Waits until all the chunks added so far have been decompressed, or discards them if cancel is true */
+static void MapDecompress_Stop(cc_bool cancel) {
+	if (!map_ring) return;
+
+	Mutex_Lock(map_mutex);
+	{
+		map_ringEnded     = true;
+		map_ringCancelled = cancel;
+	}
+	Mutex_Unlock(map_mutex);
+	Waitable_Signal(map_chunkAdded);
+
+	if (map_thread) Thread_Join(map_thread);
+	map_thread = NULL;
+
+	Mutex_Free(map_mutex);
+	Waitable_Free(map_chunkAdded);
+	Waitable_Free(map_chunkRemoved);
+	Mem_Free(map_ring);
+	map_ring = NULL;
+	/* Discarded chunks can't cause the next map to fail loading */
+	if (cancel) map_result = 0;
+}
+
+static void MapDecompress_Add(cc_uint8* data, int length, cc_uint8 value) {
+	struct MapChunk* chunk;
+	cc_bool full;
+
+	for (;;) {
+		Mutex_Lock(map_mutex);
+		{
+			full = map_ringHead - map_ringTail == MAP_RING_CHUNKS;
+		}
+		Mutex_Unlock(map_mutex);
+
+		if (!full) break;
+		/* Decompressing has fallen behind downloading, so wait for it to catch up */
+		Waitable_Wait(map_chunkRemoved);
+	}
+
+	chunk = &map_ring[map_ringHead % MAP_RING_CHUNKS];
+	chunk->length = length;
+	chunk->value  = value;
+	Mem_Copy(chunk->data, data, length);
+
+	Mutex_Lock(map_mutex);
+	{
+		map_ringHead++;
+	}
+	Mutex_Unlock(map_mutex);
+
+	if (map_thread) {
+		Waitable_Signal(map_chunkAdded);
+	} else {
+		MapDecompress_Drain();
+	}
+}
+
+
+/*########################################################################################################################*
+*------------------------------------------------------Level loading------------------------------------------------------*
+*#########################################################################################################################*/
 static void Classic_StartLoading(void) {
 	World_NewMap();
 	Stream_ReadonlyMemory(&map_part, NULL, 0);
@@ -465,6 +643,7 @@ static void Classic_StartLoading(void) {
 #ifdef EXTENDED_BLOCKS
 	MapState_Init(&map2);
 #endif
+	MapDecompress_Start();
 }
 
 static void Classic_LevelInit(cc_uint8* data) {
@@ -483,68 +662,50 @@ static void Classic_LevelInit(cc_uint8* data) {
 static void Classic_LevelDataChunk(cc_uint8* data) {
 	int usedLength;
 	float progress;
-	cc_uint32 left, read;
 	cc_uint8 value;
 	cc_result res;
 
 	/* Workaround for some servers that send LevelDataChunk before LevelInit due to their async sending behaviour */
 	if (!map_begunLoading) Classic_StartLoading();
 	usedLength = Stream_GetU16_BE(data); data += 2;
+	usedLength = min(usedLength, 1024);
 
-	map_part.Meta.Mem.Cur    = data;
-	map_part.Meta.Mem.Base   = data;
-	map_part.Meta.Mem.Left   = usedLength;
-	map_part.Meta.Mem.Length = usedLength;
+	value = data[1024]; /* progress in original classic, but we ignore it */
+	MapDecompress_Add(data, usedLength, value);
 
-	data += 1024;
-	value = *data; /* progress in original classic, but we ignore it */
-
-	if (!map_gzHeader.done) {
-		res = GZipHeader_Read(&map_part, &map_gzHeader);
-		if (res && res != ERR_END_OF_STREAM) { DisconnectInvalidMap(res); return; }
-	}
-
-	if (map_gzHeader.done) {
-		if (map_sizeIndex < MAP_SIZE_LEN) {
-			left = MAP_SIZE_LEN - map_sizeIndex;
-			res  = map.stream.Read(&map.stream, &map_size[map_sizeIndex], left, &read); 
-
-			if (res) { DisconnectInvalidMap(res); return; }
-			map_sizeIndex += read;
-		}
-
-		if (map_sizeIndex == MAP_SIZE_LEN) {
-			if (!map_volume) map_volume = Stream_GetU32_BE(map_size);
-
-#ifndef EXTENDED_BLOCKS
-			MapState_Read(&map);
-#else
-			if (cpe_extBlocks && value) {
-				MapState_Read(&map2);
-			} else {
-				MapState_Read(&map);
-			}
-#endif
-		}
+	Mutex_Lock(map_mutex);
+	{
+		res      = map_result;
+		progress = map_progress;
 	}
+	Mutex_Unlock(map_mutex);
 
-	progress = !map.blocks ? 0.0f : (float)map.index / map_volume;
+	if (res) { DisconnectInvalidMap(res); return; }
 	Event_RaiseFloat(&WorldEvents.Loading, progress);
 }
 
 static void Classic_LevelFinalise(cc_uint8* data) {
 	int width, height, length;
-	cc_uint64 end;
-	int delta;
+	cc_uint64 beg, end;
+	int delta, waited, processed;
+	cc_result res;
+
+	/* Finish decompressing any chunks that were received just before this packet */
+	beg = Stopwatch_Measure();
+	MapDecompress_Stop(false);
+	res = map_result;
+	/* So a later LevelFinalise without any LevelInit/LevelDataChunk doesn't see this map's result */
+	map_result = 0;
 
-	end   = Stopwatch_Measure();
-	delta = Stopwatch_ElapsedMS(map_receiveBeg, end);
-	Platform_Log1("map loading took: %i", &delta);
+	end    = Stopwatch_Measure();
+	waited = Stopwatch_ElapsedMS(beg, end);
 	map_begunLoading = false;
+	if (res) { DisconnectInvalidMap(res); return; }
 	WoM_CheckSendWomID();
 
+	if (map.allocFailed) WarnMapOutOfMemory();
 #ifdef EXTENDED_BLOCKS
-	if (map2.allocFailed) FreeMapStates();
+	if (map2.allocFailed) { WarnMapOutOfMemory(); FreeMapStates(); }
 #endif
 
 	width  = Stream_GetU16_BE(data + 0);
@@ -562,8 +723,16 @@ static void Classic_LevelFinalise(cc_uint8* data) {
 	if (cpe_extBlocks && map2.blocks) World_SetMapUpper(map2.blocks);
 	map2.blocks = NULL;
 #endif
+	/* Loading also includes processing the new map (e.g. calculating the lighting heightmap) */
+	beg = Stopwatch_Measure();
 	World_SetNewMap(map.blocks, width, height, length);
 	map.blocks  = NULL;
+
+	end       = Stopwatch_Measure();
+	delta     = Stopwatch_ElapsedMS(map_receiveBeg, end);
+	processed = Stopwatch_ElapsedMS(beg, end);
+	Platform_Log3("map loading took: %i (%i waiting for decompression, %i processing the map)",
+				&delta, &waited, &processed);
 }
 
 static void Classic_SetBlock(cc_uint8* data) {
@@ -1157,14 +1326,13 @@ static void CPE_ExtAddEntity2(cc_uint8* data) {
 
 #define BULK_MAX_BLOCKS 256
 static void CPE_BulkBlockUpdate(cc_uint8* data) {
-	cc_int32 indices[BULK_MAX_BLOCKS];
+	int indices[BULK_MAX_BLOCKS];
 	BlockID blocks[BULK_MAX_BLOCKS];
-	int index, i;
-	int x, y, z;
+	int index, i, j;
 	int count = 1 + *data++;
 
 	for (i = 0; i < count; i++) {
-		indices[i] = Stream_GetU32_BE(data); data += 4;
+		indices[i] = (int)Stream_GetU32_BE(data); data += 4;
 	}
 	data += (BULK_MAX_BLOCKS - count) * 4;
 	
@@ -1184,17 +1352,20 @@ static void CPE_BulkBlockUpdate(cc_uint8* data) {
 		data += BULK_MAX_BLOCKS / 4;
 	}
 
-	for (i = 0; i < count; i++) {
+	/* Remove any blocks outside the map */
+	for (i = 0, j = 0; i < count; i++) {
 		index = indices[i];
 		if (index < 0 || index >= World.Volume) continue;
-		World_Unpack(index, x, y, z);
 
+		indices[j] = index;
 #ifdef EXTENDED_BLOCKS
-		Game_UpdateBlock(x, y, z, blocks[i] % BLOCK_COUNT);
+		blocks[j]  = blocks[i] % BLOCK_COUNT;
 #else
-		Game_UpdateBlock(x, y, z, blocks[i]);
+		blocks[j]  = blocks[i];
 #endif
+		j++;
 	}
+	Game_UpdateBlocks(indices, blocks, j);
 }
 
 static void CPE_SetTextColor(cc_uint8* data) {
@@ -949,7 +949,7 @@ static void ChatScreen_ChatReceived(void* screen, const cc_string* msg, int type
 		TextWidget_Set(&s->bigAnnouncement, msg, &s->bigAnnouncementFont);
 	} else if (type == MSG_TYPE_SMALLANNOUNCEMENT) {
 		TextWidget_Set(&s->smallAnnouncement, msg, &s->smallAnnouncementFont);
-	} else if (type >= MSG_TYPE_CLIENTSTATUS_1 && type <= MSG_TYPE_CLIENTSTATUS_2) {
+	} else if (type >= MSG_TYPE_CLIENTSTATUS_1 && type <= MSG_TYPE_CLIENTSTATUS_3) {
 		TextGroupWidget_Redraw(&s->clientStatus, type - MSG_TYPE_CLIENTSTATUS_1);
 		ChatScreen_UpdateChatYOffsets(s);
 	}
@@ -1304,6 +1304,7 @@ static void ChatScreen_Init(void* screen) {
 	s->status.collapsible[0]       = true; /* Texture pack download status */
 	s->clientStatus.collapsible[0] = true;
 	s->clientStatus.collapsible[1] = true;
+	s->clientStatus.collapsible[2] = true;
 
 	s->chat.underlineUrls = !Game_ClassicMode;
 	s->chatIndex = Chat_Log.count - Gui.Chatlines;
@@ -279,6 +279,28 @@ void Stream_ReadonlyMemory(struct Stream* s, void* data, cc_uint32 len) {
 	s->Meta.Mem.Base   = (cc_uint8*)data;
 }
 
+static cc_result Stream_MemoryWrite(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	count = min(count, s->Meta.Mem.Left);
+	Mem_Copy(s->Meta.Mem.Cur, data, count);
+
+	s->Meta.Mem.Cur  += count;
+	s->Meta.Mem.Left -= count;
+	*modified = count;
+	return 0;
+}
+
+void Stream_WriteonlyMemory(struct Stream* s, void* data, cc_uint32 len) {
+	Stream_Init(s);
+	s->Write    = Stream_MemoryWrite;
+	s->Position = Stream_MemoryPosition;
+	s->Length   = Stream_MemoryLength;
+
+	s->Meta.Mem.Cur    = (cc_uint8*)data;
+	s->Meta.Mem.Left   = len;
+	s->Meta.Mem.Length = len;
+	s->Meta.Mem.Base   = (cc_uint8*)data;
+}
+
 
 /*########################################################################################################################*
 *----------------------------------------------------BufferedStream-------------------------------------------------------*
@@ -363,13 +385,7 @@ void Stream_ReadonlyBuffered(struct Stream* s, struct Stream* source, void* data
 *#########################################################################################################################*/
 static cc_result Stream_Crc32Write(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct Stream* source;
-	cc_uint32 i, crc32 = stream->Meta.CRC32.CRC32;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		crc32 = Utils_Crc32Table[(crc32 ^ data[i]) & 0xFF] ^ (crc32 >> 8);
-	}
-	stream->Meta.CRC32.CRC32 = crc32;
+	stream->Meta.CRC32.CRC32 = Utils_Crc32Update(stream->Meta.CRC32.CRC32, data, count);
 
 	source = stream->Meta.CRC32.Source;
 	return source->Write(source, data, count, modified);
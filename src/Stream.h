@@ -60,6 +60,8 @@ CC_API void Stream_FromFile(struct Stream* s, cc_file file);
 CC_API void Stream_ReadonlyPortion(struct Stream* s, struct Stream* source, cc_uint32 len);
 /* Wraps a block of memory, allowing reading from and seeking in the block. */
 CC_API void Stream_ReadonlyMemory(struct Stream* s, void* data, cc_uint32 len);
+/* Wraps a block of memory, allowing writing to the block. (writing past the end fails with ERR_END_OF_STREAM) */
+CC_API void Stream_WriteonlyMemory(struct Stream* s, void* data, cc_uint32 len);
 /* Wraps another Stream, reading through an intermediary buffer. (Useful for files, since each read call is expensive) */
 CC_API void Stream_ReadonlyBuffered(struct Stream* s, struct Stream* source, void* data, cc_uint32 size);
 
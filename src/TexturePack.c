@@ -14,6 +14,8 @@
 #include "Options.h"
 #include "Logger.h"
 #include "Utils.h"
+#include "Builder.h"
+#include "Errors.h"
 #include "Chat.h" /* TODO avoid this include */
 
 /*########################################################################################################################*
@@ -65,6 +67,8 @@ static void Atlas_Update1D(void) {
 
 	maxAtlasHeight   = min(4096, Gfx.MaxTexHeight);
 	maxTilesPerAtlas = maxAtlasHeight / Atlas2D.TileSize;
+	/* Faces merged by the greedy mesh builder need the texture to also repeat vertically */
+	if (Builder_GreedyMeshing) maxTilesPerAtlas = 1;
 	maxTiles         = Atlas2D.RowsCount * ATLAS2D_TILES_PER_ROW;
 
 	Atlas1D.TilesPerAtlas = min(maxTilesPerAtlas, maxTiles);
@@ -290,18 +294,35 @@ void TexturePack_SetDefault(const cc_string* texPack) {
 	Options_Set(OPT_DEFAULT_TEX_PACK, texPack);
 }
 
-static cc_result ProcessZipEntry(const cc_string* path, struct Stream* stream, struct ZipState* s) {
-	cc_string name = *path;
-	Utils_UNSAFE_GetFilename(&name);
-	Event_RaiseEntry(&TextureEvents.FileChanged, stream, &name);
-	return 0;
-}
+/* Extracts all the entries in the given .zip texture pack, except for entries whose filename is also in 'overrides' */
+/* (as textures are applied by filename, those entries would just be replaced by the ones in 'overrides' */
+/*  when it is extracted afterwards, even if they are stored in a different directory) */
+static cc_result ExtractZip(struct Stream* stream, struct ZipArchive* overrides) {
+	struct InflateState inflate;
+	struct ZipArchive zip;
+	struct Stream data;
+	cc_string path, name;
+	cc_result res;
+	int i;
+
+	if ((res = ZipArchive_Open(&zip, stream))) return res;
+
+	for (i = 0; i < zip.Count; i++) {
+		path = ZipArchive_GetPath(&zip, i);
+		name = path;
+		Utils_UNSAFE_GetFilename(&name);
+		if (overrides && ZipArchive_FindFilename(overrides, &name) >= 0) continue;
+
+		res = ZipArchive_OpenEntry(&zip, i, &data, &inflate);
+		if (res == ZIP_ERR_COMP_METHOD) {
+			Logger_SysWarn2(res, "extracting", &path); continue;
+		} else if (res) break;
+
+		Event_RaiseEntry(&TextureEvents.FileChanged, &data, &name);
+	}
 
-static cc_result ExtractZip(struct Stream* stream) {
-	struct ZipState state;
-	Zip_Init(&state, stream);
-	state.ProcessEntry = ProcessZipEntry;
-	return Zip_Extract(&state);
+	ZipArchive_Close(&zip);
+	return res;
 }
 
 static cc_result ExtractPng(struct Stream* stream) {
@@ -314,7 +335,7 @@ static cc_result ExtractPng(struct Stream* stream) {
 }
 
 static cc_bool needReload;
-static void ExtractFrom(struct Stream* stream, const cc_string* path) {
+static void ExtractFrom(struct Stream* stream, const cc_string* path, struct ZipArchive* overrides) {
 	cc_result res;
 
 	Event_RaiseVoid(&TextureEvents.PackChanged);
@@ -324,7 +345,7 @@ static void ExtractFrom(struct Stream* stream, const cc_string* path) {
 	needReload = false;
 
 	if (String_ContainsConst(path, ".zip")) {
-		res = ExtractZip(stream);
+		res = ExtractZip(stream, overrides);
 		if (res) Logger_SysWarn2(res, "extracting", path);
 	} else {
 		res = ExtractPng(stream);
@@ -332,33 +353,61 @@ static void ExtractFrom(struct Stream* stream, const cc_string* path) {
 	}
 }
 
-static void ExtractFromFile(const cc_string* filename) {
-	cc_string path; char pathBuffer[FILENAME_SIZE];
-	struct Stream stream;
+/* Opens the given texture pack in the texpacks folder */
+static cc_result OpenTexPack(const cc_string* filename, struct Stream* stream, cc_string* path) {
 	cc_result res;
+	String_Format1(path, TEXPACKS_DIR "/%s", filename);
 
-	String_InitArray(path, pathBuffer);
-	String_Format1(&path, TEXPACKS_DIR "/%s", filename);
-
-	res = Stream_OpenFile(&stream, &path);
+	res = Stream_OpenFile(stream, path);
 	if (res) {
 		/* Game shows a dialog if default.zip is missing */
 		Game_DefaultZipMissing |= res == ReturnCode_FileNotFound
 					&& String_CaselessEquals(filename, &defaultZip);
-		Logger_SysWarn2(res, "opening", &path); return; 
+		Logger_SysWarn2(res, "opening", path);
 	}
+	return res;
+}
+
+static void ExtractFromFile(const cc_string* filename, struct ZipArchive* overrides) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	struct Stream stream;
+	cc_result res;
+
+	String_InitArray(path, pathBuffer);
+	if (OpenTexPack(filename, &stream, &path)) return;
 
-	ExtractFrom(&stream, &path);
+	ExtractFrom(&stream, &path, overrides);
 	res = stream.Close(&stream);
 	if (res) { Logger_SysWarn2(res, "closing", &path); }
 }
 
 static void ExtractDefault(void) {
 	cc_string texPack = Game_ClassicMode ? defaultZip : defTexPack;
-	ExtractFromFile(&defaultZip);
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	struct ZipArchive overrides;
+	struct Stream stream;
+	cc_bool hasOverrides;
+	cc_result res;
 
-	/* in case the user's default texture pack doesn't have all required textures */
-	if (!String_CaselessEquals(&texPack, &defaultZip)) ExtractFromFile(&texPack);
+	if (String_CaselessEquals(&texPack, &defaultZip)) {
+		ExtractFromFile(&defaultZip, NULL); return;
+	}
+
+	/* default.zip is extracted first, in case the user's default texture pack */
+	/*  doesn't have all required textures, but textures that the user's */
+	/*  texture pack does have can be skipped when extracting default.zip */
+	String_InitArray(path, pathBuffer);
+	if (OpenTexPack(&texPack, &stream, &path)) {
+		ExtractFromFile(&defaultZip, NULL); return;
+	}
+
+	hasOverrides = String_ContainsConst(&path, ".zip") && !ZipArchive_Open(&overrides, &stream);
+	ExtractFromFile(&defaultZip, hasOverrides ? &overrides : NULL);
+	if (hasOverrides) ZipArchive_Close(&overrides);
+
+	ExtractFrom(&stream, &path, NULL);
+	res = stream.Close(&stream);
+	if (res) { Logger_SysWarn2(res, "closing", &path); }
 }
 
 static cc_bool usingDefault;
@@ -374,7 +423,7 @@ void TexturePack_ExtractCurrent(cc_bool forceReload) {
 	}
 
 	if (url.length && OpenCachedData(&url, &stream)) {
-		ExtractFrom(&stream, &url);
+		ExtractFrom(&stream, &url, NULL);
 		usingDefault = false;
 
 		res = stream.Close(&stream);
@@ -393,7 +442,7 @@ static void ApplyDownloaded(struct HttpRequest* item) {
 	if (!String_Equals(&TexturePack_Url, &url)) return;
 
 	Stream_ReadonlyMemory(&mem, item->data, item->size);
-	ExtractFrom(&mem, &url);
+	ExtractFrom(&mem, &url, NULL);
 	usingDefault = false;
 }
 
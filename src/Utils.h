@@ -40,6 +40,12 @@ int Utils_AccumulateWheelDelta(float* accumulator, float delta);
 
 cc_uint8 Utils_CalcSkinType(const struct Bitmap* bmp);
 cc_uint32 Utils_CRC32(const cc_uint8* data, cc_uint32 length);
+/* Updates a running CRC32 with the given data. (start with 0xFFFFFFFFUL, and xor with 0xFFFFFFFFUL at end) */
+/* NOTE: This is much quicker than looping over every byte with Utils_Crc32Table. */
+cc_uint32 Utils_Crc32Update(cc_uint32 crc, const cc_uint8* data, cc_uint32 length);
+/* Returns the CRC32 of two consecutive pieces of data, from the CRC32 of each piece. */
+/* NOTE: len2 is the length of the second piece of data. */
+cc_uint32 Utils_Crc32Combine(cc_uint32 crc1, cc_uint32 crc2, cc_uint32 len2);
 /* CRC32 lookup table, for faster CRC32 calculations. */
 /* NOTE: This cannot be just indexed by byte value - see Utils_CRC32 implementation. */
 extern const cc_uint32 Utils_Crc32Table[256];
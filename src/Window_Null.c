@@ -0,0 +1,77 @@
+#include "Core.h"
+#if defined CC_BUILD_HEADLESS
+#include "_WindowBase.h"
+#include "String.h"
+#include "Funcs.h"
+#include "Bitmap.h"
+#include "Errors.h"
+/* Window backend which never actually shows anything on screen. (e.g. for headless benchmarking) */
+/* The window is always focused, so that the game doesn't keep opening the pause menu */
+static char clipboardBuffer[512];
+static cc_string clipboard = String_FromArray(clipboardBuffer);
+
+void Window_Init(void) {
+	DisplayInfo.Width  = 1920;
+	DisplayInfo.Height = 1080;
+	DisplayInfo.Depth  = 24;
+	DisplayInfo.ScaleX = 1;
+	DisplayInfo.ScaleY = 1;
+}
+
+static void DoCreateWindow(int width, int height) {
+	WindowInfo.Width   = width;
+	WindowInfo.Height  = height;
+	WindowInfo.Exists  = true;
+	WindowInfo.Focused = true;
+}
+void Window_Create2D(int width, int height) { DoCreateWindow(width, height); }
+void Window_Create3D(int width, int height) { DoCreateWindow(width, height); }
+
+void Window_SetTitle(const cc_string* title) { }
+void Clipboard_GetText(cc_string* value) { String_AppendString(value, &clipboard); }
+void Clipboard_SetText(const cc_string* value) { String_Copy(&clipboard, value); }
+
+void Window_Show(void) { }
+int Window_GetWindowState(void) { return WINDOW_STATE_NORMAL; }
+cc_result Window_EnterFullscreen(void) { return ERR_NOT_SUPPORTED; }
+cc_result Window_ExitFullscreen(void)  { return ERR_NOT_SUPPORTED; }
+
+void Window_SetSize(int width, int height) {
+	WindowInfo.Width  = width;
+	WindowInfo.Height = height;
+	Event_RaiseVoid(&WindowEvents.Resized);
+}
+
+void Window_Close(void) {
+	if (!WindowInfo.Exists) return;
+	WindowInfo.Exists = false;
+	Event_RaiseVoid(&WindowEvents.Closing);
+}
+
+void Window_ProcessEvents(void) { }
+
+/* No actual mouse cursor, so it only moves when explicitly moved */
+static int cursorX, cursorY;
+static void Cursor_GetRawPos(int* x, int* y) { *x = cursorX; *y = cursorY; }
+void Cursor_SetPosition(int x, int y) { cursorX = x; cursorY = y; }
+static void Cursor_DoSetVisible(cc_bool visible) { }
+
+static void ShowDialogCore(const char* title, const char* msg) {
+	Platform_LogConst(title);
+	Platform_LogConst(msg);
+}
+
+void Window_AllocFramebuffer(struct Bitmap* bmp) {
+	bmp->scan0 = (BitmapCol*)Mem_Alloc(bmp->width * bmp->height, 4, "window pixels");
+}
+void Window_DrawFramebuffer(Rect2D r) { }
+void Window_FreeFramebuffer(struct Bitmap* bmp) { Mem_Free(bmp->scan0); }
+
+void Window_OpenKeyboard(const struct OpenKeyboardArgs* args) { }
+void Window_SetKeyboardText(const cc_string* text) { }
+void Window_CloseKeyboard(void) { }
+
+void Window_EnableRawMouse(void)  { DefaultEnableRawMouse(); }
+void Window_UpdateRawMouse(void)  { DefaultUpdateRawMouse(); }
+void Window_DisableRawMouse(void) { DefaultDisableRawMouse(); }
+#endif
@@ -10,8 +10,383 @@
 #include "Game.h"
 #include "TexturePack.h"
 #include "Window.h"
+#include "Stream.h"
+#include "Errors.h"
+#include "Funcs.h"
 
 struct _WorldData World;
+/*########################################################################################################################*
+*-----------------------------------------------------World sections------------------------------------------------------*
+*#########################################################################################################################*/
+#define SECTION_SIZE   16
+#define SECTION_SHIFT  4
+#define SECTION_MASK   15
+#define SECTION_VOLUME (SECTION_SIZE * SECTION_SIZE * SECTION_SIZE)
+/* Sections with more different blocks than this store raw block IDs instead of palette indices */
+#define SECTION_MAX_PALETTE 256
+#define SECTION_RAW_BITS    16
+#ifdef EXTENDED_BLOCKS
+#define SECTION_ID_MASK 0x3FF
+#else
+#define SECTION_ID_MASK 0xFF
+#endif
+
+struct WorldSection {
+	/* Palette of (1 << Bits) blocks followed by the packed palette index of each block, */
+	/*  or the raw IDs of each block when Bits is SECTION_RAW_BITS. */
+	/* NOTE: NULL when every block in the section is the same. (e.g. sections that are completely air) */
+	cc_uint8* Data;
+	/* Block every block in the section is, when Data is NULL. */
+	BlockID Block;
+	/* Number of bits each palette index takes up. (1, 2, 4, 8, or SECTION_RAW_BITS) */
+	cc_uint8 Bits;
+	/* Number of used entries in the palette. */
+	cc_uint16 PaletteCount;
+};
+static int sectionsX, sectionsY, sectionsZ;
+
+#define Section_Index(x, y, z) ((((y) & SECTION_MASK) << 8) | (((z) & SECTION_MASK) << 4) | ((x) & SECTION_MASK))
+#define Section_Palette(s) ((BlockID*)(s)->Data)
+#define Section_Indices(s) ((s)->Data + (sizeof(BlockID) << (s)->Bits))
+
+static struct WorldSection* Section_At(int x, int y, int z) {
+	int i = ((y >> SECTION_SHIFT) * sectionsZ + (z >> SECTION_SHIFT)) * sectionsX + (x >> SECTION_SHIFT);
+	return &World.Sections[i];
+}
+
+static CC_INLINE BlockID Section_GetBlock(struct WorldSection* s, int i) {
+	int bits = s->Bits, bit;
+	if (!s->Data) return s->Block;
+	if (bits == SECTION_RAW_BITS) return ((BlockID*)s->Data)[i];
+
+	bit = i * bits;
+	return Section_Palette(s)[(Section_Indices(s)[bit >> 3] >> (bit & 7)) & ((1 << bits) - 1)];
+}
+
+static void Section_Decode(struct WorldSection* s, BlockID* blocks) {
+	int i;
+	if (!s->Data) {
+		for (i = 0; i < SECTION_VOLUME; i++) { blocks[i] = s->Block; }
+	} else if (s->Bits == SECTION_RAW_BITS) {
+		Mem_Copy(blocks, s->Data, SECTION_VOLUME * sizeof(BlockID));
+	} else {
+		for (i = 0; i < SECTION_VOLUME; i++) { blocks[i] = Section_GetBlock(s, i); }
+	}
+}
+
+/* Replaces the contents of the given section with the given blocks, using the smallest palette possible */
+static cc_bool Section_Encode(struct WorldSection* s, const BlockID* blocks) {
+	cc_int16 lookup[SECTION_ID_MASK + 1];
+	BlockID palette[SECTION_ID_MASK + 1];
+	int i, count = 0, bits, bit, size;
+	cc_uint8* data;
+	cc_uint8* indices;
+	BlockID block;
+
+	Mem_Set(lookup, 0xFF, sizeof(lookup));
+	for (i = 0; i < SECTION_VOLUME; i++) {
+		block = blocks[i];
+		if (lookup[block] >= 0) continue;
+		lookup[block]    = count;
+		palette[count++] = block;
+	}
+
+	if (count == 1) {
+		Mem_Free(s->Data);
+		s->Data  = NULL;
+		s->Block = palette[0];
+		s->Bits  = 0;
+		s->PaletteCount = 1;
+		return true;
+	}
+
+	if (count <= 2) {
+		bits = 1;
+	} else if (count <= 4) {
+		bits = 2;
+	} else if (count <= 16) {
+		bits = 4;
+	} else if (count <= SECTION_MAX_PALETTE) {
+		bits = 8;
+	} else {
+		bits = SECTION_RAW_BITS;
+	}
+
+	if (bits == SECTION_RAW_BITS) {
+		size = SECTION_VOLUME * sizeof(BlockID);
+	} else {
+		size = (sizeof(BlockID) << bits) + ((SECTION_VOLUME * bits) >> 3);
+	}
+	data = (cc_uint8*)Mem_TryAllocCleared(size, 1);
+	if (!data) return false;
+
+	Mem_Free(s->Data);
+	s->Data = data;
+	s->Bits = bits;
+	s->PaletteCount = count;
+
+	if (bits == SECTION_RAW_BITS) {
+		Mem_Copy(data, blocks, size);
+		return true;
+	}
+
+	Mem_Copy(data, palette, count * sizeof(BlockID));
+	indices = Section_Indices(s);
+	for (i = 0; i < SECTION_VOLUME; i++) {
+		bit = i * bits;
+		indices[bit >> 3] |= lookup[blocks[i]] << (bit & 7);
+	}
+	return true;
+}
+
+static cc_bool Section_SetBlock(struct WorldSection* s, int i, BlockID block) {
+	BlockID blocks[SECTION_VOLUME];
+	BlockID* palette;
+	cc_uint8* indices;
+	int idx, bits = s->Bits, bit, mask;
+
+	if (!s->Data) {
+		if (s->Block == block) return true;
+	} else if (bits == SECTION_RAW_BITS) {
+		((BlockID*)s->Data)[i] = block;
+		return true;
+	} else {
+		palette = Section_Palette(s);
+		for (idx = 0; idx < s->PaletteCount; idx++) {
+			if (palette[idx] == block) break;
+		}
+
+		/* Add to palette if there is room left */
+		if (idx == s->PaletteCount && idx < (1 << bits)) {
+			palette[idx] = block;
+			s->PaletteCount++;
+		}
+
+		if (idx < s->PaletteCount) {
+			indices = Section_Indices(s);
+			bit  = i * bits;
+			mask = (1 << bits) - 1;
+			indices[bit >> 3] = (indices[bit >> 3] & ~(mask << (bit & 7))) | (idx << (bit & 7));
+			return true;
+		}
+	}
+
+	/* Palette needs to be larger, so rebuild the section */
+	Section_Decode(s, blocks);
+	blocks[i] = block;
+	return Section_Encode(s, blocks);
+}
+
+static void FreeSections(void) {
+	int i, count = sectionsX * sectionsY * sectionsZ;
+	if (!World.Sections) return;
+
+	for (i = 0; i < count; i++) { Mem_Free(World.Sections[i].Data); }
+	Mem_Free(World.Sections);
+	World.Sections = NULL;
+}
+
+static cc_bool AllocSections(void) {
+	sectionsX = (World.Width  + SECTION_MASK) >> SECTION_SHIFT;
+	sectionsY = (World.Height + SECTION_MASK) >> SECTION_SHIFT;
+	sectionsZ = (World.Length + SECTION_MASK) >> SECTION_SHIFT;
+
+	/* Cleared sections are all air, without any data allocated */
+	World.Sections = (struct WorldSection*)Mem_TryAllocCleared(sectionsX * sectionsY * sectionsZ, sizeof(struct WorldSection));
+	return World.Sections != NULL;
+}
+
+BlockID World_GetSectionBlock(int x, int y, int z) {
+	return Section_GetBlock(Section_At(x, y, z), Section_Index(x, y, z));
+}
+
+void World_GetSectionRow(int x, int y, int z, int count, BlockID* blocks) {
+	struct WorldSection* s;
+	int i, n, index;
+
+	for (; count > 0; x += n, count -= n) {
+		s = Section_At(x, y, z);
+		n = min(count, SECTION_SIZE - (x & SECTION_MASK));
+
+		if (!s->Data) {
+			for (i = 0; i < n; i++) { *blocks++ = s->Block; }
+		} else {
+			index = Section_Index(x, y, z);
+			for (i = 0; i < n; i++) { *blocks++ = Section_GetBlock(s, index + i); }
+		}
+	}
+}
+
+static void SetSectionBlock(int x, int y, int z, BlockID block) {
+	if (!Section_SetBlock(Section_At(x, y, z), Section_Index(x, y, z), block)) {
+		World_OutOfMemory(); return;
+	}
+#ifdef EXTENDED_BLOCKS
+	if (block > 0xFF) World.IDMask = 0x3FF;
+#endif
+}
+
+/* Copies the blocks in the given section from a slab of (up to) 16 layers of the map. */
+/* When reading the upper 8 bits of blocks, returns false if they are all 0 (so section is unchanged) */
+static cc_bool Section_Read(struct WorldSection* s, const BlockRaw* slab, int x1, int z1, int layers,
+							cc_bool upper, BlockID* blocks) {
+	int width = min(SECTION_SIZE, World.Width - x1), length = min(SECTION_SIZE, World.Length - z1);
+	int x, y, z, any = 0;
+	const BlockRaw* src;
+	BlockID* dst;
+
+	if (upper) {
+		for (y = 0; y < layers; y++) {
+			for (z = 0; z < length; z++) {
+				src = slab + (y * World.Length + z1 + z) * World.Width + x1;
+				for (x = 0; x < width; x++) { any |= src[x]; }
+			}
+		}
+		if (!any) return false;
+		Section_Decode(s, blocks);
+	} else if (width < SECTION_SIZE || length < SECTION_SIZE || layers < SECTION_SIZE) {
+		/* Parts of sections outside the map are treated as air */
+		Mem_Set(blocks, 0, SECTION_VOLUME * sizeof(BlockID));
+	}
+
+	for (y = 0; y < layers; y++) {
+		for (z = 0; z < length; z++) {
+			src = slab   + (y * World.Length + z1 + z) * World.Width + x1;
+			dst = blocks + (y << 8) + (z << 4);
+
+			if (upper) {
+				for (x = 0; x < width; x++) { dst[x] = (dst[x] | (src[x] << 8)) & SECTION_ID_MASK; }
+			} else {
+				for (x = 0; x < width; x++) { dst[x] = src[x]; }
+			}
+		}
+	}
+	return true;
+}
+
+/* Copies the blocks in the given section into a slab of (up to) 16 layers of the map. */
+static void Section_Write(struct WorldSection* s, BlockRaw* slab, int x1, int z1, int layers,
+							cc_bool upper, BlockID* blocks) {
+	int width = min(SECTION_SIZE, World.Width - x1), length = min(SECTION_SIZE, World.Length - z1);
+	int x, y, z, shift = upper ? 8 : 0;
+	const BlockID* src;
+	BlockRaw* dst;
+
+	if (!s->Data) {
+		for (y = 0; y < layers; y++) {
+			for (z = 0; z < length; z++) {
+				dst = slab + (y * World.Length + z1 + z) * World.Width + x1;
+				Mem_Set(dst, (BlockRaw)(s->Block >> shift), width);
+			}
+		}
+		return;
+	}
+
+	Section_Decode(s, blocks);
+	for (y = 0; y < layers; y++) {
+		for (z = 0; z < length; z++) {
+			src = blocks + (y << 8) + (z << 4);
+			dst = slab   + (y * World.Length + z1 + z) * World.Width + x1;
+			for (x = 0; x < width; x++) { dst[x] = (BlockRaw)(src[x] >> shift); }
+		}
+	}
+}
+
+static cc_result ReadSections(struct Stream* src, cc_bool upper) {
+	struct WorldSection* s;
+	BlockRaw* slab;
+	BlockID* blocks;
+	int x, y, z, layers, slabSize;
+	cc_result res = 0;
+
+	if (!upper && !World.Sections && !AllocSections()) return ERR_OUT_OF_MEMORY;
+	if (!World.Sections) return 0;
+
+	/* Blocks are read 16 layers at a time, so that only one layer of sections needs to be in memory at once */
+	slabSize = World.Width * World.Length * SECTION_SIZE;
+	slab     = (BlockRaw*)Mem_TryAlloc(slabSize + SECTION_VOLUME * sizeof(BlockID), 1);
+	if (!slab) return ERR_OUT_OF_MEMORY;
+	blocks   = (BlockID*)(slab + slabSize);
+
+	for (y = 0; y < World.Height && !res; y += SECTION_SIZE) {
+		layers = min(SECTION_SIZE, World.Height - y);
+		if ((res = Stream_Read(src, slab, World.Width * World.Length * layers))) break;
+
+		for (z = 0; z < World.Length && !res; z += SECTION_SIZE) {
+			for (x = 0; x < World.Width; x += SECTION_SIZE) {
+				s = Section_At(x, y, z);
+				if (!Section_Read(s, slab, x, z, layers, upper, blocks)) continue;
+				if (!Section_Encode(s, blocks)) { res = ERR_OUT_OF_MEMORY; break; }
+			}
+		}
+	}
+
+	Mem_Free(slab);
+	return res;
+}
+
+static cc_result WriteSections(struct Stream* dst, cc_bool upper) {
+	BlockRaw* slab;
+	BlockID* blocks;
+	int x, y, z, layers, slabSize;
+	cc_result res = 0;
+
+	slabSize = World.Width * World.Length * SECTION_SIZE;
+	slab     = (BlockRaw*)Mem_TryAlloc(slabSize + SECTION_VOLUME * sizeof(BlockID), 1);
+	if (!slab) return ERR_OUT_OF_MEMORY;
+	blocks   = (BlockID*)(slab + slabSize);
+
+	for (y = 0; y < World.Height; y += SECTION_SIZE) {
+		layers = min(SECTION_SIZE, World.Height - y);
+
+		for (z = 0; z < World.Length; z += SECTION_SIZE) {
+			for (x = 0; x < World.Width; x += SECTION_SIZE) {
+				Section_Write(Section_At(x, y, z), slab, x, z, layers, upper, blocks);
+			}
+		}
+		if ((res = Stream_Write(dst, slab, World.Width * World.Length * layers))) break;
+	}
+
+	Mem_Free(slab);
+	return res;
+}
+
+cc_result World_ReadSections(struct Stream* src)  { return ReadSections(src,  false); }
+cc_result World_WriteSections(struct Stream* dst) { return WriteSections(dst, false); }
+
+#ifdef EXTENDED_BLOCKS
+cc_result World_ReadSectionsUpper(struct Stream* src) {
+	World.IDMask = 0x3FF;
+	return ReadSections(src, true);
+}
+cc_result World_WriteSectionsUpper(struct Stream* dst) { return WriteSections(dst, true); }
+#endif
+
+/* Converts the flat blocks array of the world into sections, then frees the flat array */
+static void ConvertToSections(void) {
+	struct Stream mem;
+	cc_result res;
+
+	Stream_ReadonlyMemory(&mem, World.Blocks, World.Volume);
+	res = World_ReadSections(&mem);
+#ifdef EXTENDED_BLOCKS
+	if (!res && World.Blocks2 != World.Blocks) {
+		Stream_ReadonlyMemory(&mem, World.Blocks2, World.Volume);
+		res = World_ReadSectionsUpper(&mem);
+	}
+#endif
+	/* Not enough memory for sections, so just keep using the flat array */
+	if (res) { FreeSections(); return; }
+
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) Mem_Free(World.Blocks2);
+	World.Blocks2 = NULL;
+#endif
+	Mem_Free(World.Blocks);
+	World.Blocks = NULL;
+}
+
+
 /*########################################################################################################################*
 *----------------------------------------------------------World----------------------------------------------------------*
 *#########################################################################################################################*/
@@ -44,6 +419,7 @@ void World_Reset(void) {
 #endif
 	Mem_Free(World.Blocks);
 	World.Blocks = NULL;
+	FreeSections();
 
 	World_SetDimensions(0, 0, 0);
 	World.Loaded   = false;
@@ -58,19 +434,21 @@ void World_NewMap(void) {
 
 void World_SetNewMap(BlockRaw* blocks, int width, int height, int length) {
 	/* TODO: TEMP HACK */
-	if (!blocks) { width = 0; height = 0; length = 0; }
+	if (!blocks && !World.Sections) { width = 0; height = 0; length = 0; }
 
 	World_SetDimensions(width, height, length);
 	World.Blocks = blocks;
 
-	if (!World.Volume) World.Blocks = NULL;
+	if (!World.Volume) { World.Blocks = NULL; FreeSections(); }
 #ifdef EXTENDED_BLOCKS
 	/* .cw maps may have set this to a non-NULL when importing */
-	if (!World.Blocks2) {
+	if (!World.Blocks2 && !World.Sections) {
 		World.Blocks2 = World.Blocks;
 		World.IDMask  = 0xFF;
 	}
 #endif
+	/* Maps loaded from a flat array (e.g. from a server or generated) */
+	if (World.Blocks && World.Volume > WORLD_MAX_FLAT_VOLUME) ConvertToSections();
 
 	if (Env.EdgeHeight == -1)   { Env.EdgeHeight   = height / 2; }
 	if (Env.CloudsHeight == -1) { Env.CloudsHeight = height + 2; }
@@ -113,7 +491,10 @@ static CC_NOINLINE void LazyInitUpper(int i, BlockID block) {
 }
 
 void World_SetBlock(int x, int y, int z, BlockID block) {
-	int i = World_Pack(x, y, z);
+	int i;
+	if (World.Sections) { SetSectionBlock(x, y, z, block); return; }
+
+	i = World_Pack(x, y, z);
 	World.Blocks[i] = (BlockRaw)block;
 
 	/* defer allocation of second map array if possible */
@@ -126,10 +507,23 @@ void World_SetBlock(int x, int y, int z, BlockID block) {
 }
 #else
 void World_SetBlock(int x, int y, int z, BlockID block) {
+	if (World.Sections) { SetSectionBlock(x, y, z, block); return; }
 	World.Blocks[World_Pack(x, y, z)] = block; 
 }
 #endif
 
+cc_bool World_TrySetBlock(int x, int y, int z, BlockID block) {
+	int i;
+	if (World.Sections) return Section_SetBlock(Section_At(x, y, z), Section_Index(x, y, z), block);
+
+	i = World_Pack(x, y, z);
+	World.Blocks[i] = (BlockRaw)block;
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) World.Blocks2[i] = 0;
+#endif
+	return true;
+}
+
 BlockID World_GetPhysicsBlock(int x, int y, int z) {
 	if (y < 0 || !World_ContainsXZ(x, z)) return BLOCK_BEDROCK;
 	if (y >= World.Height) return BLOCK_AIR;
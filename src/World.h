@@ -7,6 +7,8 @@
    Copyright 2014-2021 ClassiCube | Licensed under BSD-3
 */
 struct AABB;
+struct Stream;
+struct WorldSection;
 extern struct IGameComponent World_Component;
 
 /* Unpacka an index into x,y,z (slow!) */
@@ -46,7 +48,18 @@ CC_VAR extern struct _WorldData {
 	cc_bool Loaded;
 	/* Point in time the current world was last saved at */
 	double LastSave;
+	/* The blocks in the world, stored as 16x16x16 sections with per-section palettes. */
+	/* NOTE: Only used instead of Blocks for very large maps (see WORLD_MAX_FLAT_VOLUME) */
+	struct WorldSection* Sections;
 } World;
+/* Whether the world currently has any blocks. (either as a flat array or as sections) */
+#define World_HasBlocks() (World.Blocks || World.Sections)
+
+/* Maps larger than this volume are stored as sections, instead of as one flat array. */
+/* Most of a large map is usually air or only a few different blocks, which sections store much more compactly. */
+#ifndef WORLD_MAX_FLAT_VOLUME
+#define WORLD_MAX_FLAT_VOLUME (64 * 1024 * 1024)
+#endif
 
 /* Frees the blocks array, sets dimensions to 0, resets environment to default. */
 void World_Reset(void);
@@ -61,18 +74,42 @@ CC_API void World_SetNewMap(BlockRaw* blocks, int width, int height, int length)
 CC_NOINLINE void World_SetDimensions(int width, int height, int length);
 void World_OutOfMemory(void);
 
+/* Gets the block at the given coordinates, when the world is stored as sections. */
+/* NOTE: Does NOT check that the coordinates are inside the map. */
+CC_API BlockID World_GetSectionBlock(int x, int y, int z);
+/* Copies the given number of blocks along the X axis, starting at the given coordinates. */
+/* NOTE: Does NOT check that the coordinates are inside the map. Only for when world is stored as sections. */
+void World_GetSectionRow(int x, int y, int z, int count, BlockID* blocks);
+/* Reads World.Volume blocks (in World_Pack order) from the given stream into sections. */
+/* NOTE: World.Width/Height/Length must be set beforehand. */
+cc_result World_ReadSections(struct Stream* src);
+/* Writes the lower 8 bits of all blocks (in World_Pack order) to the given stream. */
+cc_result World_WriteSections(struct Stream* dst);
+
 #ifdef EXTENDED_BLOCKS
 /* Sets World.Blocks2 and updates internal state for more than 256 blocks. */
 void World_SetMapUpper(BlockRaw* blocks);
+/* Reads the upper 8 bits of World.Volume blocks from the given stream into sections. */
+cc_result World_ReadSectionsUpper(struct Stream* src);
+/* Writes the upper 8 bits of all blocks (in World_Pack order) to the given stream. */
+cc_result World_WriteSectionsUpper(struct Stream* dst);
 
 /* Gets the block at the given coordinates. */
 /* NOTE: Does NOT check that the coordinates are inside the map. */
 static CC_INLINE BlockID World_GetBlock(int x, int y, int z) {
-	int i = World_Pack(x, y, z);
+	int i;
+	if (World.Sections) return World_GetSectionBlock(x, y, z);
+
+	i = World_Pack(x, y, z);
 	return (BlockID)((World.Blocks[i] | (World.Blocks2[i] << 8)) & World.IDMask);
 }
 #else
-#define World_GetBlock(x, y, z) World.Blocks[World_Pack(x, y, z)]
+/* Gets the block at the given coordinates. */
+/* NOTE: Does NOT check that the coordinates are inside the map. */
+static CC_INLINE BlockID World_GetBlock(int x, int y, int z) {
+	if (World.Sections) return World_GetSectionBlock(x, y, z);
+	return World.Blocks[World_Pack(x, y, z)];
+}
 #endif
 
 /* If Y is above the map, returns BLOCK_AIR. */
@@ -82,6 +119,11 @@ BlockID World_GetPhysicsBlock(int x, int y, int z);
 /* Sets the block at the given coordinates. */
 /* NOTE: Does NOT check that the coordinates are inside the map. */
 void World_SetBlock(int x, int y, int z, BlockID block);
+/* Sets the block at the given coordinates, returning false instead if out of memory. */
+/* NOTE: Does NOT check that the coordinates are inside the map. Only for blocks below 256. */
+/* NOTE: Can be called from a background thread, as long as no other thread is accessing */
+/*  the same 16x16x16 section of the map at the same time. (e.g. for parallel liquid physics) */
+cc_bool World_TrySetBlock(int x, int y, int z, BlockID block);
 /* If coordinates are outside the map, returns BLOCK_AIR. */
 /* Otherwise returns the block at the given coordinates. */
 BlockID World_SafeGetBlock(int x, int y, int z);
@@ -14,7 +14,7 @@ struct _GfxData Gfx;
 GfxResourceID Gfx_defaultIb;
 GfxResourceID Gfx_quadVb, Gfx_texVb;
 
-static const int strideSizes[2] = { SIZEOF_VERTEX_COLOURED, SIZEOF_VERTEX_TEXTURED };
+static const int strideSizes[3] = { SIZEOF_VERTEX_COLOURED, SIZEOF_VERTEX_TEXTURED, SIZEOF_VERTEX_PACKED };
 /* Whether mipmaps must be created for all dimensions down to 1x1 or not */
 static cc_bool customMipmapsLevels;
 #define ORTHO_NEAR -10000.0f
@@ -92,6 +92,8 @@ void Gfx_RecreateContext(void) {
 	Event_RaiseVoid(&GfxEvents.ContextRecreated);
 }
 
+#if defined CC_BUILD_D3D9 || defined CC_BUILD_D3D11
+/* Only the Direct3D backends can tell when the game is minimised or hidden */
 cc_bool reducedPerformance;
 static void TickReducedPerformance(void) {
 	Thread_Sleep(100); /* 10 FPS */
@@ -106,6 +108,7 @@ static void EndReducedPerformance(void) {
 	reducedPerformance = false;
 	Chat_AddRaw("&eExited reduced performance mode");
 }
+#endif
 
 
 void Gfx_RecreateDynamicVb(GfxResourceID* vb, VertexFormat fmt, int maxVertices) {
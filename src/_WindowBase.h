@@ -70,6 +70,10 @@ void OpenKeyboardArgs_Init(struct OpenKeyboardArgs* args, STRING_REF const cc_st
 }
 
 
+#ifdef CC_BUILD_GL
+/* OpenGL contexts are heavily tied to the window, so for simplicitly are also included here */
+/* EGL is window system agnostic, other OpenGL context backends are tied to one windowing system. */
+
 struct GraphicsMode { int R, G, B, A, IsIndexed; };
 /* Creates a GraphicsMode compatible with the default display device */
 static void InitGraphicsMode(struct GraphicsMode* m) {
@@ -96,9 +100,6 @@ static void InitGraphicsMode(struct GraphicsMode* m) {
 	}
 }
 
-#ifdef CC_BUILD_GL
-/* OpenGL contexts are heavily tied to the window, so for simplicitly are also included here */
-/* EGL is window system agnostic, other OpenGL context backends are tied to one windowing system. */
 #define GLContext_IsInvalidAddress(ptr) (ptr == (void*)0 || ptr == (void*)1 || ptr == (void*)-1 || ptr == (void*)2)
 
 void GLContext_GetAll(const struct DynamicLibSym* syms, int count) {